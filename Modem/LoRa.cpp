@@ -54,6 +54,8 @@
 #define PA_BOOST                 0x80
 
 // IRQ masks
+#define IRQ_CAD_DETECTED_MASK      0x01
+#define IRQ_CAD_DONE_MASK          0x04
 #define IRQ_TX_DONE_MASK           0x08
 #define IRQ_PAYLOAD_CRC_ERROR_MASK 0x20
 #define IRQ_RX_DONE_MASK           0x40
@@ -78,7 +80,9 @@ LoRaClass::LoRaClass() :
   _packetIndex(0),
   _implicitHeaderMode(0),
   _onReceive(NULL),
-  _onTxDone(NULL)
+  _onTxDone(NULL),
+  _onCadDone(NULL),
+  _crcErrors(0)
 {
   // overide Stream timeout value
   setTimeout(0);
@@ -273,26 +277,47 @@ int LoRaClass::packetRssi()
 
 float LoRaClass::packetSnr()
 {
-  return ((int8_t)readRegister(REG_PKT_SNR_VALUE)) * 0.25;
+  return packetSnrRaw() * 0.25;
+}
+
+int8_t LoRaClass::packetSnrRaw()
+{
+  return (int8_t)readRegister(REG_PKT_SNR_VALUE);
 }
 
 long LoRaClass::packetFrequencyError()
 {
+  int32_t freqError = packetFrequencyErrorRaw();
+
+  const float fXtal = 32E6; // FXOSC: crystal oscillator (XTAL) frequency (2.5. Chip Specification, p. 14)
+  const float fError = ((static_cast<float>(freqError) * (1L << 24)) / fXtal) * (getSignalBandwidth() / 500000.0f); // p. 37
+
+  return static_cast<long>(fError);
+}
+
+int32_t LoRaClass::packetFrequencyErrorRaw()
+{
+  // MSB, MID y LSB son consecutivos: se leen en una ráfaga
+  uint8_t reg[3];
+  readRegisters(REG_FREQ_ERROR_MSB, reg, sizeof(reg));
+
   int32_t freqError = 0;
-  freqError = static_cast<int32_t>(readRegister(REG_FREQ_ERROR_MSB) & B111);
+  freqError = static_cast<int32_t>(reg[0] & B111);
   freqError <<= 8L;
-  freqError += static_cast<int32_t>(readRegister(REG_FREQ_ERROR_MID));
+  freqError += static_cast<int32_t>(reg[1]);
   freqError <<= 8L;
-  freqError += static_cast<int32_t>(readRegister(REG_FREQ_ERROR_LSB));
+  freqError += static_cast<int32_t>(reg[2]);
 
-  if (readRegister(REG_FREQ_ERROR_MSB) & B1000) { // Sign bit is on
+  if (reg[0] & B1000) { // Sign bit is on
      freqError -= 524288; // B1000'0000'0000'0000'0000
   }
 
-  const float fXtal = 32E6; // FXOSC: crystal oscillator (XTAL) frequency (2.5. Chip Specification, p. 14)
-  const float fError = ((static_cast<float>(freqError) * (1L << 24)) / fXtal) * (getSignalBandwidth() / 500000.0f); // p. 37
+  return freqError;
+}
 
-  return static_cast<long>(fError);
+uint32_t LoRaClass::crcErrors()
+{
+  return _crcErrors;
 }
 
 int LoRaClass::rssi()
@@ -314,10 +339,8 @@ size_t LoRaClass::write(const uint8_t *buffer, size_t size)
     size = MAX_PKT_LENGTH - currentLength;
   }
 
-  // write data
-  for (size_t i = 0; i < size; i++) {
-    writeRegister(REG_FIFO, buffer[i]);
-  }
+  // write data (ráfaga: una sola transacción SPI para todo el buffer)
+  writeRegisters(REG_FIFO, buffer, size);
 
   // update length
   writeRegister(REG_PAYLOAD_LENGTH, currentLength + size);
@@ -400,6 +423,24 @@ void LoRaClass::onTxDone(void(*callback)())
   }
 }
 
+void LoRaClass::onCadDone(void(*callback)(bool))
+{
+  _onCadDone = callback;
+
+  if (callback) {
+    pinMode(_dio0, INPUT);
+#ifdef SPI_HAS_NOTUSINGINTERRUPT
+    SPI.usingInterrupt(digitalPinToInterrupt(_dio0));
+#endif
+    attachInterrupt(digitalPinToInterrupt(_dio0), LoRaClass::onDio0Rise, RISING);
+  } else {
+    detachInterrupt(digitalPinToInterrupt(_dio0));
+#ifdef SPI_HAS_NOTUSINGINTERRUPT
+    SPI.notUsingInterrupt(digitalPinToInterrupt(_dio0));
+#endif
+  }
+}
+
 void LoRaClass::receive(int size)
 {
 
@@ -430,6 +471,8 @@ void LoRaClass::sleep()
 void LoRaClass::CAD()
 {
   /*Se inicia un analisis de actividad de canal*/
+  if (_onCadDone)
+      writeRegister(REG_DIO_MAPPING_1, 0x80); // DIO0 => CADDONE
   writeRegister(REG_OP_MODE, MODE_LONG_RANGE_MODE | MODE_CAD);
 }
 
@@ -702,7 +745,10 @@ void LoRaClass::implicitHeaderMode()
 
 void LoRaClass::handleDio0Rise()
 {
-  int irqFlags = readRegister(REG_IRQ_FLAGS);
+  // Ráfaga de 0x10 a 0x13: [RX_CURRENT_ADDR][IRQ_FLAGS_MASK][IRQ_FLAGS][RX_NB_BYTES]
+  uint8_t reg[4];
+  readRegisters(REG_FIFO_RX_CURRENT_ADDR, reg, sizeof(reg));
+  int irqFlags = reg[REG_IRQ_FLAGS - REG_FIFO_RX_CURRENT_ADDR];
 
   // clear IRQ's
   writeRegister(REG_IRQ_FLAGS, irqFlags);
@@ -714,10 +760,10 @@ void LoRaClass::handleDio0Rise()
       _packetIndex = 0;
 
       // read packet length
-      int packetLength = _implicitHeaderMode ? readRegister(REG_PAYLOAD_LENGTH) : readRegister(REG_RX_NB_BYTES);
+      int packetLength = _implicitHeaderMode ? readRegister(REG_PAYLOAD_LENGTH) : reg[REG_RX_NB_BYTES - REG_FIFO_RX_CURRENT_ADDR];
 
       // set FIFO address to current RX address
-      writeRegister(REG_FIFO_ADDR_PTR, readRegister(REG_FIFO_RX_CURRENT_ADDR));
+      writeRegister(REG_FIFO_ADDR_PTR, reg[0]);
 
       if (_onReceive) {
         _onReceive(packetLength);
@@ -728,6 +774,15 @@ void LoRaClass::handleDio0Rise()
         _onTxDone();
       }
     }
+    else if ((irqFlags & IRQ_CAD_DONE_MASK) != 0) {
+      // al terminar el CAD la radio vuelve sola a standby
+      if (_onCadDone) {
+        _onCadDone((irqFlags & IRQ_CAD_DETECTED_MASK) != 0);
+      }
+    }
+  } else if ((irqFlags & IRQ_RX_DONE_MASK) != 0) {
+    // paquete con CRC inválido: la radio ya lo descartó, sólo se cuenta
+    _crcErrors++;
   }
 }
 
@@ -760,13 +815,27 @@ uint8_t LoRaClass::singleTransfer(uint8_t address, uint8_t value)
 void LoRaClass::readPayload(uint8_t * buffer, uint8_t size)
 {
   /*Lectura del payload en modo FIFO*/
+  readRegisters(REG_FIFO, buffer, size);
+}
+
+void LoRaClass::readRegisters(uint8_t address, uint8_t * buffer, uint8_t size)
+{
+  /*Lectura en ráfaga: la radio incrementa la dirección tras cada byte (salvo en la FIFO)*/
+  digitalWrite(_ss, LOW);// chip select
+  _spi->beginTransaction(_spiSettings);
+  _spi->transfer(address & 0x7f);
+  _spi->transferBytes(NULL,buffer,size);// más eficiente que un transfer por byte
+  _spi->endTransaction();
+  digitalWrite(_ss, HIGH);
+}
+
+void LoRaClass::writeRegisters(uint8_t address, const uint8_t * buffer, uint8_t size)
+{
+  /*Escritura en ráfaga, misma trama SPI que readRegisters con el bit de escritura*/
   digitalWrite(_ss, LOW);// chip select
   _spi->beginTransaction(_spiSettings);
-  _spi->transfer(REG_FIFO);
-  _spi->transferBytes(NULL,buffer,size);// más eficiente
-  //for (size_t i=0;i<size;i++)
-  //  buffer[i] = _spi->transfer(0x00);// se tranfieren 0 para que se devuelva el payload
-    // a traves de MISO
+  _spi->transfer(address | 0x80);
+  _spi->writeBytes(buffer,size);
   _spi->endTransaction();
   digitalWrite(_ss, HIGH);
 }
@@ -48,6 +48,9 @@ public:
   int packetRssi();
   float packetSnr();
   long packetFrequencyError();
+  int8_t packetSnrRaw();             // SNR en pasos de 0.25 dB, sin punto flotante (apto para ISR)
+  int32_t packetFrequencyErrorRaw(); // registro de error de frecuencia con signo (20 bits)
+  uint32_t crcErrors();              // paquetes descartados por CRC inválido (contados en la interrupción)
   int rssi();
 
   void readPayload(uint8_t * buffer, uint8_t size);// capturar payload en buffer
@@ -65,6 +68,7 @@ public:
 #ifndef ARDUINO_SAMD_MKRWAN1300
   void onReceive(void(*callback)(int));
   void onTxDone(void(*callback)());
+  void onCadDone(void(*callback)(bool)); // el argumento indica si se detectó actividad
 
   void receive(int size = 0);
 #endif
@@ -115,6 +119,8 @@ private:
   uint8_t readRegister(uint8_t address);
   void writeRegister(uint8_t address, uint8_t value);
   uint8_t singleTransfer(uint8_t address, uint8_t value);
+  void readRegisters(uint8_t address, uint8_t * buffer, uint8_t size);        // ráfaga, una transacción SPI
+  void writeRegisters(uint8_t address, const uint8_t * buffer, uint8_t size); // ráfaga, una transacción SPI
   static void onDio0Rise();
 
 private:
@@ -128,6 +134,8 @@ private:
   int _implicitHeaderMode;
   void (*_onReceive)(int);
   void (*_onTxDone)();
+  void (*_onCadDone)(bool);
+  volatile uint32_t _crcErrors;
 };
 
 extern LoRaClass LoRa;
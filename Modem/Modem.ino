@@ -1,4 +1,17 @@
 #include "red.h"
+#include "ruteo.h"
+#include "inundacion.h"
+#include "adr.h"
+#include "tramas.h"
+#include "slip.h"
+#include "pantalla.h"
+#include "telemetria.h"
+#include "control.h"
+#include "entrega.h"
+#include "grupos.h"
+#include "lote.h"
+#include "protocolos.h"
+#include "freertos/task.h"
 #include <SPI.h>
 #include <Wire.h>
 #include <Adafruit_GFX.h>
@@ -10,32 +23,76 @@
 #define OLED_RESET     16
 #define OLED_SDA        4
 #define OLED_SCL       15
+#define PERIODO_REFRESCO_OLED_MS 50 // las peticiones que lleguen en este lapso se juntan en un dibujo
 
-// Configuración LoRa
-#define SF_LORA 7
-#define BW_LORA 250000L
+// Configuración LoRa: se arranca en el escalón base de ADR (el más robusto)
+// y ADR acelera según el SNR de los vecinos
+#define SF_LORA 12
+#define BW_LORA 125000L
 #define CRC_LORA 1
 #define TX_POWER_LORA 15
-
-// Configuración SLIP
-#define SLIP_END     0xC0
-#define SLIP_ESC     0xDB
-#define SLIP_ESC_END 0xDC
-#define SLIP_ESC_ESC 0xDD
+#define FEC_PARIDAD_LORA 0   // bytes de paridad Reed-Solomon por trama (0 = sin FEC, ej: 8 corrige 4 bytes)
+// Ocupación del canal: en 915 MHz no hay ciclo de trabajo; en EU868 usar
+// 10 (1 %). El máximo por trama es el tiempo de permanencia regional
+#define CICLO_TRABAJO_PORMIL 1000 // 1000 = sin límite
+#define RAFAGA_AIRE_MS       4000 // aire que se puede usar seguido
+#define MAXIMO_AIRE_TRAMA_MS 0    // 0 = sin límite
+// Escucha de bajo consumo: la radio duerme y muestrea el canal con CAD en
+// este intervalo. Igual en toda la red: cada trama lleva un preámbulo de
+// este largo, que se suma a la latencia y al aire de quien transmite
+#define INTERVALO_ESCUCHA_MS 0    // 0 = recepción continua
+// Varios canales: cada modem recibe en uno propio según su IP y en el de
+// encuentro (broadcast). Igual en toda la red
+#define CANALES_LORA         1    // incluido el de encuentro (1 = sólo 915 MHz)
+// ACK del Nodo como trama de control en cabecera implícita (control.h).
+// Igual en toda la red: quien envía una trama que el Nodo destino confirma
+// escucha sólo tramas implícitas durante la ventana
+#define ACK_IMPLICITO      1
+#define VENTANA_CONTROL_MS 250    // UART y lazo del Nodo destino hasta su ACK
+// Reenvío directo: las tramas que el modem sólo pasa de la UART a la radio
+// (o al revés) se revisan en el buffer decodificado y salen sin armar un
+// IPv4Packet ni reconstruirlas
+#define REENVIO_DIRECTO    1
+// Entrega en el modem (entrega.h) para las tramas que el Nodo marca con
+// FLAG_ENTREGA_MODEM: margen sobre el aire de ida y vuelta antes de
+// retransmitir (acceso al canal y cola)
+#define MARGEN_ENTREGA_MS  500
 
 // LED integrado
 #define LED_PIN 25
 
 // Tamaños de buffer
-#define BUFFER_SIZE 512
 #define MAX_PACKET_SIZE 255
+#define BLOQUE_UART     128     // bytes leídos del driver de la UART por llamada
+
+// Tareas FreeRTOS: la radio en el núcleo de la aplicación (donde se
+// atiende la interrupción DIO0) y el puerto serie y el display en el otro
+#define NUCLEO_RADIO       1
+#define NUCLEO_SERIAL      0
+#define PRIORIDAD_RADIO    3
+#define PRIORIDAD_SERIAL   2
+#define PRIORIDAD_DISPLAY  1
+#define PILA_TAREA         4096
+#define LARGO_COLA_TRAMAS  8
+
+// Cabecera IPv4 simplificada: mismo formato de 11 bytes que usa el Nodo
+#define IPV4_CABECERA 11
+
+// Bits de flag_fragmento usados por el modem
+#define FLAG_METADATA_ENLACE 0x1   // la trama a UART trae el trailer de calidad de enlace
+#define FLAG_MALLA           0x2   // los datos comienzan con el prefijo de malla (ver ruteo.h)
+#define FLAG_ENTREGA_MODEM   0x4   // confirma el modem de destino y reintenta el de origen (ver entrega.h)
+
+// Identificadores: el Nodo numera sus tramas en 1..0x7FFF y el modem las
+// que origina (ACK, anuncios, protocolo propio) con el bit alto, para que
+// con la misma IP de origen no choquen en los (origen, id) ya vistos
+#define ID_MODEM             0x8000
 
 // Estructura IPv4 simplificada
 struct IPv4Packet {
-    uint8_t flag_fragmento : 2;
+    uint8_t flag_fragmento : 4;
     uint16_t offset_fragmento : 12;
     uint8_t longitud_total;
-    uint8_t relleno;
     uint16_t identificador;
     uint8_t protocolo;
     uint8_t checksum;
@@ -45,40 +102,138 @@ struct IPv4Packet {
     uint8_t datos_len;
 };
 
-// Estructura protocolo propio
+// Estructura protocolo propio; dentro de un lote el dato puede venir en
+// varios tramos de 63 bytes (ver lote.h)
 struct PropioProtocolo {
     uint8_t cmd;
     uint8_t longitud_de_dato;
-    uint8_t dato[63];
+    uint8_t dato[MAX_DATO_ENCADENADO];
     uint8_t fcs;
 };
 
 // Variables globales
 Red red;
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+Pantalla pantalla(display, &Wire);   // refresco parcial: sólo lo que cambió
 
-uint8_t buffer_uart[BUFFER_SIZE];
-uint8_t buffer_slip[BUFFER_SIZE];
-uint8_t buffer_lora[MAX_PACKET_SIZE];
-int uart_pos = 0;
+uint8_t buffer_lora[MAX_PACKET_SIZE]; // sólo tarea de radio
 bool led_state = false;
-uint16_t mi_ip = 0x3; // IP por defecto, se puede cambiar según el kit
+uint16_t mi_ip = 0x3; // IP por defecto; el Nodo la reemplaza con CMD_DIRECCION
+
+// Ruteo multi-salto
+Ruteo ruteo;
+uint16_t contador_id_modem = ID_MODEM; // identificadores de las tramas que origina el modem
+unsigned long ultimo_anuncio = 0;
+unsigned long intervalo_anuncio = INTERVALO_ANUNCIO_MS;
+
+// Broadcasts de red (protocolo 3) inundados por la malla
+Inundacion inundacion;
+
+// Tasa de datos adaptativa por vecino
+Adr adr;
+unsigned long ultimo_anuncio_adr = 0;
+
+// Unicasts que el modem confirma y retransmite en lugar del Nodo
+Entregas entregas;
+
+// Grupos de multicast del Nodo: lo demás no sube a la UART
+Grupos grupos;
+
+// Respuestas a un lote de comandos, que vuelven juntas (sólo tarea de radio)
+EscritorLote lote_respuesta;
+uint8_t buffer_lote[MAX_LOTE];
+bool lote_abierto = false;
+
+// Contadores consultados por el Nodo con CMD_TELEMETRIA
+Telemetria telemetria;
+EstadisticasProtocolos estadisticas_protocolos;
+
+// Tramas entre tareas: se pasan descriptores del pool, no copias
+PoolTramas pool;
+QueueHandle_t cola_uart_a_radio;  // IPv4 decodificado desde el Nodo
+QueueHandle_t cola_radio_a_uart;  // IPv4 (con trailer de enlace) hacia el Nodo
+QueueHandle_t cola_display;       // comandos 5 y 7 para el OLED
+TaskHandle_t tarea_radio = NULL;
+TaskHandle_t tarea_serial = NULL;
+
+// Recepción SLIP incremental (sólo tarea serial): decodifica en trama_rx
+DecodificadorSLIP slip_rx;
+Trama* trama_rx = NULL;
 
 // Prototipos de funciones
-void procesarMensajeUART();
+void tareaRadio(void* parametro);
+void tareaSerial(void* parametro);
+void tareaDisplay(void* parametro);
+void avisarTareaRadio();
+void avisarTareaSerial();
+void leerUART();
+void escribirUART();
+void procesarMensajeUART(Trama* trama);
 void procesarMensajeLoRa();
-bool decodificarSLIP(uint8_t* entrada, int len_entrada, uint8_t* salida, int* len_salida);
-bool codificarSLIP(uint8_t* entrada, int len_entrada, uint8_t* salida, int* len_salida);
+bool reenviarDirecto(Trama* trama);
+bool entregarDirecto(Trama* trama, int largo, const MetadatosEnlace* enlace);
+void solicitarDisplay(uint8_t cmd, const uint8_t* dato, int largo);
 bool parsearIPv4(uint8_t* datos, int len, IPv4Packet* paquete);
 void construirIPv4(IPv4Packet* paquete, uint8_t* buffer, int* len);
 uint8_t calcularChecksum(IPv4Packet* paquete);
+uint8_t checksumCabecera(const uint8_t* cabecera);
 void procesarProtocoloPropio(PropioProtocolo* comando);
-void enviarPorUART(IPv4Packet* paquete);
+void atenderPropio(IPv4Packet* paquete);
+void atenderComando(IPv4Packet* paquete);
+void atenderRed(IPv4Packet* paquete);
+void responderTelemetria(PropioProtocolo* pedido);
+void responderProtocolos(PropioProtocolo* pedido);
+void configurarDireccion(PropioProtocolo* comando);
+void configurarGrupos(PropioProtocolo* comando);
+void responderPropio(PropioProtocolo* respuesta);
+void ejecutarLote(const uint8_t* datos, int largo);
+void enviarLoteRespuesta();
+void enviarPropio(const uint8_t* datos, int largo);
+bool aceptaDestino(uint16_t destino);
+void actualizarTelemetria();
+void enviarPorUART(IPv4Packet* paquete, const MetadatosEnlace* enlace = NULL);
 void enviarPorLoRa(IPv4Packet* paquete);
+bool transmitirPorTasa(uint8_t* trama, int largo, bool incluir_base = false);
+void actualizarAdr();
+void enviarHaciaRed(IPv4Packet* paquete);
+bool esperaAck(uint8_t protocolo);
+void enviarControlAck(IPv4Packet* paquete);
+void procesarControl(const uint8_t* datos, int largo, const MetadatosEnlace* enlace);
+void registrarEntrega(const uint8_t* trama, int largo);
+void avisarSinSeguimiento(uint16_t destino, uint16_t id);
+bool confirmarEntrega(uint16_t origen, uint16_t id);
+bool pasaAlNodo(uint8_t flags, uint8_t protocolo, uint16_t origen, uint16_t destino, uint16_t id,
+                const uint8_t* datos, int datos_len);
+void avisarEntrega(const AvisoEntrega* aviso);
+uint16_t nuevoIdModem();
+void atenderEntregas();
+void procesarTramaMalla(IPv4Packet* paquete, const MetadatosEnlace* enlace);
+bool agregarPrefijoMalla(IPv4Packet* paquete, uint16_t siguiente, uint8_t saltos);
+void quitarPrefijoMalla(IPv4Packet* paquete);
+void actualizarRuteo();
+void procesarInundacion(IPv4Packet* paquete, const MetadatosEnlace* enlace, uint8_t saltos);
+void atenderInundacion();
 void mostrarEnOLED(String mensaje);
 void mostrarImagenPrueba();
 uint8_t calcularFCS(PropioProtocolo* comando);
 
+// Manejadores de lo que llega del Nodo, indexados por número de protocolo;
+// un protocolo nuevo es una entrada más y los que no están van a la red
+typedef void (*ManejadorUART)(IPv4Packet* paquete);
+constexpr ManejadorUART manejadores_uart[] = {
+    atenderPropio,      // 0 protocolo propio (lotes incluidos)
+    atenderRed,         // 1 ACK
+    atenderRed,         // 2 unicast
+    atenderRed,         // 3 broadcast
+    atenderRed,         // 4 Hello
+    atenderComando,     // 5 prueba
+    atenderComando,     // 6 LED
+    atenderComando,     // 7 OLED
+    atenderRed,         // 8 difusión codificada
+};
+#define PROTOCOLOS_UART (sizeof(manejadores_uart) / sizeof(manejadores_uart[0]))
+static_assert(PROTOCOLOS_UART <= MAX_PROTOCOLOS, "tabla de protocolos más larga que las estadísticas");
+
 void setup() {
     Serial.begin(115200);
     
@@ -93,184 +248,338 @@ void setup() {
     if(!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
         Serial.println("Error al inicializar OLED");
     } else {
+        pantalla.begin();
         display.clearDisplay();
         display.setTextSize(1);
         display.setTextColor(SSD1306_WHITE);
         display.setCursor(0,0);
         display.println("Modem LoRa");
         display.println("Iniciando...");
-        display.display();
+        pantalla.refrescar();
     }
     
     // Inicializar LoRa
     red.begin(SF_LORA, BW_LORA, CRC_LORA, TX_POWER_LORA);
+    adr.begin(millis());
+    red.setFEC(FEC_PARIDAD_LORA);
+    red.setCicloTrabajo(CICLO_TRABAJO_PORMIL, RAFAGA_AIRE_MS, MAXIMO_AIRE_TRAMA_MS);
+    red.setEscuchaBajoConsumo(INTERVALO_ESCUCHA_MS);
+    red.setCanales(CANALES_LORA, mi_ip);
+    if (ACK_IMPLICITO) red.setControlImplicito(TAM_TRAMA_CONTROL, VENTANA_CONTROL_MS);
     
-    // Configurar IP del nodo (se puede leer desde EEPROM o configurar)
-    mi_ip = 0x3;
+    // IP del nodo: la de la inicialización de mi_ip hasta que el Nodo
+    // envíe la suya con CMD_DIRECCION
+    ruteo.begin(mi_ip);
     
     Serial.println("Modem LoRa inicializado");
     Serial.print("IP del nodo: 0x");
     Serial.println(mi_ip, HEX);
     
     mostrarEnOLED("Modem LoRa\nIP: 0x" + String(mi_ip, HEX) + "\nListo");
+    
+    // Colas y tareas; desde aquí el OLED sólo lo usa la tarea de display
+    pool.begin();
+    cola_uart_a_radio = crearColaTramas(LARGO_COLA_TRAMAS);
+    cola_radio_a_uart = crearColaTramas(LARGO_COLA_TRAMAS);
+    cola_display = crearColaTramas(LARGO_COLA_TRAMAS);
+    xTaskCreatePinnedToCore(tareaRadio, "radio", PILA_TAREA, NULL, PRIORIDAD_RADIO, &tarea_radio, NUCLEO_RADIO);
+    xTaskCreatePinnedToCore(tareaSerial, "serial", PILA_TAREA, NULL, PRIORIDAD_SERIAL, &tarea_serial, NUCLEO_SERIAL);
+    xTaskCreatePinnedToCore(tareaDisplay, "display", PILA_TAREA, NULL, PRIORIDAD_DISPLAY, NULL, NUCLEO_SERIAL);
+    red.setAvisoEventos(avisarTareaRadio);
+    Serial.onReceive(avisarTareaSerial);
 }
 
 void loop() {
-    // Procesar mensajes no bloqueantes
-    procesarMensajeUART();
-    procesarMensajeLoRa();
-    
-    // Pequeña pausa para evitar saturar el procesador
-    delay(1);
+    // Todo el trabajo lo hacen las tareas
+    vTaskDelete(NULL);
+}
+
+void IRAM_ATTR avisarTareaRadio() {
+    BaseType_t despertar = pdFALSE;
+    if (tarea_radio != NULL) vTaskNotifyGiveFromISR(tarea_radio, &despertar);
+    if (despertar) portYIELD_FROM_ISR();
 }
 
-void procesarMensajeUART() {
-    // Leer datos del puerto serial de forma no bloqueante
-    while (Serial.available() > 0 && uart_pos < BUFFER_SIZE - 1) {
-        uint8_t byte_recibido = Serial.read();
-        buffer_uart[uart_pos++] = byte_recibido;
+void avisarTareaSerial() {
+    // Callback del driver de la UART (llega datos o vence el timeout de RX)
+    if (tarea_serial != NULL) xTaskNotifyGive(tarea_serial);
+}
+
+void tareaRadio(void* parametro) {
+    for (;;) {
+        // Despierta con una trama desde UART o una interrupción de la radio;
+        // el tick de espera máximo mantiene los backoff y temporizadores
+        ulTaskNotifyTake(pdTRUE, 1);
         
-        // Si encontramos el final del frame SLIP
-        if (byte_recibido == SLIP_END && uart_pos > 1) {
-            // Decodificar SLIP
-            int len_decodificado;
-            if (decodificarSLIP(buffer_uart, uart_pos, buffer_slip, &len_decodificado)) {
-                // Parsear IPv4
-                IPv4Packet paquete;
-                if (parsearIPv4(buffer_slip, len_decodificado, &paquete)) {
-                    // Procesar según las reglas del protocolo
-                    if (paquete.ip_destino == mi_ip ) {
-                        
-                        PropioProtocolo comando;
-                        switch(paquete.protocolo)
-                        {
-                            case 5:
-                                comando.cmd = 5;
-                                procesarProtocoloPropio(&comando);
-                                break;
-                            
-                            case 6:
-                                comando.cmd = 6;
-                                procesarProtocoloPropio(&comando);
-                                break;
-                            case 7:
-                                comando.cmd = 7;
-                                procesarProtocoloPropio(&comando);
-                                break;
-                        }
-                        procesarProtocoloPropio(&comando);
-                        
-                    }
-                    else if (paquete.ip_destino != mi_ip || paquete.ip_destino == 0xFFFF) {
-                        // Reenviar por LoRa si no es protocolo propio
-                        if (paquete.protocolo != 0) {
-                            enviarPorLoRa(&paquete);
-                        }
-                    }
-                }
+        Trama* trama;
+        while (xQueueReceive(cola_uart_a_radio, &trama, 0) == pdTRUE) {
+            procesarMensajeUART(trama);
+            pool.liberar(trama);
+        }
+        while (red.dataDisponible()) {
+            procesarMensajeLoRa();
+        }
+        red.atender();          // transmisión asíncrona: avanza la cola TX
+        actualizarRuteo();
+        actualizarAdr();
+        atenderInundacion();
+        atenderEntregas();
+    }
+}
+
+void tareaSerial(void* parametro) {
+    for (;;) {
+        // Despierta con datos en el driver de la UART o una trama hacia el
+        // Nodo; el timeout cubre un aviso perdido. Es la única que escribe
+        // en Serial: un texto de otra tarea se mezclaría con las tramas SLIP
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+        leerUART();
+        escribirUART();
+    }
+}
+
+void tareaDisplay(void* parametro) {
+    Trama* trama;
+    Trama* siguiente;
+    TickType_t ultimo_refresco = xTaskGetTickCount();
+    for (;;) {
+        if (xQueueReceive(cola_display, &trama, portMAX_DELAY) != pdTRUE) continue;
+        // A lo más un dibujo por período: lo que llegue mientras tanto
+        // reemplaza a la petición pendiente y sólo se dibuja la última
+        TickType_t transcurrido = xTaskGetTickCount() - ultimo_refresco;
+        if (transcurrido < pdMS_TO_TICKS(PERIODO_REFRESCO_OLED_MS)) {
+            vTaskDelay(pdMS_TO_TICKS(PERIODO_REFRESCO_OLED_MS) - transcurrido);
+        }
+        while (xQueueReceive(cola_display, &siguiente, 0) == pdTRUE) {
+            pool.liberar(trama);
+            pantalla.contarCoalescida();
+            trama = siguiente;
+        }
+        if (trama->tipo == 5) {
+            mostrarImagenPrueba();
+        } else if (trama->tipo == 7) {
+            String mensaje = "";
+            for (int i = 0; i < trama->largo; i++) {
+                mensaje += (char)trama->datos[i];
             }
-            uart_pos = 0; // Reiniciar buffer
+            mostrarEnOLED(mensaje);
         }
+        pool.liberar(trama);
+        ultimo_refresco = xTaskGetTickCount();
+    }
+}
+
+void leerUART() {
+    // Lectura en bloque de lo que haya en el driver y decodificación
+    // incremental directo en una trama del pool
+    static uint8_t bloque[BLOQUE_UART];
+    int disponibles;
+    while ((disponibles = Serial.available()) > 0) {
+        int n = Serial.readBytes(bloque, min(disponibles, BLOQUE_UART));
+        telemetria.contar(TEL_UART_BYTES_RX, n);
+        int pos = 0;
+        while (pos < n) {
+            if (trama_rx == NULL) {
+                // Sin tramas libres la trama en curso se descarta y se cuenta
+                trama_rx = pool.tomar();
+                slip_rx.setSalida(trama_rx != NULL ? trama_rx->datos : NULL, TAM_TRAMA);
+            }
+            int usados;
+            int largo = slip_rx.agregar(&bloque[pos], n - pos, &usados);
+            pos += usados;
+            if (largo > 0) {
+                telemetria.contar(TEL_UART_TRAMAS_RX);
+                trama_rx->largo = largo;
+                if (pool.pasar(cola_uart_a_radio, trama_rx)) xTaskNotifyGive(tarea_radio);
+                trama_rx = NULL;
+            }
+        }
+    }
+}
+
+void escribirUART() {
+    Trama* trama;
+    while (xQueueReceive(cola_radio_a_uart, &trama, 0) == pdTRUE) {
+        telemetria.contar(TEL_UART_BYTES_TX, escribirSLIP(Serial, trama->datos, trama->largo));
+        telemetria.contar(TEL_UART_TRAMAS_TX);
+        pool.liberar(trama);
+    }
+}
+
+void procesarMensajeUART(Trama* trama) {
+    // El reenvío directo también cuenta en su protocolo; el byte se lee
+    // antes porque la trama pasa a otra tarea
+    uint8_t protocolo = trama->largo > 5 ? trama->datos[5] : 0;
+    uint32_t inicio = micros();
+    if (REENVIO_DIRECTO && trama->largo >= IPV4_CABECERA && reenviarDirecto(trama)) {
+        estadisticas_protocolos.registrar(protocolo, micros() - inicio);
+        return;
     }
     
-    // Reiniciar buffer si se llena
-    if (uart_pos >= BUFFER_SIZE - 1) {
-        uart_pos = 0;
+    // Parsear IPv4 y despachar por la tabla: un acceso indexado, sin switch
+    IPv4Packet paquete;
+    if (parsearIPv4(trama->datos, trama->largo, &paquete)) {
+        ManejadorUART manejador = paquete.protocolo < PROTOCOLOS_UART ? manejadores_uart[paquete.protocolo] : atenderRed;
+        manejador(&paquete);
+        estadisticas_protocolos.registrar(paquete.protocolo, micros() - inicio);
+    } else {
+        telemetria.contar(TEL_IPV4_INVALIDAS);
+    }
+}
+
+void atenderPropio(IPv4Packet* paquete) {
+    // El protocolo propio es siempre para el modem, aunque el Nodo aún no
+    // le haya dado su IP: un lote o un comando suelto [cmd][largo][dato]
+    if (paquete->datos_len > 0 && paquete->datos[0] == CMD_LOTE) {
+        ejecutarLote(paquete->datos, paquete->datos_len);
+        return;
+    }
+    PropioProtocolo comando;
+    comando.cmd = paquete->datos_len > 0 ? paquete->datos[0] : 0;
+    comando.longitud_de_dato = paquete->datos_len > 1 ? paquete->datos[1] : 0;
+    if (comando.longitud_de_dato > MAX_DATO_COMANDO) comando.longitud_de_dato = MAX_DATO_COMANDO;
+    if (comando.longitud_de_dato + 2 > paquete->datos_len) comando.longitud_de_dato = paquete->datos_len > 2 ? paquete->datos_len - 2 : 0;
+    memcpy(comando.dato, &paquete->datos[2], comando.longitud_de_dato);
+    procesarProtocoloPropio(&comando);
+}
+
+void atenderComando(IPv4Packet* paquete) {
+    // Prueba, LED y OLED dirigidos a la IP propia se ejecutan aquí, una
+    // vez, con los datos de la trama como dato del comando
+    if (paquete->ip_destino != mi_ip) {
+        enviarHaciaRed(paquete);
+        return;
+    }
+    PropioProtocolo comando;
+    comando.cmd = paquete->protocolo;
+    comando.longitud_de_dato = paquete->datos_len > MAX_DATO_ENCADENADO ? MAX_DATO_ENCADENADO : paquete->datos_len;
+    memcpy(comando.dato, paquete->datos, comando.longitud_de_dato);
+    procesarProtocoloPropio(&comando);
+}
+
+void atenderRed(IPv4Packet* paquete) {
+    // Lo que el Nodo se manda a sí mismo no sale al aire
+    if (paquete->ip_destino != mi_ip) {
+        enviarHaciaRed(paquete);
     }
 }
 
 void procesarMensajeLoRa() {
     // Verificar si hay datos disponibles en LoRa
     if (red.dataDisponible()) {
-        int len_recibido = red.getData(buffer_lora, MAX_PACKET_SIZE);
+        MetadatosEnlace enlace;
+        // Se lee directo en una trama del pool, que sigue hacia la UART si no hay nada que cambiarle
+        Trama* trama = REENVIO_DIRECTO ? pool.tomar() : NULL;
+        uint8_t* datos = trama != NULL ? trama->datos : buffer_lora;
+        int len_recibido = red.getData(datos, MAX_PACKET_SIZE, &enlace);
+        if (trama != NULL) {
+            if (entregarDirecto(trama, len_recibido, &enlace)) return;
+            // el camino completo arma sus propias tramas; ésta sólo aporta los datos
+        }
         
-        if (len_recibido > 0) {
+        if (len_recibido > 0 && enlace.implicita) {
+            procesarControl(datos, len_recibido, &enlace);
+        } else if (len_recibido > 0) {
             // Parsear como IPv4
             IPv4Packet paquete;
-            if (parsearIPv4(buffer_lora, len_recibido, &paquete)) {
-                // Solo reenviar por UART si es para este nodo o broadcast
-                if (paquete.ip_destino == mi_ip || paquete.ip_destino == 0xFFFF) {
-                    enviarPorUART(&paquete);
+            if (parsearIPv4(datos, len_recibido, &paquete)) {
+                if (!(paquete.flag_fragmento & FLAG_MALLA)) {
+                    // Trama de un salto: el origen es el vecino que transmitió
+                    adr.registrarSnr(paquete.ip_origen, enlace.snr_cuartos, millis());
+                }
+                if (paquete.protocolo == 0 && paquete.datos_len > 0 && paquete.datos[0] == CMD_ADR) {
+                    // Anuncio de tasa entre modems, no llega al Nodo
+                    adr.procesarAnuncio(paquete.ip_origen, paquete.datos, paquete.datos_len, millis());
+                } else if (paquete.protocolo == PROTOCOLO_RUTEO) {
+                    // Anuncio de ruteo entre modems, no llega al Nodo
+                    ruteo.procesarAnuncio(paquete.ip_origen, paquete.datos, paquete.datos_len, millis());
+                } else if (paquete.flag_fragmento & FLAG_MALLA) {
+                    procesarTramaMalla(&paquete, &enlace);
+                } else if (aceptaDestino(paquete.ip_destino)) {
+                    // Solo reenviar por UART si es para este nodo, broadcast o un grupo propio
+                    if (pasaAlNodo(paquete.flag_fragmento, paquete.protocolo, paquete.ip_origen, paquete.ip_destino,
+                                   paquete.identificador, paquete.datos, paquete.datos_len)) {
+                        enviarPorUART(&paquete, &enlace);
+                    }
                 }
+            } else {
+                telemetria.contar(TEL_IPV4_INVALIDAS);
             }
         }
+        if (trama != NULL) pool.liberar(trama);
     }
 }
 
-bool decodificarSLIP(uint8_t* entrada, int len_entrada, uint8_t* salida, int* len_salida) {
-    int pos_salida = 0;
-    bool escape_next = false;
-    
-    for (int i = 0; i < len_entrada; i++) {
-        if (escape_next) {
-            if (entrada[i] == SLIP_ESC_END) {
-                salida[pos_salida++] = SLIP_END;
-            } else if (entrada[i] == SLIP_ESC_ESC) {
-                salida[pos_salida++] = SLIP_ESC;
-            } else {
-                return false; // Error en decodificación
-            }
-            escape_next = false;
-        } else if (entrada[i] == SLIP_ESC) {
-            escape_next = true;
-        } else if (entrada[i] == SLIP_END) {
-            // Fin del frame (ignorar al final)
-            continue;
-        } else {
-            salida[pos_salida++] = entrada[i];
-        }
+bool reenviarDirecto(Trama* trama) {
+    // Desde el Nodo hacia la radio sin cambios en la trama: sólo se miran
+    // destino y protocolo y sale el mismo buffer con el checksum al día.
+    // Lo que el modem atiende o modifica sigue el camino completo.
+    uint8_t* t = trama->datos;
+    uint16_t destino = (t[9] << 8) | t[10];
+    uint8_t protocolo = t[5];
+    if (destino == mi_ip || protocolo == 0) return false;
+    if (Grupos::esDifusion(destino)) {
+        if (protocolo == 3) return false;                   // se inunda con prefijo de malla
+    } else {
+        if (ACK_IMPLICITO && protocolo == PROTOCOLO_ACK) return false; // trama de control implícita
+        const Ruta* ruta = ruteo.buscar(destino);
+        if (ruta != NULL && ruta->metrica > 1) return false; // por malla
     }
     
-    *len_salida = pos_salida;
+    int largo = min((int)trama->largo, IPV4_CABECERA + MAX_PACKET_SIZE);
+    t[6] = checksumCabecera(t);
+    telemetria.contar(TEL_DIRECTAS_HACIA_RED);
+    registrarEntrega(t, largo);
+    if (!transmitirPorTasa(t, largo)) telemetria.contar(TEL_TX_NO_ENCOLADAS);
     return true;
 }
 
-bool codificarSLIP(uint8_t* entrada, int len_entrada, uint8_t* salida, int* len_salida) {
-    int pos_salida = 0;
+bool entregarDirecto(Trama* trama, int largo, const MetadatosEnlace* enlace) {
+    // Desde la radio hacia el Nodo en la misma trama en que se leyó: se
+    // marca el trailer de enlace, se agrega y se pasa a la tarea serial.
+    // Controles, malla y tramas entre modems van por el camino completo.
+    uint8_t* t = trama->datos;
+    if (largo < IPV4_CABECERA || enlace->implicita) return false;
+    if (((t[0] >> 4) & FLAG_MALLA) || t[5] == 0 || t[5] == PROTOCOLO_RUTEO) return false;
     
-    // Agregar SLIP_END al inicio
-    salida[pos_salida++] = SLIP_END;
-    
-    for (int i = 0; i < len_entrada; i++) {
-        if (entrada[i] == SLIP_END) {
-            salida[pos_salida++] = SLIP_ESC;
-            salida[pos_salida++] = SLIP_ESC_END;
-        } else if (entrada[i] == SLIP_ESC) {
-            salida[pos_salida++] = SLIP_ESC;
-            salida[pos_salida++] = SLIP_ESC_ESC;
-        } else {
-            salida[pos_salida++] = entrada[i];
-        }
+    uint16_t origen = (t[7] << 8) | t[8];
+    uint16_t destino = (t[9] << 8) | t[10];
+    adr.registrarSnr(origen, enlace->snr_cuartos, millis()); // trama de un salto
+    if (!aceptaDestino(destino) ||
+        !pasaAlNodo(t[0] >> 4, t[5], origen, destino, (t[3] << 8) | t[4], &t[IPV4_CABECERA], largo - IPV4_CABECERA)) {
+        pool.liberar(trama);
+        return true;
     }
     
-    // Agregar SLIP_END al final
-    salida[pos_salida++] = SLIP_END;
-    
-    *len_salida = pos_salida;
+    t[0] |= FLAG_METADATA_ENLACE << 4;
+    t[6] = checksumCabecera(t);
+    trama->largo = largo + escribirMetadatosEnlace(enlace, &t[largo]);
+    telemetria.contar(TEL_DIRECTAS_HACIA_NODO);
+    if (pool.pasar(cola_radio_a_uart, trama)) xTaskNotifyGive(tarea_serial);
     return true;
 }
 
 bool parsearIPv4(uint8_t* datos, int len, IPv4Packet* paquete) {
-    if (len < 8) return false; // Mínimo para cabecera IPv4
+    if (len < IPV4_CABECERA) return false; // Mínimo para cabecera IPv4
     
     // Parsear campos de la cabecera
-    uint16_t campo1 = (datos[0] << 8) | datos[1];
-    paquete->flag_fragmento = (campo1 >> 14) & 0x3;
-    paquete->offset_fragmento = campo1 & 0x0FFF;
+    paquete->flag_fragmento = (datos[0] >> 4) & 0x0F;
+    paquete->offset_fragmento = ((datos[0] & 0x0F) << 8) | datos[1];
     
     paquete->longitud_total = datos[2];
-    paquete->relleno = datos[3];
-    paquete->identificador = (datos[4] << 8) | datos[5];
-    paquete->protocolo = datos[6];
-    paquete->checksum = datos[7];
-    paquete->ip_origen = (datos[8] << 8) | datos[9];
-    paquete->ip_destino = (datos[10] << 8) | datos[11];
+    paquete->identificador = (datos[3] << 8) | datos[4];
+    paquete->protocolo = datos[5];
+    paquete->checksum = datos[6];
+    paquete->ip_origen = (datos[7] << 8) | datos[8];
+    paquete->ip_destino = (datos[9] << 8) | datos[10];
     
     // Copiar datos
-    int datos_len = len - 12;
+    int datos_len = len - IPV4_CABECERA;
     if (datos_len > 0) {
         paquete->datos_len = (datos_len > MAX_PACKET_SIZE) ? MAX_PACKET_SIZE : datos_len;
-        memcpy(paquete->datos, &datos[12], paquete->datos_len);
+        memcpy(paquete->datos, &datos[IPV4_CABECERA], paquete->datos_len);
+        telemetria.contar(TEL_COPIAS_IPV4);
+        telemetria.contar(TEL_BYTES_COPIADOS_IPV4, paquete->datos_len);
     } else {
         paquete->datos_len = 0;
     }
@@ -280,105 +589,652 @@ bool parsearIPv4(uint8_t* datos, int len, IPv4Packet* paquete) {
 
 void construirIPv4(IPv4Packet* paquete, uint8_t* buffer, int* len) {
     // Construir cabecera IPv4
-    uint16_t campo1 = (paquete->flag_fragmento << 14) | (paquete->offset_fragmento & 0x0FFF);
-    buffer[0] = (campo1 >> 8) & 0xFF;
-    buffer[1] = campo1 & 0xFF;
+    buffer[0] = ((paquete->flag_fragmento & 0x0F) << 4) | ((paquete->offset_fragmento >> 8) & 0x0F);
+    buffer[1] = paquete->offset_fragmento & 0xFF;
     
     buffer[2] = paquete->longitud_total;
-    buffer[3] = paquete->relleno;
-    buffer[4] = (paquete->identificador >> 8) & 0xFF;
-    buffer[5] = paquete->identificador & 0xFF;
-    buffer[6] = paquete->protocolo;
-    buffer[7] = paquete->checksum;
-    buffer[8] = (paquete->ip_origen >> 8) & 0xFF;
-    buffer[9] = paquete->ip_origen & 0xFF;
-    buffer[10] = (paquete->ip_destino >> 8) & 0xFF;
-    buffer[11] = paquete->ip_destino & 0xFF;
+    buffer[3] = (paquete->identificador >> 8) & 0xFF;
+    buffer[4] = paquete->identificador & 0xFF;
+    buffer[5] = paquete->protocolo;
+    buffer[6] = paquete->checksum;
+    buffer[7] = (paquete->ip_origen >> 8) & 0xFF;
+    buffer[8] = paquete->ip_origen & 0xFF;
+    buffer[9] = (paquete->ip_destino >> 8) & 0xFF;
+    buffer[10] = paquete->ip_destino & 0xFF;
     
     // Copiar datos
-    memcpy(&buffer[12], paquete->datos, paquete->datos_len);
+    memcpy(&buffer[IPV4_CABECERA], paquete->datos, paquete->datos_len);
+    telemetria.contar(TEL_COPIAS_IPV4);
+    telemetria.contar(TEL_BYTES_COPIADOS_IPV4, paquete->datos_len);
     
-    *len = 12 + paquete->datos_len;
+    *len = IPV4_CABECERA + paquete->datos_len;
 }
 
 uint8_t calcularChecksum(IPv4Packet* paquete) {
-    // Checksum simple de la cabecera (sin IPs)
-    uint8_t checksum = 0;
-    uint16_t campo1 = (paquete->flag_fragmento << 14) | (paquete->offset_fragmento & 0x0FFF);
+    // Checksum simple de la cabecera (sin IPs), igual al del Nodo
+    uint16_t suma = 0;
     
-    checksum ^= (campo1 >> 8) & 0xFF;
-    checksum ^= campo1 & 0xFF;
-    checksum ^= paquete->longitud_total;
-    checksum ^= paquete->relleno;
-    checksum ^= (paquete->identificador >> 8) & 0xFF;
-    checksum ^= paquete->identificador & 0xFF;
-    checksum ^= paquete->protocolo;
+    suma += (paquete->flag_fragmento << 4) | (paquete->offset_fragmento >> 8);
+    suma += paquete->offset_fragmento & 0xFF;
+    suma += paquete->longitud_total;
+    suma += paquete->identificador >> 8;
+    suma += paquete->identificador & 0xFF;
+    suma += paquete->protocolo;
     
-    return checksum;
+    // Complemento a 1 del resultado
+    suma = (suma & 0xFF) + (suma >> 8);
+    return (~suma) & 0xFF;
+}
+
+uint8_t checksumCabecera(const uint8_t* cabecera) {
+    // El mismo checksum sobre los bytes 0-5 de una trama ya armada
+    uint16_t suma = 0;
+    for (int i = 0; i < 6; i++) suma += cabecera[i];
+    suma = (suma & 0xFF) + (suma >> 8);
+    return (~suma) & 0xFF;
 }
 
 void procesarProtocoloPropio(PropioProtocolo* comando) {
+    telemetria.contar(TEL_COMANDOS);
     switch (comando->cmd) {
         case 5: // Comando de prueba
-            mostrarImagenPrueba();
+            solicitarDisplay(5, NULL, 0);
             break;
             
         case 6: // Cambiar estado LED
             led_state = !led_state;
             digitalWrite(LED_PIN, led_state ? HIGH : LOW);
-            Serial.print("LED cambiado a: ");
-            Serial.println(led_state ? "ON" : "OFF");
             break;
             
         case 7: // Mostrar mensaje en OLED
             if (comando->longitud_de_dato > 0) {
-                String mensaje = "";
-                for (int i = 0; i < comando->longitud_de_dato; i++) {
-                    mensaje += (char)comando->dato[i];
-                }
-                mostrarEnOLED(mensaje);
+                solicitarDisplay(7, comando->dato, comando->longitud_de_dato);
             }
             break;
             
+        case CMD_TELEMETRIA: // Contadores del modem, un bloque por pedido
+            responderTelemetria(comando);
+            break;
+            
+        case CMD_DIRECCION: // IP del Nodo
+            configurarDireccion(comando);
+            break;
+            
+        case CMD_GRUPOS: // Grupos de multicast del Nodo
+            configurarGrupos(comando);
+            break;
+            
+        case CMD_PROTOCOLOS: // Costo por protocolo del despacho de la UART
+            responderProtocolos(comando);
+            break;
+            
         default:
-            Serial.print("Comando desconocido: ");
-            Serial.println(comando->cmd);
+            telemetria.contar(TEL_COMANDOS_DESCONOCIDOS);
             break;
     }
 }
 
-void enviarPorUART(IPv4Packet* paquete) {
-    uint8_t buffer_ipv4[BUFFER_SIZE];
+void actualizarTelemetria() {
+    // Copia de los contadores que llevan los módulos
+    const EstadisticasSLIP& slip = slip_rx.estadisticas();
+    telemetria.fijar(TEL_UART_ERRORES_SLIP, slip.errores_trama);
+    telemetria.fijar(TEL_UART_DESBORDES, slip.desbordes);
+    telemetria.fijar(TEL_UART_SIN_BUFFER, slip.sin_buffer);
+    EstadisticasRx rx = red.estadisticasRx();
+    telemetria.fijar(TEL_RX_TRAMAS, rx.recibidas);
+    telemetria.fijar(TEL_RX_ERRORES_CRC, rx.errores_crc);
+    telemetria.fijar(TEL_RX_DESBORDES, rx.desbordes);
+    telemetria.fijar(TEL_RX_LARGO_INVALIDO, rx.largo_invalido);
+    const EstadisticasFEC& fec = red.estadisticasFEC();
+    telemetria.fijar(TEL_RX_FEC_CORREGIDAS, fec.tramas_corregidas);
+    telemetria.fijar(TEL_RX_FEC_IRRECUPERABLES, fec.tramas_irrecuperables);
+    const EstadisticasTx& tx = red.estadisticasTx();
+    telemetria.fijar(TEL_TX_ENCOLADAS, tx.encoladas);
+    telemetria.fijar(TEL_TX_TRANSMITIDAS, tx.transmitidas);
+    telemetria.fijar(TEL_TX_COLA_LLENA, tx.cola_llena);
+    telemetria.fijar(TEL_TX_TIMEOUTS, tx.timeouts);
+    telemetria.fijar(TEL_TX_CANAL_OCUPADO, tx.canal_ocupado);
+    telemetria.fijar(TEL_TX_DESCARTADAS_CANAL, tx.descartadas_canal);
+    const EstadisticasAire& aire = red.estadisticasAire();
+    telemetria.fijar(TEL_AIRE_TOTAL_MS, aire.aire_total_ms);
+    telemetria.fijar(TEL_AIRE_ESPERAS, aire.esperas);
+    telemetria.fijar(TEL_AIRE_UTILIZACION_PORMIL, aire.utilizacion_pormil);
+    const EstadisticasInundacion& inund = inundacion.estadisticas();
+    telemetria.fijar(TEL_INUNDACION_REENVIADAS, inund.reenviadas);
+    telemetria.fijar(TEL_INUNDACION_DUPLICADAS, inund.duplicadas);
+    telemetria.fijar(TEL_POOL_AGOTADO, pool.estadisticas().agotado);
+    const EstadisticasPantalla& oled = pantalla.estadisticas();
+    telemetria.fijar(TEL_OLED_REFRESCOS, oled.refrescos);
+    telemetria.fijar(TEL_OLED_BYTES_I2C, oled.bytes_i2c);
+    telemetria.fijar(TEL_OLED_COALESCIDAS, oled.coalescidas);
+    const EstadisticasEntrega& entrega = entregas.estadisticas();
+    telemetria.fijar(TEL_ENTREGA_CONFIRMADAS, entrega.confirmadas);
+    telemetria.fijar(TEL_ENTREGA_FALLIDAS, entrega.fallidas);
+    telemetria.fijar(TEL_ENTREGA_REINTENTOS, entrega.reintentos);
+    telemetria.fijar(TEL_ENTREGA_ACKS, entrega.acks);
+    telemetria.fijar(TEL_ENTREGA_SIN_LUGAR, entrega.sin_espacio);
+    
+    telemetria.fijar(TEL_POOL_LIBRES, pool.libres());
+    telemetria.fijar(TEL_COLA_UART_A_RADIO, uxQueueMessagesWaiting(cola_uart_a_radio));
+    telemetria.fijar(TEL_COLA_RADIO_A_UART, uxQueueMessagesWaiting(cola_radio_a_uart));
+    telemetria.fijar(TEL_COLA_TX, red.tramasEnCola());
+    telemetria.fijar(TEL_ANILLO_RX, red.tramasPendientes());
+}
+
+void responderTelemetria(PropioProtocolo* pedido) {
+    // Un bloque de contadores por pedido: [cmd][largo][bloque][fcs]
+    PropioProtocolo respuesta;
+    uint8_t bloque = pedido->longitud_de_dato > 0 ? pedido->dato[0] : 0;
+    actualizarTelemetria();
+    respuesta.cmd = CMD_TELEMETRIA;
+    respuesta.longitud_de_dato = telemetria.serializarBloque(bloque, millis(), respuesta.dato);
+    if (respuesta.longitud_de_dato == 0) return;
+    responderPropio(&respuesta);
+}
+
+void responderProtocolos(PropioProtocolo* pedido) {
+    // Una página por pedido: [cmd][largo][desde][fcs]
+    PropioProtocolo respuesta;
+    uint8_t desde = pedido->longitud_de_dato > 0 ? pedido->dato[0] : 0;
+    respuesta.cmd = CMD_PROTOCOLOS;
+    respuesta.longitud_de_dato = estadisticas_protocolos.serializar(desde, respuesta.dato);
+    responderPropio(&respuesta);
+}
+
+void configurarDireccion(PropioProtocolo* comando) {
+    // La IP decide el canal propio y el origen de lo que arma el modem;
+    // se responde con la que quedó (largo 0: sólo consulta)
+    if (comando->longitud_de_dato >= 2) {
+        uint16_t ip = (comando->dato[0] << 8) | comando->dato[1];
+        if (ip != mi_ip && ip != 0 && !Grupos::esDifusion(ip)) {
+            mi_ip = ip;
+            red.setCanales(CANALES_LORA, mi_ip);
+            ruteo.begin(mi_ip);
+        }
+    }
+    PropioProtocolo respuesta;
+    respuesta.cmd = CMD_DIRECCION;
+    respuesta.longitud_de_dato = 2;
+    respuesta.dato[0] = mi_ip >> 8;
+    respuesta.dato[1] = mi_ip & 0xFF;
+    responderPropio(&respuesta);
+}
+
+void configurarGrupos(PropioProtocolo* comando) {
+    // La lista reemplaza a la anterior; la respuesta trae la que quedó
+    grupos.vaciar();
+    for (int i = 0; i < comando->longitud_de_dato; i++) {
+        grupos.unirse(comando->dato[i]);
+    }
+    PropioProtocolo respuesta;
+    respuesta.cmd = CMD_GRUPOS;
+    respuesta.longitud_de_dato = grupos.listar(respuesta.dato, MAX_DATO_COMANDO);
+    responderPropio(&respuesta);
+}
+
+bool aceptaDestino(uint16_t destino) {
+    // Lo que no es para este Nodo se descarta antes de ocupar la UART
+    if (destino == mi_ip || destino == DIRECCION_BROADCAST || grupos.miembro(destino)) return true;
+    telemetria.contar(TEL_DESTINO_FILTRADAS);
+    return false;
+}
+
+void responderPropio(PropioProtocolo* respuesta) {
+    // Dentro de un lote la respuesta se junta con las demás; si no cabe,
+    // sale lo acumulado y se empieza otro
+    if (lote_abierto) {
+        if (lote_respuesta.agregar(respuesta->cmd, respuesta->dato, respuesta->longitud_de_dato)) return;
+        enviarLoteRespuesta();
+        if (lote_respuesta.agregar(respuesta->cmd, respuesta->dato, respuesta->longitud_de_dato)) return;
+    }
+    // Suelta: [cmd][largo][dato][fcs]
+    uint8_t datos[3 + MAX_DATO_ENCADENADO];
+    respuesta->fcs = calcularFCS(respuesta);
+    datos[0] = respuesta->cmd;
+    datos[1] = respuesta->longitud_de_dato;
+    memcpy(&datos[2], respuesta->dato, respuesta->longitud_de_dato);
+    datos[2 + respuesta->longitud_de_dato] = respuesta->fcs;
+    enviarPropio(datos, 3 + respuesta->longitud_de_dato);
+}
+
+void ejecutarLote(const uint8_t* datos, int largo) {
+    // Los comandos se ejecutan en orden; uno mal formado descarta el lote entero
+    LectorLote lector;
+    if (!lector.begin(datos, largo)) {
+        telemetria.contar(TEL_LOTES_RECHAZADOS);
+        return;
+    }
+    telemetria.contar(TEL_LOTES);
+    
+    PropioProtocolo comando;
+    int l;
+    uint8_t ejecutados = 0;
+    lote_respuesta.begin(buffer_lote, sizeof(buffer_lote));
+    lote_abierto = true;
+    while ((l = lector.siguiente(&comando.cmd, comando.dato)) >= 0) {
+        if (comando.cmd == CMD_LOTE) continue; // sin lotes anidados
+        comando.longitud_de_dato = l;
+        procesarProtocoloPropio(&comando);
+        ejecutados++;
+    }
+    lote_abierto = false;
+    
+    // El resumen cierra la respuesta: el Nodo sabe que el lote terminó
+    if (!lote_respuesta.agregar(CMD_LOTE, &ejecutados, 1)) {
+        enviarLoteRespuesta();
+        lote_respuesta.agregar(CMD_LOTE, &ejecutados, 1);
+    }
+    enviarLoteRespuesta();
+}
+
+void enviarLoteRespuesta() {
+    enviarPropio(buffer_lote, lote_respuesta.cerrar());
+    lote_respuesta.begin(buffer_lote, sizeof(buffer_lote));
+}
+
+uint16_t nuevoIdModem() {
+    uint16_t id = contador_id_modem++;
+    if (contador_id_modem == 0) contador_id_modem = ID_MODEM; // no entrar en el rango del Nodo
+    return id;
+}
+
+void enviarPropio(const uint8_t* datos, int largo) {
+    // Del modem a su Nodo como protocolo propio
+    IPv4Packet paquete;
+    paquete.flag_fragmento = 0;
+    paquete.offset_fragmento = 0;
+    paquete.identificador = nuevoIdModem();
+    paquete.protocolo = 0;
+    paquete.ip_origen = mi_ip;
+    paquete.ip_destino = mi_ip;
+    memcpy(paquete.datos, datos, largo);
+    paquete.datos_len = largo;
+    paquete.longitud_total = largo;
+    enviarPorUART(&paquete);
+}
+
+void solicitarDisplay(uint8_t cmd, const uint8_t* dato, int largo) {
+    // El OLED (I2C, decenas de ms) se dibuja en su propia tarea; si no hay
+    // tramas libres la petición se descarta
+    Trama* trama = pool.tomar();
+    if (trama == NULL) return;
+    if (largo > (int)sizeof(((PropioProtocolo*)0)->dato)) largo = sizeof(((PropioProtocolo*)0)->dato);
+    trama->tipo = cmd;
+    trama->largo = largo;
+    if (largo > 0) memcpy(trama->datos, dato, largo);
+    pool.pasar(cola_display, trama);
+}
+
+void enviarPorUART(IPv4Packet* paquete, const MetadatosEnlace* enlace) {
+    // La trama se arma en el pool y la tarea serial la codifica y escribe
+    Trama* trama = pool.tomar();
+    if (trama == NULL) return;
     int len_ipv4;
     
+    // Marcar la presencia del trailer de enlace antes del checksum
+    if (enlace != NULL) {
+        paquete->flag_fragmento |= FLAG_METADATA_ENLACE;
+    }
+    
     // Recalcular checksum
     paquete->checksum = calcularChecksum(paquete);
     
     // Construir paquete IPv4
-    construirIPv4(paquete, buffer_ipv4, &len_ipv4);
-    
-    // Codificar en SLIP
-    uint8_t buffer_slip_tx[BUFFER_SIZE];
-    int len_slip;
+    construirIPv4(paquete, trama->datos, &len_ipv4);
     
-    if (codificarSLIP(buffer_ipv4, len_ipv4, buffer_slip_tx, &len_slip)) {
-        // Enviar por UART
-        Serial.write(buffer_slip_tx, len_slip);
+    // Trailer de calidad de enlace al final de los datos
+    if (enlace != NULL) {
+        len_ipv4 += escribirMetadatosEnlace(enlace, &trama->datos[len_ipv4]);
     }
+    
+    trama->largo = len_ipv4;
+    if (pool.pasar(cola_radio_a_uart, trama)) xTaskNotifyGive(tarea_serial);
 }
 
 void enviarPorLoRa(IPv4Packet* paquete) {
-    uint8_t buffer_ipv4[MAX_PACKET_SIZE];
+    uint8_t buffer_ipv4[IPV4_CABECERA + MAX_PACKET_SIZE];
     int len_ipv4;
     
+    // Lo que no cabe en una trama junto a la paridad FEC no se arma
+    if (IPV4_CABECERA + paquete->datos_len > red.maxDato()) {
+        telemetria.contar(TEL_TX_NO_ENCOLADAS);
+        return;
+    }
+    
     // Recalcular checksum
     paquete->checksum = calcularChecksum(paquete);
     
     // Construir paquete IPv4
     construirIPv4(paquete, buffer_ipv4, &len_ipv4);
+    registrarEntrega(buffer_ipv4, len_ipv4);
     
     // Enviar por LoRa
-    red.transmite_data(buffer_ipv4, len_ipv4);
+    if (!transmitirPorTasa(buffer_ipv4, len_ipv4)) telemetria.contar(TEL_TX_NO_ENCOLADAS);
+}
+
+bool transmitirPorTasa(uint8_t* trama, int largo, bool incluir_base) {
+    // Vecino que recibe la trama: el siguiente salto en malla o el destino
+    uint16_t vecino = (trama[9] << 8) | trama[10];
+    if (((trama[0] >> 4) & FLAG_MALLA) && largo >= IPV4_CABECERA + TAM_PREFIJO_MALLA) {
+        vecino = (trama[IPV4_CABECERA] << 8) | trama[IPV4_CABECERA + 1];
+    }
+    
+    if (!Grupos::esDifusion(vecino)) {
+        const TasaLoRa& tasa = Adr::tasa(adr.escalonHacia(vecino));
+        // el ACK de un vecino directo vuelve como trama de control implícita
+        bool directa = !((trama[0] >> 4) & FLAG_MALLA);
+        uint8_t opciones = ACK_IMPLICITO && directa && esperaAck(trama[5]) ? TX_ESPERA_CONTROL : 0;
+        return red.transmite_data(trama, largo, true, tasa.sf, tasa.bw, opciones, red.canalDe(vecino));
+    }
+    // Broadcast: una copia en cada tasa en que escuchan los vecinos, en el canal de encuentro
+    uint8_t escalones[ESCALONES_ADR];
+    int n = adr.escalonesBroadcast(escalones, incluir_base);
+    bool ok = true;
+    for (int i = 0; i < n; i++) {
+        const TasaLoRa& tasa = Adr::tasa(escalones[i]);
+        ok = red.transmite_data(trama, largo, true, tasa.sf, tasa.bw) && ok;
+    }
+    return ok;
+}
+
+void enviarHaciaRed(IPv4Packet* paquete) {
+    // El ACK a un vecino directo sale como trama de control implícita
+    if (ACK_IMPLICITO && paquete->protocolo == PROTOCOLO_ACK && paquete->datos_len == 2 &&
+        !Grupos::esDifusion(paquete->ip_destino)) {
+        const Ruta* ruta = ruteo.buscar(paquete->ip_destino);
+        if (ruta == NULL || ruta->metrica <= 1) {
+            enviarControlAck(paquete);
+            return;
+        }
+    }
+    // Los broadcast y multicast de mensajes se inundan por toda la malla
+    // (también por los modems que no son del grupo); Hello y el resto de
+    // los broadcast siguen siendo de un salto
+    if (Grupos::esDifusion(paquete->ip_destino) && paquete->protocolo == 3) {
+        if (agregarPrefijoMalla(paquete, SIGUIENTE_INUNDACION, TTL_INUNDACION)) {
+            inundacion.nueva(paquete->ip_origen, paquete->identificador); // ignorar los ecos
+        }
+    }
+    // Destinos fuera del alcance directo van por malla a través del siguiente salto
+    else if (!Grupos::esDifusion(paquete->ip_destino)) {
+        const Ruta* ruta = ruteo.buscar(paquete->ip_destino);
+        if (ruta != NULL && ruta->metrica > 1 &&
+            agregarPrefijoMalla(paquete, ruta->siguiente, SALTOS_MAXIMOS)) {
+            ruteo.yaVisto(paquete->ip_origen, paquete->identificador); // ignorar el eco propio
+        }
+    }
+    enviarPorLoRa(paquete);
+}
+
+bool esperaAck(uint8_t protocolo) {
+    // Protocolos que el Nodo destino confirma con un ACK: unicast y comandos remotos
+    return protocolo == 2 || protocolo == 5 || protocolo == 6 || protocolo == 7;
+}
+
+void enviarControlAck(IPv4Packet* paquete) {
+    TramaControl control;
+    control.tipo = CONTROL_ACK;
+    control.origen = paquete->ip_origen;
+    control.destino = paquete->ip_destino;
+    control.identificador = paquete->identificador;
+    control.dato = (paquete->datos[0] << 8) | paquete->datos[1];
+    uint8_t trama[TAM_TRAMA_CONTROL];
+    escribirControl(&control, trama);
+    // en la tasa y el canal en que escucha el destino, que abrió la ventana en ellos
+    const TasaLoRa& tasa = Adr::tasa(adr.escalonHacia(paquete->ip_destino));
+    if (!red.transmite_data(trama, TAM_TRAMA_CONTROL, true, tasa.sf, tasa.bw, TX_IMPLICITA,
+                            red.canalDe(paquete->ip_destino))) {
+        telemetria.contar(TEL_TX_NO_ENCOLADAS);
+    }
+}
+
+void procesarControl(const uint8_t* datos, int largo, const MetadatosEnlace* enlace) {
+    TramaControl control;
+    if (!leerControl(datos, largo, &control)) {
+        telemetria.contar(TEL_IPV4_INVALIDAS);
+        return;
+    }
+    adr.registrarSnr(control.origen, enlace->snr_cuartos, millis()); // siempre de un salto
+    if (control.destino != mi_ip) return;
+    if (control.tipo == CONTROL_ACK && confirmarEntrega(control.origen, control.dato)) return;
+    
+    // El Nodo recibe el mismo ACK IPv4 que envió el otro Nodo
+    IPv4Packet paquete;
+    paquete.flag_fragmento = 0;
+    paquete.offset_fragmento = 0;
+    paquete.identificador = control.identificador;
+    paquete.protocolo = PROTOCOLO_ACK;
+    paquete.ip_origen = control.origen;
+    paquete.ip_destino = control.destino;
+    paquete.datos[0] = control.dato >> 8;
+    paquete.datos[1] = control.dato & 0xFF;
+    paquete.datos_len = 2;
+    paquete.longitud_total = 2;
+    enviarPorUART(&paquete, enlace);
+}
+
+void registrarEntrega(const uint8_t* trama, int largo) {
+    // Sólo unicasts de un salto: en la malla los reenvíos descartan las
+    // copias repetidas y el ACK del destino vuelve al Nodo como siempre
+    uint8_t flags = trama[0] >> 4;
+    uint16_t destino = (trama[9] << 8) | trama[10];
+    uint16_t id = (trama[3] << 8) | trama[4];
+    if (!(flags & FLAG_ENTREGA_MODEM) || Grupos::esDifusion(destino) || !esperaAck(trama[5])) return;
+    if (flags & FLAG_MALLA) {
+        avisarSinSeguimiento(destino, id);
+        return;
+    }
+    
+    // Espera: la trama y las que tiene delante en la cola, más el ACK en la tasa en que escuchamos
+    const TasaLoRa& ida = Adr::tasa(adr.escalonHacia(destino));
+    const TasaLoRa& vuelta = Adr::tasa(adr.escalonRecepcion());
+    uint32_t aire_us = red.tiempoAireUs(largo, ida.sf, ida.bw) * (1 + red.tramasEnCola()) +
+                       red.tiempoAireUs(ACK_IMPLICITO ? TAM_TRAMA_CONTROL : IPV4_CABECERA + 2, vuelta.sf, vuelta.bw,
+                                        ACK_IMPLICITO);
+    uint32_t espera_ms = aire_us / 1000 + MARGEN_ENTREGA_MS + random(MARGEN_ENTREGA_MS);
+    if (!entregas.registrar(destino, id, trama, largo, millis(), espera_ms)) avisarSinSeguimiento(destino, id);
+}
+
+void avisarSinSeguimiento(uint16_t destino, uint16_t id) {
+    // El Nodo no debe esperar un aviso que no va a llegar
+    AvisoEntrega aviso;
+    aviso.destino = destino;
+    aviso.identificador = id;
+    aviso.estado = ENTREGA_SIN_SEGUIMIENTO;
+    aviso.intentos = 1;
+    avisarEntrega(&aviso);
+}
+
+bool confirmarEntrega(uint16_t origen, uint16_t id) {
+    // ACK de una trama guardada: el Nodo recibe el aviso en su lugar
+    AvisoEntrega aviso;
+    if (!entregas.confirmar(origen, id, &aviso)) return false;
+    avisarEntrega(&aviso);
+    return true;
+}
+
+bool pasaAlNodo(uint8_t flags, uint8_t protocolo, uint16_t origen, uint16_t destino, uint16_t id,
+                const uint8_t* datos, int datos_len) {
+    // Como origen se consumen los ACK de las tramas guardadas; como destino
+    // se confirma en el acto y las retransmisiones ya entregadas no suben
+    if (destino != mi_ip) return true;
+    if (protocolo == PROTOCOLO_ACK) {
+        return datos_len < 2 || !confirmarEntrega(origen, (datos[0] << 8) | datos[1]);
+    }
+    if (!(flags & FLAG_ENTREGA_MODEM) || !esperaAck(protocolo)) return true;
+    
+    IPv4Packet ack;
+    ack.flag_fragmento = 0;
+    ack.offset_fragmento = 0;
+    ack.identificador = nuevoIdModem();
+    ack.protocolo = PROTOCOLO_ACK;
+    ack.ip_origen = mi_ip;
+    ack.ip_destino = origen;
+    ack.datos[0] = id >> 8;
+    ack.datos[1] = id & 0xFF;
+    ack.datos_len = 2;
+    ack.longitud_total = 2;
+    enviarHaciaRed(&ack);
+    entregas.contarAck();
+    return entregas.recibida(origen, id);
+}
+
+void avisarEntrega(const AvisoEntrega* aviso) {
+    // Un comando de protocolo propio por trama: [cmd][largo][destino][id][estado][intentos][fcs]
+    PropioProtocolo respuesta;
+    respuesta.cmd = CMD_ENTREGA;
+    respuesta.longitud_de_dato = 6;
+    respuesta.dato[0] = aviso->destino >> 8;
+    respuesta.dato[1] = aviso->destino & 0xFF;
+    respuesta.dato[2] = aviso->identificador >> 8;
+    respuesta.dato[3] = aviso->identificador & 0xFF;
+    respuesta.dato[4] = aviso->estado;
+    respuesta.dato[5] = aviso->intentos;
+    responderPropio(&respuesta);
+}
+
+void atenderEntregas() {
+    unsigned long ahora = millis();
+    AvisoEntrega aviso;
+    while (entregas.fallida(ahora, &aviso)) {
+        avisarEntrega(&aviso);
+    }
+    uint8_t trama[MAX_TRAMA_ENTREGA];
+    int largo = entregas.reintento(ahora, trama);
+    if (largo > 0) {
+        transmitirPorTasa(trama, largo);
+    }
+}
+
+void procesarTramaMalla(IPv4Packet* paquete, const MetadatosEnlace* enlace) {
+    if (paquete->datos_len < TAM_PREFIJO_MALLA) return;
+    
+    uint16_t siguiente = (paquete->datos[0] << 8) | paquete->datos[1];
+    uint8_t saltos = paquete->datos[2];
+    
+    if (siguiente == SIGUIENTE_INUNDACION) {
+        procesarInundacion(paquete, enlace, saltos);
+        return;
+    }
+    if (siguiente != mi_ip) return; // el reenvío le corresponde a otro nodo
+    if (ruteo.yaVisto(paquete->ip_origen, paquete->identificador)) return; // duplicado o lazo
+    
+    if (paquete->ip_destino == mi_ip) {
+        quitarPrefijoMalla(paquete);
+        if (pasaAlNodo(paquete->flag_fragmento, paquete->protocolo, paquete->ip_origen, paquete->ip_destino,
+                       paquete->identificador, paquete->datos, paquete->datos_len)) {
+            enviarPorUART(paquete, enlace);
+        }
+        return;
+    }
+    
+    if (saltos <= 1) return; // límite de saltos alcanzado
+    
+    const Ruta* ruta = ruteo.buscar(paquete->ip_destino);
+    if (ruta == NULL) return;
+    
+    paquete->datos[0] = (ruta->siguiente >> 8) & 0xFF;
+    paquete->datos[1] = ruta->siguiente & 0xFF;
+    paquete->datos[2] = saltos - 1;
+    enviarPorLoRa(paquete);
+}
+
+void procesarInundacion(IPv4Packet* paquete, const MetadatosEnlace* enlace, uint8_t saltos) {
+    // Copias repetidas sólo alimentan el contador de supresión
+    if (!inundacion.nueva(paquete->ip_origen, paquete->identificador)) return;
+    
+    if (saltos > 1) {
+        uint8_t trama[IPV4_CABECERA + MAX_PACKET_SIZE];
+        int largo;
+        paquete->datos[2] = saltos - 1;
+        paquete->checksum = calcularChecksum(paquete);
+        construirIPv4(paquete, trama, &largo);
+        inundacion.programar(paquete->ip_origen, paquete->identificador, trama, largo,
+                             millis() + random(VENTANA_REENVIO_MS));
+    }
+    
+    quitarPrefijoMalla(paquete);
+    if (aceptaDestino(paquete->ip_destino)) enviarPorUART(paquete, enlace);
+}
+
+void atenderInundacion() {
+    uint8_t trama[MAX_TRAMA_INUNDACION];
+    int largo = inundacion.siguiente(millis(), trama);
+    if (largo > 0) {
+        transmitirPorTasa(trama, largo);
+    }
+}
+
+bool agregarPrefijoMalla(IPv4Packet* paquete, uint16_t siguiente, uint8_t saltos) {
+    if (IPV4_CABECERA + paquete->datos_len + TAM_PREFIJO_MALLA > red.maxDato()) return false;
+    
+    memmove(&paquete->datos[TAM_PREFIJO_MALLA], paquete->datos, paquete->datos_len);
+    paquete->datos[0] = (siguiente >> 8) & 0xFF;
+    paquete->datos[1] = siguiente & 0xFF;
+    paquete->datos[2] = saltos;
+    paquete->datos_len += TAM_PREFIJO_MALLA;
+    paquete->longitud_total += TAM_PREFIJO_MALLA;
+    paquete->flag_fragmento |= FLAG_MALLA;
+    return true;
+}
+
+void quitarPrefijoMalla(IPv4Packet* paquete) {
+    paquete->datos_len -= TAM_PREFIJO_MALLA;
+    memmove(paquete->datos, &paquete->datos[TAM_PREFIJO_MALLA], paquete->datos_len);
+    paquete->longitud_total -= TAM_PREFIJO_MALLA;
+    paquete->flag_fragmento &= ~FLAG_MALLA;
+}
+
+void actualizarRuteo() {
+    unsigned long ahora = millis();
+    ruteo.expirar(ahora);
+    
+    if (ahora - ultimo_anuncio < intervalo_anuncio) return;
+    ultimo_anuncio = ahora;
+    // variación aleatoria para que los vecinos no anuncien sincronizados
+    intervalo_anuncio = INTERVALO_ANUNCIO_MS - 2000 + random(4000);
+    
+    IPv4Packet anuncio;
+    anuncio.flag_fragmento = 0;
+    anuncio.offset_fragmento = 0;
+    anuncio.identificador = nuevoIdModem();
+    anuncio.protocolo = PROTOCOLO_RUTEO;
+    anuncio.ip_origen = mi_ip;
+    anuncio.ip_destino = 0xFFFF;
+    anuncio.datos_len = ruteo.construirAnuncio(anuncio.datos, red.maxDato() - IPV4_CABECERA);
+    anuncio.longitud_total = anuncio.datos_len;
+    enviarPorLoRa(&anuncio);
+}
+
+void actualizarAdr() {
+    unsigned long ahora = millis();
+    if (adr.actualizar(ahora)) {
+        // Nueva tasa de recepción: se escucha en ella y se anuncia de inmediato
+        const TasaLoRa& tasa = Adr::tasa(adr.escalonRecepcion());
+        red.setTasa(tasa.sf, tasa.bw);
+        ultimo_anuncio_adr = ahora - INTERVALO_ADR_MS;
+    }
+    
+    if (ahora - ultimo_anuncio_adr < INTERVALO_ADR_MS) return;
+    ultimo_anuncio_adr = ahora;
+    
+    // Comando de protocolo propio a los vecinos
+    IPv4Packet anuncio;
+    anuncio.flag_fragmento = 0;
+    anuncio.offset_fragmento = 0;
+    anuncio.identificador = nuevoIdModem();
+    anuncio.protocolo = 0;
+    anuncio.ip_origen = mi_ip;
+    anuncio.ip_destino = 0xFFFF;
+    anuncio.datos_len = adr.construirAnuncio(anuncio.datos);
+    anuncio.longitud_total = anuncio.datos_len;
+    anuncio.checksum = calcularChecksum(&anuncio);
+    
+    // También en la tasa base, donde escuchan los vecinos nuevos
+    uint8_t trama[IPV4_CABECERA + TAM_ANUNCIO_ADR];
+    int largo;
+    construirIPv4(&anuncio, trama, &largo);
+    transmitirPorTasa(trama, largo, true);
 }
 
 void mostrarEnOLED(String mensaje) {
@@ -388,7 +1244,7 @@ void mostrarEnOLED(String mensaje) {
     display.setTextColor(SSD1306_WHITE);
     
     // Dividir mensaje en líneas
-    int inicio = 0;
+    unsigned int inicio = 0;
     int linea = 0;
     int max_lineas = 8;
     int max_chars_por_linea = 21;
@@ -400,7 +1256,7 @@ void mostrarEnOLED(String mensaje) {
         linea++;
     }
     
-    display.display();
+    pantalla.refrescar();
 }
 
 void mostrarImagenPrueba() {
@@ -419,9 +1275,7 @@ void mostrarImagenPrueba() {
     display.setCursor(20, 28);
     display.println("PRUEBA OK");
     
-    display.display();
-    
-    Serial.println("Imagen de prueba mostrada en OLED");
+    pantalla.refrescar();
 }
 
 uint8_t calcularFCS(PropioProtocolo* comando) {
@@ -0,0 +1,170 @@
+#include "adr.h"
+#include <string.h>
+
+// Escalera de tasas: cada escalón duplica el tiempo de símbolo y gana ~2.5-3 dB
+static const TasaLoRa escalones[ESCALONES_ADR] = {
+    {7, 250000}, {8, 250000}, {9, 250000}, {10, 250000},
+    {11, 250000}, {12, 250000}, {12, 125000},
+};
+
+// Ruido relativo a 125 kHz: +3 dB (12 cuartos) por cada duplicación del ancho de banda
+static int16_t ajusteAncho(long bw) {
+    int16_t ajuste = 0;
+    for (long b = 125000; b < bw; b <<= 1) ajuste += 12;
+    return ajuste;
+}
+
+static uint8_t fcsAnuncio(const uint8_t *datos, int largo) {
+    uint8_t fcs = 0;
+    for (int i = 0; i < largo; i++) fcs ^= datos[i];
+    return fcs;
+}
+
+Adr::Adr() : _escalon_rx(ESCALON_BASE_ADR), _margen(MARGEN_ADR_CUARTOS),
+    _redescubrir_ms(REDESCUBRIR_ADR_MS), _fin_redescubrir_ms(0)
+{
+    memset(_vecinos, 0, sizeof(_vecinos));
+}
+
+void Adr::begin(uint32_t ahora_ms, int16_t margen_cuartos) {
+    memset(_vecinos, 0, sizeof(_vecinos));
+    _escalon_rx = ESCALON_BASE_ADR;
+    _margen = margen_cuartos;
+    // la ventana inicial en la base es el arranque mismo
+    _fin_redescubrir_ms = ahora_ms + VENTANA_REDESCUBRIR_MS;
+    _redescubrir_ms = ahora_ms + REDESCUBRIR_ADR_MS;
+}
+
+void Adr::setMargen(int16_t margen_cuartos) {
+    _margen = margen_cuartos;
+}
+
+const TasaLoRa &Adr::tasa(uint8_t escalon) {
+    if (escalon >= ESCALONES_ADR) escalon = ESCALON_BASE_ADR;
+    return escalones[escalon];
+}
+
+int16_t Adr::snrMinimo(uint8_t escalon) {
+    // SX1276: -7.5 dB en SF7 y 2.5 dB menos por cada SF
+    return -30 - 10 * (tasa(escalon).sf - 7);
+}
+
+VecinoAdr *Adr::buscar(uint16_t ip) {
+    for (int i = 0; i < MAX_VECINOS_ADR; i++) {
+        if (_vecinos[i].activo && _vecinos[i].ip == ip) return &_vecinos[i];
+    }
+    return NULL;
+}
+
+VecinoAdr *Adr::entrada(uint16_t ip, uint32_t ahora_ms) {
+    VecinoAdr *v = buscar(ip);
+    if (v == NULL) {
+        // tabla llena: se reemplaza el vecino que expira primero
+        for (int i = 0; i < MAX_VECINOS_ADR; i++) {
+            if (!_vecinos[i].activo) { v = &_vecinos[i]; break; }
+            if (v == NULL || (int32_t)(_vecinos[i].expira_ms - v->expira_ms) < 0) v = &_vecinos[i];
+        }
+        memset(v, 0, sizeof(*v));
+        v->ip = ip;
+        v->escalon_rx = ESCALON_BASE_ADR;
+        v->activo = 1;
+    }
+    v->expira_ms = ahora_ms + VIDA_VECINO_ADR_MS;
+    return v;
+}
+
+void Adr::registrarSnr(uint16_t vecino, int8_t snr_cuartos, uint32_t ahora_ms) {
+    VecinoAdr *v = entrada(vecino, ahora_ms);
+    int16_t snr = snr_cuartos + ajusteAncho(tasa(_escalon_rx).bw);
+    if (!v->medido) {
+        v->snr_cuartos = snr;
+        v->medido = 1;
+    } else {
+        v->snr_cuartos += (snr - v->snr_cuartos) / 4; // promedio exponencial, alfa 1/4
+    }
+}
+
+bool Adr::procesarAnuncio(uint16_t vecino, const uint8_t *datos, int largo, uint32_t ahora_ms) {
+    if (largo < TAM_ANUNCIO_ADR || datos[0] != CMD_ADR || datos[1] != 1) return false;
+    if (fcsAnuncio(datos, 3) != datos[3] || datos[2] >= ESCALONES_ADR) return false;
+    VecinoAdr *v = entrada(vecino, ahora_ms);
+    v->escalon_rx = datos[2];
+    v->anuncio = 1;
+    return true;
+}
+
+int Adr::construirAnuncio(uint8_t *salida) {
+    salida[0] = CMD_ADR;
+    salida[1] = 1;
+    salida[2] = _escalon_rx;
+    salida[3] = fcsAnuncio(salida, 3);
+    return TAM_ANUNCIO_ADR;
+}
+
+bool Adr::actualizar(uint32_t ahora_ms) {
+    if ((int32_t)(ahora_ms - _redescubrir_ms) >= 0) {
+        _redescubrir_ms = ahora_ms + REDESCUBRIR_ADR_MS;
+        _fin_redescubrir_ms = ahora_ms + VENTANA_REDESCUBRIR_MS;
+    }
+
+    // el vecino con peor SNR fija la tasa de recepción
+    bool hay = false;
+    int16_t peor = 0;
+    for (int i = 0; i < MAX_VECINOS_ADR; i++) {
+        VecinoAdr &v = _vecinos[i];
+        if (!v.activo) continue;
+        if ((int32_t)(ahora_ms - v.expira_ms) >= 0) {
+            v.activo = 0;
+            continue;
+        }
+        if (v.medido && (!hay || v.snr_cuartos < peor)) {
+            peor = v.snr_cuartos;
+            hay = true;
+        }
+    }
+
+    uint8_t nuevo = ESCALON_BASE_ADR;
+    if (hay && (int32_t)(ahora_ms - _fin_redescubrir_ms) >= 0) {
+        nuevo = ESCALONES_ADR - 1;
+        for (uint8_t e = 0; e < ESCALONES_ADR; e++) {
+            int16_t margen = peor - ajusteAncho(tasa(e).bw) - snrMinimo(e);
+            if (e < _escalon_rx) margen -= HISTERESIS_ADR_CUARTOS; // acelerar exige más margen
+            if (margen >= _margen) {
+                nuevo = e;
+                break;
+            }
+        }
+    }
+    if (nuevo == _escalon_rx) return false;
+    _escalon_rx = nuevo;
+    return true;
+}
+
+uint8_t Adr::escalonHacia(uint16_t destino) {
+    VecinoAdr *v = buscar(destino);
+    if (v == NULL || !v->anuncio) return ESCALON_BASE_ADR;
+    return v->escalon_rx;
+}
+
+int Adr::escalonesBroadcast(uint8_t *escalones, bool incluir_base) {
+    // marcar las tasas en uso y devolverlas en orden
+    bool usada[ESCALONES_ADR] = {false};
+    bool alguna = false;
+    for (int i = 0; i < MAX_VECINOS_ADR; i++) {
+        if (_vecinos[i].activo && _vecinos[i].anuncio) {
+            usada[_vecinos[i].escalon_rx] = true;
+            alguna = true;
+        }
+    }
+    if (incluir_base || !alguna) usada[ESCALON_BASE_ADR] = true;
+    int n = 0;
+    for (uint8_t e = 0; e < ESCALONES_ADR; e++) {
+        if (usada[e]) escalones[n++] = e;
+    }
+    return n;
+}
+
+const VecinoAdr *Adr::vecino(int i) {
+    if (i < 0 || i >= MAX_VECINOS_ADR || !_vecinos[i].activo) return NULL;
+    return &_vecinos[i];
+}
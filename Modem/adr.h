@@ -0,0 +1,116 @@
+#ifndef ADR_H
+#define ADR_H
+#include <stdint.h>
+
+/*
+    Tasa de datos adaptativa (ADR) por vecino.
+
+    Una radio LoRa sólo demodula el SF/BW en que está escuchando, así que
+    cada modem elige su tasa de recepción y la anuncia a sus vecinos; quien
+    le transmite cambia la radio a esa tasa sólo durante la trama y vuelve
+    a la suya. La tasa de recepción es la más rápida de la escalera con
+    la que todos los vecinos activos superan el SNR mínimo del SF por al
+    menos el margen configurado. El SNR de cada vecino se promedia sobre
+    las tramas de un salto que se le oyen y se guarda normalizado a
+    125 kHz, para poder estimarlo en cualquier ancho de banda.
+
+    La tasa base es la más lenta: todos arrancan escuchando en ella, así
+    se descubren todos los vecinos al alcance, y desde ahí aceleran. Cada
+    REDESCUBRIR_ADR_MS el modem vuelve a escuchar en la base por una
+    ventana para oír vecinos nuevos o que se alejaron.
+
+    El anuncio es un comando de protocolo propio (IPv4 protocolo 0) a
+    broadcast: [cmd 1B][largo 1B][escalón 1B][fcs 1B]. Se repite cada
+    INTERVALO_ADR_MS en la tasa base y en cada tasa de vecino. Los demás
+    broadcasts se envían una vez por cada tasa distinta entre los vecinos.
+*/
+
+#define CMD_ADR               10      // comando de protocolo propio del anuncio
+#define TAM_ANUNCIO_ADR       4
+#define ESCALONES_ADR         7       // tasas posibles, de la más rápida a la más lenta
+#define ESCALON_BASE_ADR      (ESCALONES_ADR - 1) // tasa de arranque y la de quien no anunció
+#define MAX_VECINOS_ADR       16
+#define MARGEN_ADR_CUARTOS    20      // margen sobre el SNR mínimo (5 dB)
+#define HISTERESIS_ADR_CUARTOS 8      // margen extra para pasar a una tasa más rápida
+#define INTERVALO_ADR_MS      20000UL // período del anuncio
+#define VIDA_VECINO_ADR_MS    (4 * INTERVALO_ADR_MS)
+#define REDESCUBRIR_ADR_MS    300000UL // período de vuelta a la tasa base
+#define VENTANA_REDESCUBRIR_MS (3 * INTERVALO_ADR_MS / 2) // oye al menos un anuncio de cada vecino
+
+struct TasaLoRa {
+    uint8_t sf;
+    long bw;
+};
+
+struct VecinoAdr {
+    uint16_t ip;
+    int16_t snr_cuartos;     // promedio normalizado a 125 kHz
+    uint8_t escalon_rx;      // tasa en la que escucha el vecino
+    uint8_t medido;          // hay SNR medido (cuenta para la tasa propia)
+    uint8_t anuncio;         // ya anunció su tasa
+    uint8_t activo;
+    uint32_t expira_ms;
+};
+
+class Adr
+{
+private:
+    VecinoAdr _vecinos[MAX_VECINOS_ADR];
+    uint8_t _escalon_rx;
+    int16_t _margen;
+    uint32_t _redescubrir_ms;     // próxima vuelta a la tasa base
+    uint32_t _fin_redescubrir_ms; // fin de la ventana en la tasa base
+
+    VecinoAdr *buscar(uint16_t ip);
+    VecinoAdr *entrada(uint16_t ip, uint32_t ahora_ms);
+public:
+    Adr();
+
+    void begin(uint32_t ahora_ms, int16_t margen_cuartos = MARGEN_ADR_CUARTOS);
+    void setMargen(int16_t margen_cuartos);
+    static const TasaLoRa &tasa(uint8_t escalon);
+    /**
+     * @brief SNR mínimo demodulable por el SF del escalón, en cuartos de dB
+     */
+    static int16_t snrMinimo(uint8_t escalon);
+    /**
+     * @brief registrar el SNR de una trama de un salto recibida del vecino
+     * (medida en la tasa de recepción actual)
+     */
+    void registrarSnr(uint16_t vecino, int8_t snr_cuartos, uint32_t ahora_ms);
+    /**
+     * @brief procesar el anuncio de tasa de un vecino
+     *
+     * @return false si el anuncio no es válido
+     */
+    bool procesarAnuncio(uint16_t vecino, const uint8_t *datos, int largo, uint32_t ahora_ms);
+    /**
+     * @brief construir el anuncio de la tasa de recepción propia
+     *
+     * @return bytes escritos (TAM_ANUNCIO_ADR)
+     */
+    int construirAnuncio(uint8_t *salida);
+    /**
+     * @brief expirar vecinos y recalcular la tasa de recepción
+     *
+     * @return true si la tasa de recepción cambió (hay que aplicarla y anunciarla)
+     */
+    bool actualizar(uint32_t ahora_ms);
+    uint8_t escalonRecepcion() { return _escalon_rx; }
+    /**
+     * @brief escalón con el que se transmite a un destino de un salto
+     * (la tasa base si el vecino no anunció la suya)
+     */
+    uint8_t escalonHacia(uint16_t destino);
+    /**
+     * @brief tasas distintas en las que escuchan los vecinos
+     *
+     * @param escalones buffer de al menos ESCALONES_ADR entradas
+     * @param incluir_base agregar la tasa base (anuncios ADR, para vecinos nuevos)
+     * @return cantidad de escalones escritos, del más rápido al más lento
+     */
+    int escalonesBroadcast(uint8_t *escalones, bool incluir_base = false);
+    const VecinoAdr *vecino(int i);
+};
+
+#endif
@@ -0,0 +1,24 @@
+#include "control.h"
+
+int escribirControl(const TramaControl *control, uint8_t *salida) {
+    salida[0] = control->tipo;
+    salida[1] = control->origen >> 8;
+    salida[2] = control->origen & 0xFF;
+    salida[3] = control->destino >> 8;
+    salida[4] = control->destino & 0xFF;
+    salida[5] = control->identificador >> 8;
+    salida[6] = control->identificador & 0xFF;
+    salida[7] = control->dato >> 8;
+    salida[8] = control->dato & 0xFF;
+    return TAM_TRAMA_CONTROL;
+}
+
+bool leerControl(const uint8_t *datos, int largo, TramaControl *control) {
+    if (largo != TAM_TRAMA_CONTROL || datos[0] != CONTROL_ACK) return false;
+    control->tipo = datos[0];
+    control->origen = (datos[1] << 8) | datos[2];
+    control->destino = (datos[3] << 8) | datos[4];
+    control->identificador = (datos[5] << 8) | datos[6];
+    control->dato = (datos[7] << 8) | datos[8];
+    return true;
+}
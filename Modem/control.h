@@ -0,0 +1,45 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+#include <stdint.h>
+
+/*
+    Tramas de control de largo fijo para la cabecera implícita de la
+    radio (Red::setControlImplicito). Reemplazan en el aire a tramas IPv4
+    cortas y conocidas, sobre todo el ACK del Nodo (protocolo 1 con el
+    identificador confirmado): 9 bytes sin cabecera LoRa en vez de 13 con
+    ella. El modem que recibe la trama de control la vuelve a armar como
+    IPv4 antes de entregarla, así que el Nodo no ve la diferencia.
+
+    [tipo][origen 2B][destino 2B][identificador 2B][dato 2B], big endian
+*/
+
+#define TAM_TRAMA_CONTROL 9
+#define PROTOCOLO_ACK     1
+
+enum TipoControl {
+    CONTROL_ACK = 1,          // dato = identificador confirmado
+};
+
+struct TramaControl {
+    uint8_t tipo;
+    uint16_t origen;
+    uint16_t destino;
+    uint16_t identificador;   // el de la trama IPv4 reemplazada
+    uint16_t dato;
+};
+
+/**
+ * @brief serializar una trama de control
+ *
+ * @param salida buffer con al menos TAM_TRAMA_CONTROL bytes
+ * @return bytes escritos (TAM_TRAMA_CONTROL)
+ */
+int escribirControl(const TramaControl *control, uint8_t *salida);
+/**
+ * @brief leer una trama de control recibida en cabecera implícita
+ *
+ * @return false si el largo o el tipo no son de una trama de control
+ */
+bool leerControl(const uint8_t *datos, int largo, TramaControl *control);
+
+#endif
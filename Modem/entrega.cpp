@@ -0,0 +1,93 @@
+#include "entrega.h"
+#include <string.h>
+
+Entregas::Entregas() : _pos_vistas(0)
+{
+    // la clave 0 (origen 0, id 0) no la usa ningún nodo
+    memset(_pendientes, 0, sizeof(_pendientes));
+    memset(_vistas, 0, sizeof(_vistas));
+    memset(&_est, 0, sizeof(_est));
+}
+
+bool Entregas::registrar(uint16_t destino, uint16_t id, const uint8_t *trama, int largo, uint32_t ahora_ms,
+                         uint32_t espera_ms) {
+    if (largo > 0 && largo <= MAX_TRAMA_ENTREGA) {
+        for (int i = 0; i < MAX_ENTREGAS_PENDIENTES; i++) {
+            EntregaPendiente &p = _pendientes[i];
+            if (p.activo) continue;
+            p.destino = destino;
+            p.identificador = id;
+            p.espera_ms = espera_ms;
+            p.instante_ms = ahora_ms + espera_ms;
+            p.intentos = 1;
+            p.largo = largo;
+            memcpy(p.trama, trama, largo);
+            p.activo = 1;
+            return true;
+        }
+    }
+    _est.sin_espacio++;
+    return false;
+}
+
+bool Entregas::confirmar(uint16_t destino, uint16_t id, AvisoEntrega *aviso) {
+    for (int i = 0; i < MAX_ENTREGAS_PENDIENTES; i++) {
+        EntregaPendiente &p = _pendientes[i];
+        if (!p.activo || p.destino != destino || p.identificador != id) continue;
+        p.activo = 0;
+        aviso->destino = destino;
+        aviso->identificador = id;
+        aviso->estado = ENTREGA_CONFIRMADA;
+        aviso->intentos = p.intentos;
+        _est.confirmadas++;
+        return true;
+    }
+    return false;
+}
+
+int Entregas::reintento(uint32_t ahora_ms, uint8_t *salida) {
+    for (int i = 0; i < MAX_ENTREGAS_PENDIENTES; i++) {
+        EntregaPendiente &p = _pendientes[i];
+        if (!p.activo || p.intentos >= INTENTOS_ENTREGA || (int32_t)(ahora_ms - p.instante_ms) < 0) continue;
+        p.intentos++;
+        p.espera_ms *= 2;
+        p.instante_ms = ahora_ms + p.espera_ms;
+        memcpy(salida, p.trama, p.largo);
+        _est.reintentos++;
+        return p.largo;
+    }
+    return 0;
+}
+
+bool Entregas::fallida(uint32_t ahora_ms, AvisoEntrega *aviso) {
+    for (int i = 0; i < MAX_ENTREGAS_PENDIENTES; i++) {
+        EntregaPendiente &p = _pendientes[i];
+        if (!p.activo || p.intentos < INTENTOS_ENTREGA || (int32_t)(ahora_ms - p.instante_ms) < 0) continue;
+        p.activo = 0;
+        aviso->destino = p.destino;
+        aviso->identificador = p.identificador;
+        aviso->estado = ENTREGA_FALLIDA;
+        aviso->intentos = p.intentos;
+        _est.fallidas++;
+        return true;
+    }
+    return false;
+}
+
+bool Entregas::recibida(uint16_t origen, uint16_t id) {
+    uint32_t c = clave(origen, id);
+    for (int i = 0; i < MAX_ENTREGAS_VISTAS; i++) {
+        if (_vistas[i] != c) continue;
+        _est.duplicadas++;
+        return false;
+    }
+    _vistas[_pos_vistas] = c;
+    _pos_vistas = (_pos_vistas + 1) % MAX_ENTREGAS_VISTAS;
+    return true;
+}
+
+int Entregas::pendientes() const {
+    int n = 0;
+    for (int i = 0; i < MAX_ENTREGAS_PENDIENTES; i++) n += _pendientes[i].activo;
+    return n;
+}
@@ -0,0 +1,108 @@
+#ifndef ENTREGA_H
+#define ENTREGA_H
+#include <stdint.h>
+
+/*
+    Entrega confiable de unicasts resuelta en los modems.
+
+    El Nodo marca la trama con FLAG_ENTREGA_MODEM. El modem de destino la
+    confirma apenas la recibe, sin pasar por la UART ni esperar al lazo
+    del Nodo, y sólo entrega al Nodo la primera copia. El modem de origen
+    guarda la trama y la retransmite hasta recibir el ACK o agotar los
+    intentos; al terminar avisa al Nodo con un solo comando del protocolo
+    propio, que reemplaza al ACK:
+    aviso  [CMD_ENTREGA][6][destino 2B][identificador 2B][estado][intentos]
+    Las tramas que el modem no guarda (por malla o sin lugar) se avisan en
+    el acto como sin seguimiento: el ACK del destino sube al Nodo como
+    siempre y el Nodo las sigue por su cuenta.
+*/
+
+#define CMD_ENTREGA               11
+#define MAX_ENTREGAS_PENDIENTES   4
+#define INTENTOS_ENTREGA          4      // transmisiones por trama, incluida la primera
+#define MAX_ENTREGAS_VISTAS       16     // (origen, id) recibidos recordados, anillo
+#define MAX_TRAMA_ENTREGA         255
+
+enum EstadoEntrega {
+    ENTREGA_CONFIRMADA = 0,
+    ENTREGA_FALLIDA = 1,       // sin ACK tras INTENTOS_ENTREGA transmisiones
+    ENTREGA_SIN_SEGUIMIENTO = 2, // el modem no la guardó: el Nodo espera el ACK
+};
+
+struct EntregaPendiente {
+    uint16_t destino;
+    uint16_t identificador;
+    uint32_t instante_ms;    // próximo reintento (o fin de la espera del último)
+    uint32_t espera_ms;      // se duplica en cada reintento
+    uint8_t intentos;
+    uint8_t activo;
+    uint8_t largo;
+    uint8_t trama[MAX_TRAMA_ENTREGA];
+};
+
+struct AvisoEntrega {
+    uint16_t destino;
+    uint16_t identificador;
+    uint8_t estado;
+    uint8_t intentos;
+};
+
+struct EstadisticasEntrega {
+    uint32_t confirmadas;
+    uint32_t fallidas;
+    uint32_t reintentos;
+    uint32_t sin_espacio;    // tramas que salieron sin seguimiento
+    uint32_t acks;           // ACK generados como destino
+    uint32_t duplicadas;     // copias repetidas no entregadas al Nodo
+};
+
+class Entregas
+{
+private:
+    EntregaPendiente _pendientes[MAX_ENTREGAS_PENDIENTES];
+    uint32_t _vistas[MAX_ENTREGAS_VISTAS];
+    uint8_t _pos_vistas;
+    EstadisticasEntrega _est;
+
+    static uint32_t clave(uint16_t origen, uint16_t id) { return ((uint32_t)origen << 16) | id; }
+public:
+    Entregas();
+
+    /**
+     * @brief guardar una trama recién enviada hasta su ACK
+     *
+     * @param espera_ms tiempo hasta el primer reintento (aire de ida y vuelta más margen)
+     * @return false si no hay lugar o la trama no cabe: sale sin reintentos
+     */
+    bool registrar(uint16_t destino, uint16_t id, const uint8_t *trama, int largo, uint32_t ahora_ms,
+                   uint32_t espera_ms);
+    /**
+     * @brief ACK del destino para una trama guardada
+     *
+     * @return true si la trama estaba pendiente (queda el aviso para el Nodo)
+     */
+    bool confirmar(uint16_t destino, uint16_t id, AvisoEntrega *aviso);
+    /**
+     * @brief próximo reintento vencido; la espera siguiente se duplica
+     *
+     * @param salida buffer de al menos MAX_TRAMA_ENTREGA bytes
+     * @return largo de la trama a retransmitir, 0 si no hay ninguna
+     */
+    int reintento(uint32_t ahora_ms, uint8_t *salida);
+    /**
+     * @brief trama que agotó los intentos sin ACK; se libera su lugar
+     */
+    bool fallida(uint32_t ahora_ms, AvisoEntrega *aviso);
+    /**
+     * @brief registrar una trama recibida como destino
+     *
+     * @return true si es la primera copia (se entrega al Nodo), false si es
+     *         una retransmisión de algo ya entregado
+     */
+    bool recibida(uint16_t origen, uint16_t id);
+    void contarAck() { _est.acks++; }
+    int pendientes() const;
+    const EstadisticasEntrega &estadisticas() const { return _est; }
+};
+
+#endif
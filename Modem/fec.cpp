@@ -0,0 +1,151 @@
+#include "fec.h"
+#include <string.h>
+
+// Polinomio generador cacheado para el último nsym usado, también en
+// forma logarítmica: el codificador multiplica siempre por los mismos
+// coeficientes y así cada producto es un acceso a la tabla exp
+static uint8_t generador[FEC_MAX_PARIDAD + 1];
+static uint8_t log_generador[FEC_MAX_PARIDAD + 1];
+static int nsym_generador = -1;
+
+/*
+    g(x) = (x - a^0)(x - a^1)...(x - a^(nsym-1))
+    coeficientes del grado mayor al menor, generador[0] = 1
+*/
+static void calcularGenerador(int nsym) {
+    if (nsym == nsym_generador) return;
+    memset(generador, 0, sizeof(generador));
+    generador[0] = 1;
+    for (int i = 0; i < nsym; i++) {
+        uint8_t raiz = gf::alfa(i);
+        for (int j = i + 1; j > 0; j--) {
+            generador[j] ^= gf::mul(generador[j - 1], raiz);
+        }
+    }
+    for (int j = 0; j <= nsym; j++) log_generador[j] = gf::Log::v[generador[j]];
+    nsym_generador = nsym;
+}
+
+void fec_codificar(const uint8_t *mensaje, int largo, uint8_t *paridad, int nsym) {
+    calcularGenerador(nsym);
+    memset(paridad, 0, nsym);
+
+    // División sintética con registro de desplazamiento (LFSR) de nsym bytes
+    for (int i = 0; i < largo; i++) {
+        uint8_t realimentacion = mensaje[i] ^ paridad[0];
+        memmove(paridad, paridad + 1, nsym - 1);
+        paridad[nsym - 1] = 0;
+        if (realimentacion) {
+            // ningún coeficiente de g(x) es nulo hasta FEC_MAX_PARIDAD (sim/fec_ber)
+            int log_r = gf::Log::v[realimentacion];
+            for (int j = 0; j < nsym; j++) {
+                paridad[j] ^= gf::Exp::v[log_generador[j + 1] + log_r];
+            }
+        }
+    }
+}
+
+int fec_decodificar(uint8_t *bloque, int largo, int nsym) {
+    if (nsym <= 0 || nsym > FEC_MAX_PARIDAD || largo <= nsym || largo > 255) return -1;
+
+    // Camino rápido de la trama limpia: la paridad recalculada coincide
+    // (un acceso a la tabla exp por producto, sin evaluar síndromes)
+    uint8_t paridad[FEC_MAX_PARIDAD];
+    fec_codificar(bloque, largo - nsym, paridad, nsym);
+    if (memcmp(paridad, &bloque[largo - nsym], nsym) == 0) return 0;
+
+    // Síndromes S_j = r(a^j), Horner con el byte 0 como coeficiente mayor
+    uint8_t sindrome[FEC_MAX_PARIDAD];
+    bool hay_error = false;
+    for (int j = 0; j < nsym; j++) {
+        // multiplicar por a^j es sumar j al logaritmo
+        uint8_t s = 0;
+        for (int i = 0; i < largo; i++) {
+            s = (s ? gf::Exp::v[gf::Log::v[s] + j] : 0) ^ bloque[i];
+        }
+        sindrome[j] = s;
+        if (s) hay_error = true;
+    }
+    if (!hay_error) return 0;
+
+    // Berlekamp-Massey: localizador de errores C(x), coeficientes del menor al mayor
+    uint8_t C[FEC_MAX_PARIDAD + 1] = {1};
+    uint8_t B[FEC_MAX_PARIDAD + 1] = {1};
+    uint8_t T[FEC_MAX_PARIDAD + 1];
+    int L = 0, m = 1;
+    uint8_t b = 1;
+    for (int n = 0; n < nsym; n++) {
+        uint8_t d = sindrome[n];
+        for (int i = 1; i <= L; i++) {
+            d ^= gf::mul(C[i], sindrome[n - i]);
+        }
+        if (d == 0) {
+            m++;
+            continue;
+        }
+        uint8_t coef = gf::div(d, b);
+        if (2 * L <= n) {
+            memcpy(T, C, sizeof(C));
+            for (int i = 0; i + m <= nsym; i++) C[i + m] ^= gf::mul(coef, B[i]);
+            L = n + 1 - L;
+            memcpy(B, T, sizeof(B));
+            b = d;
+            m = 1;
+        } else {
+            for (int i = 0; i + m <= nsym; i++) C[i + m] ^= gf::mul(coef, B[i]);
+            m++;
+        }
+    }
+    if (2 * L > nsym) return -1;
+
+    // Búsqueda de Chien: el byte k tiene grado largo-1-k, X = a^grado
+    int posiciones[FEC_MAX_PARIDAD / 2];
+    int encontrados = 0;
+    for (int k = 0; k < largo; k++) {
+        int grado = largo - 1 - k;
+        uint8_t x_inv = gf::alfa((255 - grado) % 255);
+        uint8_t v = 0;
+        for (int i = L; i >= 0; i--) {
+            v = gf::mul(v, x_inv) ^ C[i];
+        }
+        if (v == 0) {
+            if (encontrados == L) return -1;
+            posiciones[encontrados++] = k;
+        }
+    }
+    if (encontrados != L) return -1;
+
+    // Evaluador Omega(x) = S(x) C(x) mod x^nsym
+    uint8_t omega[FEC_MAX_PARIDAD];
+    for (int i = 0; i < nsym; i++) {
+        uint8_t acc = 0;
+        for (int j = 0; j <= i && j <= L; j++) {
+            acc ^= gf::mul(C[j], sindrome[i - j]);
+        }
+        omega[i] = acc;
+    }
+
+    // Forney (primera raíz 0): e = X * Omega(X^-1) / C'(X^-1)
+    for (int e = 0; e < encontrados; e++) {
+        int grado = largo - 1 - posiciones[e];
+        uint8_t x = gf::alfa(grado);
+        uint8_t x_inv = gf::inv(x);
+
+        uint8_t num = 0;
+        for (int i = nsym - 1; i >= 0; i--) {
+            num = gf::mul(num, x_inv) ^ omega[i];
+        }
+
+        // derivada formal: sólo sobreviven los términos de grado impar
+        uint8_t den = 0;
+        uint8_t x_inv2 = gf::mul(x_inv, x_inv);
+        for (int i = (L % 2 == 1) ? L : L - 1; i >= 1; i -= 2) {
+            den = gf::mul(den, x_inv2) ^ C[i];
+        }
+        if (den == 0) return -1;
+
+        bloque[posiciones[e]] ^= gf::mul(x, gf::div(num, den));
+    }
+
+    return encontrados;
+}
@@ -0,0 +1,111 @@
+#ifndef FEC_H
+#define FEC_H
+#include <stdint.h>
+
+/*
+    Corrección de errores hacia adelante (FEC) Reed-Solomon sobre GF(256)
+    para las tramas LoRa. Polinomio primitivo 0x11D, primera raíz alpha^0.
+    Con n bytes de paridad se corrigen hasta n/2 bytes erróneos por trama.
+    Las tablas exp/log se generan en tiempo de compilación (constexpr),
+    por lo que quedan en flash en el ESP32 y no ocupan RAM.
+*/
+
+#define FEC_MAX_PARIDAD 32      // máximo de bytes de paridad por trama
+#define GF_POLINOMIO    0x11D   // x^8 + x^4 + x^3 + x^2 + 1
+
+struct EstadisticasFEC {
+    uint32_t tramas_codificadas;    // tramas transmitidas con paridad
+    uint32_t tramas_limpias;        // recibidas sin errores
+    uint32_t tramas_corregidas;     // recibidas con errores corregidos
+    uint32_t bytes_corregidos;      // total de bytes reparados
+    uint32_t tramas_irrecuperables; // más errores que paridad/2
+    uint8_t  ultima_correccion;     // bytes corregidos en la última trama
+};
+
+namespace gf {
+
+// multiplicación por alpha (x) reduciendo por el polinomio primitivo
+constexpr uint8_t xtime(uint8_t a) {
+    return (uint8_t)((a & 0x80) ? ((a << 1) ^ GF_POLINOMIO) : (a << 1));
+}
+
+// alpha^i, recursivo para ser constexpr en C++11
+constexpr uint8_t expRec(int i, uint8_t acc) {
+    return i == 0 ? acc : expRec(i - 1, xtime(acc));
+}
+
+constexpr uint8_t exp(int i) {
+    return expRec(i % 255, 1);
+}
+
+// busca i tal que alpha^i == x, arrastrando alpha^i para no recalcularlo
+constexpr uint8_t logRec(uint8_t x, int i, uint8_t e) {
+    return (i >= 255 || e == x) ? (uint8_t)i : logRec(x, i + 1, xtime(e));
+}
+
+constexpr uint8_t log(int x) {
+    return x == 0 ? 0 : logRec((uint8_t)x, 0, 1);
+}
+
+template<int... I> struct Indices {};
+template<int N, int... I> struct GenerarIndices : GenerarIndices<N - 1, N - 1, I...> {};
+template<int... I> struct GenerarIndices<0, I...> { typedef Indices<I...> tipo; };
+
+// exp duplicada (512 entradas) para evitar el módulo 255 al multiplicar
+template<typename T> struct TablaExp;
+template<int... I> struct TablaExp<Indices<I...> > {
+    static constexpr uint8_t v[sizeof...(I)] = { gf::exp(I)... };
+};
+template<int... I> constexpr uint8_t TablaExp<Indices<I...> >::v[sizeof...(I)];
+
+template<typename T> struct TablaLog;
+template<int... I> struct TablaLog<Indices<I...> > {
+    static constexpr uint8_t v[sizeof...(I)] = { gf::log(I)... };
+};
+template<int... I> constexpr uint8_t TablaLog<Indices<I...> >::v[sizeof...(I)];
+
+typedef TablaExp<GenerarIndices<512>::tipo> Exp;
+typedef TablaLog<GenerarIndices<256>::tipo> Log;
+
+inline uint8_t mul(uint8_t a, uint8_t b) {
+    if (a == 0 || b == 0) return 0;
+    return Exp::v[Log::v[a] + Log::v[b]];
+}
+
+inline uint8_t div(uint8_t a, uint8_t b) {
+    if (a == 0) return 0;
+    return Exp::v[Log::v[a] + 255 - Log::v[b]];
+}
+
+inline uint8_t inv(uint8_t a) {
+    return Exp::v[255 - Log::v[a]];
+}
+
+// alpha^p con p en [0, 255)
+inline uint8_t alfa(int p) {
+    return Exp::v[p];
+}
+
+} // namespace gf
+
+/**
+ * @brief Calcula la paridad Reed-Solomon de un mensaje
+ *
+ * @param mensaje bytes a proteger
+ * @param largo largo del mensaje (largo + paridad <= 255)
+ * @param paridad buffer de salida de nsym bytes
+ * @param nsym cantidad de bytes de paridad (par, <= FEC_MAX_PARIDAD)
+ */
+void fec_codificar(const uint8_t *mensaje, int largo, uint8_t *paridad, int nsym);
+
+/**
+ * @brief Decodifica y corrige en el lugar un bloque mensaje+paridad
+ *
+ * @param bloque mensaje seguido de sus nsym bytes de paridad
+ * @param largo largo total del bloque (incluye la paridad)
+ * @param nsym cantidad de bytes de paridad
+ * @return bytes corregidos (0 si no había errores), -1 si es irrecuperable
+ */
+int fec_decodificar(uint8_t *bloque, int largo, int nsym);
+
+#endif
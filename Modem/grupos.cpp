@@ -0,0 +1,34 @@
+#include "grupos.h"
+#include <string.h>
+
+Grupos::Grupos() : _cantidad(0)
+{
+    memset(_bits, 0, sizeof(_bits));
+}
+
+bool Grupos::unirse(uint8_t grupo) {
+    if (grupo >= MAX_GRUPOS || miembro(BASE_GRUPOS | grupo)) return false;
+    _bits[grupo >> 3] |= 1 << (grupo & 7);
+    _cantidad++;
+    return true;
+}
+
+bool Grupos::salir(uint8_t grupo) {
+    if (!miembro(BASE_GRUPOS | grupo)) return false;
+    _bits[grupo >> 3] &= ~(1 << (grupo & 7));
+    _cantidad--;
+    return true;
+}
+
+void Grupos::vaciar() {
+    memset(_bits, 0, sizeof(_bits));
+    _cantidad = 0;
+}
+
+int Grupos::listar(uint8_t *salida, int max) const {
+    int n = 0;
+    for (int g = 0; g < MAX_GRUPOS && n < max; g++) {
+        if (_bits[g >> 3] & (1 << (g & 7))) salida[n++] = g;
+    }
+    return n;
+}
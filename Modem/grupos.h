@@ -0,0 +1,62 @@
+#ifndef GRUPOS_H
+#define GRUPOS_H
+#include <stdint.h>
+
+/*
+    Direcciones que el modem acepta para su Nodo.
+
+    Además de la IP propia y del broadcast (0xFFFF), las direcciones
+    0xFF00-0xFFFE son grupos de multicast: el byte bajo es el número de
+    grupo y la pertenencia se guarda en un mapa de bits de 32 bytes, que
+    se consulta con un acceso por trama. Las tramas para un grupo viajan
+    como los broadcast (inundadas si son mensajes) y el modem sólo las
+    sube a la UART si su Nodo es miembro; el resto se descarta antes de
+    ocupar la UART.
+
+    El Nodo configura la IP y los grupos con el protocolo propio; el
+    modem responde con la configuración aplicada:
+    dirección  [CMD_DIRECCION][2][ip 2B]       (largo 0: sólo consulta)
+    grupos     [CMD_GRUPOS][n][grupo]...       reemplaza la lista completa
+*/
+
+#define CMD_DIRECCION      12
+#define CMD_GRUPOS         13
+#define DIRECCION_BROADCAST 0xFFFF
+#define BASE_GRUPOS        0xFF00
+#define MAX_GRUPOS         255      // grupos 0x00-0xFE
+
+class Grupos
+{
+private:
+    uint8_t _bits[(MAX_GRUPOS + 7) / 8];
+    uint8_t _cantidad;
+public:
+    Grupos();
+
+    /** Grupo de multicast (no el broadcast) */
+    static bool esGrupo(uint16_t direccion) {
+        return direccion >= BASE_GRUPOS && direccion != DIRECCION_BROADCAST;
+    }
+    /** Broadcast o grupo: sale a todos los vecinos y no tiene ruta */
+    static bool esDifusion(uint16_t direccion) { return direccion >= BASE_GRUPOS; }
+
+    /** @return false si el grupo no es válido o ya era miembro */
+    bool unirse(uint8_t grupo);
+    bool salir(uint8_t grupo);
+    void vaciar();
+    /** Pertenencia para una dirección de grupo; false para cualquier otra */
+    bool miembro(uint16_t direccion) const {
+        if (!esGrupo(direccion)) return false;
+        uint8_t g = direccion & 0xFF;
+        return (_bits[g >> 3] >> (g & 7)) & 1;
+    }
+    /**
+     * @brief lista de grupos en orden creciente
+     *
+     * @return cantidad escrita (a lo sumo max)
+     */
+    int listar(uint8_t *salida, int max) const;
+    int cantidad() const { return _cantidad; }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "inundacion.h"
+#include <string.h>
+
+Inundacion::Inundacion() : _pos_vistos(0), _umbral(UMBRAL_COPIAS)
+{
+    // la clave 0 (origen 0, id 0) no la usa ningún nodo
+    memset(_vistos, 0, sizeof(_vistos));
+    memset(_pendientes, 0, sizeof(_pendientes));
+    memset(&_est, 0, sizeof(_est));
+}
+
+void Inundacion::setUmbral(uint8_t umbral) {
+    _umbral = umbral;
+}
+
+bool Inundacion::nueva(uint16_t origen, uint16_t id) {
+    uint32_t c = clave(origen, id);
+    for (int i = 0; i < MAX_INUNDACION_VISTOS; i++) {
+        if (_vistos[i] != c) continue;
+        _est.duplicadas++;
+        for (int j = 0; j < MAX_REENVIOS_PENDIENTES; j++) {
+            if (_pendientes[j].activo && _pendientes[j].clave == c && _pendientes[j].copias < 0xFF) {
+                _pendientes[j].copias++;
+            }
+        }
+        return false;
+    }
+    _vistos[_pos_vistos] = c;
+    _pos_vistos = (_pos_vistos + 1) % MAX_INUNDACION_VISTOS;
+    return true;
+}
+
+bool Inundacion::programar(uint16_t origen, uint16_t id, const uint8_t *trama, int largo, uint32_t instante_ms) {
+    if (largo <= 0 || largo > MAX_TRAMA_INUNDACION) return false;
+    for (int i = 0; i < MAX_REENVIOS_PENDIENTES; i++) {
+        ReenvioPendiente &p = _pendientes[i];
+        if (p.activo) continue;
+        p.clave = clave(origen, id);
+        p.instante_ms = instante_ms;
+        p.copias = 0;
+        p.largo = largo;
+        memcpy(p.trama, trama, largo);
+        p.activo = 1;
+        return true;
+    }
+    _est.sin_espacio++;
+    return false;
+}
+
+int Inundacion::siguiente(uint32_t ahora_ms, uint8_t *salida) {
+    for (int i = 0; i < MAX_REENVIOS_PENDIENTES; i++) {
+        ReenvioPendiente &p = _pendientes[i];
+        if (!p.activo || (int32_t)(ahora_ms - p.instante_ms) < 0) continue;
+        p.activo = 0;
+        if (_umbral > 0 && p.copias >= _umbral) {
+            _est.suprimidas++;
+            continue;
+        }
+        memcpy(salida, p.trama, p.largo);
+        _est.reenviadas++;
+        return p.largo;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef INUNDACION_H
+#define INUNDACION_H
+#include <stdint.h>
+
+/*
+    Inundación controlada de broadcasts por toda la malla.
+
+    Un broadcast de red viaja con la bandera FLAG_MALLA y el prefijo de
+    malla con siguiente salto 0xFFFF; el byte de saltos restantes hace de
+    TTL. Cada modem recuerda los (origen, id) recientes y sólo reenvía la
+    primera copia, tras un retardo aleatorio. Mientras espera cuenta las
+    copias que oye de sus vecinos: si llegan UMBRAL_COPIAS o más, su
+    reenvío aportaría poca cobertura nueva y se cancela (esquema por
+    contador). Con umbral 0 se reenvía siempre (inundación ciega).
+*/
+
+#define SIGUIENTE_INUNDACION      0xFFFF
+#define TTL_INUNDACION            8      // saltos máximos de un broadcast de red
+#define MAX_INUNDACION_VISTOS     32     // (origen, id) recordados, anillo
+#define MAX_REENVIOS_PENDIENTES   4
+#define VENTANA_REENVIO_MS        500    // retardo aleatorio máximo antes de reenviar
+#define UMBRAL_COPIAS             2      // copias oídas que suprimen el reenvío propio
+#define MAX_TRAMA_INUNDACION      255
+
+struct ReenvioPendiente {
+    uint32_t clave;          // origen << 16 | id
+    uint32_t instante_ms;    // cuándo reenviar
+    uint8_t copias;          // copias oídas desde que se programó
+    uint8_t activo;
+    uint8_t largo;
+    uint8_t trama[MAX_TRAMA_INUNDACION];
+};
+
+struct EstadisticasInundacion {
+    uint32_t reenviadas;
+    uint32_t suprimidas;     // canceladas por el contador de copias
+    uint32_t duplicadas;     // copias descartadas por ya vistas
+    uint32_t sin_espacio;    // sin lugar en la cola de reenvíos
+};
+
+class Inundacion
+{
+private:
+    uint32_t _vistos[MAX_INUNDACION_VISTOS];
+    uint8_t _pos_vistos;
+    uint8_t _umbral;
+    ReenvioPendiente _pendientes[MAX_REENVIOS_PENDIENTES];
+    EstadisticasInundacion _est;
+
+    static uint32_t clave(uint16_t origen, uint16_t id) { return ((uint32_t)origen << 16) | id; }
+public:
+    Inundacion();
+
+    void setUmbral(uint8_t umbral);
+    /**
+     * @brief registrar una copia recibida (o originada) de un broadcast de red
+     *
+     * @return true si es la primera vez que se ve; false si es un duplicado,
+     *         en cuyo caso se cuenta para el reenvío pendiente si lo hay
+     */
+    bool nueva(uint16_t origen, uint16_t id);
+    /**
+     * @brief programar el reenvío de una trama ya construida
+     *
+     * @param instante_ms momento del reenvío (ahora + retardo aleatorio)
+     * @return false si la cola de reenvíos está llena o la trama no cabe
+     */
+    bool programar(uint16_t origen, uint16_t id, const uint8_t *trama, int largo, uint32_t instante_ms);
+    /**
+     * @brief obtener el próximo reenvío vencido que no fue suprimido
+     *
+     * @param salida buffer de al menos MAX_TRAMA_INUNDACION bytes
+     * @return largo de la trama a transmitir, 0 si no hay ninguna
+     */
+    int siguiente(uint32_t ahora_ms, uint8_t *salida);
+    const EstadisticasInundacion &estadisticas() const { return _est; }
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "lote.h"
+#include <string.h>
+
+static uint8_t fcsLote(const uint8_t *datos, int largo) {
+    uint8_t fcs = 0;
+    for (int i = 0; i < largo; i++) fcs ^= datos[i];
+    return fcs;
+}
+
+LectorLote::LectorLote() : _datos(0), _largo(0), _pos(0), _tramos(0)
+{
+}
+
+bool LectorLote::begin(const uint8_t *datos, int largo) {
+    _datos = datos;
+    _largo = largo;
+    _pos = 2;
+    _tramos = 0;
+    if (largo < 3 || datos[0] != CMD_LOTE || fcsLote(datos, largo - 1) != datos[largo - 1]) return false;
+
+    // Se recorre todo antes de ejecutar: un lote mal formado no se ejecuta a medias
+    int fin = largo - 1;
+    int pos = 2;
+    int encadenado = 0;
+    uint8_t anterior = 0;
+    for (int i = 0; i < datos[1]; i++) {
+        if (pos + 2 > fin) return false;
+        uint8_t cmd = datos[pos];
+        int l = datos[pos + 1];
+        if (l > MAX_DATO_COMANDO || pos + 2 + l > fin || ((cmd & CMD_CONTINUA) && l == 0)) return false;
+        if (encadenado > 0 && (cmd & ~CMD_CONTINUA) != anterior) return false;
+        encadenado += l;
+        if (encadenado > MAX_DATO_ENCADENADO) return false;
+        if (!(cmd & CMD_CONTINUA)) encadenado = 0;
+        anterior = cmd & ~CMD_CONTINUA;
+        pos += 2 + l;
+    }
+    if (pos != fin || encadenado != 0) return false;
+    _tramos = datos[1];
+    return true;
+}
+
+int LectorLote::siguiente(uint8_t *cmd, uint8_t *dato) {
+    if (_tramos == 0) return -1;
+    int largo = 0;
+    uint8_t c;
+    do {
+        c = _datos[_pos];
+        int l = _datos[_pos + 1];
+        memcpy(&dato[largo], &_datos[_pos + 2], l);
+        largo += l;
+        _pos += 2 + l;
+        _tramos--;
+    } while ((c & CMD_CONTINUA) && _tramos > 0);
+    *cmd = c & ~CMD_CONTINUA;
+    return largo;
+}
+
+EscritorLote::EscritorLote() : _buffer(0), _max(0), _largo(0), _comandos(0)
+{
+}
+
+void EscritorLote::begin(uint8_t *buffer, int max) {
+    _buffer = buffer;
+    _max = max;
+    _buffer[0] = CMD_LOTE;
+    _buffer[1] = 0;
+    _largo = 2;
+    _comandos = 0;
+}
+
+int EscritorLote::espacio(int largo) {
+    int tramos = largo == 0 ? 1 : (largo + MAX_DATO_COMANDO - 1) / MAX_DATO_COMANDO;
+    return 2 * tramos + largo;
+}
+
+bool EscritorLote::agregar(uint8_t cmd, const uint8_t *dato, int largo) {
+    if (largo > MAX_DATO_ENCADENADO || _largo + espacio(largo) + 1 > _max) return false;
+    int pos = 0;
+    do {
+        int l = largo - pos > MAX_DATO_COMANDO ? MAX_DATO_COMANDO : largo - pos;
+        bool continua = pos + l < largo;
+        _buffer[_largo] = continua ? (cmd | CMD_CONTINUA) : (cmd & ~CMD_CONTINUA);
+        _buffer[_largo + 1] = l;
+        memcpy(&_buffer[_largo + 2], &dato[pos], l);
+        _largo += 2 + l;
+        _buffer[1]++;
+        pos += l;
+    } while (pos < largo);
+    _comandos++;
+    return true;
+}
+
+int EscritorLote::cerrar() {
+    _buffer[_largo] = fcsLote(_buffer, _largo);
+    return _largo + 1;
+}
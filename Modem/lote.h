@@ -0,0 +1,78 @@
+#ifndef LOTE_H
+#define LOTE_H
+#include <stdint.h>
+
+/*
+    Lote de comandos del protocolo propio en una sola trama.
+
+    El Nodo junta varios comandos en un IPv4 y el modem los ejecuta en
+    orden; las respuestas que generen (telemetría, dirección, grupos)
+    vuelven juntas en otro lote que cierra con un resumen. Un guión de
+    comandos cuesta así una trama de ida y una de vuelta por la UART.
+    lote       [CMD_LOTE][tramos][comando]...[fcs]   fcs: XOR de lo anterior
+    comando    [cmd][largo 0-63][dato]
+    resumen    [CMD_LOTE][1][comandos ejecutados]     último de la respuesta
+    Un dato de más de 63 bytes se parte en tramos seguidos del mismo
+    comando con CMD_CONTINUA en todos menos el último; el lector los une.
+*/
+
+#define CMD_LOTE             14
+#define CMD_CONTINUA         0x80   // bit del cmd: el dato sigue en el próximo tramo
+#define MAX_DATO_COMANDO     63
+#define MAX_DATO_ENCADENADO  189    // tres tramos (el OLED muestra 8 x 21 caracteres)
+#define MAX_LOTE             240    // entra en los datos de un IPv4 por la UART
+
+class LectorLote
+{
+private:
+    const uint8_t *_datos;
+    int _largo;
+    int _pos;
+    int _tramos;      // tramos que faltan leer
+public:
+    LectorLote();
+
+    /**
+     * @brief validar la cabecera, la estructura y el FCS de un lote
+     *
+     * @return false si no es un lote o está mal formado: no se ejecuta nada
+     */
+    bool begin(const uint8_t *datos, int largo);
+    /**
+     * @brief próximo comando, con sus tramos encadenados ya unidos
+     *
+     * @param dato buffer de al menos MAX_DATO_ENCADENADO bytes
+     * @return largo del dato, -1 si no quedan comandos
+     */
+    int siguiente(uint8_t *cmd, uint8_t *dato);
+};
+
+class EscritorLote
+{
+private:
+    uint8_t *_buffer;
+    int _max;
+    int _largo;
+    uint8_t _comandos;
+public:
+    EscritorLote();
+
+    void begin(uint8_t *buffer, int max);
+    /**
+     * @brief agregar un comando, partido en tramos si pasa de 63 bytes
+     *
+     * @return false si no cabe o es más largo que MAX_DATO_ENCADENADO (el lote no cambia)
+     */
+    bool agregar(uint8_t cmd, const uint8_t *dato, int largo);
+    /**
+     * @brief escribir el FCS al final
+     *
+     * @return largo total del lote
+     */
+    int cerrar();
+    int comandos() const { return _comandos; }
+    /** Bytes que ocupa en el lote un comando con un dato de este largo */
+    static int espacio(int largo);
+};
+
+#endif
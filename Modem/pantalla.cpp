@@ -0,0 +1,89 @@
+#include "pantalla.h"
+
+Pantalla::Pantalla(Adafruit_SSD1306 &display, TwoWire *wire, uint8_t direccion)
+    : _display(display), _wire(wire), _direccion(direccion), _valido(false)
+{
+    memset(_mostrado, 0, sizeof(_mostrado));
+    memset(&_est, 0, sizeof(_est));
+}
+
+void Pantalla::begin() {
+    _wire->setClock(RELOJ_I2C_PANTALLA);
+    invalidar();
+}
+
+void Pantalla::invalidar() {
+    _valido = false;
+}
+
+void Pantalla::enviarVentana(const uint8_t *buffer, uint8_t pagina_desde, uint8_t pagina_hasta,
+                             uint8_t desde, uint8_t hasta) {
+    _wire->beginTransmission(_direccion);
+    _wire->write((uint8_t)0x00);
+    _wire->write((uint8_t)0x21);
+    _wire->write(desde);
+    _wire->write(hasta);
+    _wire->write((uint8_t)0x22);
+    _wire->write(pagina_desde);
+    _wire->write(pagina_hasta);
+    _wire->endTransmission();
+    _est.bytes_i2c += 8;
+
+    // El controlador recorre la ventana columna a columna y baja de página
+    // al llegar a la última columna
+    int ancho = hasta - desde + 1;
+    int total = ancho * (pagina_hasta - pagina_desde + 1);
+    for (int k = 0; k < total;) {
+        int n = 0;
+        _wire->beginTransmission(_direccion);
+        _wire->write((uint8_t)0x40);
+        for (; n < TRANSACCION_I2C - 1 && k < total; n++, k++) {
+            int i = (pagina_desde + k / ancho) * ANCHO_PANTALLA + desde + k % ancho;
+            _wire->write(buffer[i]);
+            _mostrado[i] = buffer[i];
+        }
+        _wire->endTransmission();
+        _est.bytes_i2c += 2 + n;
+        _est.bytes_datos += n;
+    }
+    _est.ventanas++;
+}
+
+uint32_t Pantalla::refrescar() {
+    const uint8_t *buffer = _display.getBuffer();
+    uint32_t previos = _est.bytes_i2c;
+    _est.refrescos++;
+
+    if (!_valido) {
+        // contenido desconocido: una sola ventana con la pantalla completa
+        enviarVentana(buffer, 0, PAGINAS_PANTALLA - 1, 0, ANCHO_PANTALLA - 1);
+        _valido = true;
+        return _est.bytes_i2c - previos;
+    }
+
+    for (uint8_t pagina = 0; pagina < PAGINAS_PANTALLA; pagina++) {
+        const uint8_t *nuevo = &buffer[pagina * ANCHO_PANTALLA];
+        const uint8_t *visto = &_mostrado[pagina * ANCHO_PANTALLA];
+        int c = 0;
+        while (c < ANCHO_PANTALLA) {
+            if (nuevo[c] == visto[c]) {
+                c++;
+                continue;
+            }
+            // extender el tramo mientras el hueco de columnas iguales sea corto
+            int fin = c;
+            for (int j = c + 1; j < ANCHO_PANTALLA && j - fin <= UNION_COLUMNAS; j++) {
+                if (nuevo[j] != visto[j]) fin = j;
+            }
+            enviarVentana(buffer, pagina, pagina, c, fin);
+            c = fin + 1;
+        }
+    }
+    uint32_t enviados = _est.bytes_i2c - previos;
+    if (enviados == 0) _est.sin_cambios++;
+    return enviados;
+}
+
+void Pantalla::contarCoalescida() {
+    _est.coalescidas++;
+}
@@ -0,0 +1,75 @@
+#ifndef PANTALLA_H
+#define PANTALLA_H
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+
+/*
+    Refresco parcial del OLED SSD1306.
+
+    Adafruit_SSD1306::display() manda siempre el framebuffer completo
+    (1024 bytes, ~25 ms a 400 kHz) aunque haya cambiado un solo carácter.
+    Pantalla guarda una copia de lo que ya está en la GDDRAM del
+    controlador y en cada refresco compara página por página: sólo los
+    tramos de columnas distintos se envían, cada uno con su ventana de
+    columna y página (comandos 0x21 y 0x22) en direccionamiento
+    horizontal. Dos tramos separados por pocas columnas iguales se unen,
+    porque abrir una ventana cuesta más que reenviar esos bytes.
+
+    Se sigue dibujando con la API de Adafruit_GFX sobre el framebuffer de
+    la biblioteca; sólo cambia display() por refrescar().
+*/
+
+#define ANCHO_PANTALLA        128
+#define PAGINAS_PANTALLA      8     // 64 filas, 8 por página
+#define RELOJ_I2C_PANTALLA    400000
+#define TRANSACCION_I2C       32    // buffer de Wire, byte de control incluido
+#define UNION_COLUMNAS        8     // columnas iguales que se reenvían para no abrir otra ventana
+
+struct EstadisticasPantalla {
+    uint32_t refrescos;       // llamadas a refrescar()
+    uint32_t sin_cambios;     // refrescos que no enviaron nada
+    uint32_t ventanas;        // tramos enviados
+    uint32_t bytes_datos;     // bytes de GDDRAM enviados
+    uint32_t bytes_i2c;       // bytes en el bus (dirección, control y comandos incluidos)
+    uint32_t coalescidas;     // peticiones reemplazadas por una posterior antes de dibujarse
+};
+
+class Pantalla
+{
+private:
+    Adafruit_SSD1306 &_display;
+    TwoWire *_wire;
+    uint8_t _direccion;
+    uint8_t _mostrado[ANCHO_PANTALLA * PAGINAS_PANTALLA]; // copia de la GDDRAM
+    bool _valido;             // _mostrado refleja la pantalla
+    EstadisticasPantalla _est;
+
+    void enviarVentana(const uint8_t *buffer, uint8_t pagina_desde, uint8_t pagina_hasta,
+                       uint8_t desde, uint8_t hasta);
+public:
+    Pantalla(Adafruit_SSD1306 &display, TwoWire *wire, uint8_t direccion = 0x3C);
+
+    /**
+     * @brief tras display.begin(): sube el reloj del bus y fuerza un refresco completo
+     */
+    void begin();
+    /**
+     * @brief el contenido de la pantalla ya no se conoce (otro escribió
+     * directo al controlador); el próximo refresco la envía completa
+     */
+    void invalidar();
+    /**
+     * @brief enviar al controlador lo que cambió en el framebuffer
+     *
+     * @return bytes puestos en el bus (0 si no había cambios)
+     */
+    uint32_t refrescar();
+    /**
+     * @brief contar una petición de dibujo descartada porque llegó otra más nueva
+     */
+    void contarCoalescida();
+    const EstadisticasPantalla &estadisticas() const { return _est; }
+};
+
+#endif
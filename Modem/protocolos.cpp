@@ -0,0 +1,50 @@
+#include "protocolos.h"
+#include <string.h>
+
+static void escribir16(uint32_t valor, uint8_t *salida) {
+    if (valor > 0xFFFF) valor = 0xFFFF;
+    salida[0] = valor >> 8;
+    salida[1] = valor;
+}
+
+EstadisticasProtocolos::EstadisticasProtocolos() {
+    memset(_tramas, 0, sizeof(_tramas));
+    memset(_us_total, 0, sizeof(_us_total));
+    memset(_us_maximo, 0, sizeof(_us_maximo));
+}
+
+void EstadisticasProtocolos::registrar(uint8_t protocolo, uint32_t us) {
+    uint8_t i = indice(protocolo);
+    _tramas[i]++;
+    _us_total[i] += us;
+    if (us > _us_maximo[i]) _us_maximo[i] = us;
+}
+
+uint32_t EstadisticasProtocolos::usMedio(uint8_t protocolo) const {
+    uint8_t i = indice(protocolo);
+    return _tramas[i] > 0 ? _us_total[i] / _tramas[i] : 0;
+}
+
+int EstadisticasProtocolos::serializar(uint8_t desde, uint8_t *salida) const {
+    int largo = 1;
+    int n = 0;
+    salida[0] = 0;
+    for (int i = desde; i <= PROTOCOLO_OTROS; i++) {
+        if (_tramas[i] == 0) continue;
+        if (n == PROTOCOLOS_POR_RESPUESTA) {
+            salida[0] = i;
+            break;
+        }
+        uint8_t *e = &salida[largo];
+        e[0] = i;
+        e[1] = _tramas[i] >> 24;
+        e[2] = _tramas[i] >> 16;
+        e[3] = _tramas[i] >> 8;
+        e[4] = _tramas[i];
+        escribir16(usMedio(i), &e[5]);
+        escribir16(_us_maximo[i], &e[7]);
+        largo += ENTRADA_PROTOCOLO;
+        n++;
+    }
+    return largo;
+}
@@ -0,0 +1,51 @@
+#ifndef PROTOCOLOS_H
+#define PROTOCOLOS_H
+#include <stdint.h>
+
+/*
+    Costo por protocolo de lo que el Nodo manda al modem.
+
+    El modem despacha cada trama de la UART con una tabla constante de
+    manejadores indexada por el número de protocolo (ver Modem.ino); un
+    protocolo nuevo es una entrada más de la tabla, sin tocar el lazo.
+    El despacho mide cada llamada con micros() y la registra aquí: tramas,
+    tiempo total y máximo por protocolo. Los números desde MAX_PROTOCOLOS
+    en adelante se juntan en PROTOCOLO_OTROS.
+
+    El Nodo los consulta con el protocolo propio, por páginas:
+    pedido     [desde]
+    respuesta  [siguiente (0: no hay más)][protocolo][tramas 4B][us medio 2B][us máximo 2B]...
+    big endian; sólo van los protocolos con tramas.
+*/
+
+#define CMD_PROTOCOLOS           15
+#define MAX_PROTOCOLOS           16
+#define PROTOCOLO_OTROS          MAX_PROTOCOLOS
+#define ENTRADA_PROTOCOLO        9
+#define PROTOCOLOS_POR_RESPUESTA 6      // 1 + 6 * 9 = 55 bytes de dato
+
+class EstadisticasProtocolos
+{
+private:
+    uint32_t _tramas[MAX_PROTOCOLOS + 1];
+    uint32_t _us_total[MAX_PROTOCOLOS + 1];
+    uint32_t _us_maximo[MAX_PROTOCOLOS + 1];
+public:
+    EstadisticasProtocolos();
+
+    static uint8_t indice(uint8_t protocolo) { return protocolo < MAX_PROTOCOLOS ? protocolo : PROTOCOLO_OTROS; }
+    void registrar(uint8_t protocolo, uint32_t us);
+    uint32_t tramas(uint8_t protocolo) const { return _tramas[indice(protocolo)]; }
+    uint32_t usMedio(uint8_t protocolo) const;
+    uint32_t usMaximo(uint8_t protocolo) const { return _us_maximo[indice(protocolo)]; }
+    /**
+     * @brief serializar una página de la respuesta a CMD_PROTOCOLOS
+     *
+     * @param desde primer índice a incluir (el "siguiente" de la página anterior)
+     * @param salida buffer de al menos 1 + ENTRADA_PROTOCOLO * PROTOCOLOS_POR_RESPUESTA bytes
+     * @return bytes escritos
+     */
+    int serializar(uint8_t desde, uint8_t *salida) const;
+};
+
+#endif
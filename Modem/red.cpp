@@ -1,14 +1,59 @@
 #include "red.h"
-#define TAM_DATOS_LORA 255
-volatile bool flag_rxDone = false; // Recepción completada
-volatile BYTE buffer_rx[TAM_DATOS_LORA]; // Buffer de recepción LoRa
-volatile int last_tamDato; // tamaño del último dato recibido.
+
+/*
+    Anillo de recepción de un productor (ISR) y un consumidor (loop).
+    Sólo la ISR escribe rx_escritura y sólo getData escribe rx_lectura;
+    ambos índices avanzan libremente y se enmascaran con SLOTS_RX - 1.
+    Un slot se publica recién después de llenarlo, por lo que el lazo
+    principal nunca lee una trama a medio escribir.
+*/
+static TramaRx anillo_rx[SLOTS_RX];
+static volatile uint8_t rx_escritura = 0;
+static volatile uint8_t rx_lectura = 0;
+static volatile EstadisticasRx est_rx = {};
+static volatile bool flag_txDone = false; // TX_DONE recibido, lo consume Red::atender
+static volatile bool flag_cadDone = false; // CAD_DONE recibido
+static volatile bool flag_canalOcupado = false; // resultado del último CAD
+static volatile bool flag_rxDone = false;  // la radio entregó una trama (escucha de bajo consumo)
+static volatile bool rx_implicita = false; // la radio recibe en cabecera implícita
+static void (*aviso_eventos)() = NULL;     // despierta a la tarea de radio
 
 void IRAM_ATTR recepcion(int tamDato){
-    if (tamDato==0 || tamDato > TAM_DATOS_LORA) return;    // tamaño incorrecto?
-    LoRa.readPayload((BYTE *)buffer_rx,tamDato);        // se lee el payload
-    last_tamDato = tamDato;
     flag_rxDone = true;
+    if (tamDato==0 || tamDato > TAM_DATOS_LORA){     // tamaño incorrecto?
+        est_rx.largo_invalido++;
+        return;
+    }
+    uint8_t ocupados = rx_escritura - rx_lectura;
+    if (ocupados >= SLOTS_RX){
+        est_rx.desbordes++;                          // anillo lleno: se pierde la trama nueva
+        return;
+    }
+    TramaRx *slot = &anillo_rx[rx_escritura & (SLOTS_RX - 1)];
+    LoRa.readPayload(slot->datos,tamDato);           // se lee el payload
+    slot->largo = tamDato;
+    // registros del paquete recién recibido, sin punto flotante
+    slot->rssi = LoRa.packetRssi();
+    slot->snr_cuartos = LoRa.packetSnrRaw();
+    slot->error_frecuencia_crudo = LoRa.packetFrequencyErrorRaw();
+    slot->instante_us = micros();
+    slot->implicita = rx_implicita;
+    __sync_synchronize();                            // el slot queda escrito antes de publicarlo
+    rx_escritura = rx_escritura + 1;
+    est_rx.recibidas++;
+    if (ocupados + 1 > est_rx.ocupacion_maxima) est_rx.ocupacion_maxima = ocupados + 1;
+    if (aviso_eventos) aviso_eventos();
+}
+
+void IRAM_ATTR finTransmision(){
+    flag_txDone = true;
+    if (aviso_eventos) aviso_eventos();
+}
+
+void IRAM_ATTR finCAD(bool ocupado){
+    flag_canalOcupado = ocupado;
+    flag_cadDone = true;
+    if (aviso_eventos) aviso_eventos();
 }
 
 Red::Red()
@@ -16,11 +61,404 @@ Red::Red()
 
 }
 
-void Red::transmite_data(BYTE * data,BYTE largo,bool rx_on){
-    LoRa.beginPacket();
-    LoRa.write(data,largo);
-    LoRa.endPacket();
-    if (rx_on) lora_sleep(false);
+bool Red::transmite_data(BYTE * data,BYTE largo,bool rx_on,int sf,long bw,uint8_t opciones,uint8_t canal){
+    bool implicita = opciones & TX_IMPLICITA;
+    if (implicita ? (_largoControl == 0 || largo != _largoControl) : largo > maxDato()) return false;
+    if (canal >= _canales) return false;
+    if (_txCantidad >= SLOTS_TX){
+        _estTx.cola_llena++;
+        return false;
+    }
+    TramaTx *trama = &_colaTx[(_txCabeza + _txCantidad) % SLOTS_TX];
+    memcpy(trama->datos,data,largo);
+    int paridad = implicita ? 0 : _fec;  // la trama de control tiene largo fijo: la protege el CRC
+    if (paridad > 0){
+        fec_codificar(data,largo,&trama->datos[largo],paridad); // paridad al final del payload
+    }
+    trama->largo = largo + paridad;
+    trama->rx_on = rx_on;
+    trama->opciones = opciones;
+    trama->sf = sf > 0 ? sf : _sf;
+    trama->bw = bw > 0 ? bw : _bw;
+    trama->canal = canal;
+    trama->aire_us = tiempoAireUs(trama->largo,trama->sf,trama->bw,implicita);
+    if (!_aire.admite(trama->aire_us)) return false; // nunca podría salir a esta tasa
+    if (paridad > 0) _estFEC.tramas_codificadas++;
+    _txCantidad++;
+    _estTx.encoladas++;
+    if (_txCantidad > _estTx.ocupacion_maxima) _estTx.ocupacion_maxima = _txCantidad;
+
+    if (_txEstado == TX_LIBRE) atender(); // arranca el backoff de inmediato
+    return true;
+}
+
+void Red::atender(){
+    switch (_txEstado){
+    case TX_AIRE:
+        if (flag_txDone){
+            flag_txDone = false;
+            _estTx.transmitidas++;
+            terminarTransmision();
+        }
+        else if (micros() - _txMarca > TIMEOUT_TX_MS * 1000UL + _colaTx[_txCabeza].aire_us){
+            _estTx.timeouts++;        // interrupción perdida: se descarta la trama
+            LoRa.idle();
+            terminarTransmision();
+        }
+        break;
+    case TX_CAD:
+        if (flag_cadDone){
+            flag_cadDone = false;
+            if (flag_canalOcupado) canalOcupado();
+            else iniciarTransmision();
+        }
+        else if (micros() - _txMarca > TIMEOUT_CAD_MS * 1000UL){
+            _estTx.cad_timeouts++;    // sin respuesta del CAD se transmite igual
+            iniciarTransmision();
+        }
+        break;
+    case TX_ESPERA:
+        if (micros() - _txMarca >= _txEspera) iniciarCAD();
+        break;
+    case TX_LIBRE:
+        atenderEscucha();
+        if (_txCantidad == 0) break;
+        if (_escucha != ESCUCHA_CONTINUA && _escucha != ESCUCHA_DORMIDA) break; // no cortar el muestreo ni una recepción
+        if (_aire.disponible(_colaTx[_txCabeza].aire_us,micros())){
+            _txEsperaAire = false;
+            programarBackoff();
+        }
+        else if (!_txEsperaAire){
+            _txEsperaAire = true;     // la trama queda en la cola hasta que se recargue
+            _aire.contarEspera();
+        }
+        break;
+    }
+}
+
+uint32_t Red::tiempoSimboloUs(){
+    return tiempoSimboloUs(_sf,_bw);
+}
+
+uint32_t Red::tiempoSimboloUs(int sf,long bw){
+    return (uint32_t)(((1UL << sf) * 1000000ULL) / bw);
+}
+
+uint32_t Red::tiempoAireUs(int largo,int sf,long bw,bool implicita){
+    // _crc es el denominador que recibe setCodingRate4, que lo limita a 5..8
+    int cr = constrain(_crc,5,8) - 4;
+    sf = sf > 0 ? sf : _sf;
+    bw = bw > 0 ? bw : _bw;
+    return aire::tiempoAireUs(largo,sf,bw,cr,preambuloSimbolos(sf,bw),true,implicita);
+}
+
+void Red::setControlImplicito(uint8_t largo,uint32_t ventana_ms){
+    _largoControl = largo;
+    _ventanaControlUs = ventana_ms * 1000;
+}
+
+uint32_t Red::ventanaControlUs(){
+    // más el primer backoff y el CAD de quien responde y el aire de la
+    // respuesta, que sale a nuestra tasa de recepción
+    uint32_t acceso = (VENTANA_MIN_RANURAS * SIMBOLOS_POR_RANURA + 2) * tiempoSimboloUs();
+    return _ventanaControlUs + acceso + tiempoAireUs(_largoControl,0,0,true);
+}
+
+long Red::preambuloSimbolos(int sf,long bw){
+    if (!muestreo()) return PREAMBLE_LENGTH;
+    // el sueño del receptor más sus CAD (~2 símbolos cada uno, uno por canal
+    // que escucha), con el preámbulo normal de margen para la latencia del
+    // muestreo y el enganche de la recepción
+    uint32_t simbolo = tiempoSimboloUs(sf > 0 ? sf : _sf,bw > 0 ? bw : _bw);
+    int cads = _canales > 1 ? 2 : 1;
+    long simbolos = (_intervaloEscuchaUs + simbolo - 1) / simbolo + 2 * cads + PREAMBLE_LENGTH;
+    return simbolos > MAX_PREAMBULO ? MAX_PREAMBULO : simbolos;
+}
+
+void Red::setEscuchaBajoConsumo(uint32_t intervalo_ms){
+    _intervaloEscuchaUs = intervalo_ms * 1000;
+    // el registro de preámbulo se usa también en recepción: igual al de los emisores
+    LoRa.setPreambleLength(preambuloSimbolos());
+    if (_txEstado == TX_LIBRE) reposo();
+}
+
+const EstadisticasEscucha &Red::estadisticasEscucha(){
+    return _estEscucha;
+}
+
+void Red::setCanales(uint8_t canales,uint16_t direccion){
+    _canales = constrain(canales,1,MAX_CANALES);
+    _canalPropio = canalDe(direccion);
+    LoRa.setPreambleLength(preambuloSimbolos());
+    if (_txEstado == TX_LIBRE){
+        LoRa.idle();
+        aplicarCanal(_canalPropio);
+        reposo();
+    }
+}
+
+uint8_t Red::canalDe(uint16_t direccion){
+    return direccion % _canales;      // el de encuentro también es el propio de algunos nodos
+}
+
+uint8_t Red::canalPropio(){
+    return _canalPropio;
+}
+
+long Red::frecuenciaCanal(uint8_t canal){
+    return FRECUENCIA_ENCUENTRO + canal * SEPARACION_CANALES;
+}
+
+void Red::aplicarCanal(uint8_t canal){
+    if (canal == _canalRadio) return;
+    LoRa.setFrequency(frecuenciaCanal(canal));
+    _canalRadio = canal;
+}
+
+bool Red::muestreo(){
+    return _intervaloEscuchaUs > 0 || _canales > 1;
+}
+
+void Red::reposo(){
+    rx_implicita = false;
+    if (!muestreo()){
+        _escucha = ESCUCHA_CONTINUA;
+        lora_sleep(false);
+    }
+    else dormir();
+}
+
+void Red::dormir(){
+    _escucha = ESCUCHA_DORMIDA;
+    _escuchaMarca = micros();
+    if (_intervaloEscuchaUs > 0){
+        lora_sleep(true);
+        return;
+    }
+    // varios canales sin bajo consumo: hasta la próxima vuelta de CAD se
+    // recibe en el canal propio, como en recepción continua
+    LoRa.idle();
+    aplicarCanal(_canalPropio);
+    lora_sleep(false);
+}
+
+void Red::muestrear(uint8_t canal){
+    flag_cadDone = false;
+    aplicarCanal(canal);
+    _canalMuestreo = canal;
+    _escucha = ESCUCHA_CAD;
+    _escuchaMarca = micros();
+    LoRa.CAD();                       // termina con la interrupción CAD_DONE
+}
+
+void Red::escuchar(){
+    flag_rxDone = false;
+    rx_implicita = false;
+    _escucha = ESCUCHA_RX;
+    _escuchaMarca = micros();
+    lora_sleep(false);
+}
+
+void Red::abrirVentanaControl(){
+    flag_rxDone = false;
+    rx_implicita = true;
+    _escucha = ESCUCHA_CONTROL;
+    _escuchaMarca = micros();
+    _estEscucha.ventanas_control++;
+    LoRa.receive(_largoControl);      // cabecera implícita con el largo fijo
+}
+
+void Red::atenderEscucha(){
+    switch (_escucha){
+    case ESCUCHA_CONTINUA:
+        break;
+    case ESCUCHA_DORMIDA:
+        if (micros() - _escuchaMarca < _intervaloEscuchaUs) break;
+        LoRa.idle();
+        aplicarTasa(_sf,_bw);             // una tasa nueva o la de recepción tras transmitir
+        LoRa.setPreambleLength(preambuloSimbolos());
+        _estEscucha.muestreos++;
+        muestrear(_canalPropio);
+        break;
+    case ESCUCHA_CAD:
+        if (flag_cadDone){
+            flag_cadDone = false;
+            if (flag_canalOcupado){
+                _estEscucha.detecciones++;
+                if (_canalMuestreo != _canalPropio) _estEscucha.detecciones_encuentro++;
+                escuchar();                   // en el canal del CAD
+            }
+            else if (_canalMuestreo != CANAL_ENCUENTRO) muestrear(CANAL_ENCUENTRO); // el propio y el de encuentro
+            else dormir();
+        }
+        else if (micros() - _escuchaMarca > TIMEOUT_CAD_MS * 1000UL) dormir();
+        break;
+    case ESCUCHA_RX:
+        if (flag_rxDone){
+            _estEscucha.recepciones++;
+            dormir();
+        }
+        // lo que falte del preámbulo más la trama más larga
+        else if (micros() - _escuchaMarca > tiempoAireUs(TAM_DATOS_LORA)){
+            _estEscucha.sin_trama++;
+            dormir();
+        }
+        break;
+    case ESCUCHA_CONTROL:
+        if (flag_rxDone) _estEscucha.controles++;
+        else if (micros() - _escuchaMarca <= ventanaControlUs()) break;
+        if (_sfRadio != _sf || _bwRadio != _bw){ // setTasa durante la ventana
+            LoRa.idle();
+            aplicarTasa(_sf,_bw);
+        }
+        reposo();
+        break;
+    }
+}
+
+void Red::setCicloTrabajo(uint16_t pormil,uint32_t rafaga_ms,uint32_t maximo_trama_ms){
+    _aire.configurar(pormil,rafaga_ms,maximo_trama_ms);
+}
+
+const EstadisticasAire &Red::estadisticasAire(){
+    return _aire.estadisticas(millis());
+}
+
+void Red::aplicarTasa(int sf,long bw){
+    if (sf == _sfRadio && bw == _bwRadio) return;
+    LoRa.setSpreadingFactor(sf);
+    LoRa.setSignalBandwidth(bw);
+    _sfRadio = sf;
+    _bwRadio = bw;
+}
+
+void Red::setTasa(int sf,long bw){
+    _sf = sf;
+    _bw = bw;
+    // en CAD o en el aire la radio vuelve a la tasa de recepción al terminar;
+    // el muestreo de la escucha de bajo consumo la aplica al despertar y la
+    // ventana de control al cerrarse: no se corta un CAD ni una recepción
+    bool escuchando = _escucha == ESCUCHA_CAD || _escucha == ESCUCHA_RX || _escucha == ESCUCHA_CONTROL;
+    if ((_txEstado == TX_LIBRE && !escuchando) || _txEstado == TX_ESPERA){
+        LoRa.idle();
+        aplicarTasa(sf,bw);
+        reposo();
+    }
+}
+
+void Red::programarBackoff(){
+    // ventana binaria exponencial en ranuras de SIMBOLOS_POR_RANURA símbolos
+    // de la tasa de la trama (el CAD se hace en esa tasa)
+    TramaTx *trama = &_colaTx[_txCabeza];
+    uint8_t exp = _txIntentos < VENTANA_MAX_EXP ? _txIntentos : VENTANA_MAX_EXP;
+    long ventana = (long)VENTANA_MIN_RANURAS << exp;
+    _txEspera = (unsigned long)random(ventana) * SIMBOLOS_POR_RANURA * tiempoSimboloUs(trama->sf,trama->bw);
+    _txMarca = micros();
+    _txEstado = TX_ESPERA;
+    if (_txEspera == 0) iniciarCAD();
+}
+
+void Red::iniciarCAD(){
+    TramaTx *trama = &_colaTx[_txCabeza];
+    flag_cadDone = false;
+    LoRa.idle();
+    aplicarTasa(trama->sf,trama->bw); // escuchar el canal en la tasa en que se va a transmitir
+    aplicarCanal(trama->canal);
+    _txMarca = micros();
+    _txEstado = TX_CAD;
+    LoRa.CAD();                       // termina con la interrupción CAD_DONE
+}
+
+void Red::canalOcupado(){
+    _estTx.canal_ocupado++;
+    aplicarTasa(_sf,_bw);
+    if (muestreo() && _canalRadio == CANAL_ENCUENTRO){
+        // con muestreo lo ocupado suele ser un preámbulo largo, más largo
+        // que cualquier backoff: se recibe esa trama y el backoff empieza
+        // al terminar (en TX_LIBRE)
+        escuchar();
+        _txEstado = TX_LIBRE;
+    }
+    else{
+        // escuchar durante el backoff: puede ser para nosotros (el canal
+        // propio de otro nodo, en cambio, nunca lo es); tras el CAD la
+        // radio quedó en standby
+        aplicarCanal(_canalPropio);
+        lora_sleep(false);
+    }
+    if (++_txIntentos > MAX_INTENTOS_CAD){
+        _estTx.descartadas_canal++;
+        _txIntentos = 0;
+        _txCabeza = (_txCabeza + 1) % SLOTS_TX;
+        _txCantidad--;
+        _txEstado = TX_LIBRE;
+        return;
+    }
+    if (_txEstado != TX_LIBRE) programarBackoff();
+}
+
+void Red::iniciarTransmision(){
+    TramaTx *trama = &_colaTx[_txCabeza];
+    bool implicita = trama->opciones & TX_IMPLICITA;
+    if (!LoRa.beginPacket(implicita)){ // la radio aún transmite: se reintenta más tarde
+        programarBackoff();
+        return;
+    }
+    LoRa.write(trama->datos,trama->largo);
+    if (muestreo()) LoRa.setPreambleLength(preambuloSimbolos(trama->sf,trama->bw));
+    if (trama->sf != _sf || trama->bw != _bw) _estTx.cambios_tasa++;
+    if (trama->canal != CANAL_ENCUENTRO) _estTx.otro_canal++;
+    if (implicita) _estTx.implicitas++;
+    flag_txDone = false;
+    _txIntentos = 0;
+    _txMarca = micros();
+    _txEstado = TX_AIRE;
+    _aire.consumir(trama->aire_us,_txMarca,millis());
+    LoRa.endPacket(true);             // asíncrono: termina con la interrupción TX_DONE
+}
+
+void Red::terminarTransmision(){
+    bool rx_on = _colaTx[_txCabeza].rx_on;
+    bool espera_control = _colaTx[_txCabeza].opciones & TX_ESPERA_CONTROL;
+    _txCabeza = (_txCabeza + 1) % SLOTS_TX;
+    _txCantidad--;
+    _txEstado = TX_LIBRE;
+    aplicarTasa(_sf,_bw);             // volver a la tasa y al canal de recepción
+    aplicarCanal(_canalPropio);
+    // la respuesta de control, o volver a recepción continua o al muestreo (o dormir sin escuchar)
+    if (espera_control && _largoControl > 0) abrirVentanaControl();
+    else if (rx_on || muestreo()) reposo();
+    else lora_sleep(true);
+}
+
+void Red::setAvisoEventos(void (*aviso)()){
+    aviso_eventos = aviso;
+}
+
+bool Red::transmitiendo(){
+    return _txEstado == TX_AIRE;
+}
+
+int Red::tramasEnCola(){
+    return _txCantidad;
+}
+
+const EstadisticasTx &Red::estadisticasTx(){
+    return _estTx;
+}
+
+void Red::setFEC(int paridad){
+    if (paridad < 0) paridad = 0;
+    if (paridad > FEC_MAX_PARIDAD) paridad = FEC_MAX_PARIDAD;
+    _fec = paridad & ~1; // Reed-Solomon corrige paridad/2 bytes, se usa un valor par
+}
+
+int Red::maxDato(){
+    return TAM_DATOS_LORA - _fec;
+}
+
+const EstadisticasFEC &Red::estadisticasFEC(){
+    return _estFEC;
 }
 
 void Red::lora_sleep(bool sleep){
@@ -37,7 +475,7 @@ void Red::begin(int sf,long bw,int CR,int txpwr){
     //https://resource.heltec.cn/download/WiFi_LoRa_32/V2/WIFI_LoRa_32_V2(868-915).PDF
     do
     {
-        if (LoRa.begin(915E6))break;// intenta inicializar la radio LoRa
+        if (LoRa.begin(FRECUENCIA_ENCUENTRO))break;// intenta inicializar la radio LoRa
         Serial.println("No se pudo iniciar radio LoRa");
         delay(1000); // en caso de error se espera 1 segundo
     } while (1);
@@ -46,7 +484,10 @@ void Red::begin(int sf,long bw,int CR,int txpwr){
     LoRa.setPreambleLength(PREAMBLE_LENGTH); // largo del preambulo
     setconfLoRa(sf,bw,CR,txpwr);             // asignación de parámetros
     LoRa.onReceive(recepcion);               // preparar interrupción
+    LoRa.onTxDone(finTransmision);           // fin de transmisión asíncrona
+    LoRa.onCadDone(finCAD);                  // resultado de escuchar el canal
     lora_sleep(false);
+    randomSeed(((uint32_t)LoRa.random() << 8) | LoRa.random()); // RSSI de banda ancha en RX como semilla del backoff
 }
 
 void Red::setconfLoRa(int sf,long bw,int CR,int txpwr)
@@ -54,6 +495,8 @@ void Red::setconfLoRa(int sf,long bw,int CR,int txpwr)
     _sf = sf; // factor de ensanchamiento
     _bw = bw; // ancho de banda
     _crc = CR; // factor de codificación
+    _sfRadio = sf;
+    _bwRadio = bw;
     LoRa.setSpreadingFactor(sf);
     LoRa.setSignalBandwidth(bw);
     LoRa.setCodingRate4(CR);
@@ -62,16 +505,75 @@ void Red::setconfLoRa(int sf,long bw,int CR,int txpwr)
 
 
 bool  Red::dataDisponible(){
-    return flag_rxDone;
+    return rx_lectura != rx_escritura;
 }
 
-int Red::getData(BYTE *data,int n){
-    if (flag_rxDone)
-    {
-        n = min(n,(int)last_tamDato);
-        memcpy(data,(BYTE *)buffer_rx,(int)last_tamDato);
-        flag_rxDone = false;
-        return n;
+int Red::tramasPendientes(){
+    return (uint8_t)(rx_escritura - rx_lectura);
+}
+
+EstadisticasRx Red::estadisticasRx(){
+    EstadisticasRx copia;
+    noInterrupts();
+    copia.recibidas = est_rx.recibidas;
+    copia.desbordes = est_rx.desbordes;
+    copia.largo_invalido = est_rx.largo_invalido;
+    copia.ocupacion_maxima = est_rx.ocupacion_maxima;
+    interrupts();
+    copia.errores_crc = LoRa.crcErrors();
+    return copia;
+}
+
+int escribirMetadatosEnlace(const MetadatosEnlace *enlace, BYTE *salida){
+    salida[0] = (enlace->rssi >> 8) & 0xFF;
+    salida[1] = enlace->rssi & 0xFF;
+    salida[2] = (BYTE)enlace->snr_cuartos;
+    salida[3] = (enlace->error_frecuencia >> 8) & 0xFF;
+    salida[4] = enlace->error_frecuencia & 0xFF;
+    return TAM_METADATOS_ENLACE;
+}
+
+int Red::getData(BYTE *data,int n,MetadatosEnlace *enlace){
+    if (!dataDisponible()) return 0;// No hay datos.
+
+    __sync_synchronize();            // ver el slot completo que publicó la ISR
+    TramaRx *slot = &anillo_rx[rx_lectura & (SLOTS_RX - 1)];
+    int largo = slot->largo;
+
+    if (enlace != NULL){
+        // conversión del registro de error de frecuencia (datasheet SX1276, p. 37)
+        float ferr = (slot->error_frecuencia_crudo * 16777216.0f / 32E6f) * (_bw / 500000.0f);
+        enlace->rssi = slot->rssi;
+        enlace->snr_cuartos = slot->snr_cuartos;
+        enlace->error_frecuencia = (int16_t)constrain((long)ferr, -32767L, 32767L);
+        enlace->instante_us = slot->instante_us;
+        enlace->implicita = slot->implicita;
     }
-    return 0;// No hay datos.
+
+    int copiados = 0;
+    if (_fec > 0 && !slot->implicita){
+        // corregir en el lugar antes de entregar; la paridad no se entrega
+        int corregidos = fec_decodificar(slot->datos,largo,_fec);
+        if (corregidos < 0){
+            _estFEC.tramas_irrecuperables++;
+            largo = 0;
+        }
+        else {
+            if (corregidos == 0) _estFEC.tramas_limpias++;
+            else {
+                _estFEC.tramas_corregidas++;
+                _estFEC.bytes_corregidos += corregidos;
+            }
+            _estFEC.ultima_correccion = corregidos;
+            largo -= _fec;
+        }
+    }
+    if (largo > 0){
+        copiados = min(n,largo);
+        memcpy(data,slot->datos,copiados);
+    }
+
+    __sync_synchronize();            // terminar de leer antes de liberar el slot
+    rx_lectura = rx_lectura + 1;
+    return copiados;
 }
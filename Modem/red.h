@@ -2,6 +2,8 @@
 #define RED_H
 #include <SPI.h>
 #include "LoRa.h"
+#include "fec.h"
+#include "tiempo_aire.h"
 #include <Arduino.h>
 
 // Pines SPI LoRa
@@ -11,19 +13,189 @@
 // extras
 #define PREAMBLE_LENGTH     12       // tamaño del preambulo LoRa
 #define BYTE unsigned char
+#define TAM_METADATOS_ENLACE 5  // bytes del trailer de calidad de enlace hacia el Nodo
+#define TAM_DATOS_LORA 255
+#define SLOTS_RX 8              // tramas recibidas en espera (potencia de 2)
+#define SLOTS_TX 8              // tramas en cola de transmisión
+#define TIMEOUT_TX_MS 5000      // sin TX_DONE en este tiempo se aborta la transmisión
+// Acceso al canal (escuchar antes de transmitir con CAD)
+#define SIMBOLOS_POR_RANURA 4   // ranura de backoff: un CAD (~2 símbolos) más el cambio RX/TX
+#define VENTANA_MIN_RANURAS 4   // ventana de contención del primer intento
+#define VENTANA_MAX_EXP 5       // la ventana se duplica hasta VENTANA_MIN_RANURAS << 5
+#define MAX_INTENTOS_CAD 6      // CAD con canal ocupado antes de descartar la trama
+#define TIMEOUT_CAD_MS 100      // sin CAD_DONE se transmite igual
+// Escucha de bajo consumo (muestreo del preámbulo con CAD)
+#define MAX_PREAMBULO 65535     // registro de 16 bits del SX1276
+// Varios canales: cada nodo escucha en su canal propio y en el de encuentro
+#define FRECUENCIA_ENCUENTRO 915E6  // canal 0: broadcast (y el único canal si no se configuran más)
+#define SEPARACION_CANALES 600E3    // canal i en FRECUENCIA_ENCUENTRO + i * SEPARACION_CANALES
+#define MAX_CANALES 8               // hasta 919.2 MHz, dentro de la banda de 902-928 MHz
+#define CANAL_ENCUENTRO 0
+// Opciones de transmite_data
+#define TX_IMPLICITA      0x1   // cabecera implícita: largo fijo de setControlImplicito, sin FEC
+#define TX_ESPERA_CONTROL 0x2   // al terminar, ventana de recepción implícita para la respuesta
+
+/**
+ * @brief Calidad de enlace medida por la radio para el último paquete
+ */
+struct MetadatosEnlace {
+    int16_t rssi;              // dBm
+    int8_t snr_cuartos;        // SNR en pasos de 0.25 dB
+    int16_t error_frecuencia;  // Hz (saturado a +-32767)
+    uint32_t instante_us;      // micros() al terminar la recepción (no se serializa)
+    bool implicita;            // trama de control en cabecera implícita (no se serializa)
+};
+
+/**
+ * @brief Trama guardada por la interrupción de recepción
+ */
+struct TramaRx {
+    BYTE datos[TAM_DATOS_LORA];
+    BYTE largo;
+    int16_t rssi;
+    int8_t snr_cuartos;
+    int32_t error_frecuencia_crudo; // registro de la radio, se convierte a Hz fuera de la ISR
+    uint32_t instante_us;
+    bool implicita;
+};
+
+/**
+ * @brief Contadores del anillo de recepción
+ */
+struct EstadisticasRx {
+    uint32_t recibidas;       // tramas guardadas en el anillo
+    uint32_t desbordes;       // tramas descartadas por anillo lleno
+    uint32_t largo_invalido;  // interrupciones con tamaño 0 o mayor a la trama
+    uint32_t errores_crc;     // paquetes con CRC inválido descartados por la radio
+    uint8_t ocupacion_maxima; // máximo de slots ocupados observado
+};
+
+/**
+ * @brief Trama a la espera de ser transmitida (incluye la paridad FEC)
+ */
+struct TramaTx {
+    BYTE datos[TAM_DATOS_LORA];
+    BYTE largo;
+    bool rx_on;               // volver a recepción al terminar
+    uint8_t opciones;         // TX_IMPLICITA, TX_ESPERA_CONTROL
+    uint8_t sf;               // tasa de esta trama (la de quien la recibe)
+    long bw;
+    uint8_t canal;            // canal de esta trama (el propio de quien la recibe o el de encuentro)
+    uint32_t aire_us;         // tiempo en el aire a esa tasa
+};
+
+/**
+ * @brief Contadores de la cola de transmisión
+ */
+struct EstadisticasTx {
+    uint32_t encoladas;
+    uint32_t transmitidas;    // terminadas con TX_DONE
+    uint32_t cola_llena;      // tramas rechazadas por cola llena
+    uint32_t timeouts;        // transmisiones abortadas sin TX_DONE
+    uint32_t canal_ocupado;   // CAD que detectaron actividad
+    uint32_t descartadas_canal; // tramas descartadas tras MAX_INTENTOS_CAD
+    uint32_t cad_timeouts;    // CAD sin respuesta de la radio
+    uint32_t cambios_tasa;    // tramas transmitidas en una tasa distinta a la de recepción
+    uint32_t implicitas;      // tramas de control transmitidas en cabecera implícita
+    uint32_t otro_canal;      // tramas transmitidas en el canal propio de su receptor
+    uint8_t ocupacion_maxima;
+};
+
+/**
+ * @brief Contadores de la escucha de bajo consumo
+ */
+struct EstadisticasEscucha {
+    uint32_t muestreos;       // CAD al despertar
+    uint32_t detecciones;     // CAD con actividad: se pasó a recepción
+    uint32_t detecciones_encuentro; // de ellas, en el canal de encuentro (con varios canales)
+    uint32_t recepciones;     // detecciones que terminaron en una trama
+    uint32_t sin_trama;       // detecciones que vencieron sin trama (falsa alarma o trama perdida)
+    uint32_t ventanas_control; // ventanas de recepción implícita abiertas tras transmitir
+    uint32_t controles;       // ventanas que recibieron una trama de control
+};
+
+/**
+ * @brief Serializar el trailer de enlace que se agrega a las tramas hacia UART
+ * [rssi 2B][snr 1B][error de frecuencia 2B], big endian
+ * 
+ * @param enlace metadatos a serializar
+ * @param salida buffer con al menos TAM_METADATOS_ENLACE bytes
+ * @return bytes escritos
+ */
+int escribirMetadatosEnlace(const MetadatosEnlace *enlace, BYTE *salida);
 /**
  * @brief Recepción
- * Función para manejar interrupción de recepción LoRa
+ * Función para manejar interrupción de recepción LoRa. Guarda la trama y
+ * su calidad de enlace en el siguiente slot libre del anillo de recepción;
+ * si está lleno la trama se descarta y se cuenta como desborde.
  * 
  * @param tamDato tamaño del dato LoRa obtenido desde la radio
  */
 void recepcion(int tamDato);
+/**
+ * @brief Fin de transmisión
+ * Interrupción TX_DONE de la radio; sólo marca la bandera, el lazo
+ * principal vuelve a recepción y lanza la siguiente trama.
+ */
+void finTransmision();
+/**
+ * @brief Fin de CAD
+ * Interrupción CAD_DONE de la radio
+ * 
+ * @param ocupado se detectó un preámbulo LoRa en el canal
+ */
+void finCAD(bool ocupado);
 
 class Red
 {
 private:
     bool flg_rxOK = false;
+    int _fec = 0; // bytes de paridad Reed-Solomon (0 = FEC deshabilitado)
+    EstadisticasFEC _estFEC = {};
+
+    // Cola de transmisión (sólo la usa el lazo principal)
+    enum EstadoTx { TX_LIBRE, TX_ESPERA, TX_CAD, TX_AIRE };
+    TramaTx _colaTx[SLOTS_TX];
+    uint8_t _txCabeza = 0;       // próxima trama a transmitir
+    uint8_t _txCantidad = 0;
+    EstadoTx _txEstado = TX_LIBRE;
+    uint8_t _txIntentos = 0;     // CAD ocupados de la trama actual
+    unsigned long _txMarca = 0;  // micros() al entrar al estado actual
+    unsigned long _txEspera = 0; // backoff en microsegundos
+    EstadisticasTx _estTx = {};
+    int _sfRadio = 0;            // tasa configurada en la radio en este momento
+    long _bwRadio = 0;
+    PresupuestoAire _aire;       // ciclo de trabajo y tiempo máximo por trama
+    bool _txEsperaAire = false;  // la cabecera ya se contó como espera de presupuesto
 
+    // Recepción: continua, o dormida y muestreando el canal con CAD, o en
+    // cabecera implícita esperando una trama de control
+    enum EstadoEscucha { ESCUCHA_CONTINUA, ESCUCHA_DORMIDA, ESCUCHA_CAD, ESCUCHA_RX, ESCUCHA_CONTROL };
+    EstadoEscucha _escucha = ESCUCHA_CONTINUA;
+    uint32_t _intervaloEscuchaUs = 0; // sueño entre CAD, 0 = recepción continua
+    unsigned long _escuchaMarca = 0;  // micros() al entrar al estado actual
+    EstadisticasEscucha _estEscucha = {};
+    uint8_t _largoControl = 0;        // largo de las tramas implícitas, 0 = deshabilitadas
+    uint32_t _ventanaControlUs = 0;   // espera de la respuesta, además de su tiempo en el aire
+    uint8_t _canales = 1;             // canales en uso, 1 = sólo el de encuentro
+    uint8_t _canalPropio = CANAL_ENCUENTRO;
+    uint8_t _canalRadio = CANAL_ENCUENTRO;   // canal configurado en la radio en este momento
+    uint8_t _canalMuestreo = CANAL_ENCUENTRO; // canal del CAD o la recepción de la escucha
+
+    void aplicarTasa(int sf,long bw);
+    void aplicarCanal(uint8_t canal);
+    bool muestreo();             // la recepción muestrea con CAD (bajo consumo o varios canales)
+    void muestrear(uint8_t canal); // CAD de escucha en un canal
+    void programarBackoff();
+    void iniciarCAD();
+    void canalOcupado();
+    void iniciarTransmision();
+    void terminarTransmision();
+    void reposo();               // radio sin transmisión: recepción continua o muestreo
+    void dormir();               // hasta el próximo CAD de escucha
+    void escuchar();             // recepción tras detectar un preámbulo
+    void abrirVentanaControl();  // recepción implícita tras una trama con TX_ESPERA_CONTROL
+    void atenderEscucha();
 
     void setconfLoRa(int sf,long bw,int CR=1,int txpwr=2);
     /**
@@ -35,21 +207,139 @@ private:
 public:
     Red();// constructor
 
-    //parametros LoRa 
+    //parametros LoRa (tasa de recepción)
     int _sf; // Spreading Factor
     long _bw; // Ancho de banda
     int _crc; // Factor de codificación para detección de errores
     void begin(int sf=7,long bw=250E3,int CR=1,int txpwr=2);
     
     bool dataDisponible();// dato listo para extración
-    int getData(BYTE *data,int n); // Obtener datos disponibles
     /**
-     * @brief transmitir datos por lora
+     * @brief obtener la trama más antigua del anillo de recepción
+     * 
+     * @param data buffer destino
+     * @param n tamaño del buffer (se copian a lo más n bytes)
+     * @param enlace calidad de enlace e instante de la trama (opcional)
+     * @return bytes copiados, 0 si no hay datos o la trama no se pudo corregir
+     */
+    int getData(BYTE *data,int n,MetadatosEnlace *enlace=NULL);
+    int tramasPendientes(); // slots ocupados del anillo
+    EstadisticasRx estadisticasRx(); // copia de los contadores de recepción
+    /**
+     * @brief encolar datos para transmitir por lora
+     * La transmisión es asíncrona: atender() espera a que el presupuesto
+     * de aire alcance para la trama, luego un backoff aleatorio,
+     * verifica con CAD que el canal esté libre (si no, duplica la ventana
+     * y reintenta) y transmite; termina con la interrupción TX_DONE, sin
+     * bloquear el lazo principal.
      * 
-     * @param data buffer a transmitir < 256 bytes
+     * @param data buffer a transmitir < 256 bytes (menos la paridad FEC)
      * @param largo largo del buffer
      * @param rx_on activar modo recepción luego del envio
+     * @param sf spreading factor de esta trama (0 = el de recepción)
+     * @param bw ancho de banda de esta trama (0 = el de recepción)
+     * @param opciones TX_IMPLICITA (largo fijo, sin FEC) y/o TX_ESPERA_CONTROL
+     * @param canal canal de esta trama: canalDe(receptor) o CANAL_ENCUENTRO para broadcast
+     * @return false si el dato no cabe en la trama junto a la paridad, la cola está llena,
+     * la trama supera el tiempo máximo por trama configurado, una trama implícita
+     * no tiene el largo de control o el canal no existe
+     */
+    bool transmite_data(BYTE * data,BYTE largo,bool rx_on=true,int sf=0,long bw=0,uint8_t opciones=0,
+                        uint8_t canal=CANAL_ENCUENTRO);
+    /**
+     * @brief tramas de control en cabecera implícita: sin los símbolos de
+     * la cabecera, con un largo fijo que el receptor debe conocer. La
+     * radio no recibe explícitas e implícitas a la vez, así que sólo se
+     * esperan en una ventana que se abre al terminar una trama enviada
+     * con TX_ESPERA_CONTROL (la respuesta sale a la tasa de recepción).
+     * Todos los nodos de la red deben usar el mismo largo.
+     *
+     * @param largo bytes de la trama de control (0 = deshabilitadas)
+     * @param ventana_ms demora de quien responde, sin contar su acceso al
+     * canal ni el tiempo en el aire de la respuesta
+     */
+    void setControlImplicito(uint8_t largo,uint32_t ventana_ms);
+    uint32_t ventanaControlUs(); // duración total de la ventana a la tasa de recepción
+    /**
+     * @brief cambiar la tasa de recepción (SF/BW en que se escucha)
+     * Si hay una trama en CAD o en el aire se aplica al terminarla.
+     */
+    void setTasa(int sf,long bw);
+    /**
+     * @brief avanzar la máquina de transmisión, llamar en cada vuelta del lazo principal
+     */
+    void atender();
+    bool transmitiendo();        // hay una transmisión en el aire
+    uint32_t tiempoSimboloUs();  // 2^SF / BW de la tasa de recepción
+    static uint32_t tiempoSimboloUs(int sf,long bw);
+    /**
+     * @brief tiempo en el aire de un payload con la configuración de la radio
+     * (preámbulo, tasa de código, CRC, cabecera explícita)
+     *
+     * @param largo bytes del payload incluida la paridad FEC
+     * @param sf spreading factor (0 = el de recepción)
+     * @param bw ancho de banda (0 = el de recepción)
+     * @param implicita cabecera implícita
+     */
+    uint32_t tiempoAireUs(int largo,int sf=0,long bw=0,bool implicita=false);
+    /**
+     * @brief limitar la ocupación del canal (ver PresupuestoAire)
+     * Las tramas sin presupuesto esperan en la cola, no se descartan.
+     *
+     * @param pormil ciclo de trabajo en milésimas (10 = 1 %, 1000 = sin límite)
+     * @param rafaga_ms aire que se puede usar seguido
+     * @param maximo_trama_ms tiempo máximo por trama (0 = sin límite)
+     */
+    void setCicloTrabajo(uint16_t pormil,uint32_t rafaga_ms,uint32_t maximo_trama_ms=0);
+    const EstadisticasAire &estadisticasAire();
+    /**
+     * @brief escucha de bajo consumo: la radio duerme y cada intervalo
+     * hace un CAD; sólo pasa a recepción si detecta un preámbulo. Las
+     * tramas propias salen con un preámbulo que cubre el intervalo, así
+     * que todos los nodos de la red deben usar el mismo valor.
+     * Intervalos largos ahorran energía en recepción pero alargan cada
+     * trama (latencia y aire de quien transmite) en el mismo tiempo.
+     *
+     * @param intervalo_ms sueño entre muestreos (0 = recepción continua)
+     */
+    void setEscuchaBajoConsumo(uint32_t intervalo_ms);
+    /**
+     * @brief símbolos de preámbulo con que se transmite a esa tasa: el
+     * normal o, con escucha de bajo consumo, el que cubre el intervalo
+     */
+    long preambuloSimbolos(int sf=0,long bw=0);
+    /**
+     * @brief operar en varios canales: cada nodo recibe en un canal propio
+     * que se deriva de su dirección y los broadcast van por el canal de
+     * encuentro. La recepción alterna CAD en los dos canales (tras el sueño
+     * de la escucha de bajo consumo, o seguidos si está deshabilitada) y
+     * las tramas salen con un preámbulo que cubre esa vuelta; quien
+     * transmite sintoniza el canal de la trama y vuelve al propio al
+     * terminar. Todos los nodos de la red deben usar la misma cantidad.
+     *
+     * @param canales canales en uso, incluido el de encuentro (1 = un solo canal)
+     * @param direccion dirección de este nodo
+     */
+    void setCanales(uint8_t canales,uint16_t direccion);
+    uint8_t canalDe(uint16_t direccion); // canal propio de un nodo (direcciones consecutivas, canales distintos)
+    uint8_t canalPropio();
+    static long frecuenciaCanal(uint8_t canal);
+    const EstadisticasEscucha &estadisticasEscucha();
+    int tramasEnCola();          // tramas esperando (incluye la que está en el aire)
+    const EstadisticasTx &estadisticasTx();
+    /**
+     * @brief función a llamar desde las interrupciones de la radio (RX, TX_DONE, CAD_DONE)
+     * para despertar a la tarea que atiende la red; debe ser segura en ISR
+     */
+    void setAvisoEventos(void (*aviso)());
+    /**
+     * @brief configurar FEC Reed-Solomon en el payload LoRa
+     * 
+     * @param paridad bytes de paridad por trama (par, 0 deshabilita).
+     * Todos los nodos de la red deben usar el mismo valor.
      */
-    void transmite_data(BYTE * data,BYTE largo,bool rx_on=true);
+    void setFEC(int paridad);
+    int maxDato(); // largo máximo de dato por trama con la paridad actual
+    const EstadisticasFEC &estadisticasFEC(); // contadores de corrección
 };
 #endif
\ No newline at end of file
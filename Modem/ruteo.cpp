@@ -0,0 +1,138 @@
+#include "ruteo.h"
+#include <string.h>
+
+// true si la secuencia a es más nueva que b (aritmética circular de 8 bits)
+static bool secuenciaMasNueva(uint8_t a, uint8_t b) {
+    return (int8_t)(a - b) > 0;
+}
+
+Ruteo::Ruteo() : _mi_ip(0), _secuencia(0), _pos_vistos(0)
+{
+    memset(_rutas, 0, sizeof(_rutas));
+    memset(_vistos, 0, sizeof(_vistos));
+}
+
+void Ruteo::begin(uint16_t mi_ip) {
+    _mi_ip = mi_ip;
+}
+
+Ruta *Ruteo::buscarEntrada(uint16_t destino) {
+    for (int i = 0; i < MAX_RUTAS; i++) {
+        if (_rutas[i].activa && _rutas[i].destino == destino) return &_rutas[i];
+    }
+    return NULL;
+}
+
+Ruta *Ruteo::entradaLibre() {
+    Ruta *peor = NULL;
+    for (int i = 0; i < MAX_RUTAS; i++) {
+        if (!_rutas[i].activa) return &_rutas[i];
+        // tabla llena: se reemplaza una ruta rota o la de mayor métrica
+        if (peor == NULL || _rutas[i].metrica > peor->metrica) peor = &_rutas[i];
+    }
+    return peor;
+}
+
+const Ruta *Ruteo::buscar(uint16_t destino) {
+    Ruta *r = buscarEntrada(destino);
+    if (r == NULL || r->metrica >= METRICA_INFINITA) return NULL;
+    return r;
+}
+
+void Ruteo::procesarAnuncio(uint16_t vecino, const uint8_t *datos, int largo, uint32_t ahora_ms) {
+    for (int i = 0; i + TAM_ENTRADA_ANUNCIO <= largo; i += TAM_ENTRADA_ANUNCIO) {
+        uint16_t destino = (datos[i] << 8) | datos[i + 1];
+        uint8_t metrica = datos[i + 2];
+        uint8_t secuencia = datos[i + 3];
+
+        if (destino == _mi_ip) continue;
+        if (metrica < METRICA_INFINITA) metrica++;
+
+        Ruta *r = buscarEntrada(destino);
+        bool aceptar;
+        if (r == NULL) {
+            if (metrica >= METRICA_INFINITA) continue; // no aprender rutas rotas
+            aceptar = true;
+        } else if (secuenciaMasNueva(secuencia, r->secuencia)) {
+            aceptar = true;
+        } else if (secuencia == r->secuencia) {
+            // misma secuencia: sólo si mejora la métrica (evita lazos)
+            aceptar = metrica < r->metrica;
+        } else {
+            aceptar = false;
+        }
+
+        if (!aceptar) {
+            if (r != NULL && r->siguiente == vecino && r->metrica < METRICA_INFINITA) {
+                r->expira_ms = ahora_ms + VIDA_RUTA_MS; // refresco de la ruta vigente
+            }
+            continue;
+        }
+
+        if (r == NULL) r = entradaLibre();
+        r->destino = destino;
+        r->siguiente = vecino;
+        r->metrica = metrica;
+        r->secuencia = secuencia;
+        r->activa = 1;
+        r->expira_ms = ahora_ms + VIDA_RUTA_MS;
+    }
+}
+
+int Ruteo::construirAnuncio(uint8_t *salida, int max) {
+    int pos = 0;
+    _secuencia += 2;
+
+    if (pos + TAM_ENTRADA_ANUNCIO <= max) {
+        salida[pos++] = (_mi_ip >> 8) & 0xFF;
+        salida[pos++] = _mi_ip & 0xFF;
+        salida[pos++] = 0;
+        salida[pos++] = _secuencia;
+    }
+    for (int i = 0; i < MAX_RUTAS && pos + TAM_ENTRADA_ANUNCIO <= max; i++) {
+        if (!_rutas[i].activa) continue;
+        salida[pos++] = (_rutas[i].destino >> 8) & 0xFF;
+        salida[pos++] = _rutas[i].destino & 0xFF;
+        salida[pos++] = _rutas[i].metrica;
+        salida[pos++] = _rutas[i].secuencia;
+    }
+    return pos;
+}
+
+void Ruteo::expirar(uint32_t ahora_ms) {
+    for (int i = 0; i < MAX_RUTAS; i++) {
+        Ruta &r = _rutas[i];
+        if (!r.activa || (int32_t)(ahora_ms - r.expira_ms) < 0) continue;
+        if (r.metrica < METRICA_INFINITA) {
+            // se anuncia rota (secuencia impar) durante un período más
+            r.metrica = METRICA_INFINITA;
+            r.secuencia |= 1;
+            r.expira_ms = ahora_ms + INTERVALO_ANUNCIO_MS;
+        } else {
+            r.activa = 0;
+        }
+    }
+}
+
+bool Ruteo::yaVisto(uint16_t origen, uint16_t id) {
+    uint32_t clave = ((uint32_t)origen << 16) | id;
+    for (int i = 0; i < MAX_VISTOS; i++) {
+        if (_vistos[i] == clave) return true;
+    }
+    _vistos[_pos_vistos] = clave;
+    _pos_vistos = (_pos_vistos + 1) % MAX_VISTOS;
+    return false;
+}
+
+int Ruteo::cantidadRutas() {
+    int n = 0;
+    for (int i = 0; i < MAX_RUTAS; i++) {
+        if (_rutas[i].activa && _rutas[i].metrica < METRICA_INFINITA) n++;
+    }
+    return n;
+}
+
+const Ruta *Ruteo::ruta(int i) {
+    if (i < 0 || i >= MAX_RUTAS || !_rutas[i].activa) return NULL;
+    return &_rutas[i];
+}
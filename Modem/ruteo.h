@@ -0,0 +1,90 @@
+#ifndef RUTEO_H
+#define RUTEO_H
+#include <stdint.h>
+
+/*
+    Ruteo multi-salto vector-distancia con números de secuencia (DSDV simplificado).
+
+    Cada modem anuncia periódicamente por broadcast (protocolo 9) su tabla
+    como una lista de [destino 2B][métrica 1B][secuencia 1B]. La secuencia
+    la genera el propio destino: par = alcanzable, impar = ruta rota. Sólo
+    se aceptan rutas con secuencia más nueva, o igual secuencia y menor
+    métrica, lo que evita lazos persistentes.
+
+    Las tramas que viajan por más de un salto llevan la bandera FLAG_MALLA
+    y un prefijo [siguiente salto 2B][saltos restantes 1B] al inicio de los
+    datos IPv4. Sólo el siguiente salto indicado reenvía la trama.
+*/
+
+#define PROTOCOLO_RUTEO     9
+#define MAX_RUTAS           32       // entradas de la tabla (búsqueda lineal, cabe en caché)
+#define MAX_VISTOS          16       // (origen, id) recordados para descartar duplicados
+#define METRICA_INFINITA    16
+#define SALTOS_MAXIMOS      8        // límite de saltos de una trama en malla
+#define TAM_PREFIJO_MALLA   3
+#define TAM_ENTRADA_ANUNCIO 4
+#define INTERVALO_ANUNCIO_MS 30000UL // período de los anuncios de ruteo
+#define VIDA_RUTA_MS (3 * INTERVALO_ANUNCIO_MS)
+
+struct Ruta {
+    uint16_t destino;
+    uint16_t siguiente;   // vecino por el que se llega al destino
+    uint8_t metrica;      // saltos
+    uint8_t secuencia;    // secuencia del destino con la que se aprendió
+    uint8_t activa;
+    uint32_t expira_ms;
+};
+
+class Ruteo
+{
+private:
+    uint16_t _mi_ip;
+    uint8_t _secuencia;           // secuencia propia (par)
+    Ruta _rutas[MAX_RUTAS];
+    uint32_t _vistos[MAX_VISTOS]; // (origen << 16 | id) recientes, anillo
+    uint8_t _pos_vistos;
+
+    Ruta *buscarEntrada(uint16_t destino);
+    Ruta *entradaLibre();
+public:
+    Ruteo();
+
+    void begin(uint16_t mi_ip);
+    /**
+     * @brief buscar la ruta vigente hacia un destino
+     *
+     * @return ruta con métrica finita o NULL si no hay
+     */
+    const Ruta *buscar(uint16_t destino);
+    /**
+     * @brief incorporar un anuncio de ruteo recibido de un vecino
+     *
+     * @param vecino IP del modem que envió el anuncio
+     * @param datos lista de entradas del anuncio
+     * @param largo largo de la lista en bytes
+     * @param ahora_ms tiempo actual en milisegundos
+     */
+    void procesarAnuncio(uint16_t vecino, const uint8_t *datos, int largo, uint32_t ahora_ms);
+    /**
+     * @brief construir el anuncio propio (incluye la entrada del nodo con métrica 0)
+     *
+     * @param salida buffer del anuncio
+     * @param max tamaño del buffer
+     * @return bytes escritos
+     */
+    int construirAnuncio(uint8_t *salida, int max);
+    /**
+     * @brief invalidar rutas vencidas y liberar las ya anunciadas como rotas
+     */
+    void expirar(uint32_t ahora_ms);
+    /**
+     * @brief registrar (origen, id) y detectar si ya se había visto
+     *
+     * @return true si la trama ya pasó por este nodo (duplicado o lazo)
+     */
+    bool yaVisto(uint16_t origen, uint16_t id);
+    int cantidadRutas();
+    const Ruta *ruta(int i); // acceso a la tabla para mostrar/telemetría
+};
+
+#endif
@@ -0,0 +1,246 @@
+/*
+    Verificación en Linux de la tasa de datos adaptativa (adr.h) sobre un
+    canal simulado.
+
+    1) Red.cpp con la radio simulada: una trama con tasa propia se
+       transmite en esa tasa y la radio vuelve a la de recepción.
+    2) Malla de nodos al azar con pérdida por distancia y desvanecimiento
+       log-normal: una trama sólo llega si el receptor escucha en la tasa
+       en que se transmitió y el SNR supera el mínimo del SF. Se compara
+       ADR contra todos en la tasa más rápida y todos en la más lenta.
+
+    Uso: make bin/adr_canal && ./bin/adr_canal
+*/
+#include "adr.h"
+#include "red.h"
+#include "lora_stub.h"
+#include <math.h>
+#include <vector>
+#include "verificar.h"
+
+#define NODOS 10
+#define CORRIDAS 20
+#define DURACION_S 900
+#define CALENTAMIENTO_S 200
+#define LARGO_DATOS 60
+#define SIGMA_DB 2.0
+
+static void pruebaRed() {
+    Red red;
+    red.begin(7, 250E3, 1, 2);
+    uint8_t trama[30] = {0};
+    int sf;
+    long bw;
+
+    VERIFICAR(red.transmite_data(trama, sizeof(trama), true, 10, 250E3));
+    for (int i = 0; i < 1000 && !simTransmitiendo(); i++) {
+        red.atender();
+        simAvanzarUs(100);
+    }
+    simTasaUltimaTx(&sf, &bw);
+    VERIFICAR(sf == 10 && bw == 250000);
+
+    // cambio de tasa de recepción con la trama en el aire: se aplica al terminar
+    red.setTasa(9, 125E3);
+    simTasa(&sf, &bw);
+    VERIFICAR(sf == 10);
+    simTerminarTransmision();
+    red.atender();
+    simTasa(&sf, &bw);
+    VERIFICAR(sf == 9 && bw == 125000);
+    VERIFICAR(red.estadisticasTx().cambios_tasa == 1);
+
+    // sin tasa propia sale en la de recepción
+    red.transmite_data(trama, sizeof(trama));
+    for (int i = 0; i < 1000 && !simTransmitiendo(); i++) {
+        red.atender();
+        simAvanzarUs(100);
+    }
+    simTasaUltimaTx(&sf, &bw);
+    VERIFICAR(sf == 9 && bw == 125000);
+    simTerminarTransmision();
+    red.atender();
+    VERIFICAR(red.estadisticasTx().cambios_tasa == 1);
+}
+
+// Tiempo en el aire en ms con la configuración de red.cpp (CR 4/5, CRC)
+static double tiempoAireMs(uint8_t escalon, int largo) {
+    const TasaLoRa &t = Adr::tasa(escalon);
+    return aire::tiempoAireUs(largo, t.sf, t.bw, 1, PREAMBLE_LENGTH) / 1000.0;
+}
+
+static double gauss() {
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0), v = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+struct Resultado {
+    double entrega;
+    double aire_ms; // por trama de datos entregada
+};
+
+enum Esquema { FIJA_RAPIDA, FIJA_LENTA, CON_ADR };
+
+/*
+    snr[i][j]: SNR medio a 125 kHz de i hacia j (dB). Cada segundo cada
+    nodo envía datos a un vecino al azar; los anuncios ADR salen cada
+    INTERVALO_ADR_MS en todas las tasas de sus vecinos.
+*/
+static Resultado simular(const double snr[NODOS][NODOS], const std::vector<int> vecinos[NODOS], Esquema esquema) {
+    Adr adr[NODOS];
+    uint32_t proximo_anuncio[NODOS];
+    for (int i = 0; i < NODOS; i++) {
+        adr[i].begin(rand() % 5000);   // arranques desfasados
+        proximo_anuncio[i] = rand() % INTERVALO_ADR_MS;
+    }
+    long enviadas = 0, entregadas = 0;
+    double aire = 0;
+
+    // entrega de una trama de i en escalón e; si llega, j mide el SNR
+    struct Canal {
+        static bool entregar(Adr *adr, const double snr[NODOS][NODOS], Esquema esquema, int i, int j,
+                             uint8_t e, uint32_t ahora) {
+            uint8_t rx = esquema == CON_ADR ? adr[j].escalonRecepcion() : e;
+            if (rx != e) return false;
+            const TasaLoRa &t = Adr::tasa(e);
+            double medido = snr[i][j] - 10 * log10(t.bw / 125000.0) + SIGMA_DB * gauss();
+            if (medido * 4 < Adr::snrMinimo(e)) return false;
+            if (esquema == CON_ADR) {
+                int cuartos = (int)lround(medido * 4);
+                if (cuartos > 127) cuartos = 127;
+                if (cuartos < -128) cuartos = -128;
+                adr[j].registrarSnr(i, (int8_t)cuartos, ahora);
+            }
+            return true;
+        }
+    };
+
+    for (uint32_t ms = 0; ms < DURACION_S * 1000UL; ms += 100) {
+        for (int i = 0; i < NODOS; i++) {
+            if (vecinos[i].empty()) continue;
+            if (esquema == CON_ADR) {
+                // al cambiar de tasa se anuncia de inmediato, como en el firmware
+                if (adr[i].actualizar(ms)) proximo_anuncio[i] = ms;
+                if ((int32_t)(ms - proximo_anuncio[i]) >= 0) {
+                    proximo_anuncio[i] = ms + INTERVALO_ADR_MS;
+                    uint8_t anuncio[TAM_ANUNCIO_ADR];
+                    adr[i].construirAnuncio(anuncio);
+                    uint8_t escalones[ESCALONES_ADR];
+                    int n = adr[i].escalonesBroadcast(escalones, true);
+                    for (int k = 0; k < n; k++) {
+                        for (size_t v = 0; v < vecinos[i].size(); v++) {
+                            int j = vecinos[i][v];
+                            if (Canal::entregar(adr, snr, esquema, i, j, escalones[k], ms))
+                                adr[j].procesarAnuncio(i, anuncio, sizeof(anuncio), ms);
+                        }
+                    }
+                }
+            }
+            // un mensaje de datos por segundo y nodo, desfasados
+            if ((ms / 100) % 10 != (uint32_t)i % 10) continue;
+            int j = vecinos[i][rand() % vecinos[i].size()];
+            uint8_t e = esquema == FIJA_RAPIDA ? 0 : esquema == FIJA_LENTA ? ESCALONES_ADR - 1 : adr[i].escalonHacia(j);
+            bool ok = Canal::entregar(adr, snr, esquema, i, j, e, ms);
+            if (ms >= CALENTAMIENTO_S * 1000UL) {
+                enviadas++;
+                aire += tiempoAireMs(e, LARGO_DATOS);
+                if (ok) entregadas++;
+            }
+        }
+    }
+    Resultado r;
+    r.entrega = enviadas ? (double)entregadas / enviadas : 0;
+    r.aire_ms = entregadas ? aire / entregadas : 0;
+    return r;
+}
+
+// Promedio de CORRIDAS mallas al azar en un cuadrado de lado_m metros
+static void escenario(double lado_m, double entrega[3], double aire[3]) {
+    for (int e = 0; e < 3; e++) entrega[e] = aire[e] = 0;
+    for (int c = 0; c < CORRIDAS; c++) {
+        double x[NODOS], y[NODOS];
+        for (int i = 0; i < NODOS; i++) {
+            x[i] = rand() / (double)RAND_MAX * lado_m;
+            y[i] = rand() / (double)RAND_MAX * lado_m;
+        }
+        // pérdida log-distancia: +10 dB a 300 m, exponente 3
+        double snr[NODOS][NODOS];
+        std::vector<int> vecinos[NODOS];
+        for (int i = 0; i < NODOS; i++) {
+            for (int j = 0; j < NODOS; j++) {
+                if (i == j) continue;
+                double d = hypot(x[i] - x[j], y[i] - y[j]);
+                if (d < 10) d = 10;
+                snr[i][j] = 10 - 30 * log10(d / 300.0);
+                // vecino si el enlace cierra en la tasa más lenta con 3 dB de margen
+                if (snr[i][j] - 10 * log10(Adr::tasa(ESCALONES_ADR - 1).bw / 125000.0) >=
+                    Adr::snrMinimo(ESCALONES_ADR - 1) / 4.0 + 3)
+                    vecinos[i].push_back(j);
+            }
+        }
+        for (int e = 0; e < 3; e++) {
+            Resultado r = simular(snr, vecinos, (Esquema)e);
+            entrega[e] += r.entrega / CORRIDAS;
+            aire[e] += r.aire_ms / CORRIDAS;
+        }
+    }
+
+    const char *nombres[3] = {"fija SF7/250", "fija SF12/125", "ADR"};
+    printf("\n%d nodos en %.0f m x %.0f m, %d corridas\n", NODOS, lado_m, lado_m, CORRIDAS);
+    printf("%-16s %8s %18s\n", "esquema", "entrega", "aire/entregada ms");
+    for (int e = 0; e < 3; e++) printf("%-16s %7.1f%% %18.1f\n", nombres[e], 100 * entrega[e], aire[e]);
+}
+
+int main() {
+    srand(11);
+    pruebaRed();
+
+    // Tabla de tasas y umbrales
+    for (uint8_t e = 0; e < ESCALONES_ADR; e++) {
+        const TasaLoRa &t = Adr::tasa(e);
+        printf("escalón %u: SF%u/%ld kHz, SNR mínimo %.1f dB, %.1f ms para %d bytes\n", e, t.sf, t.bw / 1000,
+               Adr::snrMinimo(e) / 4.0, tiempoAireMs(e, LARGO_DATOS), LARGO_DATOS);
+    }
+
+    // Anuncio: ida y vuelta y rechazo de basura
+    {
+        Adr a, b;
+        a.begin(0);
+        b.begin(0);
+        uint8_t anuncio[TAM_ANUNCIO_ADR];
+        VERIFICAR(a.construirAnuncio(anuncio) == TAM_ANUNCIO_ADR);
+        VERIFICAR(b.procesarAnuncio(1, anuncio, sizeof(anuncio), 0));
+        VERIFICAR(b.escalonHacia(1) == ESCALON_BASE_ADR);
+        anuncio[2] ^= 1;
+        VERIFICAR(!b.procesarAnuncio(1, anuncio, sizeof(anuncio), 0));
+        // arranca en la base; tras la ventana inicial un vecino cercano la acelera
+        uint32_t t = VENTANA_REDESCUBRIR_MS;
+        for (int k = 0; k < 10; k++) b.registrarSnr(2, 40, t);
+        VERIFICAR(!b.actualizar(t - 1) && b.escalonRecepcion() == ESCALON_BASE_ADR);
+        VERIFICAR(b.actualizar(t) && b.escalonRecepcion() == 0);
+        // un vecino lejano la frena (se mide en SF7/250: +3 dB a 125 kHz)
+        for (int k = 0; k < 10; k++) b.registrarSnr(3, -60, t);
+        VERIFICAR(b.actualizar(t + 1) && b.escalonRecepcion() == 5);
+        // al expirar el vecino lejano vuelve a la tasa del cercano
+        b.registrarSnr(2, 40, t + VIDA_VECINO_ADR_MS);
+        VERIFICAR(b.actualizar(t + VIDA_VECINO_ADR_MS + 1) && b.escalonRecepcion() == 0);
+        // redescubrimiento periódico: vuelve a la base durante la ventana
+        VERIFICAR(b.actualizar(REDESCUBRIR_ADR_MS) && b.escalonRecepcion() == ESCALON_BASE_ADR);
+        VERIFICAR(b.escalonHacia(99) == ESCALON_BASE_ADR);
+    }
+
+    // ADR entrega como la tasa más lenta; cuánto aire ahorra depende de
+    // qué tan lejos está el peor vecino de cada nodo
+    double entrega[3], aire[3];
+    escenario(1500, entrega, aire);
+    VERIFICAR(entrega[CON_ADR] > 0.95 * entrega[FIJA_LENTA]);
+    VERIFICAR(aire[CON_ADR] < 0.7 * aire[FIJA_LENTA]);
+    escenario(3000, entrega, aire);
+    VERIFICAR(entrega[CON_ADR] > 0.95 * entrega[FIJA_LENTA]);
+    VERIFICAR(entrega[CON_ADR] > entrega[FIJA_RAPIDA]);
+    escenario(6000, entrega, aire);
+    VERIFICAR(entrega[CON_ADR] > 0.95 * entrega[FIJA_LENTA]);
+    VERIFICAR(aire[CON_ADR] < aire[FIJA_LENTA]);
+
+    return terminar();
+}
@@ -0,0 +1,134 @@
+/*
+    Verificación en Linux de las tramas de control en cabecera implícita
+    (control.h y Red::setControlImplicito) con la radio simulada. Compara
+    el tiempo en el aire del ACK del Nodo como trama IPv4 explícita (con y
+    sin paridad FEC) contra la trama de control implícita de largo fijo, y
+    ejercita la ventana de recepción implícita que abre el emisor de un
+    unicast hasta que llega la respuesta o vence.
+
+    Uso: make bin/control_implicito && ./bin/control_implicito
+*/
+#include "red.h"
+#include "control.h"
+#include "lora_stub.h"
+#include "verificar.h"
+
+#define LARGO_ACK_IPV4 13     // cabecera IPv4 de 11 bytes + identificador confirmado
+#define PARIDAD 8
+#define PASO_US 100
+
+// Avanza el reloj llamando a atender() hasta que salga una trama y la termina
+static bool transmitir(Red &red) {
+    int previas = simTransmitidas();
+    unsigned long inicio = micros();
+    while (simTransmitidas() == previas && micros() - inicio < 2000000UL) {
+        red.atender();
+        simAvanzarUs(PASO_US);
+    }
+    if (simTransmitidas() == previas) return false;
+    simTerminarTransmision();
+    red.atender();
+    return true;
+}
+
+static void correr(Red &red, unsigned long duracion_us) {
+    unsigned long fin = micros() + duracion_us;
+    while ((long)(fin - micros()) > 0) {
+        red.atender();
+        simAvanzarUs(PASO_US);
+    }
+}
+
+int main() {
+    Red red;
+    red.begin(7, 125E3, 1, 2);
+
+    // Tiempo en el aire del ACK: IPv4 explícita contra control implícita
+    red.setControlImplicito(TAM_TRAMA_CONTROL, 250);
+    static const int tasas[][2] = {{7, 125}, {8, 125}, {9, 125}, {10, 125}, {11, 125}, {12, 125}, {7, 250}};
+    printf("tasa         ACK %d B  +FEC %d B  control %d B  ahorro / con FEC\n", LARGO_ACK_IPV4,
+           LARGO_ACK_IPV4 + PARIDAD, TAM_TRAMA_CONTROL);
+    for (unsigned i = 0; i < sizeof(tasas) / sizeof(tasas[0]); i++) {
+        int sf = tasas[i][0];
+        long bw = tasas[i][1] * 1000L;
+        uint32_t explicita = red.tiempoAireUs(LARGO_ACK_IPV4, sf, bw);
+        uint32_t con_fec = red.tiempoAireUs(LARGO_ACK_IPV4 + PARIDAD, sf, bw);
+        uint32_t implicita = red.tiempoAireUs(TAM_TRAMA_CONTROL, sf, bw, true);
+        printf("SF%-2d/%3ld kHz %7.1f ms %8.1f ms %9.1f ms   %4.1f%% / %4.1f%%\n", sf, bw / 1000,
+               explicita / 1000.0, con_fec / 1000.0, implicita / 1000.0, 100.0 * (explicita - implicita) / explicita,
+               100.0 * (con_fec - implicita) / con_fec);
+        VERIFICAR(implicita < explicita && explicita < con_fec);
+        VERIFICAR(implicita == aire::tiempoAireUs(TAM_TRAMA_CONTROL, sf, bw, 1, PREAMBLE_LENGTH, true, true));
+    }
+
+    // La trama de control ida y vuelta
+    TramaControl ack = {CONTROL_ACK, 0x0102, 0x0304, 0x0506, 0x0708};
+    TramaControl leida;
+    uint8_t control[TAM_TRAMA_CONTROL];
+    VERIFICAR(escribirControl(&ack, control) == TAM_TRAMA_CONTROL);
+    VERIFICAR(leerControl(control, TAM_TRAMA_CONTROL, &leida));
+    VERIFICAR(leida.origen == 0x0102 && leida.destino == 0x0304 && leida.identificador == 0x0506 &&
+              leida.dato == 0x0708);
+    VERIFICAR(!leerControl(control, TAM_TRAMA_CONTROL - 1, &leida));
+    control[0] = 0;
+    VERIFICAR(!leerControl(control, TAM_TRAMA_CONTROL, &leida));
+    escribirControl(&ack, control);
+
+    // Transmisión implícita: largo fijo, sin paridad FEC aunque esté habilitada
+    red.setFEC(PARIDAD);
+    uint32_t codificadas = red.estadisticasFEC().tramas_codificadas;
+    VERIFICAR(!red.transmite_data(control, TAM_TRAMA_CONTROL + 1, true, 0, 0, TX_IMPLICITA));
+    VERIFICAR(red.transmite_data(control, TAM_TRAMA_CONTROL, true, 0, 0, TX_IMPLICITA));
+    VERIFICAR(transmitir(red));
+    VERIFICAR(simImplicitaUltimaTx() && red.estadisticasTx().implicitas == 1);
+    VERIFICAR(red.estadisticasFEC().tramas_codificadas == codificadas);
+    VERIFICAR(simLargoImplicito() == 0 && simModo() == SIM_RX);
+    Red sin_control;
+    VERIFICAR(!sin_control.transmite_data(control, TAM_TRAMA_CONTROL, true, 0, 0, TX_IMPLICITA));
+
+    // Unicast con TX_ESPERA_CONTROL: al terminar escucha en implícita hasta la respuesta
+    uint8_t dato[32] = {0x45};
+    VERIFICAR(red.transmite_data(dato, sizeof(dato), true, 0, 0, TX_ESPERA_CONTROL));
+    VERIFICAR(transmitir(red));
+    VERIFICAR(!simImplicitaUltimaTx());
+    VERIFICAR(simLargoImplicito() == TAM_TRAMA_CONTROL && simModo() == SIM_RX);
+    correr(red, 100000);
+    simRecibir(control, TAM_TRAMA_CONTROL, -90, 24);
+    red.atender();
+    VERIFICAR(simLargoImplicito() == 0);
+    BYTE buffer[TAM_DATOS_LORA];
+    MetadatosEnlace enlace;
+    VERIFICAR(red.getData(buffer, sizeof(buffer), &enlace) == TAM_TRAMA_CONTROL);
+    VERIFICAR(enlace.implicita && leerControl(buffer, TAM_TRAMA_CONTROL, &leida) && leida.dato == 0x0708);
+    const EstadisticasEscucha &est = red.estadisticasEscucha();
+    VERIFICAR(est.ventanas_control == 1 && est.controles == 1);
+
+    // Después de la ventana vuelven las tramas explícitas
+    red.setFEC(0);
+    simRecibir(dato, sizeof(dato), -90, 24);
+    VERIFICAR(red.getData(buffer, sizeof(buffer), &enlace) == sizeof(dato) && !enlace.implicita);
+
+    // Sin respuesta la ventana vence y la radio vuelve a la cabecera explícita
+    VERIFICAR(red.transmite_data(dato, sizeof(dato), true, 0, 0, TX_ESPERA_CONTROL));
+    VERIFICAR(transmitir(red));
+    VERIFICAR(simLargoImplicito() == TAM_TRAMA_CONTROL);
+    unsigned long abierta = micros();
+    while (simLargoImplicito() != 0 && micros() - abierta < 2000000UL) correr(red, 1000);
+    unsigned long duracion = micros() - abierta;
+    printf("ventana de control: %.1f ms (configurada 250 ms + acceso y aire de la respuesta %.1f ms)\n",
+           duracion / 1000.0, red.ventanaControlUs() / 1000.0);
+    VERIFICAR(duracion >= red.ventanaControlUs() && duracion <= red.ventanaControlUs() + 2000);
+    VERIFICAR(est.ventanas_control == 2 && est.controles == 1);
+
+    // Una trama en cola espera a que cierre la ventana
+    VERIFICAR(red.transmite_data(dato, sizeof(dato), true, 0, 0, TX_ESPERA_CONTROL));
+    VERIFICAR(transmitir(red));
+    int previas = simTransmitidas();
+    red.transmite_data(dato, sizeof(dato));
+    correr(red, red.ventanaControlUs() / 2);
+    VERIFICAR(simTransmitidas() == previas);
+    correr(red, red.ventanaControlUs());
+    VERIFICAR(simTransmitidas() == previas + 1);
+
+    return terminar();
+}
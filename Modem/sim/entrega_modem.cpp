@@ -0,0 +1,138 @@
+/*
+    Verificación en Linux de la entrega en el modem (entrega.h): el modem
+    de origen guarda cada unicast marcado, lo retransmite con espera
+    duplicada hasta el ACK del modem de destino y avisa al Nodo una vez
+    por trama; el de destino confirma cada copia y entrega sólo la
+    primera. Se corre sobre un enlace con pérdida independiente de la
+    trama y del ACK y se compara con el ACK del Nodo, que no retransmite.
+
+    Uso: make bin/entrega_modem && ./bin/entrega_modem
+*/
+#include "entrega.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "verificar.h"
+
+#define ORIGEN  0x1
+#define DESTINO 0x2
+#define ESPERA_MS 1000
+#define TRAMAS 2000
+
+static double aleatorio() {
+    return rand() / (RAND_MAX + 1.0);
+}
+
+static void pruebaBasica() {
+    Entregas origen, destino;
+    uint8_t trama[40], salida[MAX_TRAMA_ENTREGA];
+    AvisoEntrega aviso;
+    for (int i = 0; i < 40; i++) trama[i] = i;
+
+    // Confirmada al primer intento
+    VERIFICAR(origen.registrar(DESTINO, 1, trama, sizeof(trama), 0, ESPERA_MS));
+    VERIFICAR(origen.pendientes() == 1);
+    VERIFICAR(!origen.confirmar(DESTINO, 2, &aviso) && !origen.confirmar(0x3, 1, &aviso));
+    VERIFICAR(origen.confirmar(DESTINO, 1, &aviso));
+    VERIFICAR(aviso.estado == ENTREGA_CONFIRMADA && aviso.intentos == 1 && aviso.identificador == 1);
+    VERIFICAR(!origen.confirmar(DESTINO, 1, &aviso) && origen.pendientes() == 0);
+
+    // Reintentos con espera duplicada y fallo al agotar los intentos
+    origen.registrar(DESTINO, 2, trama, sizeof(trama), 0, ESPERA_MS);
+    VERIFICAR(origen.reintento(ESPERA_MS - 1, salida) == 0);
+    VERIFICAR(origen.reintento(ESPERA_MS, salida) == (int)sizeof(trama) && memcmp(salida, trama, sizeof(trama)) == 0);
+    uint32_t t = ESPERA_MS, espera = ESPERA_MS;
+    for (int i = 2; i < INTENTOS_ENTREGA; i++) {
+        espera *= 2;
+        VERIFICAR(origen.reintento(t + espera - 1, salida) == 0);
+        t += espera;
+        VERIFICAR(origen.reintento(t, salida) > 0);
+    }
+    espera *= 2;
+    VERIFICAR(origen.reintento(t + 10 * espera, salida) == 0); // sin más intentos
+    VERIFICAR(!origen.fallida(t + espera - 1, &aviso));
+    VERIFICAR(origen.fallida(t + espera, &aviso));
+    VERIFICAR(aviso.estado == ENTREGA_FALLIDA && aviso.intentos == INTENTOS_ENTREGA && aviso.identificador == 2);
+    VERIFICAR(origen.pendientes() == 0 && origen.estadisticas().reintentos == INTENTOS_ENTREGA - 1);
+
+    // Sin lugar la trama sale sin reintentos
+    for (int i = 0; i < MAX_ENTREGAS_PENDIENTES; i++) VERIFICAR(origen.registrar(DESTINO, 10 + i, trama, 40, 0, 100));
+    VERIFICAR(!origen.registrar(DESTINO, 20, trama, 40, 0, 100) && origen.estadisticas().sin_espacio == 1);
+
+    // Destino: la primera copia se entrega, las retransmisiones no
+    VERIFICAR(destino.recibida(ORIGEN, 7));
+    VERIFICAR(!destino.recibida(ORIGEN, 7) && destino.estadisticas().duplicadas == 1);
+    VERIFICAR(destino.recibida(0x3, 7) && destino.recibida(ORIGEN, 8));
+}
+
+struct Resultado {
+    int entregadas;      // tramas que llegaron al Nodo destino
+    int duplicadas;      // copias repetidas que llegaron al Nodo destino
+    int confirmadas;     // avisos (o ACK) de éxito en el Nodo origen
+    int transmisiones;
+};
+
+// Entrega en el modem sobre un enlace con pérdida: cada intento puede perder la trama o el ACK
+static Resultado conModem(double perdida) {
+    Entregas origen, destino;
+    Resultado r = {0, 0, 0, 0};
+    uint8_t trama[32] = {0x45}, salida[MAX_TRAMA_ENTREGA];
+    AvisoEntrega aviso;
+    uint32_t ahora = 0;
+    for (int id = 1; id <= TRAMAS; id++) {
+        origen.registrar(DESTINO, id, trama, sizeof(trama), ahora, ESPERA_MS);
+        bool terminada = false;
+        for (bool transmitir = true; !terminada; ahora += 10) {
+            if (transmitir || origen.reintento(ahora, salida) > 0) {
+                transmitir = false;
+                r.transmisiones++;
+                if (aleatorio() >= perdida) {
+                    if (destino.recibida(ORIGEN, id)) r.entregadas++;
+                    else r.duplicadas++;
+                    if (aleatorio() >= perdida && origen.confirmar(DESTINO, id, &aviso)) {
+                        r.confirmadas++;
+                        terminada = true;
+                    }
+                }
+            }
+            if (origen.fallida(ahora, &aviso)) terminada = true;
+        }
+    }
+    VERIFICAR(origen.estadisticas().confirmadas + origen.estadisticas().fallidas == TRAMAS);
+    return r;
+}
+
+// ACK del Nodo: una sola transmisión, el reintento del Nodo no reenvía la trama
+static Resultado conNodo(double perdida) {
+    Resultado r = {0, 0, 0, 0};
+    for (int id = 1; id <= TRAMAS; id++) {
+        r.transmisiones++;
+        if (aleatorio() < perdida) continue;
+        r.entregadas++;
+        if (aleatorio() >= perdida) r.confirmadas++;
+    }
+    return r;
+}
+
+int main() {
+    pruebaBasica();
+
+    srand(47);
+    static const double perdidas[] = {0.0, 0.1, 0.2, 0.3};
+    printf("pérdida   ACK del Nodo: entrega confirm.   en el modem: entrega confirm. dupl.  tx/trama\n");
+    for (unsigned i = 0; i < sizeof(perdidas) / sizeof(perdidas[0]); i++) {
+        double p = perdidas[i];
+        Resultado nodo = conNodo(p);
+        Resultado modem = conModem(p);
+        printf("%5.0f%%   %19.1f%% %7.1f%%   %18.1f%% %7.1f%% %5d  %8.2f\n", 100 * p, 100.0 * nodo.entregadas / TRAMAS,
+               100.0 * nodo.confirmadas / TRAMAS, 100.0 * modem.entregadas / TRAMAS,
+               100.0 * modem.confirmadas / TRAMAS, modem.duplicadas, (double)modem.transmisiones / TRAMAS);
+        VERIFICAR(modem.entregadas >= nodo.entregadas && modem.confirmadas >= nodo.confirmadas);
+        // con pérdida p por intento la trama no llega con probabilidad p^INTENTOS
+        double esperado = 1 - p * p * p * p;
+        VERIFICAR(modem.entregadas >= (esperado - 0.01) * TRAMAS);
+        if (p == 0) VERIFICAR(modem.transmisiones == TRAMAS && modem.duplicadas == 0);
+    }
+
+    return terminar();
+}
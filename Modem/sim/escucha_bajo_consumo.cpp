@@ -0,0 +1,188 @@
+/*
+    Verificación en Linux de la escucha de bajo consumo de red.cpp con la
+    radio simulada y su modelo de energía: la radio duerme, muestrea el
+    canal con CAD cada intervalo y sólo recibe cuando detecta un preámbulo.
+    Llegan tramas de un vecino con el mismo intervalo (preámbulo largo) en
+    instantes aleatorios y se mide, para cada intervalo, la corriente media
+    de la radio y la latencia de la trama contra la recepción continua.
+
+    Uso: make bin/escucha_bajo_consumo && ./bin/escucha_bajo_consumo
+*/
+#include "red.h"
+#include "lora_stub.h"
+#include "verificar.h"
+
+#define PASO_US 200
+#define LARGO 32
+#define BATERIA_MAH 2000
+
+struct Banco {
+    Red &red;
+    unsigned long llegada;    // micros() en que empezó la trama entrante
+    unsigned long fin_aire;   // fin de la trama propia en el aire
+    int entregadas, perdidas;
+    double latencia_ms, latencia_maxima_ms;
+
+    Banco(Red &r) : red(r), llegada(0), fin_aire(0), entregadas(0), perdidas(0), latencia_ms(0),
+        latencia_maxima_ms(0) {}
+
+    // Trama de un vecino: preámbulo con la configuración de esta red (o el normal)
+    void entrante(bool preambulo_largo) {
+        static uint8_t dato[LARGO] = {0x45};
+        uint32_t simbolo = red.tiempoSimboloUs();
+        long preambulo = preambulo_largo ? red.preambuloSimbolos() : PREAMBLE_LENGTH;
+        unsigned long preambulo_us = (unsigned long)(preambulo * simbolo + 4.25 * simbolo);
+        unsigned long aire_us = aire::tiempoAireUs(LARGO, 7, 125000, 1, preambulo);
+        llegada = micros();
+        simTramaEntrante(dato, LARGO, preambulo_us, aire_us, -80, 20);
+    }
+
+    void correr(unsigned long duracion_us) {
+        unsigned long fin = micros() + duracion_us;
+        BYTE buffer[TAM_DATOS_LORA];
+        int previas = simTransmitidas();
+        while ((long)(fin - micros()) > 0) {
+            red.atender();
+            if (simTransmitidas() != previas) {
+                previas = simTransmitidas();
+                fin_aire = micros() + red.tiempoAireUs(LARGO);
+            }
+            if (simTransmitiendo() && (long)(micros() - fin_aire) >= 0) {
+                simTerminarTransmision();
+                red.atender();
+            }
+            int r = simAtenderRadio();
+            if (r > 0) {
+                double ms = (micros() - llegada) / 1000.0;
+                entregadas++;
+                latencia_ms += ms;
+                if (ms > latencia_maxima_ms) latencia_maxima_ms = ms;
+            }
+            else if (r < 0) perdidas++;
+            while (red.dataDisponible()) red.getData(buffer, sizeof(buffer));
+            simAvanzarUs(PASO_US);
+        }
+    }
+};
+
+static double corrienteMedia() {
+    EnergiaSim e;
+    simEnergia(&e);
+    double carga = 0, tiempo = 0;
+    for (int m = 0; m < SIM_MODOS; m++) {
+        carga += e.carga_mas[m];
+        tiempo += e.tiempo_s[m];
+    }
+    return carga / tiempo;
+}
+
+struct Resultado {
+    double corriente_ma, latencia_ms, latencia_maxima_ms;
+    int enviadas, entregadas, perdidas;
+};
+
+// Una trama cada ~30 s durante 10 minutos, en fases aleatorias respecto del muestreo
+static Resultado medir(Red &red, uint32_t intervalo_ms) {
+    red.setEscuchaBajoConsumo(intervalo_ms);
+    Banco banco(red);
+    simReiniciarEnergia();
+    Resultado r = {};
+    for (int i = 0; i < 20; i++) {
+        banco.entrante(true);
+        r.enviadas++;
+        banco.correr(20000000UL + (unsigned long)random(20000000));
+    }
+    r.corriente_ma = corrienteMedia();
+    r.entregadas = banco.entregadas;
+    r.perdidas = banco.perdidas;
+    r.latencia_ms = banco.entregadas ? banco.latencia_ms / banco.entregadas : 0;
+    r.latencia_maxima_ms = banco.latencia_maxima_ms;
+    return r;
+}
+
+int main() {
+    Red red;
+    red.begin(7, 125E3, 1, 2);
+    randomSeed(43);
+
+    // Recepción continua: sin cambios en el preámbulo ni en el tiempo en el aire
+    VERIFICAR(red.preambuloSimbolos() == PREAMBLE_LENGTH);
+    VERIFICAR(red.tiempoAireUs(LARGO) == aire::tiempoAireUs(LARGO, 7, 125000, 1, PREAMBLE_LENGTH));
+    VERIFICAR(simModo() == SIM_RX);
+
+    // Compromiso energía / latencia para cada intervalo
+    static const uint32_t intervalos[] = {0, 50, 100, 250, 500, 1000, 2000};
+    const int N = sizeof(intervalos) / sizeof(intervalos[0]);
+    Resultado res[N];
+    printf("intervalo  preámbulo  corriente   autonomía  latencia media/máx  aire de %d B\n", LARGO);
+    for (int i = 0; i < N; i++) {
+        res[i] = medir(red, intervalos[i]);
+        printf("%6u ms  %5ld sím  %7.3f mA  %6.0f días  %7.1f / %7.1f ms  %8.1f ms\n", (unsigned)intervalos[i],
+               red.preambuloSimbolos(), res[i].corriente_ma, BATERIA_MAH / res[i].corriente_ma / 24,
+               res[i].latencia_ms, res[i].latencia_maxima_ms, red.tiempoAireUs(LARGO) / 1000.0);
+        VERIFICAR(res[i].entregadas == res[i].enviadas && res[i].perdidas == 0);
+        // la latencia es el aire de la trama: crece con el preámbulo que cubre el intervalo
+        VERIFICAR(res[i].latencia_maxima_ms <= red.tiempoAireUs(LARGO) / 1000.0 + 1);
+        if (i > 0) {
+            VERIFICAR(res[i].corriente_ma < res[0].corriente_ma / 10);
+            VERIFICAR(res[i].latencia_ms > res[i - 1].latencia_ms);
+        }
+    }
+    VERIFICAR(res[0].corriente_ma > 0.99 * CORRIENTE_RX_MA);
+    const EstadisticasEscucha &est = red.estadisticasEscucha();
+    printf("escucha: %u muestreos, %u detecciones, %u recepciones, %u sin trama\n", (unsigned)est.muestreos,
+           (unsigned)est.detecciones, (unsigned)est.recepciones, (unsigned)est.sin_trama);
+    VERIFICAR(est.detecciones == est.recepciones && est.sin_trama == 0);
+
+    // Transmisión con escucha de bajo consumo: preámbulo largo y vuelta a dormir
+    red.setEscuchaBajoConsumo(500);
+    Banco banco(red);
+    uint8_t dato[LARGO] = {0};
+    long preambulo = red.preambuloSimbolos();
+    VERIFICAR(preambulo * red.tiempoSimboloUs() > 500000);
+    VERIFICAR(red.tiempoAireUs(LARGO) == aire::tiempoAireUs(LARGO, 7, 125000, 1, preambulo));
+    int previas = simTransmitidas();
+    red.transmite_data(dato, LARGO);
+    banco.correr(2000000);
+    VERIFICAR(simTransmitidas() == previas + 1 && simPreambuloUltimaTx() == preambulo);
+    VERIFICAR(simModo() == SIM_SUENO);
+    printf("transmisión con 500 ms: preámbulo de %ld símbolos (%.0f ms)\n", preambulo,
+           preambulo * red.tiempoSimboloUs() / 1000.0);
+
+    // Un vecino con el preámbulo normal casi nunca cae en un muestreo
+    Banco corto(red);
+    for (int i = 0; i < 20; i++) {
+        corto.entrante(false);
+        corto.correr(1000000UL + (unsigned long)random(500000));
+    }
+    printf("preámbulo normal con 500 ms: %d de 20 recibidas\n", corto.entregadas);
+    VERIFICAR(corto.entregadas < 5);
+
+    // Falsa alarma: CAD ocupado sin trama, la recepción vence y se vuelve a dormir
+    uint32_t sin_trama = est.sin_trama;
+    simCanalOcupadoHasta(micros() + 600000);
+    banco.correr(600000);
+    VERIFICAR(simModo() == SIM_RX);
+    banco.correr(red.tiempoAireUs(TAM_DATOS_LORA) + 100000);
+    VERIFICAR(est.sin_trama == sin_trama + 1);
+    VERIFICAR(simModo() == SIM_SUENO);
+    simCanalOcupadoHasta(0);
+
+    // Transmitir con un preámbulo largo en el aire: se recibe esa trama y después se transmite
+    Banco cruce(red);
+    cruce.entrante(true);
+    cruce.correr(50000);
+    previas = simTransmitidas();
+    red.transmite_data(dato, LARGO);
+    cruce.correr(3000000);
+    VERIFICAR(cruce.entregadas == 1 && simTransmitidas() == previas + 1);
+    VERIFICAR(red.estadisticasTx().descartadas_canal == 0);
+    printf("trama propia durante un preámbulo largo: recibida %d, transmitida %d\n", cruce.entregadas,
+           simTransmitidas() - previas);
+
+    // Volver a recepción continua
+    red.setEscuchaBajoConsumo(0);
+    VERIFICAR(simModo() == SIM_RX && red.preambuloSimbolos() == PREAMBLE_LENGTH);
+
+    return terminar();
+}
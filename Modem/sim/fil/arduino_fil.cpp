@@ -0,0 +1,161 @@
+/*
+    Núcleo Arduino para el firmware completo en Linux: reloj real, las
+    "interrupciones" son un mutex que toma el hilo de la radio simulada
+    mientras corre un callback, y Serial es el lado maestro de una
+    pseudo-terminal. El Nodo abre el lado esclavo como si fuera el
+    /dev/ttyUSB0 del modem.
+*/
+#include "Arduino.h"
+#include "SPI.h"
+#include "Wire.h"
+#include "fil.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+HardwareSerial Serial;
+SPIClass SPI;
+TwoWire Wire;
+
+static std::recursive_mutex interrupciones;
+
+static uint64_t relojUs()
+{
+    static timespec inicio;
+    static bool iniciado = false;
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    if (!iniciado)
+    {
+        inicio = ts;
+        iniciado = true;
+    }
+    return (uint64_t)(ts.tv_sec - inicio.tv_sec) * 1000000ULL + (ts.tv_nsec - inicio.tv_nsec) / 1000;
+}
+
+unsigned long micros() { return (unsigned long)relojUs(); }
+unsigned long millis() { return (unsigned long)(relojUs() / 1000); }
+void delay(unsigned long ms) { usleep(ms * 1000); }
+void simAvanzarUs(unsigned long us) { usleep(us); }
+void noInterrupts() { interrupciones.lock(); }
+void interrupts() { interrupciones.unlock(); }
+void attachInterrupt(int, void (*)(), int) {}
+void detachInterrupt(int) {}
+
+// Serial sobre pty
+static int pty = -1;
+static std::mutex m_rx, m_tx;
+static std::deque<uint8_t> rx;
+static void (*aviso_rx)() = NULL;
+
+static void leerPty()
+{
+    uint8_t bloque[256];
+    for (;;)
+    {
+        pollfd p = {pty, POLLIN, 0};
+        if (poll(&p, 1, -1) <= 0)
+            continue;
+        ssize_t n = read(pty, bloque, sizeof(bloque));
+        if (n <= 0)
+        {
+            usleep(10000); // EIO mientras nadie tiene abierto el esclavo
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_rx);
+            rx.insert(rx.end(), bloque, bloque + n);
+        }
+        if (aviso_rx)
+            aviso_rx();
+    }
+}
+
+void HardwareSerial::begin(unsigned long)
+{
+    if (pty >= 0)
+        return;
+    pty = posix_openpt(O_RDWR | O_NOCTTY);
+    if (pty < 0 || grantpt(pty) < 0 || unlockpt(pty) < 0)
+    {
+        perror("posix_openpt");
+        exit(1);
+    }
+    const char *esclavo = ptsname(pty);
+
+    // El esclavo queda abierto y en modo crudo: así el Nodo puede ir y
+    // venir sin que el maestro vea EIO ni se pierda la configuración
+    int fd = open(esclavo, O_RDWR | O_NOCTTY);
+    termios t;
+    tcgetattr(fd, &t);
+    cfmakeraw(&t);
+    tcsetattr(fd, TCSANOW, &t);
+    // la UART no se bloquea si nadie lee: lo que no entra se pierde
+    fcntl(pty, F_SETFL, fcntl(pty, F_GETFL) | O_NONBLOCK);
+
+    if (ruta_serie_fil != NULL)
+    {
+        unlink(ruta_serie_fil);
+        if (symlink(esclavo, ruta_serie_fil) < 0)
+            perror(ruta_serie_fil);
+    }
+    fprintf(stderr, "modem_fil: Serial en %s%s%s\n", esclavo, ruta_serie_fil ? " -> " : "",
+            ruta_serie_fil ? ruta_serie_fil : "");
+    std::thread(leerPty).detach();
+}
+
+int HardwareSerial::available()
+{
+    std::lock_guard<std::mutex> lock(m_rx);
+    return rx.size();
+}
+
+int HardwareSerial::read()
+{
+    std::lock_guard<std::mutex> lock(m_rx);
+    if (rx.empty())
+        return -1;
+    int c = rx.front();
+    rx.pop_front();
+    return c;
+}
+
+int HardwareSerial::peek()
+{
+    std::lock_guard<std::mutex> lock(m_rx);
+    return rx.empty() ? -1 : rx.front();
+}
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_tx);
+    size_t escritos = 0;
+    while (pty >= 0 && escritos < size)
+    {
+        ssize_t n = ::write(pty, buffer + escritos, size - escritos);
+        if (n > 0)
+        {
+            escritos += n;
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN)
+        {
+            // esperar un poco a que el Nodo lea; si no, se descarta
+            pollfd p = {pty, POLLOUT, 0};
+            if (poll(&p, 1, 100) > 0)
+                continue;
+        }
+        break;
+    }
+    return size;
+}
+
+void HardwareSerial::onReceive(void (*funcion)(), bool) { aviso_rx = funcion; }
@@ -0,0 +1,409 @@
+/*
+    Banco de rendimiento del firmware-in-the-loop: hace de Nodo en dos
+    modems simulados. Envía por la pty del modem A tramas IPv4 unicast
+    (protocolo 2) hacia el modem B, cada una con número de secuencia y
+    marca de tiempo, y las recoge en la pty de B. Informa entrega,
+    throughput útil y latencia Nodo a Nodo (UART + cola + radio + UART).
+
+    El ADR arranca en la tasa base (SF12/125 kHz) y acelera después de la
+    primera ventana de descubrimiento: -w descarta ese período. Con -k el
+    Nodo de B confirma cada trama con el ACK del Nodo (protocolo 1) y se
+    cuentan los ACK que llegan a A; sin -k la ventana de control que abre
+    el modem A tras cada unicast vence sin respuesta. Con -m las tramas
+    van con la entrega en el modem (Modem/entrega.h): confirma el modem de
+    B y el de A avisa cada resultado; se cuentan los avisos. Con -k o -m
+    se mide además la ida y vuelta desde que la trama sale del banco hasta
+    que vuelve el ACK o el aviso. Con -g el banco suscribe el modem B al
+    grupo indicado (Modem/grupos.h) y A alterna mensajes inundados
+    (protocolo 3) a ese grupo y al siguiente: sólo los primeros deben
+    llegar a la UART de B. Con -t se consulta
+    la telemetría de los dos modems antes y después de la corrida y se
+    informa cuántas tramas pasaron por el reenvío directo y cuántas copias
+    de IPv4Packet hizo cada modem por trama del banco (y con -g cuántas
+    filtró B por destino).
+
+    Uso: ./bin/fil_banco -a pty_A -A ip_A -b pty_B -B ip_B
+                         [-n tramas] [-l largo] [-i intervalo_ms] [-w calentamiento_s] [-k | -m | -g grupo] [-t]
+*/
+#include "slip.h"
+#include "telemetria.h"
+#include "entrega.h"
+#include "grupos.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#define IPV4_CABECERA 11
+#define PROTOCOLO_ACK 1
+#define PROTOCOLO_UNICAST 2
+#define PROTOCOLO_BROADCAST 3
+#define TAM_TRAMA_UART 272
+#define FLAG_ENTREGA_MODEM 0x4
+#define DRENAJE_MS 15000      // espera por las últimas tramas
+static const uint8_t MARCA[4] = {'F', 'I', 'L', 0};
+
+static uint64_t ahoraUs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static int abrirPuerto(const char *ruta) {
+    int fd = open(ruta, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(ruta);
+        exit(1);
+    }
+    termios t;
+    tcgetattr(fd, &t);
+    cfmakeraw(&t);
+    tcsetattr(fd, TCSANOW, &t);
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+class PuertoFd : public Print
+{
+public:
+    int fd;
+    PuertoFd(int f) : fd(f) {}
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t *b, size_t n)
+    {
+        return ::write(fd, b, n) == (ssize_t)n ? n : 0;
+    }
+};
+
+// Mismo checksum de cabecera que el Nodo y el modem (sin IPs)
+static uint8_t checksum(const uint8_t *c) {
+    uint16_t suma = c[0] + c[1] + c[2] + c[3] + c[4] + c[5];
+    suma = (suma & 0xFF) + (suma >> 8);
+    return (~suma) & 0xFF;
+}
+
+static int construirTrama(uint8_t *t, uint16_t origen, uint16_t destino, uint16_t id, uint32_t secuencia, int largo,
+                          bool entrega_modem, uint8_t protocolo) {
+    uint64_t marca = ahoraUs();
+    memset(t, 0, IPV4_CABECERA + largo);
+    t[0] = entrega_modem ? FLAG_ENTREGA_MODEM << 4 : 0;
+    t[2] = IPV4_CABECERA + largo;
+    t[3] = id >> 8;
+    t[4] = id & 0xFF;
+    t[5] = protocolo;
+    t[6] = checksum(t);
+    t[7] = origen >> 8;
+    t[8] = origen & 0xFF;
+    t[9] = destino >> 8;
+    t[10] = destino & 0xFF;
+    uint8_t *d = &t[IPV4_CABECERA];
+    memcpy(d, MARCA, 4);
+    for (int i = 0; i < 4; i++) d[4 + i] = secuencia >> (24 - 8 * i);
+    for (int i = 0; i < 8; i++) d[8 + i] = marca >> (56 - 8 * i);
+    return IPV4_CABECERA + largo;
+}
+
+// ACK del Nodo: protocolo 1 con el identificador confirmado como datos
+static int construirAck(uint8_t *t, uint16_t origen, uint16_t destino, uint16_t id, uint16_t confirmado) {
+    memset(t, 0, IPV4_CABECERA + 2);
+    t[2] = 2; // el Nodo pone en longitud_total sólo los datos
+    t[3] = id >> 8;
+    t[4] = id & 0xFF;
+    t[5] = PROTOCOLO_ACK;
+    t[6] = checksum(t);
+    t[7] = origen >> 8;
+    t[8] = origen & 0xFF;
+    t[9] = destino >> 8;
+    t[10] = destino & 0xFF;
+    t[IPV4_CABECERA] = confirmado >> 8;
+    t[IPV4_CABECERA + 1] = confirmado & 0xFF;
+    return IPV4_CABECERA + 2;
+}
+
+struct Recepcion {
+    std::vector<bool> vista;
+    std::vector<double> latencias_ms;
+    unsigned long bytes, duplicadas, acks, fallidas;
+    unsigned long ajenas;                // tramas del banco para otro destino (otro grupo)
+    std::vector<uint64_t> envio_us;      // por identificador, para la ida y vuelta
+    std::vector<double> ida_vuelta_ms;
+    uint64_t ultima_us;
+    Print *acuse;  // puerto por el que se confirma cada trama (NULL = sin ACK)
+};
+
+// Reconoce las tramas del banco entre todo lo que el modem escribe por la UART
+static void procesarTrama(const uint8_t *t, int largo, uint16_t origen, uint16_t destino, Recepcion &r) {
+    if (largo >= IPV4_CABECERA + 2 && t[5] == PROTOCOLO_ACK) { // más el trailer de enlace
+        r.acks++;
+        uint16_t id = (t[IPV4_CABECERA] << 8) | t[IPV4_CABECERA + 1];
+        if (id < r.envio_us.size() && r.envio_us[id]) r.ida_vuelta_ms.push_back((ahoraUs() - r.envio_us[id]) / 1000.0);
+        return;
+    }
+    const uint8_t *aviso = &t[IPV4_CABECERA];
+    if (largo >= IPV4_CABECERA + 9 && t[5] == 0 && aviso[0] == CMD_ENTREGA) {
+        // aviso del modem: [cmd][6][destino][id][estado][intentos][fcs]
+        uint16_t id = (aviso[4] << 8) | aviso[5];
+        if (aviso[6] != ENTREGA_CONFIRMADA) {
+            r.fallidas++;
+            return;
+        }
+        r.acks++;
+        if (id < r.envio_us.size() && r.envio_us[id]) r.ida_vuelta_ms.push_back((ahoraUs() - r.envio_us[id]) / 1000.0);
+        return;
+    }
+    if (largo < IPV4_CABECERA + 16 || (t[5] != PROTOCOLO_UNICAST && t[5] != PROTOCOLO_BROADCAST)) return;
+    if (((t[7] << 8) | t[8]) != origen) return;
+    const uint8_t *d = &t[IPV4_CABECERA];
+    if (memcmp(d, MARCA, 4) != 0) return;
+    if (((t[9] << 8) | t[10]) != destino) {
+        r.ajenas++;
+        return;
+    }
+    if (r.acuse != NULL) {
+        // como el Nodo: también se confirman los duplicados
+        uint8_t ack[IPV4_CABECERA + 2];
+        uint16_t id = (t[3] << 8) | t[4];
+        escribirSLIP(*r.acuse, ack, construirAck(ack, destino, origen, 0x8000 | id, id));
+    }
+    uint32_t secuencia = 0;
+    uint64_t marca = 0;
+    for (int i = 0; i < 4; i++) secuencia = (secuencia << 8) | d[4 + i];
+    for (int i = 0; i < 8; i++) marca = (marca << 8) | d[8 + i];
+    if (secuencia >= r.vista.size()) return;
+    if (r.vista[secuencia]) {
+        r.duplicadas++;
+        return;
+    }
+    r.vista[secuencia] = true;
+    r.latencias_ms.push_back((ahoraUs() - marca) / 1000.0);
+    r.bytes += t[2] - IPV4_CABECERA;
+    r.ultima_us = ahoraUs();
+}
+
+static void leerPuerto(int fd, DecodificadorSLIP &dec, uint8_t *trama, uint16_t origen, uint16_t destino,
+                       Recepcion &r, int espera_ms) {
+    pollfd p = {fd, POLLIN, 0};
+    if (poll(&p, 1, espera_ms) <= 0) return;
+    uint8_t bloque[512];
+    ssize_t n = read(fd, bloque, sizeof(bloque));
+    int pos = 0;
+    while (pos < n) {
+        int usados;
+        int largo = dec.agregar(&bloque[pos], n - pos, &usados);
+        pos += usados;
+        if (largo > 0) procesarTrama(trama, largo, origen, destino, r);
+    }
+}
+
+// Contadores del modem con CMD_TELEMETRIA, un bloque por pedido; lo demás que llegue se descarta
+static bool leerTelemetria(int fd, Print &puerto, DecodificadorSLIP &dec, uint8_t *trama, uint16_t ip,
+                           uint32_t *valores) {
+    int bloques = 1;
+    for (int bloque = 0; bloque < bloques; bloque++) {
+        uint8_t pedido[IPV4_CABECERA + 4] = {0};
+        pedido[2] = 4;
+        pedido[6] = checksum(pedido);
+        pedido[7] = pedido[9] = ip >> 8;
+        pedido[8] = pedido[10] = ip & 0xFF;
+        uint8_t *d = &pedido[IPV4_CABECERA];
+        d[0] = CMD_TELEMETRIA;
+        d[1] = 1;
+        d[2] = bloque;
+        d[3] = d[0] ^ d[1] ^ d[2];
+        escribirSLIP(puerto, pedido, sizeof(pedido));
+
+        bool leido = false;
+        uint64_t limite = ahoraUs() + 2000000ULL;
+        while (!leido && ahoraUs() < limite) {
+            pollfd p = {fd, POLLIN, 0};
+            if (poll(&p, 1, 50) <= 0) continue;
+            uint8_t byte;
+            int usados;
+            if (read(fd, &byte, 1) != 1) continue;
+            int largo = dec.agregar(&byte, 1, &usados);
+            const uint8_t *r = &trama[IPV4_CABECERA];
+            if (largo < IPV4_CABECERA + 2 + CABECERA_BLOQUE_TELEMETRIA || trama[5] != 0 || r[0] != CMD_TELEMETRIA ||
+                r[3] != bloque) continue;
+            bloques = r[4];
+            int n = (r[1] - CABECERA_BLOQUE_TELEMETRIA) / 4;
+            for (int i = 0; i < n && bloque * CONTADORES_POR_BLOQUE + i < CONTADORES_TELEMETRIA; i++) {
+                const uint8_t *v = &r[2 + CABECERA_BLOQUE_TELEMETRIA + 4 * i];
+                valores[bloque * CONTADORES_POR_BLOQUE + i] = (v[0] << 24) | (v[1] << 16) | (v[2] << 8) | v[3];
+            }
+            leido = true;
+        }
+        if (!leido) return false;
+    }
+    return true;
+}
+
+// Grupos del modem con CMD_GRUPOS; espera la lista que quedó aplicada
+static bool suscribirGrupo(int fd, Print &puerto, DecodificadorSLIP &dec, uint8_t *trama, uint16_t ip, uint8_t grupo) {
+    uint8_t pedido[IPV4_CABECERA + 4] = {0};
+    pedido[2] = 4;
+    pedido[6] = checksum(pedido);
+    pedido[7] = pedido[9] = ip >> 8;
+    pedido[8] = pedido[10] = ip & 0xFF;
+    uint8_t *d = &pedido[IPV4_CABECERA];
+    d[0] = CMD_GRUPOS;
+    d[1] = 1;
+    d[2] = grupo;
+    d[3] = d[0] ^ d[1] ^ d[2];
+    escribirSLIP(puerto, pedido, sizeof(pedido));
+
+    uint64_t limite = ahoraUs() + 2000000ULL;
+    while (ahoraUs() < limite) {
+        pollfd p = {fd, POLLIN, 0};
+        if (poll(&p, 1, 50) <= 0) continue;
+        uint8_t byte;
+        int usados;
+        if (read(fd, &byte, 1) != 1) continue;
+        int largo = dec.agregar(&byte, 1, &usados);
+        const uint8_t *r = &trama[IPV4_CABECERA];
+        if (largo >= IPV4_CABECERA + 3 && trama[5] == 0 && r[0] == CMD_GRUPOS) return r[1] == 1 && r[2] == grupo;
+    }
+    return false;
+}
+
+static double percentil(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[(size_t)(p * (v.size() - 1))];
+}
+
+int main(int argc, char **argv) {
+    const char *ruta_a = NULL, *ruta_b = NULL;
+    uint16_t ip_a = 0, ip_b = 0;
+    int tramas = 50, largo = 32, intervalo_ms = 1000, calentamiento_s = 0;
+    bool confirmar = false, entrega_modem = false, telemetria = false;
+    int grupo = -1;
+    int opcion;
+    while ((opcion = getopt(argc, argv, "a:A:b:B:n:l:i:w:kmg:t")) != -1) {
+        switch (opcion) {
+        case 'a': ruta_a = optarg; break;
+        case 'A': ip_a = strtol(optarg, NULL, 16); break;
+        case 'b': ruta_b = optarg; break;
+        case 'B': ip_b = strtol(optarg, NULL, 16); break;
+        case 'n': tramas = atoi(optarg); break;
+        case 'l': largo = atoi(optarg); break;
+        case 'i': intervalo_ms = atoi(optarg); break;
+        case 'w': calentamiento_s = atoi(optarg); break;
+        case 'k': confirmar = true; break;
+        case 'm': entrega_modem = true; break;
+        case 'g': grupo = strtol(optarg, NULL, 16) % (MAX_GRUPOS - 1); break;
+        case 't': telemetria = true; break;
+        }
+    }
+    if (ruta_a == NULL || ruta_b == NULL || ip_a == 0 || ip_b == 0) {
+        fprintf(stderr, "uso: %s -a pty_A -A ip_A -b pty_B -B ip_B [-n tramas] [-l largo] [-i intervalo_ms] "
+                        "[-w calentamiento_s] [-k | -m | -g grupo] [-t]\n", argv[0]);
+        return 1;
+    }
+    largo = constrain(largo, 16, 200);
+
+    int fd_a = abrirPuerto(ruta_a);
+    int fd_b = abrirPuerto(ruta_b);
+    PuertoFd puerto_a(fd_a), puerto_b(fd_b);
+    DecodificadorSLIP dec_a, dec_b;
+    uint8_t trama_a[TAM_TRAMA_UART], trama_b[TAM_TRAMA_UART], salida[TAM_TRAMA_UART];
+    dec_a.setSalida(trama_a, sizeof(trama_a));
+    dec_b.setSalida(trama_b, sizeof(trama_b));
+    Recepcion r;
+    r.vista.assign(tramas, false);
+    r.bytes = r.duplicadas = r.acks = r.fallidas = r.ajenas = 0;
+    r.ultima_us = 0;
+    r.acuse = confirmar ? &puerto_b : NULL;
+    Recepcion descarte; // lo que llegue a A (ecos, broadcasts) sólo se drena y se cuentan los ACK
+    descarte.acks = descarte.fallidas = 0;
+    descarte.acuse = NULL;
+    descarte.envio_us.assign(tramas + 1, 0);
+    bool esperar_acks = confirmar || entrega_modem;
+    // con -g sólo llegan las pares, las impares van a un grupo del que B no es miembro
+    uint16_t destino = grupo >= 0 ? BASE_GRUPOS | grupo : ip_b;
+    size_t esperadas = grupo >= 0 ? (tramas + 1) / 2 : tramas;
+    if (grupo >= 0) {
+        confirmar = entrega_modem = esperar_acks = false;
+        r.acuse = NULL;
+    }
+
+    if (calentamiento_s > 0) {
+        printf("fil_banco: calentamiento de %d s\n", calentamiento_s);
+        fflush(stdout);
+        uint64_t fin = ahoraUs() + calentamiento_s * 1000000ULL;
+        while (ahoraUs() < fin) {
+            leerPuerto(fd_a, dec_a, trama_a, 0, 0, descarte, 50);
+            leerPuerto(fd_b, dec_b, trama_b, 0, 0, descarte, 50);
+        }
+        descarte.acks = descarte.fallidas = 0;
+        descarte.ida_vuelta_ms.clear();
+    }
+    if (grupo >= 0 && !suscribirGrupo(fd_b, puerto_b, dec_b, trama_b, ip_b, grupo)) {
+        fprintf(stderr, "fil_banco: el modem 0x%x no confirmó el grupo %x\n", ip_b, grupo);
+        return 1;
+    }
+    uint32_t antes_a[CONTADORES_TELEMETRIA] = {0}, antes_b[CONTADORES_TELEMETRIA] = {0};
+    uint32_t despues_a[CONTADORES_TELEMETRIA] = {0}, despues_b[CONTADORES_TELEMETRIA] = {0};
+    if (telemetria && (!leerTelemetria(fd_a, puerto_a, dec_a, trama_a, ip_a, antes_a) ||
+                       !leerTelemetria(fd_b, puerto_b, dec_b, trama_b, ip_b, antes_b))) {
+        fprintf(stderr, "fil_banco: sin respuesta de telemetría\n");
+        telemetria = false;
+    }
+
+    uint64_t inicio = ahoraUs();
+    uint64_t proximo = inicio;
+    int enviadas = 0;
+    uint64_t fin = 0;
+    while (true) {
+        uint64_t ahora = ahoraUs();
+        if (enviadas < tramas && ahora >= proximo) {
+            int n = grupo < 0 ? construirTrama(salida, ip_a, ip_b, enviadas + 1, enviadas, largo, entrega_modem,
+                                               PROTOCOLO_UNICAST)
+                              : construirTrama(salida, ip_a, BASE_GRUPOS | (grupo + enviadas % 2), enviadas + 1,
+                                               enviadas, largo, false, PROTOCOLO_BROADCAST);
+            descarte.envio_us[enviadas + 1] = ahoraUs();
+            escribirSLIP(puerto_a, salida, n);
+            enviadas++;
+            proximo += intervalo_ms * 1000ULL;
+            if (enviadas == tramas) fin = ahora + DRENAJE_MS * 1000ULL;
+        }
+        bool completas = r.latencias_ms.size() == esperadas && (!esperar_acks || descarte.acks + descarte.fallidas >= (size_t)tramas);
+        if (enviadas == tramas && (completas || ahora >= fin)) break;
+        leerPuerto(fd_b, dec_b, trama_b, ip_a, destino, r, 5);
+        leerPuerto(fd_a, dec_a, trama_a, 0, 0, descarte, 0);
+    }
+    double segundos = r.ultima_us > inicio ? (r.ultima_us - inicio) / 1e6 : 0;
+
+    size_t recibidas = r.latencias_ms.size();
+    printf("fil_banco: %d tramas de %d bytes cada %d ms, 0x%x -> 0x%x\n", tramas, largo, intervalo_ms, ip_a, destino);
+    printf("  entrega      %lu/%lu (%.1f%%), %lu duplicadas\n", (unsigned long)recibidas, (unsigned long)esperadas,
+           100.0 * recibidas / esperadas, r.duplicadas);
+    if (grupo >= 0) printf("  grupos       %lu tramas del grupo ajeno llegaron a la UART de 0x%x\n", r.ajenas, ip_b);
+    printf("  throughput   %.1f B/s útiles en %.1f s\n", segundos > 0 ? r.bytes / segundos : 0, segundos);
+    printf("  latencia ms  p50 %.1f  p95 %.1f  máx %.1f\n", percentil(r.latencias_ms, 0.5),
+           percentil(r.latencias_ms, 0.95), percentil(r.latencias_ms, 1.0));
+    if (confirmar) printf("  ACK          %lu recibidos en 0x%x\n", descarte.acks, ip_a);
+    if (entrega_modem) printf("  entrega      %lu confirmadas y %lu fallidas avisadas por 0x%x\n", descarte.acks,
+                              descarte.fallidas, ip_a);
+    if (esperar_acks) printf("  ida y vuelta p50 %.1f  p95 %.1f ms hasta el ACK o el aviso\n",
+                             percentil(descarte.ida_vuelta_ms, 0.5), percentil(descarte.ida_vuelta_ms, 0.95));
+    if (telemetria && leerTelemetria(fd_a, puerto_a, dec_a, trama_a, ip_a, despues_a) &&
+        leerTelemetria(fd_b, puerto_b, dec_b, trama_b, ip_b, despues_b)) {
+        // incluye los anuncios de ruteo y ADR que arman los modems durante la corrida
+        printf("  directas     0x%x %u hacia la red, 0x%x %u hacia el Nodo\n", ip_a,
+               despues_a[TEL_DIRECTAS_HACIA_RED] - antes_a[TEL_DIRECTAS_HACIA_RED], ip_b,
+               despues_b[TEL_DIRECTAS_HACIA_NODO] - antes_b[TEL_DIRECTAS_HACIA_NODO]);
+        printf("  copias IPv4  0x%x %.2f, 0x%x %.2f por trama (%.0f / %.0f bytes)\n", ip_a,
+               (double)(despues_a[TEL_COPIAS_IPV4] - antes_a[TEL_COPIAS_IPV4]) / tramas, ip_b,
+               (double)(despues_b[TEL_COPIAS_IPV4] - antes_b[TEL_COPIAS_IPV4]) / tramas,
+               (double)(despues_a[TEL_BYTES_COPIADOS_IPV4] - antes_a[TEL_BYTES_COPIADOS_IPV4]) / tramas,
+               (double)(despues_b[TEL_BYTES_COPIADOS_IPV4] - antes_b[TEL_BYTES_COPIADOS_IPV4]) / tramas);
+        if (grupo >= 0) printf("  filtradas    0x%x %u por destino\n", ip_b,
+                               despues_b[TEL_DESTINO_FILTRADAS] - antes_b[TEL_DESTINO_FILTRADAS]);
+    }
+    close(fd_a);
+    close(fd_b);
+    return recibidas > 0 ? 0 : 1;
+}
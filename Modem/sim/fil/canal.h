@@ -0,0 +1,54 @@
+/*
+    Protocolo entre los modems compilados para Linux (lora_canal.cpp) y el
+    servidor del canal de radio (canal_servidor.cpp). Cada mensaje viaja
+    entero en un datagrama de un socket Unix SOCK_SEQPACKET.
+
+    modem -> canal: HOLA (ip del nodo), MODO (recepción, idle o sleep, la
+                    tasa en que escucha y el largo de cabecera implícita),
+                    TX (trama a la tasa indicada, explícita o implícita),
+                    CAD (escuchar el canal en la tasa indicada). Todos
+                    llevan la frecuencia sintonizada en la radio.
+    canal -> modem: RX (trama recibida con RSSI y SNR), TX_FIN, CAD_FIN
+                    (ocupado = hubo actividad)
+*/
+#ifndef CANAL_FIL_H
+#define CANAL_FIL_H
+
+#include <stdint.h>
+
+#define CANAL_FIL_DEFECTO "/tmp/lora_canal.sock"
+
+enum TipoMensajeCanal {
+    CANAL_HOLA = 1,
+    CANAL_MODO,
+    CANAL_TX,
+    CANAL_CAD,
+    CANAL_RX,
+    CANAL_TX_FIN,
+    CANAL_CAD_FIN,
+};
+
+enum ModoRadioCanal {
+    MODO_CANAL_SLEEP = 0,
+    MODO_CANAL_IDLE,
+    MODO_CANAL_RX,
+};
+
+struct MensajeCanal {
+    uint8_t tipo;
+    uint8_t modo;
+    uint8_t sf;
+    uint8_t largo;
+    uint8_t cr;          // denominador de la tasa de código (5 = 4/5)
+    uint16_t preambulo;  // símbolos de preámbulo
+    int32_t bw;
+    int32_t frecuencia;  // Hz
+    uint16_t nodo;
+    int16_t rssi;
+    int8_t snr_cuartos;
+    uint8_t ocupado;
+    uint8_t implicito;   // MODO: largo en cabecera implícita (0 = explícita); TX: 1 = implícita
+    uint8_t datos[255];
+};
+
+#endif
@@ -0,0 +1,436 @@
+/*
+    Canal de radio compartido para los modems compilados en Linux
+    (firmware-in-the-loop). Cada modem se conecta por un socket Unix
+    (canal.h) y el servidor decide qué receptores oyen cada trama.
+
+    Modelo:
+    - tiempo de aire del SX1276 con el mismo cálculo del firmware
+      (tiempo_aire.h: preámbulo, header explícito, CRC, tasa de código y
+      optimización de baja tasa);
+    - una radio sólo oye tramas en el SF/BW en que escucha y sólo si
+      estaba escuchando con al menos SIMBOLOS_ENGANCHE símbolos de
+      preámbulo por delante (half-duplex: quien transmite o hace CAD no
+      recibe; con escucha de bajo consumo se entra a mitad del preámbulo);
+    - SNR por enlace referido a 125 kHz, -3 dB por cada duplicación del
+      ancho de banda, y pérdida si queda bajo el mínimo del SF;
+    - colisión si otra trama audible en el receptor, en la misma tasa, se
+      solapa en el tiempo (sin efecto captura; tasas distintas no chocan);
+    - pérdida aleatoria configurable por enlace;
+    - CAD ocupado si durante los dos símbolos del CAD hay actividad
+      audible en la misma tasa.
+
+    Sin archivo de enlaces todos los nodos se oyen con el SNR y la pérdida
+    de la línea de comandos. El archivo tiene una línea por enlace
+    bidireccional: "<ip a> <ip b> <snr dB> [pérdida]", IPs en hex; los
+    pares que no figuran no se oyen (topologías multi-salto).
+
+    Uso: ./bin/canal [-c socket] [-s snr_dB] [-p perdida] [-e enlaces] [-x semilla] [-v]
+*/
+#include "canal.h"
+#include "tiempo_aire.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include <map>
+#include <vector>
+
+#define MAX_CLIENTES 64
+#define RUIDO_DBM -117           // piso de ruido en 125 kHz
+#define HISTORIA_US 30000000ULL  // tramas terminadas que aún pueden solaparse
+#define SIMBOLOS_CAD 2
+#define SIMBOLOS_ENGANCHE 4      // preámbulo que necesita el receptor para engancharse
+
+struct Cliente {
+    int fd;
+    uint16_t nodo;
+    uint8_t modo;
+    uint8_t sf;
+    long bw;
+    uint64_t escucha_desde;  // instante desde el que escucha sin cambios
+    uint8_t implicito;       // largo con que recibe en cabecera implícita (0 = explícita)
+    long frecuencia;
+};
+
+struct Transmision {
+    int emisor;              // índice del cliente
+    uint16_t nodo;
+    uint8_t sf;
+    long bw;
+    long frecuencia;
+    uint64_t inicio, fin;
+    uint64_t enganche;       // último instante en que un receptor puede empezar a escuchar
+    bool implicita;
+    bool terminada;
+    uint8_t largo;
+    uint8_t datos[255];
+};
+
+struct Cad {
+    int cliente;
+    uint8_t sf;
+    long bw;
+    long frecuencia;
+    uint64_t inicio, fin;
+};
+
+struct Enlace {
+    double snr_db;
+    double perdida;
+};
+
+struct Estadisticas {
+    unsigned long transmisiones, entregas, colisiones, otro_canal, fuera_de_tasa, otra_cabecera, bajo_umbral,
+        perdidas, cads, cads_ocupados;
+};
+
+static std::vector<Cliente> clientes;
+static std::vector<Transmision> en_aire;
+static std::vector<Cad> cads;
+static std::map<uint32_t, Enlace> enlaces;
+static bool con_enlaces = false;
+static Enlace enlace_defecto = {10.0, 0.0};
+static Estadisticas est;
+static bool detallado = false;
+static volatile sig_atomic_t terminar = 0;
+
+static uint64_t ahoraUs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static double tiempoSimboloUs(uint8_t sf, long bw) {
+    return (double)(1UL << sf) * 1e6 / bw;
+}
+
+// SNR mínimo demodulable por SF, en cuartos de dB (-7.5 dB en SF7)
+static int snrMinimoCuartos(uint8_t sf) {
+    return -30 - 10 * (sf - 7);
+}
+
+static int ajusteAnchoCuartos(long bw) {
+    int ajuste = 0;
+    for (long b = 125000; b < bw; b <<= 1) ajuste += 12;
+    return ajuste;
+}
+
+static uint32_t claveEnlace(uint16_t a, uint16_t b) {
+    return ((uint32_t)a << 16) | b;
+}
+
+// NULL si los nodos no se oyen
+static const Enlace *enlace(uint16_t desde, uint16_t hacia) {
+    if (!con_enlaces) return &enlace_defecto;
+    std::map<uint32_t, Enlace>::const_iterator it = enlaces.find(claveEnlace(desde, hacia));
+    return it == enlaces.end() ? NULL : &it->second;
+}
+
+static bool cargarEnlaces(const char *archivo) {
+    FILE *f = fopen(archivo, "r");
+    if (f == NULL) return false;
+    char linea[128];
+    while (fgets(linea, sizeof(linea), f)) {
+        unsigned a, b;
+        Enlace e = {0, 0};
+        if (linea[0] == '#') continue;
+        int n = sscanf(linea, "%x %x %lf %lf", &a, &b, &e.snr_db, &e.perdida);
+        if (n < 3) continue;
+        enlaces[claveEnlace(a, b)] = e;
+        enlaces[claveEnlace(b, a)] = e;
+    }
+    fclose(f);
+    con_enlaces = true;
+    return true;
+}
+
+static void enviar(const Cliente &c, const MensajeCanal &m) {
+    // un receptor lento no frena el canal: el datagrama se pierde
+    send(c.fd, &m, sizeof(m), MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+static void cambiarModo(Cliente &c, uint8_t modo, uint8_t sf, long bw, uint64_t ahora) {
+    if (c.modo != modo || c.sf != sf || c.bw != bw) c.escucha_desde = ahora;
+    c.modo = modo;
+    c.sf = sf;
+    c.bw = bw;
+}
+
+static bool audible(const Transmision &t, const Cliente &r) {
+    const Enlace *e = enlace(t.nodo, r.nodo);
+    if (e == NULL) return false;
+    return e->snr_db * 4 - ajusteAnchoCuartos(t.bw) >= snrMinimoCuartos(t.sf);
+}
+
+static void entregar(Transmision &t) {
+    for (size_t i = 0; i < clientes.size(); i++) {
+        Cliente &r = clientes[i];
+        if ((int)i == t.emisor || r.fd < 0) continue;
+        const Enlace *e = enlace(t.nodo, r.nodo);
+        if (e == NULL) continue;
+
+        if (r.modo == MODO_CANAL_RX && r.frecuencia != t.frecuencia) {
+            est.otro_canal++;
+            continue;
+        }
+        if (r.modo != MODO_CANAL_RX || r.sf != t.sf || r.bw != t.bw || r.escucha_desde > t.enganche) {
+            est.fuera_de_tasa++;
+            continue;
+        }
+        // sin cabecera el receptor sólo decodifica lo que espera con el largo configurado
+        if (r.implicito != (t.implicita ? t.largo : 0)) {
+            est.otra_cabecera++;
+            continue;
+        }
+        int snr = (int)(e->snr_db * 4) - ajusteAnchoCuartos(t.bw);
+        if (snr < snrMinimoCuartos(t.sf)) {
+            est.bajo_umbral++;
+            continue;
+        }
+        bool choque = false;
+        for (size_t j = 0; j < en_aire.size() && !choque; j++) {
+            const Transmision &u = en_aire[j];
+            if (&u == &t || u.frecuencia != t.frecuencia || u.sf != t.sf || u.bw != t.bw) continue;
+            if (u.inicio < t.fin && u.fin > t.inicio && audible(u, r)) choque = true;
+        }
+        if (choque) {
+            est.colisiones++;
+            continue;
+        }
+        if (drand48() < e->perdida) {
+            est.perdidas++;
+            continue;
+        }
+
+        MensajeCanal m;
+        memset(&m, 0, sizeof(m));
+        m.tipo = CANAL_RX;
+        m.nodo = t.nodo;
+        m.sf = t.sf;
+        m.bw = t.bw;
+        m.largo = t.largo;
+        m.snr_cuartos = snr < -128 ? -128 : snr > 127 ? 127 : snr;
+        m.rssi = RUIDO_DBM + ajusteAnchoCuartos(t.bw) / 4 + snr / 4;
+        memcpy(m.datos, t.datos, t.largo);
+        enviar(r, m);
+        est.entregas++;
+    }
+}
+
+static void terminarTransmision(Transmision &t, uint64_t ahora) {
+    t.terminada = true;
+    entregar(t);
+    if (t.emisor < 0) return;
+    Cliente &c = clientes[t.emisor];
+    cambiarModo(c, MODO_CANAL_IDLE, c.sf, c.bw, ahora); // el SX1276 queda en standby
+    MensajeCanal m;
+    memset(&m, 0, sizeof(m));
+    m.tipo = CANAL_TX_FIN;
+    enviar(c, m);
+}
+
+static void terminarCad(const Cad &cad, uint64_t ahora) {
+    Cliente &c = clientes[cad.cliente];
+    bool ocupado = false;
+    for (size_t j = 0; j < en_aire.size() && !ocupado; j++) {
+        const Transmision &u = en_aire[j];
+        if (u.frecuencia != cad.frecuencia || u.sf != cad.sf || u.bw != cad.bw || u.emisor == cad.cliente) continue;
+        if (u.inicio < cad.fin && u.fin > cad.inicio && audible(u, c)) ocupado = true;
+    }
+    if (ocupado) est.cads_ocupados++;
+    cambiarModo(c, MODO_CANAL_IDLE, c.sf, c.bw, ahora);
+    MensajeCanal m;
+    memset(&m, 0, sizeof(m));
+    m.tipo = CANAL_CAD_FIN;
+    m.ocupado = ocupado;
+    enviar(c, m);
+}
+
+static void atenderMensaje(int i, const MensajeCanal &m, uint64_t ahora) {
+    Cliente &c = clientes[i];
+    if (c.frecuencia != m.frecuencia) c.escucha_desde = ahora; // cada mensaje trae el canal sintonizado
+    c.frecuencia = m.frecuencia;
+    switch (m.tipo) {
+    case CANAL_HOLA:
+        c.nodo = m.nodo;
+        if (detallado) printf("canal: nodo 0x%x conectado\n", c.nodo);
+        break;
+    case CANAL_MODO:
+        if (c.implicito != m.implicito) c.escucha_desde = ahora;
+        cambiarModo(c, m.modo, m.sf, m.bw, ahora);
+        c.implicito = m.implicito;
+        break;
+    case CANAL_TX: {
+        Transmision t;
+        t.emisor = i;
+        t.nodo = c.nodo;
+        t.sf = m.sf;
+        t.bw = m.bw;
+        t.frecuencia = m.frecuencia;
+        t.inicio = ahora;
+        t.fin = ahora + aire::tiempoAireUs(m.largo, m.sf, m.bw, m.cr - 4, m.preambulo, true, m.implicito);
+        t.enganche = ahora + (m.preambulo > SIMBOLOS_ENGANCHE ? m.preambulo - SIMBOLOS_ENGANCHE : 0) *
+                                 ((1000000ULL << m.sf) / m.bw);
+        t.implicita = m.implicito;
+        t.terminada = false;
+        t.largo = m.largo;
+        memcpy(t.datos, m.datos, m.largo);
+        en_aire.push_back(t);
+        cambiarModo(c, MODO_CANAL_IDLE, m.sf, m.bw, ahora);
+        est.transmisiones++;
+        if (detallado) {
+            printf("canal: 0x%x TX %u bytes SF%u/%ld kHz %.1f MHz %.1f ms\n", c.nodo, m.largo, m.sf,
+                   (long)m.bw / 1000, m.frecuencia / 1e6, (t.fin - t.inicio) / 1000.0);
+        }
+        break;
+    }
+    case CANAL_CAD: {
+        Cad cad;
+        cad.cliente = i;
+        cad.sf = m.sf;
+        cad.bw = m.bw;
+        cad.frecuencia = m.frecuencia;
+        cad.inicio = ahora;
+        cad.fin = ahora + (uint64_t)(SIMBOLOS_CAD * tiempoSimboloUs(m.sf, m.bw));
+        cads.push_back(cad);
+        cambiarModo(c, MODO_CANAL_IDLE, m.sf, m.bw, ahora);
+        est.cads++;
+        break;
+    }
+    }
+}
+
+// Atiende los eventos vencidos y devuelve el instante del próximo
+static uint64_t atenderEventos(uint64_t ahora) {
+    uint64_t proximo = ahora + 1000000;
+    for (size_t j = 0; j < en_aire.size(); j++) {
+        if (en_aire[j].terminada) continue;
+        if (en_aire[j].fin <= ahora) terminarTransmision(en_aire[j], ahora);
+        else if (en_aire[j].fin < proximo) proximo = en_aire[j].fin;
+    }
+    for (size_t j = 0; j < cads.size();) {
+        if (cads[j].fin <= ahora) {
+            terminarCad(cads[j], ahora);
+            cads.erase(cads.begin() + j);
+            continue;
+        }
+        if (cads[j].fin < proximo) proximo = cads[j].fin;
+        j++;
+    }
+    for (size_t j = 0; j < en_aire.size();) {
+        if (en_aire[j].terminada && en_aire[j].fin + HISTORIA_US < ahora) en_aire.erase(en_aire.begin() + j);
+        else j++;
+    }
+    return proximo;
+}
+
+static void desconectar(int i) {
+    if (detallado) printf("canal: nodo 0x%x desconectado\n", clientes[i].nodo);
+    close(clientes[i].fd);
+    clientes[i].fd = -1;
+    clientes[i].modo = MODO_CANAL_SLEEP;
+    for (size_t j = 0; j < en_aire.size(); j++) {
+        if (en_aire[j].emisor == i) en_aire[j].emisor = -1;
+    }
+    for (size_t j = 0; j < cads.size();) {
+        if (cads[j].cliente == i) cads.erase(cads.begin() + j);
+        else j++;
+    }
+}
+
+static void alTerminar(int) {
+    terminar = 1;
+}
+
+int main(int argc, char **argv) {
+    const char *ruta = CANAL_FIL_DEFECTO;
+    long semilla = 1;
+    int opcion;
+    while ((opcion = getopt(argc, argv, "c:s:p:e:x:v")) != -1) {
+        switch (opcion) {
+        case 'c': ruta = optarg; break;
+        case 's': enlace_defecto.snr_db = atof(optarg); break;
+        case 'p': enlace_defecto.perdida = atof(optarg); break;
+        case 'e':
+            if (!cargarEnlaces(optarg)) {
+                fprintf(stderr, "canal: no se puede leer %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'x': semilla = atol(optarg); break;
+        case 'v': detallado = true; break;
+        default:
+            fprintf(stderr, "uso: %s [-c socket] [-s snr_dB] [-p perdida] [-e enlaces] [-x semilla] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+    srand48(semilla);
+
+    int escucha = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    sockaddr_un dir;
+    memset(&dir, 0, sizeof(dir));
+    dir.sun_family = AF_UNIX;
+    strncpy(dir.sun_path, ruta, sizeof(dir.sun_path) - 1);
+    unlink(ruta);
+    if (escucha < 0 || bind(escucha, (sockaddr *)&dir, sizeof(dir)) < 0 || listen(escucha, MAX_CLIENTES) < 0) {
+        fprintf(stderr, "canal: %s: %s\n", ruta, strerror(errno));
+        return 1;
+    }
+    signal(SIGINT, alTerminar);
+    signal(SIGTERM, alTerminar);
+    printf("canal: escuchando en %s\n", ruta);
+    fflush(stdout);
+
+    while (!terminar) {
+        uint64_t ahora = ahoraUs();
+        uint64_t proximo = atenderEventos(ahora);
+
+        std::vector<pollfd> fds;
+        pollfd p = {escucha, POLLIN, 0};
+        fds.push_back(p);
+        std::vector<int> indices;
+        for (size_t i = 0; i < clientes.size(); i++) {
+            if (clientes[i].fd < 0) continue;
+            pollfd q = {clientes[i].fd, POLLIN, 0};
+            fds.push_back(q);
+            indices.push_back(i);
+        }
+        uint64_t espera = proximo > ahora ? proximo - ahora : 0;
+        timespec ts = {(time_t)(espera / 1000000), (long)(espera % 1000000) * 1000};
+        if (ppoll(&fds[0], fds.size(), &ts, NULL) <= 0) continue;
+
+        ahora = ahoraUs();
+        atenderEventos(ahora); // las tramas que terminaron antes de este mensaje
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(escucha, NULL, NULL);
+            if (fd >= 0) {
+                Cliente c = {fd, 0, MODO_CANAL_SLEEP, 7, 125000, ahora, 0, 0};
+                size_t i = 0;
+                while (i < clientes.size() && clientes[i].fd >= 0) i++;
+                if (i == clientes.size()) clientes.push_back(c);
+                else clientes[i] = c;
+            }
+        }
+        for (size_t k = 1; k < fds.size(); k++) {
+            if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            int i = indices[k - 1];
+            MensajeCanal m;
+            ssize_t n = recv(clientes[i].fd, &m, sizeof(m), 0);
+            if (n <= 0) desconectar(i);
+            else if (n == (ssize_t)sizeof(m)) atenderMensaje(i, m, ahora);
+        }
+    }
+
+    printf("canal: %lu transmisiones, %lu entregas, %lu colisiones, %lu en otro canal, %lu fuera de tasa, "
+           "%lu con otra cabecera, %lu bajo umbral, %lu perdidas, %lu CAD (%lu ocupados)\n",
+           est.transmisiones, est.entregas, est.colisiones, est.otro_canal, est.fuera_de_tasa, est.otra_cabecera,
+           est.bajo_umbral, est.perdidas, est.cads, est.cads_ocupados);
+    unlink(ruta);
+    return 0;
+}
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Firmware-in-the-loop: levanta el canal, N modems y corre el banco entre
+# los dos primeros. Las UART de los modems quedan en $DIR/modem<ip>; un
+# Nodo real se conecta a cualquiera de las demás con
+#   ../../Nodo/bin/app <ip> $DIR/modem<ip>
+#
+# Uso (desde Modem/sim): fil/correr.sh [modems] [opciones de fil_banco...]
+# Variables: DIR (por defecto /tmp/lora_fil), CANAL_OPC (opciones de bin/canal)
+set -e
+MODEMS=${1:-2}
+[ $# -gt 0 ] && shift
+DIR=${DIR:-/tmp/lora_fil}
+mkdir -p "$DIR"
+
+make -s fil
+./bin/canal -c "$DIR/canal.sock" $CANAL_OPC > "$DIR/canal.log" 2>&1 &
+PIDS=$!
+trap 'kill $PIDS 2>/dev/null; wait 2>/dev/null' EXIT INT TERM
+sleep 0.2
+
+i=1
+while [ $i -le "$MODEMS" ]; do
+    ./bin/modem_fil -i $i -c "$DIR/canal.sock" -t "$DIR/modem$i" > "$DIR/modem$i.log" 2>&1 &
+    PIDS="$PIDS $!"
+    i=$((i + 1))
+done
+while [ ! -e "$DIR/modem$MODEMS" ]; do sleep 0.1; done
+
+./bin/fil_banco -a "$DIR/modem1" -A 1 -b "$DIR/modem2" -B 2 "$@"
+kill -INT $PIDS 2>/dev/null; wait 2>/dev/null || true
+trap - EXIT
+tail -n 1 "$DIR/canal.log"
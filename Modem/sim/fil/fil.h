@@ -0,0 +1,17 @@
+#ifndef FIL_H
+#define FIL_H
+
+#include <stdint.h>
+
+/*
+    Firmware del modem compilado en Linux (firmware-in-the-loop):
+    lora_canal.cpp reemplaza la radio por el canal compartido de
+    canal_servidor.cpp y arduino_fil.cpp da reloj real y Serial sobre una
+    pseudo-terminal a la que se conecta el Nodo. modem_fil.cpp fija estas
+    variables antes de llamar a setup().
+*/
+extern const char *ruta_canal_fil;  // socket del servidor del canal
+extern const char *ruta_serie_fil;  // enlace simbólico a la pty (NULL: sólo se informa)
+extern uint16_t nodo_fil;           // IP con la que el modem se presenta al canal
+
+#endif
@@ -0,0 +1,242 @@
+/*
+    Radio LoRa sobre el canal compartido (canal.h). Los comandos de la
+    radio se envían al servidor y un hilo lector entrega RX_DONE, TX_DONE
+    y CAD_DONE llamando a los callbacks con las "interrupciones"
+    deshabilitadas, igual que el manejador de DIO0 del SX1276.
+*/
+#include "LoRa.h"
+#include "canal.h"
+#include "fil.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+LoRaClass LoRa;
+
+static int fd_canal = -1;
+static uint8_t fifo[256];
+static int rssi_pkt = 0;
+static int8_t snr_pkt = 0;
+static uint8_t tx[256];
+static int tx_largo = 0;
+static uint8_t modo = MODO_CANAL_SLEEP;
+static int sf_radio = 7;
+static long bw_radio = 125000;
+static int cr_radio = 5;
+static long preambulo_radio = 8;
+static long frecuencia_radio = 915E6;
+static int largo_implicito = 0;
+static bool implicita_tx = false;
+static unsigned int semilla = 0;
+static std::mutex m_tx;
+static std::condition_variable cv_tx;
+static bool en_aire = false;
+
+static void enviar(MensajeCanal &m)
+{
+    m.sf = sf_radio;
+    m.bw = bw_radio;
+    m.cr = cr_radio;
+    m.preambulo = preambulo_radio;
+    m.frecuencia = frecuencia_radio;
+    send(fd_canal, &m, sizeof(m), MSG_NOSIGNAL);
+}
+
+static void enviarModo(uint8_t nuevo)
+{
+    modo = nuevo;
+    MensajeCanal m;
+    memset(&m, 0, sizeof(m));
+    m.tipo = CANAL_MODO;
+    m.modo = nuevo;
+    m.implicito = largo_implicito;
+    enviar(m);
+}
+
+LoRaClass::LoRaClass() : _spi(&SPI), _onReceive(NULL), _onTxDone(NULL), _onCadDone(NULL) {}
+
+static void leerCanal(void (**rx)(int), void (**tx_fin)(), void (**cad)(bool))
+{
+    MensajeCanal m;
+    while (recv(fd_canal, &m, sizeof(m), 0) == (ssize_t)sizeof(m))
+    {
+        noInterrupts();
+        switch (m.tipo)
+        {
+        case CANAL_RX:
+            memcpy(fifo, m.datos, m.largo);
+            rssi_pkt = m.rssi;
+            snr_pkt = m.snr_cuartos;
+            if (*rx)
+                (*rx)(m.largo);
+            break;
+        case CANAL_TX_FIN:
+        {
+            std::lock_guard<std::mutex> lock(m_tx);
+            en_aire = false;
+            modo = MODO_CANAL_IDLE;
+            cv_tx.notify_all();
+        }
+            if (*tx_fin)
+                (*tx_fin)();
+            break;
+        case CANAL_CAD_FIN:
+            modo = MODO_CANAL_IDLE;
+            if (*cad)
+                (*cad)(m.ocupado != 0);
+            break;
+        }
+        interrupts();
+    }
+    fprintf(stderr, "lora_canal: se cerró el canal\n");
+    exit(1);
+}
+
+int LoRaClass::begin(long frequency)
+{
+    _frequency = frequency;
+    frecuencia_radio = frequency;
+    if (fd_canal >= 0)
+        return 1;
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    sockaddr_un dir;
+    memset(&dir, 0, sizeof(dir));
+    dir.sun_family = AF_UNIX;
+    strncpy(dir.sun_path, ruta_canal_fil, sizeof(dir.sun_path) - 1);
+    if (fd < 0 || connect(fd, (sockaddr *)&dir, sizeof(dir)) < 0)
+    {
+        if (fd >= 0)
+            close(fd);
+        return 0;
+    }
+    fd_canal = fd;
+    semilla = getpid() ^ (unsigned int)time(NULL) ^ nodo_fil;
+
+    MensajeCanal m;
+    memset(&m, 0, sizeof(m));
+    m.tipo = CANAL_HOLA;
+    m.nodo = nodo_fil;
+    enviar(m);
+    std::thread(leerCanal, &_onReceive, &_onTxDone, &_onCadDone).detach();
+    return 1;
+}
+
+void LoRaClass::end() {}
+
+int LoRaClass::beginPacket(int implicitHeader)
+{
+    std::lock_guard<std::mutex> lock(m_tx);
+    if (en_aire)
+        return 0;
+    tx_largo = 0;
+    implicita_tx = implicitHeader;
+    return 1;
+}
+
+int LoRaClass::endPacket(bool async)
+{
+    MensajeCanal m;
+    memset(&m, 0, sizeof(m));
+    m.tipo = CANAL_TX;
+    m.largo = tx_largo;
+    m.implicito = implicita_tx;
+    memcpy(m.datos, tx, tx_largo);
+    {
+        std::lock_guard<std::mutex> lock(m_tx);
+        en_aire = true;
+    }
+    modo = MODO_CANAL_IDLE;
+    enviar(m);
+    if (!async)
+    {
+        std::unique_lock<std::mutex> lock(m_tx);
+        cv_tx.wait(lock, [] { return !en_aire; });
+    }
+    return 1;
+}
+
+bool LoRaClass::isTransmitting()
+{
+    std::lock_guard<std::mutex> lock(m_tx);
+    return en_aire;
+}
+
+int LoRaClass::packetRssi() { return rssi_pkt; }
+float LoRaClass::packetSnr() { return snr_pkt * 0.25f; }
+int8_t LoRaClass::packetSnrRaw() { return snr_pkt; }
+long LoRaClass::packetFrequencyError() { return 0; }
+int32_t LoRaClass::packetFrequencyErrorRaw() { return 0; }
+uint32_t LoRaClass::crcErrors() { return 0; } // el canal no entrega tramas corruptas
+void LoRaClass::readPayload(uint8_t *buffer, uint8_t size) { memcpy(buffer, fifo, size); }
+
+size_t LoRaClass::write(uint8_t byte) { return write(&byte, 1); }
+
+size_t LoRaClass::write(const uint8_t *buffer, size_t size)
+{
+    if (tx_largo + size > 255)
+        size = 255 - tx_largo;
+    memcpy(&tx[tx_largo], buffer, size);
+    tx_largo += size;
+    return size;
+}
+
+int LoRaClass::available() { return 0; }
+int LoRaClass::read() { return -1; }
+int LoRaClass::peek() { return -1; }
+void LoRaClass::flush() {}
+void LoRaClass::onReceive(void (*callback)(int)) { _onReceive = callback; }
+void LoRaClass::onTxDone(void (*callback)()) { _onTxDone = callback; }
+void LoRaClass::onCadDone(void (*callback)(bool)) { _onCadDone = callback; }
+void LoRaClass::receive(int size)
+{
+    largo_implicito = size;
+    enviarModo(MODO_CANAL_RX);
+}
+void LoRaClass::idle() { enviarModo(MODO_CANAL_IDLE); }
+void LoRaClass::sleep() { enviarModo(MODO_CANAL_SLEEP); }
+
+void LoRaClass::CAD()
+{
+    MensajeCanal m;
+    memset(&m, 0, sizeof(m));
+    m.tipo = CANAL_CAD;
+    modo = MODO_CANAL_IDLE;
+    enviar(m);
+}
+
+// El RSSI de banda ancha del SX1276 es ruido: acá, distinto en cada proceso
+byte LoRaClass::random() { return rand_r(&semilla) & 0xff; }
+
+void LoRaClass::setTxPower(int, int) {}
+
+void LoRaClass::setFrequency(long frequency)
+{
+    frecuencia_radio = frequency;
+    if (modo == MODO_CANAL_RX)
+        enviarModo(modo);
+}
+
+void LoRaClass::setSpreadingFactor(int sf)
+{
+    sf_radio = sf;
+    if (modo == MODO_CANAL_RX)
+        enviarModo(modo);
+}
+
+void LoRaClass::setSignalBandwidth(long sbw)
+{
+    bw_radio = sbw;
+    if (modo == MODO_CANAL_RX)
+        enviarModo(modo);
+}
+
+int LoRaClass::getSpreadingFactor() { return sf_radio; }
+long LoRaClass::getSignalBandwidth() { return bw_radio; }
+void LoRaClass::setCodingRate4(int denominator) { cr_radio = constrain(denominator, 5, 8); }
+void LoRaClass::setPreambleLength(long length) { preambulo_radio = length; }
+void LoRaClass::enableCrc() {}
+void LoRaClass::disableCrc() {}
@@ -0,0 +1,49 @@
+/*
+    Firmware completo del modem (Modem.ino y sus módulos) corriendo en
+    Linux contra el canal simulado. Cada proceso es un modem: se conecta
+    al servidor del canal y expone su UART como una pty.
+
+    Uso: ./bin/modem_fil -i <ip hex> [-c socket del canal] [-t enlace a la pty]
+*/
+#include "Arduino.h"
+#include "canal.h"
+#include "fil.h"
+#include "Adafruit_GFX.h"
+#include <unistd.h>
+
+const char *ruta_canal_fil = CANAL_FIL_DEFECTO;
+const char *ruta_serie_fil = NULL;
+uint16_t nodo_fil = 0;
+
+extern uint16_t mi_ip; // Modem.ino
+void setup();
+void loop();
+
+int main(int argc, char **argv)
+{
+    int opcion;
+    while ((opcion = getopt(argc, argv, "i:c:t:")) != -1)
+    {
+        switch (opcion)
+        {
+        case 'i': nodo_fil = (uint16_t)strtol(optarg, NULL, 16); break;
+        case 'c': ruta_canal_fil = optarg; break;
+        case 't': ruta_serie_fil = optarg; break;
+        default:
+            fprintf(stderr, "uso: %s -i <ip hex> [-c socket] [-t enlace_pty]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (nodo_fil == 0)
+    {
+        fprintf(stderr, "%s: falta la IP del modem (-i)\n", argv[0]);
+        return 1;
+    }
+    mi_ip = nodo_fil;
+    simOledTexto(true); // el texto del OLED sale por stderr
+
+    setup();
+    loop(); // termina la tarea de loop; el trabajo sigue en las tareas
+    for (;;)
+        pause();
+}
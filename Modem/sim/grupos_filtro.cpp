@@ -0,0 +1,58 @@
+/*
+    Verificación en Linux del filtro de grupos de multicast (grupos.h):
+    pertenencia por mapa de bits, lista ordenada para la respuesta al Nodo
+    y separación entre grupos, broadcast y unicast. Con 8 grupos y un
+    tráfico repartido entre ellos se cuenta cuánto sube a la UART de un
+    miembro de un solo grupo.
+
+    Uso: make bin/grupos_filtro && ./bin/grupos_filtro
+*/
+#include "grupos.h"
+#include <cstdio>
+#include <cstdlib>
+#include "verificar.h"
+
+#define TRAMAS 10000
+#define GRUPOS_TRAFICO 8
+
+int main() {
+    Grupos grupos;
+    VERIFICAR(grupos.cantidad() == 0 && !grupos.miembro(BASE_GRUPOS));
+
+    // Grupos válidos 0x00-0xFE; el broadcast no es un grupo
+    VERIFICAR(grupos.unirse(0x00) && grupos.unirse(0x7F) && grupos.unirse(0xFE) && grupos.unirse(0x08));
+    VERIFICAR(!grupos.unirse(0xFF) && !grupos.unirse(0x7F));
+    VERIFICAR(grupos.cantidad() == 4);
+    VERIFICAR(grupos.miembro(0xFF00) && grupos.miembro(0xFF7F) && grupos.miembro(0xFFFE) && grupos.miembro(0xFF08));
+    VERIFICAR(!grupos.miembro(0xFFFF) && !grupos.miembro(0xFF01) && !grupos.miembro(0x0008) && !grupos.miembro(0x7F00));
+    VERIFICAR(Grupos::esGrupo(0xFF00) && !Grupos::esGrupo(0xFFFF) && !Grupos::esGrupo(0xFEFF));
+    VERIFICAR(Grupos::esDifusion(0xFFFF) && Grupos::esDifusion(0xFF10) && !Grupos::esDifusion(0x0003));
+
+    uint8_t lista[MAX_GRUPOS];
+    VERIFICAR(grupos.listar(lista, MAX_GRUPOS) == 4);
+    VERIFICAR(lista[0] == 0x00 && lista[1] == 0x08 && lista[2] == 0x7F && lista[3] == 0xFE);
+    VERIFICAR(grupos.listar(lista, 2) == 2 && lista[1] == 0x08);
+
+    VERIFICAR(grupos.salir(0x7F) && !grupos.salir(0x7F) && !grupos.miembro(0xFF7F) && grupos.cantidad() == 3);
+    grupos.vaciar();
+    VERIFICAR(grupos.cantidad() == 0 && !grupos.miembro(0xFF00) && grupos.listar(lista, MAX_GRUPOS) == 0);
+
+    // Todos los grupos a la vez
+    for (int g = 0; g < MAX_GRUPOS; g++) VERIFICAR(grupos.unirse(g));
+    VERIFICAR(grupos.cantidad() == MAX_GRUPOS && grupos.listar(lista, MAX_GRUPOS) == MAX_GRUPOS);
+    grupos.vaciar();
+
+    // Tráfico repartido entre grupos: sólo sube el del grupo propio
+    grupos.unirse(3);
+    srand(48);
+    int suben = 0;
+    for (int i = 0; i < TRAMAS; i++) {
+        uint16_t destino = BASE_GRUPOS | (rand() % GRUPOS_TRAFICO);
+        if (grupos.miembro(destino)) suben++;
+    }
+    printf("grupos: %d de %d tramas repartidas en %d grupos suben a la UART de un miembro de uno\n", suben, TRAMAS,
+           GRUPOS_TRAFICO);
+    VERIFICAR(suben > TRAMAS / GRUPOS_TRAFICO / 2 && suben < 2 * TRAMAS / GRUPOS_TRAFICO);
+
+    return terminar();
+}
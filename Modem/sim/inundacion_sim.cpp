@@ -0,0 +1,149 @@
+/*
+    Simulación de la inundación controlada (inundacion.h) sobre grillas.
+
+    Modelo: nodos en una grilla con separación 1 y alcance de radio fijo,
+    canal compartido sin detección de portadora, pérdida independiente por
+    enlace y colisión si dos transmisiones vecinas se solapan en el tiempo
+    en un receptor (sin efecto captura, half-duplex). Cada corrida origina
+    un broadcast desde un nodo al azar y mide la fracción de nodos que lo
+    recibe y cuántas transmisiones costó.
+
+    Uso: make && ./bin/inundacion_sim [corridas]
+*/
+#include "inundacion.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define DURACION_TRAMA_MS 40     // ~30 bytes a SF7/250 kHz
+#define PERDIDA_ENLACE    0.10
+#define FIN_SIMULACION_MS 30000
+
+struct Transmision {
+    int nodo;
+    uint32_t inicio;
+    uint8_t ttl;
+};
+
+struct Esquema {
+    const char *nombre;
+    uint8_t umbral;          // 0 = sin supresión por contador
+    double probabilidad;     // probabilidad de reenviar (gossip), 1 = siempre
+};
+
+struct Resultado {
+    double entrega;
+    double transmisiones;
+};
+
+static double aleatorio() {
+    return rand() / (RAND_MAX + 1.0);
+}
+
+static Resultado simular(int filas, int columnas, double alcance, const Esquema &e, int corridas) {
+    int n = filas * columnas;
+    std::vector<std::vector<int> > vecinos(n);
+    for (int a = 0; a < n; a++) {
+        for (int b = 0; b < n; b++) {
+            double dx = a % columnas - b % columnas;
+            double dy = a / columnas - b / columnas;
+            if (a != b && std::sqrt(dx * dx + dy * dy) <= alcance + 1e-9) vecinos[a].push_back(b);
+        }
+    }
+
+    double suma_entrega = 0, suma_tx = 0;
+    for (int r = 0; r < corridas; r++) {
+        std::vector<Inundacion> nodos(n);
+        std::vector<bool> recibido(n, false);
+        std::vector<Transmision> txs;
+        for (int i = 0; i < n; i++) nodos[i].setUmbral(e.umbral);
+
+        int origen = rand() % n;
+        nodos[origen].nueva(origen, 1);
+        recibido[origen] = true;
+        Transmision primera = {origen, 0, TTL_INUNDACION};
+        txs.push_back(primera);
+
+        for (uint32_t t = 0; t < FIN_SIMULACION_MS; t++) {
+            // Entregas de las transmisiones que terminan en t
+            for (size_t k = 0; k < txs.size(); k++) {
+                if (txs[k].inicio + DURACION_TRAMA_MS != t) continue;
+                const Transmision &tx = txs[k];
+                for (size_t v = 0; v < vecinos[tx.nodo].size(); v++) {
+                    int j = vecinos[tx.nodo][v];
+                    bool colision = false;
+                    for (size_t o = 0; o < txs.size() && !colision; o++) {
+                        if (o == k) continue;
+                        const Transmision &otra = txs[o];
+                        bool solapa = otra.inicio < tx.inicio + DURACION_TRAMA_MS &&
+                                      tx.inicio < otra.inicio + DURACION_TRAMA_MS;
+                        if (!solapa) continue;
+                        if (otra.nodo == j) colision = true;
+                        for (size_t w = 0; w < vecinos[j].size() && !colision; w++) {
+                            if (vecinos[j][w] == otra.nodo) colision = true;
+                        }
+                    }
+                    if (colision || aleatorio() < PERDIDA_ENLACE) continue;
+
+                    if (!nodos[j].nueva(origen, 1)) continue;
+                    recibido[j] = true;
+                    if (tx.ttl > 1 && aleatorio() < e.probabilidad) {
+                        uint8_t trama = tx.ttl - 1;
+                        nodos[j].programar(origen, 1, &trama, 1, t + rand() % VENTANA_REENVIO_MS);
+                    }
+                }
+            }
+
+            // Reenvíos que vencen en t
+            for (int i = 0; i < n; i++) {
+                uint8_t trama[MAX_TRAMA_INUNDACION];
+                if (nodos[i].siguiente(t, trama) > 0) {
+                    Transmision tx = {i, t, trama[0]};
+                    txs.push_back(tx);
+                }
+            }
+        }
+
+        int entregados = 0;
+        for (int i = 0; i < n; i++) entregados += recibido[i];
+        suma_entrega += (double)entregados / n;
+        suma_tx += txs.size();
+    }
+
+    Resultado res = {suma_entrega / corridas, suma_tx / corridas};
+    return res;
+}
+
+int main(int argc, char **argv) {
+    int corridas = argc > 1 ? atoi(argv[1]) : 100;
+
+    const Esquema esquemas[] = {
+        {"ciega", 0, 1.0},
+        {"contador C=2", 2, 1.0},
+        {"contador C=3", 3, 1.0},
+        {"contador C=4", 4, 1.0},
+        {"probabilistica p=0.5", 0, 0.5},
+        {"probabilistica p=0.7", 0, 0.7},
+    };
+    const int cantidad = sizeof(esquemas) / sizeof(esquemas[0]);
+
+    struct { int filas, columnas; double alcance; } grillas[] = {
+        {5, 5, 1.0},
+        {5, 5, 1.5},
+        {7, 7, 1.5},
+        {10, 10, 1.5},
+    };
+
+    for (size_t g = 0; g < sizeof(grillas) / sizeof(grillas[0]); g++) {
+        printf("\nGrilla %dx%d, alcance %.1f (%d corridas)\n", grillas[g].filas, grillas[g].columnas,
+               grillas[g].alcance, corridas);
+        printf("%-22s %10s %14s\n", "esquema", "entrega", "tx/broadcast");
+        for (int i = 0; i < cantidad; i++) {
+            srand(1234 + g);
+            Resultado r = simular(grillas[g].filas, grillas[g].columnas, grillas[g].alcance, esquemas[i], corridas);
+            printf("%-22s %9.1f%% %14.1f\n", esquemas[i].nombre, 100.0 * r.entrega, r.transmisiones);
+        }
+    }
+    return 0;
+}
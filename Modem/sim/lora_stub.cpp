@@ -0,0 +1,223 @@
+#include "LoRa.h"
+#include "lora_stub.h"
+
+LoRaClass LoRa;
+
+static void (*callback_rx)(int) = NULL;
+static uint8_t fifo[256];
+static int rssi_pkt = 0;
+static int8_t snr_pkt = 0;
+static void (*callback_tx)() = NULL;
+static void (*callback_cad)(bool) = NULL;
+static unsigned long ocupado_hasta = 0;
+static int cads = 0;
+static int transmitidas = 0;
+static bool en_aire = false;
+static int sf_radio = 7, sf_tx = 0, sf_cad = 0;
+static long bw_radio = 125000, bw_tx = 0, bw_cad = 0;
+static long preambulo_radio = 8, preambulo_tx = 0;
+static int largo_implicito = 0;
+static long frecuencia_radio = 915E6, frecuencia_tx = 0;
+static bool implicita_tx = false, implicita_ultima_tx = false;
+
+static ModoRadioSim modo = SIM_STANDBY;
+static unsigned long modo_desde = 0;  // micros() desde el último cobro
+static unsigned long rx_desde = 0;    // micros() al entrar en RX
+static EnergiaSim energia = {};
+
+static const double corrientes[SIM_MODOS] = {
+    CORRIENTE_SUENO_MA, CORRIENTE_STANDBY_MA, CORRIENTE_RX_MA, CORRIENTE_CAD_MA, CORRIENTE_TX_MA,
+};
+
+static struct {
+    bool activa;
+    uint8_t datos[256];
+    int largo, rssi;
+    int8_t snr;
+    long frecuencia;
+    unsigned long inicio, fin_preambulo, fin;
+} entrante;
+
+static unsigned long simboloUs() { return (1000000UL << sf_radio) / bw_radio; }
+
+static void cobrar(ModoRadioSim m, double segundos)
+{
+    energia.tiempo_s[m] += segundos;
+    energia.carga_mas[m] += segundos * corrientes[m];
+}
+
+static void cambiarModo(ModoRadioSim nuevo)
+{
+    unsigned long ahora = micros();
+    cobrar(modo, (ahora - modo_desde) / 1e6);
+    if (nuevo == SIM_RX && modo != SIM_RX) rx_desde = ahora; // si ya escuchaba sigue desde antes
+    modo = nuevo;
+    modo_desde = ahora;
+}
+
+ModoRadioSim simModo() { return modo; }
+long simPreambuloUltimaTx() { return preambulo_tx; }
+int simLargoImplicito() { return largo_implicito; }
+bool simImplicitaUltimaTx() { return implicita_ultima_tx; }
+long simFrecuencia() { return frecuencia_radio; }
+long simFrecuenciaUltimaTx() { return frecuencia_tx; }
+
+void simEnergia(EnergiaSim *e)
+{
+    *e = energia;
+    double en_curso = (micros() - modo_desde) / 1e6;
+    e->tiempo_s[modo] += en_curso;
+    e->carga_mas[modo] += en_curso * corrientes[modo];
+}
+
+void simReiniciarEnergia()
+{
+    memset(&energia, 0, sizeof(energia));
+    modo_desde = micros();
+}
+
+void simTramaEntrante(const uint8_t *datos, int largo, unsigned long preambulo_us, unsigned long aire_us,
+                      int rssi, int8_t snr_cuartos, long frecuencia)
+{
+    memcpy(entrante.datos, datos, largo);
+    entrante.largo = largo;
+    entrante.rssi = rssi;
+    entrante.snr = snr_cuartos;
+    entrante.frecuencia = frecuencia;
+    entrante.inicio = micros();
+    entrante.fin_preambulo = entrante.inicio + preambulo_us;
+    entrante.fin = entrante.inicio + aire_us;
+    entrante.activa = true;
+}
+
+int simAtenderRadio()
+{
+    if (!entrante.activa || (long)(micros() - entrante.fin) < 0) return 0;
+    entrante.activa = false;
+    // escuchando sin cortes desde antes de los últimos símbolos del preámbulo
+    long margen = (long)(entrante.fin_preambulo - SIMBOLOS_ENGANCHE_SIM * simboloUs() - rx_desde);
+    if (modo != SIM_RX || margen < 0 || frecuencia_radio != entrante.frecuencia) return -1;
+    simRecibir(entrante.datos, entrante.largo, entrante.rssi, entrante.snr);
+    return 1;
+}
+
+void simRecibir(const uint8_t *datos, int largo, int rssi, int8_t snr_cuartos)
+{
+    memcpy(fifo, datos, largo);
+    rssi_pkt = rssi;
+    snr_pkt = snr_cuartos;
+    if (callback_rx)
+        callback_rx(largo);
+}
+
+int simTransmitidas() { return transmitidas; }
+void simCanalOcupadoHasta(unsigned long instante_us) { ocupado_hasta = instante_us; }
+int simCADs() { return cads; }
+bool simTransmitiendo() { return en_aire; }
+
+void simTasa(int *sf, long *bw)
+{
+    *sf = sf_radio;
+    *bw = bw_radio;
+}
+
+void simTasaUltimaTx(int *sf, long *bw)
+{
+    *sf = sf_tx;
+    *bw = bw_tx;
+}
+
+void simTasaUltimoCAD(int *sf, long *bw)
+{
+    *sf = sf_cad;
+    *bw = bw_cad;
+}
+
+void simTerminarTransmision()
+{
+    en_aire = false;
+    cambiarModo(SIM_STANDBY);
+    if (callback_tx)
+        callback_tx();
+}
+
+LoRaClass::LoRaClass() : _spi(&SPI), _onReceive(NULL), _onTxDone(NULL) {}
+int LoRaClass::begin(long frequency)
+{
+    _frequency = frequency;
+    frecuencia_radio = frequency;
+    return 1;
+}
+void LoRaClass::end() {}
+int LoRaClass::beginPacket(int implicitHeader)
+{
+    if (en_aire)
+        return 0;
+    implicita_tx = implicitHeader;
+    return 1;
+}
+
+int LoRaClass::endPacket(bool async)
+{
+    transmitidas++;
+    en_aire = async;
+    sf_tx = sf_radio;
+    bw_tx = bw_radio;
+    preambulo_tx = preambulo_radio;
+    frecuencia_tx = frecuencia_radio;
+    implicita_ultima_tx = implicita_tx;
+    cambiarModo(async ? SIM_TX : SIM_STANDBY);
+    return 1;
+}
+
+int LoRaClass::packetRssi() { return rssi_pkt; }
+float LoRaClass::packetSnr() { return snr_pkt * 0.25f; }
+int8_t LoRaClass::packetSnrRaw() { return snr_pkt; }
+long LoRaClass::packetFrequencyError() { return 0; }
+int32_t LoRaClass::packetFrequencyErrorRaw() { return 0; }
+uint32_t LoRaClass::crcErrors() { return 0; }
+void LoRaClass::readPayload(uint8_t *buffer, uint8_t size) { memcpy(buffer, fifo, size); }
+size_t LoRaClass::write(uint8_t) { return 1; }
+size_t LoRaClass::write(const uint8_t *, size_t size) { return size; }
+int LoRaClass::available() { return 0; }
+int LoRaClass::read() { return -1; }
+int LoRaClass::peek() { return -1; }
+void LoRaClass::flush() {}
+void LoRaClass::onReceive(void (*callback)(int)) { callback_rx = callback; }
+void LoRaClass::onTxDone(void (*callback)()) { callback_tx = callback; }
+void LoRaClass::onCadDone(void (*callback)(bool)) { callback_cad = callback; }
+void LoRaClass::receive(int size)
+{
+    largo_implicito = size;
+    cambiarModo(SIM_RX);
+}
+
+void LoRaClass::CAD()
+{
+    // el CAD es instantáneo en el reloj simulado pero se cobra su duración
+    cambiarModo(SIM_STANDBY);
+    cobrar(SIM_CAD, SIMBOLOS_CAD_SIM * simboloUs() / 1e6);
+    cads++;
+    sf_cad = sf_radio;
+    bw_cad = bw_radio;
+    bool preambulo = entrante.activa && (long)(micros() - entrante.fin_preambulo) < 0 &&
+                     entrante.frecuencia == frecuencia_radio;
+    if (callback_cad)
+        callback_cad(micros() < ocupado_hasta || preambulo);
+}
+
+byte LoRaClass::random() { return rand() & 0xff; }
+void LoRaClass::idle() { cambiarModo(SIM_STANDBY); }
+void LoRaClass::sleep() { cambiarModo(SIM_SUENO); }
+void LoRaClass::setTxPower(int, int) {}
+void LoRaClass::setFrequency(long frequency)
+{
+    if (frequency != frecuencia_radio && modo == SIM_RX)
+        rx_desde = micros(); // la recepción vuelve a engancharse en el canal nuevo
+    frecuencia_radio = frequency;
+}
+void LoRaClass::setSpreadingFactor(int sf) { sf_radio = sf; }
+void LoRaClass::setSignalBandwidth(long bw) { bw_radio = bw; }
+void LoRaClass::setCodingRate4(int) {}
+void LoRaClass::setPreambleLength(long length) { preambulo_radio = length; }
+void LoRaClass::enableCrc() {}
@@ -0,0 +1,63 @@
+#ifndef LORA_STUB_H
+#define LORA_STUB_H
+
+#include <stdint.h>
+
+/*
+    Radio simulada para compilar red.cpp en Linux. simRecibir deja una
+    trama en la "FIFO" y llama al callback de onReceive tal como lo haría
+    la interrupción DIO0; simTransmitidas cuenta los endPacket y
+    simTerminarTransmision dispara TX_DONE de una transmisión asíncrona.
+    El CAD responde al instante según simCanalOcupadoHasta. simTasa
+    devuelve el SF/BW configurado en la radio, simTasaUltimaTx el de la
+    última trama transmitida y simTasaUltimoCAD el del último CAD; simLargoImplicito el largo con que recibe en
+    cabecera implícita (0 = explícita) y simImplicitaUltimaTx si la última
+    trama salió con cabecera implícita. simFrecuencia y simFrecuenciaUltimaTx
+    dan el canal sintonizado y el de la última trama.
+
+    Para la escucha de bajo consumo la radio lleva el modo en que está
+    (sueño, standby, RX, CAD, TX) y acumula la carga con las corrientes
+    de la hoja de datos del SX1276 sobre el reloj simulado. simTramaEntrante
+    pone una trama en el aire con su preámbulo: el CAD la ve mientras dura
+    el preámbulo y simAtenderRadio la entrega al terminar sólo si la radio
+    entró en RX a tiempo para engancharse y siguió escuchando. La trama va
+    en una frecuencia: el CAD y la recepción sólo la ven sintonizados en ella.
+*/
+void simRecibir(const uint8_t *datos, int largo, int rssi, int8_t snr_cuartos);
+int simTransmitidas();
+bool simTransmitiendo();
+void simTerminarTransmision();
+void simCanalOcupadoHasta(unsigned long instante_us); // ~0UL: siempre ocupado
+int simCADs();
+void simTasa(int *sf, long *bw);
+void simTasaUltimaTx(int *sf, long *bw);
+void simTasaUltimoCAD(int *sf, long *bw);
+long simPreambuloUltimaTx();
+int simLargoImplicito();
+bool simImplicitaUltimaTx();
+long simFrecuencia();
+long simFrecuenciaUltimaTx();
+
+enum ModoRadioSim { SIM_SUENO, SIM_STANDBY, SIM_RX, SIM_CAD, SIM_TX, SIM_MODOS };
+// Corrientes en mA (SX1276, 915 MHz, LnaBoost; TX con PA_BOOST a +17 dBm)
+#define CORRIENTE_SUENO_MA 0.0002
+#define CORRIENTE_STANDBY_MA 1.6
+#define CORRIENTE_RX_MA 11.5
+#define CORRIENTE_CAD_MA 11.5
+#define CORRIENTE_TX_MA 87.0
+#define SIMBOLOS_CAD_SIM 2       // duración de un CAD
+#define SIMBOLOS_ENGANCHE_SIM 4  // preámbulo que necesita la recepción para engancharse
+
+struct EnergiaSim {
+    double carga_mas[SIM_MODOS];   // mA·s por modo
+    double tiempo_s[SIM_MODOS];    // tiempo por modo (el CAD se cobra aunque sea instantáneo)
+};
+ModoRadioSim simModo();
+void simEnergia(EnergiaSim *e);    // incluye el tramo en curso
+void simReiniciarEnergia();
+// preambulo_us: desde el inicio hasta el fin del preámbulo; aire_us: trama completa
+void simTramaEntrante(const uint8_t *datos, int largo, unsigned long preambulo_us, unsigned long aire_us,
+                      int rssi, int8_t snr_cuartos, long frecuencia = 915E6);
+int simAtenderRadio();             // 1 entregada, -1 perdida, 0 nada que resolver
+
+#endif
@@ -0,0 +1,112 @@
+/*
+    Verificación en Linux del lote de comandos (lote.h): ida y vuelta
+    entre el escritor y el lector, encadenamiento de datos de más de 63
+    bytes y rechazo de lotes mal formados o con el FCS errado. Al final
+    se compara lo que cuesta por la UART un guión de comandos enviado
+    uno por trama contra el mismo guión en un lote.
+
+    Uso: make bin/lote_comandos && ./bin/lote_comandos
+*/
+#include "lote.h"
+#include <cstdio>
+#include <cstring>
+#include "verificar.h"
+
+#define CABECERA_IPV4 11
+#define SLIP_FIN      2     // END al inicio y al final de cada trama
+#define BAUDIOS       115200
+
+// Bytes por la UART de una trama con estos datos (sin contar escapes SLIP)
+static int bytesTrama(int datos) {
+    return CABECERA_IPV4 + datos + SLIP_FIN;
+}
+
+int main() {
+    uint8_t lote[MAX_LOTE];
+    uint8_t dato[MAX_DATO_ENCADENADO];
+    uint8_t cmd;
+    EscritorLote escritor;
+    LectorLote lector;
+
+    // Ida y vuelta con un comando sin datos y otro con datos
+    escritor.begin(lote, sizeof(lote));
+    const uint8_t texto[] = "hola";
+    VERIFICAR(escritor.agregar(6, NULL, 0));
+    VERIFICAR(escritor.agregar(7, texto, 4));
+    VERIFICAR(escritor.comandos() == 2);
+    int largo = escritor.cerrar();
+    VERIFICAR(largo == 2 + 2 + 6 + 1 && lote[0] == CMD_LOTE && lote[1] == 2);
+    VERIFICAR(lector.begin(lote, largo));
+    VERIFICAR(lector.siguiente(&cmd, dato) == 0 && cmd == 6);
+    VERIFICAR(lector.siguiente(&cmd, dato) == 4 && cmd == 7 && memcmp(dato, "hola", 4) == 0);
+    VERIFICAR(lector.siguiente(&cmd, dato) == -1);
+
+    // Encadenado: 150 bytes van en tres tramos y vuelven unidos
+    uint8_t largo_texto[150];
+    for (int i = 0; i < 150; i++) largo_texto[i] = 'a' + i % 26;
+    escritor.begin(lote, sizeof(lote));
+    VERIFICAR(escritor.agregar(7, largo_texto, 150));
+    VERIFICAR(escritor.agregar(5, NULL, 0));
+    largo = escritor.cerrar();
+    VERIFICAR(lote[1] == 4 && escritor.comandos() == 2);
+    VERIFICAR(lote[2] == (7 | CMD_CONTINUA) && lote[3] == MAX_DATO_COMANDO);
+    VERIFICAR(EscritorLote::espacio(150) == 156 && EscritorLote::espacio(0) == 2 && EscritorLote::espacio(63) == 65);
+    VERIFICAR(lector.begin(lote, largo));
+    VERIFICAR(lector.siguiente(&cmd, dato) == 150 && cmd == 7 && memcmp(dato, largo_texto, 150) == 0);
+    VERIFICAR(lector.siguiente(&cmd, dato) == 0 && cmd == 5);
+    VERIFICAR(lector.siguiente(&cmd, dato) == -1);
+
+    // Lo que no cabe no cambia el lote
+    escritor.begin(lote, 20);
+    VERIFICAR(escritor.agregar(7, texto, 4));
+    VERIFICAR(!escritor.agregar(7, largo_texto, 30));
+    VERIFICAR(!escritor.agregar(7, largo_texto, MAX_DATO_ENCADENADO + 1));
+    VERIFICAR(escritor.comandos() == 1 && lote[1] == 1);
+    VERIFICAR(lector.begin(lote, escritor.cerrar()));
+
+    // Mal formados: no se ejecuta nada
+    escritor.begin(lote, sizeof(lote));
+    escritor.agregar(7, largo_texto, 100);
+    escritor.agregar(6, NULL, 0);
+    largo = escritor.cerrar();
+    uint8_t copia[MAX_LOTE];
+    memcpy(copia, lote, largo);
+    copia[5] ^= 0x01;
+    VERIFICAR(!lector.begin(copia, largo));                       // FCS
+    VERIFICAR(!lector.begin(lote, largo - 1));                    // cortado
+    VERIFICAR(!lector.begin(lote, 2));
+    memcpy(copia, lote, largo);
+    copia[0] = 7;
+    copia[largo - 1] ^= 7 ^ CMD_LOTE;
+    VERIFICAR(!lector.begin(copia, largo));                       // no es un lote
+    memcpy(copia, lote, largo);
+    copia[1]++;
+    copia[largo - 1] ^= lote[1] ^ copia[1];
+    VERIFICAR(!lector.begin(copia, largo));                       // faltan tramos
+    memcpy(copia, lote, largo);
+    copia[2 + 2 + MAX_DATO_COMANDO] = 6;                          // la cadena cambia de comando
+    copia[largo - 1] ^= 7 ^ 6;
+    VERIFICAR(!lector.begin(copia, largo));
+    const uint8_t abierto[] = {CMD_LOTE, 1, 7 | CMD_CONTINUA, 1, 'x', CMD_LOTE ^ 1 ^ (7 | CMD_CONTINUA) ^ 1 ^ 'x'};
+    VERIFICAR(!lector.begin(abierto, sizeof(abierto)));           // cadena sin cerrar
+    const uint8_t largo_tramo[] = {CMD_LOTE, 1, 7, 64};
+    VERIFICAR(!lector.begin(largo_tramo, sizeof(largo_tramo)));
+    VERIFICAR(lector.siguiente(&cmd, dato) == -1);
+
+    // Guión: prueba, LED, texto, LED, telemetría, grupos
+    struct { uint8_t cmd; int largo; } guion[] = {{5, 0}, {6, 0}, {7, 40}, {6, 0}, {8, 1}, {13, 3}};
+    int cantidad = sizeof(guion) / sizeof(guion[0]);
+    int bytes_sueltos = 0;
+    escritor.begin(lote, sizeof(lote));
+    for (int i = 0; i < cantidad; i++) {
+        bytes_sueltos += bytesTrama(2 + guion[i].largo);
+        VERIFICAR(escritor.agregar(guion[i].cmd, largo_texto, guion[i].largo));
+    }
+    int bytes_lote = bytesTrama(escritor.cerrar());
+    printf("lote: %d comandos en %d tramas y %d bytes por la UART (%.2f ms), en lote 1 trama y %d bytes (%.2f ms)\n",
+           cantidad, cantidad, bytes_sueltos, bytes_sueltos * 10000.0 / BAUDIOS, bytes_lote,
+           bytes_lote * 10000.0 / BAUDIOS);
+    VERIFICAR(bytes_lote < bytes_sueltos);
+
+    return terminar();
+}
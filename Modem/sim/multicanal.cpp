@@ -0,0 +1,240 @@
+/*
+    Verificación en Linux de la operación en varios canales de red.cpp.
+
+    1) Red.cpp con la radio simulada: el canal propio sale de la
+       dirección, la recepción alterna CAD entre el canal propio y el de
+       encuentro, quien transmite sintoniza el canal de la trama y vuelve
+       al propio. Llegan tramas en instantes aleatorios en el canal propio,
+       en el de encuentro y en el de otro nodo.
+    2) Capacidad: nodos al alcance de todos con tráfico unicast al azar,
+       CSMA con CAD en el canal del receptor y half-duplex. Se compara el
+       throughput entregado con 1, 2, 4 y 8 canales.
+
+    Uso: make bin/multicanal && ./bin/multicanal
+*/
+#include "red.h"
+#include "lora_stub.h"
+#include <vector>
+#include "verificar.h"
+
+#define PASO_US 200
+#define LARGO 32
+#define MI_IP 0x6
+
+struct Banco {
+    Red &red;
+    unsigned long fin_aire;
+    int entregadas, perdidas;
+
+    Banco(Red &r) : red(r), fin_aire(0), entregadas(0), perdidas(0) {}
+
+    // Trama de un vecino en un canal, con el preámbulo de esta red
+    void entrante(uint8_t canal) {
+        static uint8_t dato[LARGO] = {0x45};
+        uint32_t simbolo = red.tiempoSimboloUs();
+        long preambulo = red.preambuloSimbolos();
+        unsigned long preambulo_us = (unsigned long)(preambulo * simbolo + 4.25 * simbolo);
+        simTramaEntrante(dato, LARGO, preambulo_us, red.tiempoAireUs(LARGO), -80, 20, Red::frecuenciaCanal(canal));
+    }
+
+    void correr(unsigned long duracion_us) {
+        unsigned long fin = micros() + duracion_us;
+        BYTE buffer[TAM_DATOS_LORA];
+        int previas = simTransmitidas();
+        while ((long)(fin - micros()) > 0) {
+            red.atender();
+            if (simTransmitidas() != previas) {
+                previas = simTransmitidas();
+                fin_aire = micros() + red.tiempoAireUs(LARGO);
+            }
+            if (simTransmitiendo() && (long)(micros() - fin_aire) >= 0) {
+                simTerminarTransmision();
+                red.atender();
+            }
+            int r = simAtenderRadio();
+            if (r > 0) entregadas++;
+            else if (r < 0) perdidas++;
+            while (red.dataDisponible()) red.getData(buffer, sizeof(buffer));
+            simAvanzarUs(PASO_US);
+        }
+    }
+};
+
+// Veinte tramas en instantes aleatorios en un canal
+static int recibir(Red &red, uint8_t canal) {
+    Banco banco(red);
+    for (int i = 0; i < 20; i++) {
+        banco.entrante(canal);
+        banco.correr(300000UL + (unsigned long)random(200000));
+    }
+    return banco.entregadas;
+}
+
+static void pruebaRed() {
+    Red red;
+    red.begin(7, 125E3, 1, 2);
+    randomSeed(45);
+
+    // Un solo canal: todo en 915 MHz y recepción continua
+    red.setCanales(1, MI_IP);
+    VERIFICAR(red.canalPropio() == CANAL_ENCUENTRO && red.canalDe(0x1) == CANAL_ENCUENTRO);
+    VERIFICAR(red.preambuloSimbolos() == PREAMBLE_LENGTH && simFrecuencia() == (long)FRECUENCIA_ENCUENTRO);
+    uint8_t dato[LARGO] = {0};
+    VERIFICAR(!red.transmite_data(dato, LARGO, true, 0, 0, 0, 1));
+
+    // Cuatro canales: direcciones consecutivas en canales distintos
+    red.setCanales(4, MI_IP);
+    VERIFICAR(red.canalPropio() == 2 && red.canalDe(0x5) == 1 && red.canalDe(0x7) == 3 && red.canalDe(0x8) == 0);
+    VERIFICAR(Red::frecuenciaCanal(2) == (long)(FRECUENCIA_ENCUENTRO + 2 * SEPARACION_CANALES));
+    // el preámbulo cubre la vuelta de dos CAD
+    VERIFICAR(red.preambuloSimbolos() == PREAMBLE_LENGTH + 4);
+    VERIFICAR(!red.transmite_data(dato, LARGO, true, 0, 0, 0, 4));
+
+    // Sin transmitir alterna CAD en el canal propio y el de encuentro y
+    // entre vueltas recibe en el propio
+    Banco banco(red);
+    int cads = simCADs();
+    banco.correr(100000);
+    VERIFICAR(simCADs() - cads > 100);
+    VERIFICAR(simFrecuencia() == Red::frecuenciaCanal(2) || simFrecuencia() == (long)FRECUENCIA_ENCUENTRO);
+    printf("barrido de 2 canales: %d CAD en 100 ms\n", simCADs() - cads);
+
+    // Unicast al canal del receptor y broadcast al de encuentro; al terminar vuelve al propio
+    red.transmite_data(dato, LARGO, true, 0, 0, 0, red.canalDe(0x7));
+    banco.correr(500000);
+    VERIFICAR(simFrecuenciaUltimaTx() == Red::frecuenciaCanal(3) && simPreambuloUltimaTx() == PREAMBLE_LENGTH + 4);
+    VERIFICAR(red.estadisticasTx().otro_canal == 1);
+    red.transmite_data(dato, LARGO);
+    banco.correr(500000);
+    VERIFICAR(simFrecuenciaUltimaTx() == (long)FRECUENCIA_ENCUENTRO && red.estadisticasTx().otro_canal == 1);
+    VERIFICAR(simTransmitidas() == 2);
+
+    // Recepción: lo del canal propio y el de encuentro llega, lo de otro canal no
+    const EstadisticasEscucha &est = red.estadisticasEscucha();
+    int propio = recibir(red, 2);
+    uint32_t en_encuentro = est.detecciones_encuentro;
+    int encuentro = recibir(red, CANAL_ENCUENTRO);
+    int ajeno = recibir(red, 1);
+    printf("recibidas de 20: canal propio %d, encuentro %d, canal de otro nodo %d\n", propio, encuentro, ajeno);
+    VERIFICAR(propio == 20 && encuentro == 20 && ajeno == 0);
+    VERIFICAR(est.detecciones_encuentro == en_encuentro + 20);
+
+    // Con escucha de bajo consumo el muestreo revisa los dos canales al despertar
+    red.setEscuchaBajoConsumo(200);
+    VERIFICAR(red.preambuloSimbolos() > 200000 / (long)red.tiempoSimboloUs() + 4);
+    propio = recibir(red, 2);
+    encuentro = recibir(red, CANAL_ENCUENTRO);
+    VERIFICAR(propio == 20 && encuentro == 20);
+    red.setEscuchaBajoConsumo(0);
+
+    // Volver a un solo canal
+    red.setCanales(1, MI_IP);
+    VERIFICAR(simFrecuencia() == (long)FRECUENCIA_ENCUENTRO && simModo() == SIM_RX);
+    VERIFICAR(red.preambuloSimbolos() == PREAMBLE_LENGTH);
+}
+
+/*
+    Capacidad: NODOS nodos que se escuchan entre todos, cada uno con una
+    cola que se llena con tramas a destinos al azar (carga ofrecida mayor
+    que lo que cabe en un canal). Pasos de un símbolo; backoff binario
+    exponencial en ranuras de SIMBOLOS_POR_RANURA y CAD en el canal del
+    destino. La trama llega si nadie más transmitió en su canal mientras
+    duraba y el receptor no estuvo transmitiendo: con un solo canal el
+    CAD también lo evita, con varios no (el receptor transmite en el canal
+    de otro), así que la entrega baja a medida que sube la carga por nodo.
+*/
+#define NODOS 64
+#define DURACION_SIMBOLOS 600000
+#define CARGA_POR_NODO 0.002 // tramas por símbolo y nodo
+
+struct NodoSim {
+    int cola;
+    long espera;          // símbolos de backoff que faltan, -1 sin trama en curso
+    int intentos;
+    long fin_tx;          // símbolo en que termina su transmisión (0 = no transmite)
+    int destino;
+    bool arruinada;
+};
+
+static double capacidad(Red &red, int canales, double *entrega) {
+    red.setCanales(canales, 0);
+    long aire = (red.tiempoAireUs(LARGO) + red.tiempoSimboloUs() - 1) / red.tiempoSimboloUs();
+    std::vector<NodoSim> n(NODOS);
+    for (int i = 0; i < NODOS; i++) {
+        n[i].cola = 0;
+        n[i].espera = -1;
+        n[i].intentos = 0;
+        n[i].fin_tx = 0;
+    }
+    long ofrecidas = 0, entregadas = 0;
+    for (long t = 1; t < DURACION_SIMBOLOS; t++) {
+        // fin de transmisiones
+        for (int i = 0; i < NODOS; i++) {
+            if (n[i].fin_tx != t) continue;
+            n[i].fin_tx = 0;
+            if (!n[i].arruinada) entregadas++;
+            n[i].cola--;
+            n[i].espera = -1;
+        }
+        for (int i = 0; i < NODOS; i++) {
+            if (n[i].cola < SLOTS_TX && drand48() < CARGA_POR_NODO) {
+                n[i].cola++;
+                ofrecidas++;
+            }
+            if (n[i].fin_tx || n[i].cola == 0) continue;
+            if (n[i].espera < 0) {
+                n[i].destino = (i + 1 + lrand48() % (NODOS - 1)) % NODOS;
+                n[i].intentos = 0;
+                n[i].espera = lrand48() % VENTANA_MIN_RANURAS * SIMBOLOS_POR_RANURA;
+            }
+            if (n[i].espera-- > 0) continue;
+            // CAD en el canal del destino
+            int canal = red.canalDe(n[i].destino);
+            bool ocupado = false;
+            for (int j = 0; j < NODOS && !ocupado; j++)
+                ocupado = n[j].fin_tx && red.canalDe(n[j].destino) == canal;
+            if (ocupado) {
+                int exp = ++n[i].intentos < VENTANA_MAX_EXP ? n[i].intentos : VENTANA_MAX_EXP;
+                n[i].espera = lrand48() % ((long)VENTANA_MIN_RANURAS << exp) * SIMBOLOS_POR_RANURA;
+                continue;
+            }
+            n[i].fin_tx = t + aire;
+            // el receptor no puede estar transmitiendo
+            n[i].arruinada = n[n[i].destino].fin_tx != 0;
+        }
+        // colisiones y receptores que empiezan a transmitir
+        for (int i = 0; i < NODOS; i++) {
+            if (!n[i].fin_tx || n[i].arruinada) continue;
+            int canal = red.canalDe(n[i].destino);
+            for (int j = 0; j < NODOS; j++) {
+                if (j == i || !n[j].fin_tx) continue;
+                if (red.canalDe(n[j].destino) == canal || j == n[i].destino) n[i].arruinada = true;
+            }
+        }
+    }
+    *entrega = (double)entregadas / ofrecidas;
+    return entregadas / (DURACION_SIMBOLOS * red.tiempoSimboloUs() / 1e6);
+}
+
+int main() {
+    pruebaRed();
+
+    srand48(45);
+    static const int canales[] = {1, 2, 4, 8};
+    double throughput[4], entrega[4];
+    Red red;
+    red.begin(7, 125E3, 1, 2);
+    printf("\n%d nodos, carga ofrecida %.1f tramas/s de %d bytes, SF7/125 kHz\n", NODOS,
+           NODOS * CARGA_POR_NODO * 1e6 / red.tiempoSimboloUs(), LARGO);
+    printf("canales  preámbulo  tramas/s  entrega\n");
+    for (int k = 0; k < 4; k++) {
+        throughput[k] = capacidad(red, canales[k], &entrega[k]);
+        printf("%7d  %5ld sím  %8.1f  %6.1f%%\n", canales[k], red.preambuloSimbolos(), throughput[k],
+               100 * entrega[k]);
+    }
+    VERIFICAR(throughput[1] > 1.6 * throughput[0]);
+    VERIFICAR(throughput[2] > 3 * throughput[0]);
+    VERIFICAR(throughput[3] > throughput[2]);
+
+    return terminar();
+}
@@ -0,0 +1,120 @@
+/*
+    Verificación en Linux del refresco parcial del OLED (pantalla.h): se
+    dibuja con la API de Adafruit_GFX sobre el SSD1306 simulado y se
+    cuentan los bytes que pasan por el I2C con Wire simulado, que además
+    mantiene la GDDRAM del controlador. Después de cada refresco la
+    GDDRAM debe ser igual al framebuffer.
+
+    Uso: make bin/oled_parcial && ./bin/oled_parcial
+*/
+#include "pantalla.h"
+
+TwoWire Wire;
+
+#include "verificar.h"
+
+#define TAM_BUFFER (ANCHO_PANTALLA * PAGINAS_PANTALLA)
+#define PRUEBAS_AZAR 2000
+
+static bool igualAPantalla(Adafruit_SSD1306 &display) {
+    return memcmp(Wire.gddram, display.getBuffer(), TAM_BUFFER) == 0;
+}
+
+// Mismo texto que dibuja mostrarEnOLED en el modem
+static void texto(Adafruit_SSD1306 &display, const char *mensaje) {
+    display.clearDisplay();
+    display.setCursor(0, 0);
+    display.setTextSize(1);
+    display.setTextColor(SSD1306_WHITE);
+    display.print(mensaje);
+}
+
+int main() {
+    Adafruit_SSD1306 display(128, 64, &Wire, -1);
+    Pantalla pantalla(display, &Wire);
+    display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+    pantalla.begin();
+
+    // Costo de referencia: display() de la biblioteca
+    texto(display, "Modem LoRa\nIP: 0x3\nListo");
+    Wire.simReiniciar();
+    display.display();
+    uint32_t completo = Wire.bytes;
+    VERIFICAR(Wire.bytes_datos == TAM_BUFFER && igualAPantalla(display));
+
+    // El primer refresco no conoce la pantalla: la envía completa
+    Wire.simReiniciar();
+    uint32_t n = pantalla.refrescar();
+    VERIFICAR(n == Wire.bytes && Wire.bytes_datos == TAM_BUFFER && igualAPantalla(display));
+    VERIFICAR(n <= completo);
+
+    // Sin cambios no se envía nada
+    Wire.bytes = Wire.bytes_datos = 0;
+    VERIFICAR(pantalla.refrescar() == 0 && Wire.bytes == 0);
+
+    // Un pixel: una ventana con un byte de datos
+    display.drawPixel(70, 40, SSD1306_WHITE);
+    Wire.bytes = Wire.bytes_datos = 0;
+    n = pantalla.refrescar();
+    VERIFICAR(Wire.bytes_datos == 1 && n == Wire.bytes && igualAPantalla(display));
+    printf("un pixel: %u bytes en el bus (display(): %u)\n", (unsigned)n, (unsigned)completo);
+
+    // Cambia un carácter de una línea: sólo esa celda
+    texto(display, "Modem LoRa\nIP: 0x3\nListo");
+    pantalla.refrescar();
+    texto(display, "Modem LoRa\nIP: 0x4\nListo");
+    Wire.bytes = Wire.bytes_datos = 0;
+    n = pantalla.refrescar();
+    VERIFICAR(Wire.bytes_datos > 0 && Wire.bytes_datos <= 6 && igualAPantalla(display));
+    printf("un carácter: %u bytes en el bus\n", (unsigned)n);
+
+    // Un mensaje nuevo de tres líneas: bastante menos que la pantalla completa
+    texto(display, "RX 0x5 -> 0x3\nRSSI -97 SNR 6.5\n12 bytes");
+    Wire.bytes = Wire.bytes_datos = 0;
+    n = pantalla.refrescar();
+    VERIFICAR(igualAPantalla(display) && n < completo / 2);
+    printf("mensaje de 3 líneas: %u bytes en el bus (%.0f%% de display())\n", (unsigned)n, 100.0 * n / completo);
+
+    // Tras invalidar, de nuevo completa
+    pantalla.invalidar();
+    Wire.bytes = Wire.bytes_datos = 0;
+    pantalla.refrescar();
+    VERIFICAR(Wire.bytes_datos == TAM_BUFFER && igualAPantalla(display));
+
+    // Cambios al azar (pixeles, rectángulos, texto) contra la GDDRAM simulada
+    srand(1);
+    uint32_t parcial = 0;
+    for (int i = 0; i < PRUEBAS_AZAR; i++) {
+        switch (rand() % 3) {
+        case 0:
+            for (int k = rand() % 20; k >= 0; k--)
+                display.drawPixel(rand() % 128, rand() % 64, rand() % 3);
+            break;
+        case 1:
+            display.fillRect(rand() % 128, rand() % 64, rand() % 40, rand() % 20, rand() % 2);
+            break;
+        default:
+            display.setCursor(rand() % 128, rand() % 64);
+            display.setTextColor(SSD1306_WHITE, SSD1306_BLACK);
+            display.print(rand() % 1000);
+            break;
+        }
+        uint32_t previos = Wire.bytes;
+        n = pantalla.refrescar();
+        VERIFICAR(n == Wire.bytes - previos);
+        parcial += n;
+        if (!igualAPantalla(display)) {
+            printf("FALLA: GDDRAM distinta tras el cambio %d\n", i);
+            fallas++;
+            break;
+        }
+    }
+    printf("%d cambios al azar: %.0f bytes por refresco (display(): %u)\n", PRUEBAS_AZAR,
+           (double)parcial / PRUEBAS_AZAR, (unsigned)completo);
+    VERIFICAR(parcial < (uint32_t)PRUEBAS_AZAR * completo / 4);
+
+    const EstadisticasPantalla &est = pantalla.estadisticas();
+    VERIFICAR(est.sin_cambios >= 1 && est.bytes_datos > 0);
+
+    return terminar();
+}
@@ -0,0 +1,64 @@
+/*
+    Verificación en Linux de las estadísticas por protocolo del despacho
+    de la UART (protocolos.h): tramas, tiempo medio y máximo por número
+    de protocolo, los números altos juntos en PROTOCOLO_OTROS, saturación
+    de los tiempos en 16 bits y la respuesta a CMD_PROTOCOLOS por páginas
+    hasta recorrer todos los protocolos con tramas.
+
+    Uso: make bin/protocolos_despacho && ./bin/protocolos_despacho
+*/
+#include "protocolos.h"
+#include <cstdio>
+#include "verificar.h"
+
+static uint32_t leer32(const uint8_t *d) {
+    return ((uint32_t)d[0] << 24) | (d[1] << 16) | (d[2] << 8) | d[3];
+}
+
+int main() {
+    EstadisticasProtocolos e;
+    uint8_t salida[1 + ENTRADA_PROTOCOLO * PROTOCOLOS_POR_RESPUESTA];
+
+    // Sin tramas: una página vacía que no pide otra
+    VERIFICAR(e.serializar(0, salida) == 1 && salida[0] == 0);
+
+    e.registrar(2, 100);
+    e.registrar(2, 300);
+    e.registrar(0, 40);
+    VERIFICAR(e.tramas(2) == 2 && e.usMedio(2) == 200 && e.usMaximo(2) == 300);
+    VERIFICAR(e.tramas(0) == 1 && e.tramas(1) == 0 && e.usMedio(1) == 0);
+
+    // Los números desde MAX_PROTOCOLOS comparten una entrada
+    e.registrar(MAX_PROTOCOLOS, 10);
+    e.registrar(200, 20);
+    VERIFICAR(e.tramas(MAX_PROTOCOLOS) == 2 && e.tramas(255) == 2 && e.usMaximo(200) == 20);
+
+    // Tiempos de más de 16 bits se informan saturados
+    e.registrar(7, 100000);
+    int largo = e.serializar(7, salida);
+    VERIFICAR(largo == 1 + 2 * ENTRADA_PROTOCOLO && salida[0] == 0);
+    VERIFICAR(salida[1] == 7 && leer32(&salida[2]) == 1 && salida[6] == 0xFF && salida[7] == 0xFF);
+    VERIFICAR(salida[10] == PROTOCOLO_OTROS && leer32(&salida[11]) == 2);
+
+    // Todos los protocolos con tramas: se recorren por páginas sin repetir
+    for (int p = 0; p <= PROTOCOLO_OTROS; p++) e.registrar(p, p);
+    int vistos = 0, paginas = 0;
+    uint8_t desde = 0;
+    int anterior = -1;
+    do {
+        largo = e.serializar(desde, salida);
+        int n = (largo - 1) / ENTRADA_PROTOCOLO;
+        VERIFICAR(n <= PROTOCOLOS_POR_RESPUESTA && (largo - 1) % ENTRADA_PROTOCOLO == 0);
+        for (int i = 0; i < n; i++) {
+            VERIFICAR(salida[1 + i * ENTRADA_PROTOCOLO] > anterior);
+            anterior = salida[1 + i * ENTRADA_PROTOCOLO];
+        }
+        vistos += n;
+        paginas++;
+        desde = salida[0];
+    } while (desde != 0 && paginas < 10);
+    printf("protocolos: %d protocolos con tramas en %d páginas de CMD_PROTOCOLOS\n", vistos, paginas);
+    VERIFICAR(vistos == MAX_PROTOCOLOS + 1 && paginas == 3);
+
+    return terminar();
+}
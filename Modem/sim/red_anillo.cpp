@@ -0,0 +1,103 @@
+/*
+    Verificación en Linux del anillo de recepción de red.cpp.
+
+    Se inyectan ráfagas de tramas por la radio simulada sin que el lazo
+    principal las consuma y se comprueba que no se pisan, que getData
+    respeta el tamaño del buffer y que los desbordes quedan contados.
+    También se recorre la cola de transmisión asíncrona.
+
+    Uso: make bin/red_anillo && ./bin/red_anillo
+*/
+#include "red.h"
+#include "lora_stub.h"
+#include "verificar.h"
+
+static void rafaga(int desde, int cantidad) {
+    for (int i = desde; i < desde + cantidad; i++) {
+        uint8_t trama[40];
+        memset(trama, i, sizeof(trama));
+        simAvanzarUs(1000);
+        simRecibir(trama, 10 + i % 20, -40 - i, (int8_t)(4 * i));
+    }
+}
+
+int main() {
+    Red red;
+    red.begin(7, 250E3, 1, 2);
+    uint8_t buffer[TAM_DATOS_LORA];
+    MetadatosEnlace enlace;
+
+    // Ráfaga que cabe en el anillo: todas las tramas intactas y en orden
+    rafaga(0, SLOTS_RX);
+    VERIFICAR(red.tramasPendientes() == SLOTS_RX);
+    uint32_t instante_previo = 0;
+    for (int i = 0; i < SLOTS_RX; i++) {
+        int n = red.getData(buffer, sizeof(buffer), &enlace);
+        VERIFICAR(n == 10 + i % 20);
+        VERIFICAR(buffer[0] == i && buffer[n - 1] == i);
+        VERIFICAR(enlace.rssi == -40 - i);
+        VERIFICAR(enlace.snr_cuartos == 4 * i);
+        VERIFICAR(enlace.instante_us > instante_previo);
+        instante_previo = enlace.instante_us;
+    }
+    VERIFICAR(!red.dataDisponible());
+    VERIFICAR(red.estadisticasRx().desbordes == 0);
+
+    // Ráfaga mayor que el anillo: se conservan las primeras, el resto se cuenta
+    rafaga(100, SLOTS_RX + 3);
+    VERIFICAR(red.estadisticasRx().desbordes == 3);
+    VERIFICAR(red.estadisticasRx().ocupacion_maxima == SLOTS_RX);
+    int n = red.getData(buffer, 4, &enlace); // buffer chico: sólo se copian 4 bytes
+    VERIFICAR(n == 4 && buffer[0] == 100);
+    for (int i = 1; i < SLOTS_RX; i++) {
+        n = red.getData(buffer, sizeof(buffer));
+        VERIFICAR(n > 0 && buffer[0] == 100 + i);
+    }
+    VERIFICAR(red.getData(buffer, sizeof(buffer)) == 0);
+
+    // Los índices dan la vuelta sin perder tramas
+    for (int vuelta = 0; vuelta < 100; vuelta++) {
+        rafaga(vuelta % 50, 3);
+        for (int i = 0; i < 3; i++) {
+            n = red.getData(buffer, sizeof(buffer));
+            VERIFICAR(n > 0 && buffer[0] == vuelta % 50 + i);
+        }
+    }
+
+    // Largos inválidos
+    simRecibir(buffer, 0, 0, 0);
+    VERIFICAR(red.estadisticasRx().largo_invalido == 1);
+    VERIFICAR(!red.dataDisponible());
+
+    // Cola de transmisión: una trama en el aire a la vez, el resto espera TX_DONE
+    uint8_t trama[20] = {0};
+    int aceptadas = 0;
+    for (int i = 0; i < SLOTS_TX + 2; i++) aceptadas += red.transmite_data(trama, sizeof(trama));
+    VERIFICAR(aceptadas == SLOTS_TX);
+    VERIFICAR(red.estadisticasTx().cola_llena == 2);
+    for (int i = 0; i < 1000 && !red.transmitiendo(); i++) {
+        red.atender(); // backoff + CAD
+        simAvanzarUs(100);
+    }
+    VERIFICAR(simTransmitidas() == 1 && red.transmitiendo());
+    red.atender(); // sin TX_DONE no avanza
+    VERIFICAR(simTransmitidas() == 1);
+    rafaga(0, 2); // la recepción sigue atendida mientras hay tramas en cola
+    VERIFICAR(red.getData(buffer, sizeof(buffer)) > 0);
+    VERIFICAR(red.getData(buffer, sizeof(buffer)) > 0);
+    for (int i = 1; i <= SLOTS_TX; i++) {
+        simTerminarTransmision();
+        for (int j = 0; j < 1000 && simTransmitidas() == i && red.tramasEnCola() > 0; j++) {
+            red.atender();
+            simAvanzarUs(100);
+        }
+        VERIFICAR(simTransmitidas() == (i < SLOTS_TX ? i + 1 : SLOTS_TX));
+    }
+    VERIFICAR(!red.transmitiendo() && red.tramasEnCola() == 0);
+    VERIFICAR(red.estadisticasTx().transmitidas == SLOTS_TX);
+
+    EstadisticasRx est = red.estadisticasRx();
+    printf("recibidas=%u desbordes=%u largo_invalido=%u ocupacion_maxima=%u\n", (unsigned)est.recibidas,
+           (unsigned)est.desbordes, (unsigned)est.largo_invalido, (unsigned)est.ocupacion_maxima);
+    return terminar();
+}
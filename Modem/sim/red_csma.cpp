@@ -0,0 +1,94 @@
+/*
+    Verificación en Linux del acceso al canal de red.cpp (CAD + backoff
+    binario exponencial) con la radio simulada: el canal se marca ocupado
+    por un intervalo y se observa cuándo sale la trama.
+
+    Uso: make bin/red_csma && ./bin/red_csma
+*/
+#include "red.h"
+#include "lora_stub.h"
+#include "verificar.h"
+
+// Avanza el reloj de a 100 us llamando a atender() hasta que salga una trama
+static long esperarTransmision(Red &red, long limite_us) {
+    int previas = simTransmitidas();
+    unsigned long inicio = micros();
+    while (simTransmitidas() == previas && (long)(micros() - inicio) < limite_us) {
+        red.atender();
+        simAvanzarUs(100);
+    }
+    return simTransmitidas() == previas ? -1 : (long)(micros() - inicio);
+}
+
+static void terminar(Red &red) {
+    simTerminarTransmision();
+    red.atender();
+}
+
+int main() {
+    Red red;
+    red.begin(7, 250E3, 1, 2);
+    uint8_t trama[20] = {0};
+    unsigned long ranura = SIMBOLOS_POR_RANURA * red.tiempoSimboloUs();
+    printf("símbolo %u us, ranura %lu us\n", (unsigned)red.tiempoSimboloUs(), ranura);
+    VERIFICAR(red.tiempoSimboloUs() == 512);
+
+    // Canal libre: sale dentro de la ventana inicial
+    long maximo = 0;
+    for (int i = 0; i < 50; i++) {
+        red.transmite_data(trama, sizeof(trama));
+        long t = esperarTransmision(red, 1000000);
+        VERIFICAR(t >= 0 && t <= (long)(VENTANA_MIN_RANURAS * ranura) + 200);
+        if (t > maximo) maximo = t;
+        terminar(red);
+    }
+    printf("canal libre: espera máxima %ld us\n", maximo);
+    VERIFICAR(red.estadisticasTx().canal_ocupado == 0);
+
+    // Canal ocupado 50 ms: no se transmite antes de que se libere
+    unsigned long libre_desde = micros() + 50000;
+    simCanalOcupadoHasta(libre_desde);
+    red.transmite_data(trama, sizeof(trama));
+    long t = esperarTransmision(red, 2000000);
+    VERIFICAR(t >= 0 && micros() >= libre_desde);
+    printf("canal ocupado 50 ms: transmitió a los %ld us tras %u CAD ocupados\n", t,
+           (unsigned)red.estadisticasTx().canal_ocupado);
+    VERIFICAR(red.estadisticasTx().canal_ocupado > 0);
+    terminar(red);
+
+    // Canal siempre ocupado: se descarta tras MAX_INTENTOS_CAD
+    simCanalOcupadoHasta(~0UL);
+    uint32_t ocupados_previos = red.estadisticasTx().canal_ocupado;
+    int cads_previos = simCADs();
+    red.transmite_data(trama, sizeof(trama));
+    VERIFICAR(esperarTransmision(red, 5000000) < 0);
+    VERIFICAR(red.estadisticasTx().descartadas_canal == 1);
+    VERIFICAR(red.estadisticasTx().canal_ocupado - ocupados_previos == MAX_INTENTOS_CAD + 1);
+    VERIFICAR(simCADs() - cads_previos == MAX_INTENTOS_CAD + 1);
+    VERIFICAR(red.tramasEnCola() == 0);
+    simCanalOcupadoHasta(0);
+
+    // Trama a otra tasa: el CAD escucha en la tasa de la trama, no en la de
+    // recepción, y el backoff se mide en sus símbolos
+    unsigned long ranura_lenta = SIMBOLOS_POR_RANURA * red.tiempoSimboloUs(10, 125E3);
+    libre_desde = micros() + VENTANA_MIN_RANURAS * ranura_lenta + 50000;
+    simCanalOcupadoHasta(libre_desde);
+    ocupados_previos = red.estadisticasTx().canal_ocupado;
+    red.transmite_data(trama, sizeof(trama), true, 10, 125E3);
+    t = esperarTransmision(red, 5000000);
+    int sf;
+    long bw;
+    simTasaUltimoCAD(&sf, &bw);
+    VERIFICAR(t >= 0 && sf == 10 && bw == 125E3);
+    VERIFICAR(red.estadisticasTx().canal_ocupado > ocupados_previos);
+    printf("trama SF10/125 kHz: CAD en SF%d/%ld, transmitió a los %ld us (ranura %lu us)\n", sf, bw, t, ranura_lenta);
+    terminar(red);
+    simTasa(&sf, &bw);
+    VERIFICAR(sf == 7 && bw == 250E3);
+    simCanalOcupadoHasta(0);
+
+    EstadisticasTx est = red.estadisticasTx();
+    printf("transmitidas=%u canal_ocupado=%u descartadas_canal=%u\n", (unsigned)est.transmitidas,
+           (unsigned)est.canal_ocupado, (unsigned)est.descartadas_canal);
+    return terminar();
+}
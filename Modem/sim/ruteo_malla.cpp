@@ -0,0 +1,175 @@
+/*
+    Verificación en Linux del ruteo vector-distancia (ruteo.h) con varios
+    modems simulados: cada ronda todos anuncian su tabla a sus vecinos y
+    vencen las rutas viejas. En una línea y en un anillo se comprueba que
+    las rutas convergen a la distancia mínima; el reenvío de una trama
+    sigue la misma lógica que procesarTramaMalla en Modem.ino, con el
+    límite de SALTOS_MAXIMOS y el descarte de duplicados y lazos de
+    yaVisto. Al cortar un enlace las rutas que pasaban por él se anuncian
+    rotas y desaparecen sin volver a contar hasta el infinito.
+
+    Uso: make bin/ruteo_malla && ./bin/ruteo_malla
+*/
+#include "ruteo.h"
+#include <cstdlib>
+#include "verificar.h"
+
+#define MAX_NODOS 20
+#define RONDAS_MAXIMAS 40
+
+struct Malla {
+    int n;
+    Ruteo nodos[MAX_NODOS];
+    bool enlace[MAX_NODOS][MAX_NODOS];
+    uint32_t ahora_ms;
+
+    explicit Malla(int cantidad) : n(cantidad), ahora_ms(0) {
+        for (int i = 0; i < n; i++) {
+            nodos[i].begin(ip(i));
+            for (int j = 0; j < n; j++) enlace[i][j] = false;
+        }
+    }
+    static uint16_t ip(int i) { return i + 1; }
+    void unir(int a, int b, bool unido = true) { enlace[a][b] = enlace[b][a] = unido; }
+
+    // Un período de anuncios: todos anuncian a la vez (cada anuncio avanza
+    // un salto por ronda) y después vencen las rutas
+    void ronda() {
+        static uint8_t anuncios[MAX_NODOS][MAX_RUTAS * TAM_ENTRADA_ANUNCIO + TAM_ENTRADA_ANUNCIO];
+        int largos[MAX_NODOS];
+        for (int i = 0; i < n; i++) largos[i] = nodos[i].construirAnuncio(anuncios[i], sizeof(anuncios[i]));
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (enlace[i][j]) nodos[j].procesarAnuncio(ip(i), anuncios[i], largos[i], ahora_ms);
+            }
+        }
+        ahora_ms += INTERVALO_ANUNCIO_MS;
+        for (int i = 0; i < n; i++) nodos[i].expirar(ahora_ms);
+    }
+
+    // Métrica de i hacia j, o METRICA_INFINITA sin ruta
+    int metrica(int i, int j) {
+        const Ruta *r = nodos[i].buscar(ip(j));
+        return r != NULL ? r->metrica : METRICA_INFINITA;
+    }
+
+    // Reenvío como procesarTramaMalla: saltos hasta el destino, -1 si se descarta
+    int enviar(int origen, int destino, uint16_t id) {
+        const Ruta *r = nodos[origen].buscar(ip(destino));
+        if (r == NULL) return -1;
+        nodos[origen].yaVisto(ip(origen), id);
+        uint16_t siguiente = r->siguiente;
+        uint8_t saltos = SALTOS_MAXIMOS;
+        for (int dados = 1; dados <= 4 * SALTOS_MAXIMOS; dados++) {
+            int actual = siguiente - 1;
+            if (nodos[actual].yaVisto(ip(origen), id)) return -1; // duplicado o lazo
+            if (actual == destino) return dados;
+            if (saltos <= 1) return -1;
+            r = nodos[actual].buscar(ip(destino));
+            if (r == NULL) return -1;
+            siguiente = r->siguiente;
+            saltos--;
+        }
+        return -1;
+    }
+};
+
+// Rondas hasta que todos tienen la distancia esperada hacia todos
+static int converger(Malla &m, int (*distancia)(int, int, int)) {
+    for (int ronda = 1; ronda <= RONDAS_MAXIMAS; ronda++) {
+        m.ronda();
+        bool listo = true;
+        for (int i = 0; i < m.n && listo; i++) {
+            for (int j = 0; j < m.n && listo; j++) {
+                if (i != j && m.metrica(i, j) != distancia(i, j, m.n)) listo = false;
+            }
+        }
+        if (listo) return ronda;
+    }
+    return -1;
+}
+
+static int distanciaLinea(int i, int j, int) {
+    int d = abs(i - j);
+    return d < METRICA_INFINITA ? d : METRICA_INFINITA;
+}
+
+static int distanciaAnillo(int i, int j, int n) {
+    int d = abs(i - j);
+    return d < n - d ? d : n - d;
+}
+
+int main() {
+    // Línea de 6: converge en tantas rondas como saltos tiene
+    Malla linea(6);
+    for (int i = 0; i + 1 < linea.n; i++) linea.unir(i, i + 1);
+    int rondas_linea = converger(linea, distanciaLinea);
+    VERIFICAR(rondas_linea > 0 && rondas_linea <= linea.n);
+    VERIFICAR(linea.nodos[0].buscar(Malla::ip(5))->siguiente == Malla::ip(1));
+    VERIFICAR(linea.nodos[5].buscar(Malla::ip(0))->siguiente == Malla::ip(4));
+    VERIFICAR(linea.nodos[2].cantidadRutas() == 5);
+    VERIFICAR(linea.enviar(0, 5, 1) == 5);
+
+    // Anillo de 8: la ruta va por el lado más corto
+    Malla anillo(8);
+    for (int i = 0; i < anillo.n; i++) anillo.unir(i, (i + 1) % anillo.n);
+    int rondas_anillo = converger(anillo, distanciaAnillo);
+    VERIFICAR(rondas_anillo > 0);
+    VERIFICAR(anillo.metrica(0, 4) == 4 && anillo.metrica(0, 6) == 2);
+    VERIFICAR(anillo.nodos[0].buscar(Malla::ip(6))->siguiente == Malla::ip(7));
+    VERIFICAR(anillo.enviar(1, 6, 1) == 3);
+
+    // Línea de 18: sin rutas más allá de la métrica infinita y las tramas
+    // mueren a los SALTOS_MAXIMOS saltos
+    Malla larga(18);
+    for (int i = 0; i + 1 < larga.n; i++) larga.unir(i, i + 1);
+    VERIFICAR(converger(larga, distanciaLinea) > 0);
+    VERIFICAR(larga.metrica(0, METRICA_INFINITA - 1) == METRICA_INFINITA - 1);
+    VERIFICAR(larga.nodos[0].buscar(Malla::ip(METRICA_INFINITA)) == NULL);
+    VERIFICAR(larga.enviar(0, SALTOS_MAXIMOS, 1) == SALTOS_MAXIMOS);
+    VERIFICAR(larga.enviar(0, SALTOS_MAXIMOS + 1, 2) == -1);
+
+    // Duplicados: la misma (origen, id) no pasa dos veces por un nodo
+    VERIFICAR(linea.enviar(0, 3, 7) == 3);
+    VERIFICAR(linea.enviar(0, 3, 7) == -1);
+    VERIFICAR(linea.enviar(0, 3, 8) == 3);
+
+    // Lazo de rutas viejas entre A y B hacia un destino que no ven: la
+    // trama pasa por B, vuelve a A, que ya la registró al enviarla, y ahí
+    // se descarta
+    Ruteo a, b;
+    a.begin(1);
+    b.begin(2);
+    const uint8_t desde_b[] = {0, 9, 1, 2};     // B: destino 9 a 1 salto, secuencia 2
+    a.procesarAnuncio(2, desde_b, sizeof(desde_b), 0);
+    const uint8_t desde_a[] = {0, 9, 2, 2};     // A: destino 9 a 2 saltos por B
+    b.procesarAnuncio(1, desde_a, sizeof(desde_a), 0);
+    VERIFICAR(a.buscar(9)->siguiente == 2 && b.buscar(9)->siguiente == 1);
+    a.yaVisto(1, 40);
+    int pasadas = 0;
+    Ruteo *turno[2] = {&b, &a};
+    while (pasadas < 4 * SALTOS_MAXIMOS && !turno[pasadas % 2]->yaVisto(1, 40)) pasadas++;
+    VERIFICAR(pasadas == 1);                    // B la reenvía, A la descarta
+
+    // Corte de un enlace en la línea de 6: las rutas que cruzaban vencen,
+    // se anuncian rotas y no reaparecen
+    linea.unir(2, 3, false);
+    int rondas_corte = 0;
+    while (rondas_corte < RONDAS_MAXIMAS && linea.nodos[0].buscar(Malla::ip(5)) != NULL) {
+        linea.ronda();
+        rondas_corte++;
+    }
+    VERIFICAR(rondas_corte <= (int)(VIDA_RUTA_MS / INTERVALO_ANUNCIO_MS) + 1);
+    for (int r = 0; r < 2 * METRICA_INFINITA; r++) linea.ronda();
+    for (int i = 0; i <= 2; i++) {
+        for (int j = 3; j < linea.n; j++) {
+            VERIFICAR(linea.nodos[i].buscar(Malla::ip(j)) == NULL && linea.nodos[j].buscar(Malla::ip(i)) == NULL);
+        }
+    }
+    VERIFICAR(linea.metrica(0, 2) == 2 && linea.metrica(5, 3) == 2);
+    VERIFICAR(linea.enviar(0, 5, 9) == -1);
+
+    printf("ruteo: línea de 6 en %d rondas, anillo de 8 en %d, rutas cortadas vencen en %d rondas\n", rondas_linea,
+           rondas_anillo, rondas_corte);
+    return terminar();
+}
@@ -0,0 +1,134 @@
+/*
+    Verificación en Linux del entramado SLIP por flujo (slip.h): se
+    codifican tramas aleatorias con escribirSLIP, se concatenan con ruido
+    de entramado y se entregan al decodificador en bloques de tamaño
+    aleatorio, como los entrega el driver de la UART. Cada trama válida
+    debe salir idéntica y cada error contarse una sola vez.
+
+    Uso: make bin/slip_flujo && ./bin/slip_flujo
+*/
+#include "slip.h"
+#include <vector>
+#include "verificar.h"
+
+#define TAM_DESTINO 272
+#define TRAMAS_PRUEBA 5000
+
+// Puerto que acumula lo escrito y cuenta las llamadas a write
+class PuertoMemoria : public Print
+{
+public:
+    std::vector<uint8_t> datos;
+    int escrituras;
+
+    PuertoMemoria() : escrituras(0) {}
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t *b, size_t n)
+    {
+        escrituras++;
+        datos.insert(datos.end(), b, b + n);
+        return n;
+    }
+};
+
+static std::vector<uint8_t> tramaAleatoria(int largo) {
+    std::vector<uint8_t> t(largo);
+    for (int i = 0; i < largo; i++) {
+        // bytes especiales frecuentes para ejercitar los escapes
+        int r = rand() % 16;
+        t[i] = r == 0 ? SLIP_END : r == 1 ? SLIP_ESC : (uint8_t)rand();
+    }
+    return t;
+}
+
+// Entrega 'flujo' en bloques aleatorios y junta las tramas decodificadas
+static void decodificar(DecodificadorSLIP &dec, const std::vector<uint8_t> &flujo,
+                        std::vector<std::vector<uint8_t> > &salida) {
+    uint8_t destino[TAM_DESTINO];
+    dec.setSalida(destino, TAM_DESTINO);
+    size_t pos = 0;
+    while (pos < flujo.size()) {
+        int n = 1 + rand() % 64;
+        if (pos + n > flujo.size()) n = flujo.size() - pos;
+        int base = 0;
+        while (base < n) {
+            int usados;
+            int largo = dec.agregar(&flujo[pos + base], n - base, &usados);
+            base += usados;
+            if (largo > 0) salida.push_back(std::vector<uint8_t>(destino, destino + largo));
+        }
+        pos += n;
+    }
+}
+
+int main() {
+    srand(7);
+
+    // Codificación directa: un write por tramo más los escapes
+    {
+        PuertoMemoria puerto;
+        const uint8_t t[] = {1, 2, SLIP_END, 3, SLIP_ESC, 4, 5};
+        size_t n = escribirSLIP(puerto, t, sizeof(t));
+        const uint8_t esperado[] = {SLIP_END, 1, 2, SLIP_ESC, SLIP_ESC_END, 3, SLIP_ESC, SLIP_ESC_ESC, 4, 5, SLIP_END};
+        VERIFICAR(n == sizeof(esperado));
+        VERIFICAR(puerto.datos.size() == sizeof(esperado) && memcmp(&puerto.datos[0], esperado, sizeof(esperado)) == 0);
+        VERIFICAR(puerto.escrituras == 7);
+    }
+
+    // Ida y vuelta de muchas tramas con ruido entre ellas
+    PuertoMemoria puerto;
+    std::vector<std::vector<uint8_t> > enviadas;
+    int errores_esperados = 0, desbordes_esperados = 0;
+    for (int i = 0; i < TRAMAS_PRUEBA; i++) {
+        int caso = rand() % 20;
+        if (caso == 0) {
+            // escape inválido: la trama se descarta hasta el END
+            const uint8_t malo[] = {0x11, SLIP_ESC, 0x22, 0x33, SLIP_END};
+            puerto.write(malo, sizeof(malo));
+            errores_esperados++;
+        } else if (caso == 1) {
+            // más larga que el destino
+            std::vector<uint8_t> larga = tramaAleatoria(TAM_DESTINO + 1 + rand() % 100);
+            escribirSLIP(puerto, &larga[0], larga.size());
+            desbordes_esperados++;
+        } else if (caso == 2) {
+            // END repetidos entre tramas no forman tramas vacías
+            const uint8_t fines[] = {SLIP_END, SLIP_END, SLIP_END};
+            puerto.write(fines, sizeof(fines));
+        } else {
+            std::vector<uint8_t> t = tramaAleatoria(1 + rand() % TAM_DESTINO);
+            escribirSLIP(puerto, &t[0], t.size());
+            enviadas.push_back(t);
+        }
+    }
+
+    DecodificadorSLIP dec;
+    std::vector<std::vector<uint8_t> > recibidas;
+    decodificar(dec, puerto.datos, recibidas);
+
+    VERIFICAR(recibidas.size() == enviadas.size());
+    int distintas = 0;
+    for (size_t i = 0; i < recibidas.size() && i < enviadas.size(); i++) {
+        if (recibidas[i] != enviadas[i]) distintas++;
+    }
+    VERIFICAR(distintas == 0);
+    const EstadisticasSLIP &est = dec.estadisticas();
+    VERIFICAR(est.tramas == enviadas.size());
+    VERIFICAR((int)est.errores_trama == errores_esperados);
+    VERIFICAR((int)est.desbordes == desbordes_esperados);
+    VERIFICAR(est.sin_buffer == 0);
+
+    // Sin buffer destino (pool agotado) la trama se descarta y se cuenta
+    {
+        DecodificadorSLIP sin;
+        const uint8_t t[] = {SLIP_END, 1, 2, 3, SLIP_END};
+        int usados;
+        VERIFICAR(sin.agregar(t, sizeof(t), &usados) == 0 && usados == (int)sizeof(t));
+        VERIFICAR(sin.estadisticas().sin_buffer == 1);
+    }
+
+    printf("slip_flujo: %d tramas (%lu bytes), %u errores de entramado, %u desbordes\n",
+           (int)enviadas.size(), (unsigned long)puerto.datos.size(),
+           (unsigned)est.errores_trama, (unsigned)est.desbordes);
+    return terminar();
+}
@@ -0,0 +1,64 @@
+/*
+    Conteo de transacciones SPI del driver LoRa.cpp real contra el SPI
+    simulado (stubs/SPI.h), para comparar la escritura de la FIFO y la
+    atención de DIO0 en ráfaga con el acceso registro a registro anterior.
+
+    Uso: make bin/spi_rafaga && ./bin/spi_rafaga
+*/
+#include "LoRa.h"
+#include "verificar.h"
+
+static int largo_recibido = -1;
+static uint8_t payload_recibido[255];
+
+static void alRecibir(int largo) {
+    largo_recibido = largo;
+    LoRa.readPayload(payload_recibido, largo);
+}
+
+int main() {
+    VERIFICAR(LoRa.begin(915E6) == 1);
+
+    // Escritura de una trama completa en la FIFO
+    uint8_t trama[255];
+    for (int i = 0; i < 255; i++) trama[i] = i * 7;
+    LoRa.beginPacket();
+    SPI.reiniciarContadores();
+    LoRa.write(trama, sizeof(trama));
+    uint32_t tx_transacciones = SPI.transacciones, tx_bytes = SPI.bytes;
+    VERIFICAR(memcmp(SPI.fifo, trama, sizeof(trama)) == 0);
+    VERIFICAR(SPI.registros[0x22] == 255); // REG_PAYLOAD_LENGTH
+    LoRa.endPacket();
+
+    // Antes: leer largo + un writeRegister por byte + escribir largo
+    uint32_t tx_previas = 1 + sizeof(trama) + 1;
+    printf("write(255 B): %u transacciones, %u bytes SPI (antes %u transacciones, %u bytes)\n",
+           (unsigned)tx_transacciones, (unsigned)tx_bytes, (unsigned)tx_previas, (unsigned)(2 * tx_previas));
+    VERIFICAR(tx_transacciones == 3);
+
+    // Recepción: DIO0 con RX_DONE y una trama de 40 bytes en la dirección 0x80
+    LoRa.onReceive(alRecibir);
+    LoRa.receive();
+    for (int i = 0; i < 40; i++) SPI.fifo[0x80 + i] = 200 - i;
+    SPI.registros[0x10] = 0x80; // REG_FIFO_RX_CURRENT_ADDR
+    SPI.registros[0x13] = 40;   // REG_RX_NB_BYTES
+    SPI.registros[0x12] = 0x40; // IRQ_RX_DONE
+    SPI.reiniciarContadores();
+    simDispararInterrupcion();
+    uint32_t rx_transacciones = SPI.transacciones;
+
+    VERIFICAR(largo_recibido == 40);
+    VERIFICAR(payload_recibido[0] == 200 && payload_recibido[39] == 161);
+    VERIFICAR(SPI.registros[0x12] == 0); // IRQ limpiadas
+
+    // Antes: IRQ, limpiar IRQ, largo, dirección actual, puntero + payload
+    printf("DIO0 RX_DONE (40 B): %u transacciones (antes 6)\n", (unsigned)rx_transacciones);
+    VERIFICAR(rx_transacciones == 4);
+
+    SPI.reiniciarContadores();
+    LoRa.packetFrequencyErrorRaw();
+    printf("packetFrequencyErrorRaw: %u transacciones (antes 4)\n", (unsigned)SPI.transacciones);
+    VERIFICAR(SPI.transacciones == 1);
+
+    return terminar();
+}
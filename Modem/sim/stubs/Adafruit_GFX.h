@@ -0,0 +1,116 @@
+/*
+    Primitivas gráficas del OLED dibujadas con drawPixel como en la
+    biblioteca real. El texto usa una fuente sintética de 5x7 en celdas de
+    6x8 (cada carácter un patrón distinto, el espacio vacío): alcanza para
+    que cambiar un texto cambie los mismos bytes del framebuffer que con
+    la fuente real. Con simOledTexto(true) cada línea impresa se copia a
+    stderr con el prefijo "oled|".
+*/
+#ifndef ADAFRUIT_GFX_STUB_H
+#define ADAFRUIT_GFX_STUB_H
+
+#include "Arduino.h"
+
+inline bool &simOledTexto()
+{
+    static bool activo = false;
+    return activo;
+}
+
+inline void simOledTexto(bool activo) { simOledTexto() = activo; }
+
+class Adafruit_GFX : public Print
+{
+protected:
+    int16_t _ancho, _alto;
+    int16_t _cursor_x, _cursor_y;
+    uint8_t _tamano;
+    uint16_t _color, _fondo;
+    bool _envolver;
+    std::string _linea;
+
+    void glifo(int16_t x, int16_t y, uint8_t c)
+    {
+        for (int col = 0; col < 6; col++)
+        {
+            uint8_t bits = (col < 5 && c != ' ') ? (uint8_t)((c * 37 + col * 11 + 1) | 1) & 0x7F : 0;
+            for (int fila = 0; fila < 8; fila++)
+            {
+                bool encendido = (bits >> fila) & 1;
+                if (!encendido && _fondo == _color)
+                    continue;
+                fillRect(x + col * _tamano, y + fila * _tamano, _tamano, _tamano, encendido ? _color : _fondo);
+            }
+        }
+    }
+
+public:
+    Adafruit_GFX(int16_t ancho, int16_t alto)
+        : _ancho(ancho), _alto(alto), _cursor_x(0), _cursor_y(0), _tamano(1), _color(1), _fondo(1), _envolver(true) {}
+    virtual ~Adafruit_GFX() {}
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+    {
+        for (int16_t i = x; i < x + w; i++)
+            for (int16_t j = y; j < y + h; j++)
+                drawPixel(i, j, color);
+    }
+
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+    {
+        for (int16_t i = x; i < x + w; i++)
+        {
+            drawPixel(i, y, color);
+            drawPixel(i, y + h - 1, color);
+        }
+        for (int16_t j = y; j < y + h; j++)
+        {
+            drawPixel(x, j, color);
+            drawPixel(x + w - 1, j, color);
+        }
+    }
+
+    void setCursor(int16_t x, int16_t y)
+    {
+        _cursor_x = x;
+        _cursor_y = y;
+    }
+    void setTextSize(uint8_t s) { _tamano = s > 0 ? s : 1; }
+    void setTextColor(uint16_t c) { _color = _fondo = c; } // fondo igual al color: transparente
+    void setTextColor(uint16_t c, uint16_t fondo)
+    {
+        _color = c;
+        _fondo = fondo;
+    }
+    void setTextWrap(bool w) { _envolver = w; }
+    int16_t width() { return _ancho; }
+    int16_t height() { return _alto; }
+
+    size_t write(uint8_t c)
+    {
+        if (c == '\n')
+        {
+            _cursor_x = 0;
+            _cursor_y += 8 * _tamano;
+            if (simOledTexto())
+                fprintf(stderr, "oled| %s\n", _linea.c_str());
+            _linea.clear();
+        }
+        else if (c != '\r')
+        {
+            if (_envolver && _cursor_x + 6 * _tamano > _ancho)
+            {
+                _cursor_x = 0;
+                _cursor_y += 8 * _tamano;
+            }
+            glifo(_cursor_x, _cursor_y, c);
+            _cursor_x += 6 * _tamano;
+            _linea += (char)c;
+        }
+        return 1;
+    }
+    using Print::write;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+    SSD1306 simulado: framebuffer en RAM igual al de la biblioteca
+    (una página de 8 filas por byte, columna a columna) y display() que
+    manda el framebuffer completo por Wire con la misma secuencia de
+    comandos y transacciones de 32 bytes que la biblioteca real.
+*/
+#ifndef ADAFRUIT_SSD1306_STUB_H
+#define ADAFRUIT_SSD1306_STUB_H
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_SWITCHCAPVCC 2
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define WIRE_MAX 32
+
+class Adafruit_SSD1306 : public Adafruit_GFX
+{
+private:
+    TwoWire *_wire;
+    uint8_t _direccion;
+    uint8_t _buffer[SSD1306_SIM_ANCHO * SSD1306_SIM_PAGINAS];
+
+    void comandos(const uint8_t *c, int n)
+    {
+        _wire->beginTransmission(_direccion);
+        _wire->write((uint8_t)0x00);
+        _wire->write(c, n);
+        _wire->endTransmission();
+    }
+
+public:
+    Adafruit_SSD1306(int16_t ancho, int16_t alto, TwoWire *wire, int8_t)
+        : Adafruit_GFX(ancho, alto), _wire(wire), _direccion(SSD1306_SIM_DIRECCION)
+    {
+        memset(_buffer, 0, sizeof(_buffer));
+    }
+
+    bool begin(uint8_t, uint8_t direccion)
+    {
+        _direccion = direccion;
+        return true;
+    }
+
+    void ssd1306_command(uint8_t c) { comandos(&c, 1); }
+    uint8_t *getBuffer() { return _buffer; }
+    void clearDisplay() { memset(_buffer, 0, sizeof(_buffer)); }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color)
+    {
+        if (x < 0 || y < 0 || x >= _ancho || y >= _alto)
+            return;
+        uint8_t &b = _buffer[x + (y / 8) * _ancho];
+        uint8_t bit = 1 << (y & 7);
+        if (color == SSD1306_WHITE)
+            b |= bit;
+        else if (color == SSD1306_BLACK)
+            b &= ~bit;
+        else
+            b ^= bit;
+    }
+
+    void display()
+    {
+        static const uint8_t ventana[] = {0x22, 0, 0xFF, 0x21, 0};
+        comandos(ventana, sizeof(ventana));
+        ssd1306_command(_ancho - 1);
+        int total = _ancho * ((_alto + 7) / 8);
+        for (int i = 0; i < total;)
+        {
+            _wire->beginTransmission(_direccion);
+            _wire->write((uint8_t)0x40);
+            for (int n = 1; n < WIRE_MAX && i < total; n++)
+                _wire->write(_buffer[i++]);
+            _wire->endTransmission();
+        }
+    }
+};
+
+#endif
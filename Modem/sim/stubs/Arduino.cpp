@@ -0,0 +1,33 @@
+#include "Arduino.h"
+#include "SPI.h"
+
+HardwareSerial Serial;
+SPIClass SPI;
+
+static unsigned long reloj_us = 0;
+static void (*isr_registrada)() = NULL;
+
+unsigned long micros() { return reloj_us; }
+unsigned long millis() { return reloj_us / 1000; }
+void delay(unsigned long ms) { reloj_us += ms * 1000; }
+void simAvanzarUs(unsigned long us) { reloj_us += us; }
+
+void noInterrupts() {}
+void interrupts() {}
+
+void attachInterrupt(int, void (*isr)(), int) { isr_registrada = isr; }
+void detachInterrupt(int) { isr_registrada = NULL; }
+
+void simDispararInterrupcion()
+{
+    if (isr_registrada)
+        isr_registrada();
+}
+
+void HardwareSerial::begin(unsigned long) {}
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+size_t HardwareSerial::write(uint8_t c) { return fwrite(&c, 1, 1, stdout); }
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) { return fwrite(buffer, 1, size, stdout); }
+void HardwareSerial::onReceive(void (*)(), bool) {}
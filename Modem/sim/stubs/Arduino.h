@@ -0,0 +1,151 @@
+/*
+    Reemplazo mínimo del núcleo Arduino para compilar módulos del modem
+    en Linux. Con Arduino.cpp el tiempo lo controla la simulación
+    (simAvanzarUs), la interrupción registrada con attachInterrupt se
+    dispara con simDispararInterrupcion y Serial escribe en stdout. La
+    compilación completa del firmware (fil/) usa las mismas declaraciones
+    con reloj real y Serial sobre una pty.
+*/
+#ifndef ARDUINO_STUB_H
+#define ARDUINO_STUB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define RISING 1
+#define HEX 16
+#define DEC 10
+#define B111 7
+#define B1000 8
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+#define bitWrite(v, b, x) ((x) ? ((v) |= (1UL << (b))) : ((v) &= ~(1UL << (b))))
+using std::max;
+using std::min;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void simAvanzarUs(unsigned long us);
+void attachInterrupt(int pin, void (*isr)(), int modo);
+void detachInterrupt(int pin);
+void simDispararInterrupcion();
+inline void delayMicroseconds(unsigned int us) { simAvanzarUs(us); }
+void noInterrupts();
+void interrupts();
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline int digitalRead(int) { return 0; }
+inline int digitalPinToInterrupt(int p) { return p; }
+inline void yield() {}
+inline long random(long max) { return rand() % max; }
+inline long random(long min, long max) { return min + rand() % (max - min); }
+inline void randomSeed(unsigned long semilla) { srand(semilla); }
+
+class String
+{
+private:
+    std::string _s;
+
+public:
+    String() {}
+    String(const char *c) : _s(c) {}
+    String(char c) : _s(1, c) {}
+    String(int v, int base = DEC) { numero(v, base); }
+    String(unsigned int v, int base = DEC) { numero(v, base); }
+    String(long v, int base = DEC) { numero(v, base); }
+    String(unsigned long v, int base = DEC) { numero((long)v, base); }
+
+    unsigned int length() const { return _s.size(); }
+    const char *c_str() const { return _s.c_str(); }
+    char operator[](unsigned int i) const { return _s[i]; }
+    String substring(unsigned int desde, unsigned int hasta) const
+    {
+        if (desde > _s.size()) desde = _s.size();
+        if (hasta > _s.size()) hasta = _s.size();
+        String r;
+        r._s = _s.substr(desde, hasta > desde ? hasta - desde : 0);
+        return r;
+    }
+    String &operator+=(const String &o) { _s += o._s; return *this; }
+    String &operator+=(const char *c) { _s += c; return *this; }
+    String &operator+=(char c) { _s += c; return *this; }
+    friend String operator+(String a, const String &b) { return a += b; }
+
+private:
+    void numero(long v, int base)
+    {
+        char b[24];
+        snprintf(b, sizeof(b), base == HEX ? "%lx" : "%ld", v);
+        _s = b;
+    }
+};
+
+// print/println pasan por write() como en el núcleo real
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            write(buffer[i]);
+        return size;
+    }
+    size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(const String &s) { return print(s.c_str()); }
+    size_t print(long v, int base = DEC) { return print(String(v, base)); }
+    size_t println() { return print("\r\n"); }
+    size_t println(const char *s) { return print(s) + println(); }
+    size_t println(const String &s) { return print(s) + println(); }
+    size_t println(long v, int base = DEC) { return print(v, base) + println(); }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+    void setTimeout(unsigned long) {}
+    size_t readBytes(uint8_t *buffer, size_t largo)
+    {
+        size_t n = 0;
+        while (n < largo && available() > 0)
+            buffer[n++] = read();
+        return n;
+    }
+};
+
+// Definida en Arduino.cpp (stdout, sin entrada) o en fil/ (pty)
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baudios);
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buffer, size_t size);
+    void onReceive(void (*funcion)(), bool solo_timeout = false);
+    void setRxBufferSize(size_t) {}
+};
+
+extern HardwareSerial Serial;
+
+#endif
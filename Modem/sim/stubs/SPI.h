@@ -0,0 +1,107 @@
+#ifndef SPI_STUB_H
+#define SPI_STUB_H
+
+#include "Arduino.h"
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+class SPISettings
+{
+public:
+    SPISettings() {}
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+/*
+    SPI simulado con un modelo mínimo de los registros del SX1276: el
+    primer byte de cada transacción es la dirección (bit 7 = escritura) y
+    los siguientes leen o escriben con autoincremento, salvo la FIFO
+    (0x00), que avanza REG_FIFO_ADDR_PTR. Cuenta transacciones y bytes
+    para comparar accesos byte a byte contra ráfagas.
+*/
+class SPIClass
+{
+public:
+    uint8_t registros[128];
+    uint8_t fifo[256];
+    uint32_t transacciones;
+    uint32_t bytes;
+
+    SPIClass() : transacciones(0), bytes(0), direccion_(0), escritura_(false), primero_(true)
+    {
+        memset(registros, 0, sizeof(registros));
+        memset(fifo, 0, sizeof(fifo));
+        registros[0x42] = 0x12; // REG_VERSION del SX1276
+    }
+    void begin(int = -1, int = -1, int = -1, int = -1) {}
+    void end() {}
+    void beginTransaction(SPISettings)
+    {
+        transacciones++;
+        primero_ = true;
+    }
+    void endTransaction() {}
+    uint8_t transfer(uint8_t dato)
+    {
+        bytes++;
+        if (primero_)
+        {
+            primero_ = false;
+            escritura_ = dato & 0x80;
+            direccion_ = dato & 0x7f;
+            return 0;
+        }
+        uint8_t respuesta = registros[direccion_];
+        if (direccion_ == 0x00)
+        {
+            uint8_t &ptr = registros[0x0d];
+            if (escritura_)
+                fifo[ptr] = dato;
+            respuesta = fifo[ptr];
+            ptr++;
+            return respuesta;
+        }
+        if (escritura_)
+            escribir(direccion_, dato);
+        direccion_ = (direccion_ + 1) & 0x7f;
+        return respuesta;
+    }
+    void transferBytes(const uint8_t *datos, uint8_t *salida, uint32_t largo)
+    {
+        for (uint32_t i = 0; i < largo; i++)
+        {
+            uint8_t r = transfer(datos ? datos[i] : 0xff);
+            if (salida)
+                salida[i] = r;
+        }
+    }
+    void writeBytes(const uint8_t *datos, uint32_t largo) { transferBytes(datos, NULL, largo); }
+    void usingInterrupt(int) {}
+    void reiniciarContadores()
+    {
+        transacciones = 0;
+        bytes = 0;
+    }
+
+private:
+    void escribir(uint8_t reg, uint8_t dato)
+    {
+        if (reg == 0x12)
+        {
+            registros[reg] &= ~dato; // IRQ_FLAGS: se limpian escribiendo 1
+            return;
+        }
+        registros[reg] = dato;
+        if (reg == 0x01 && (dato & 0x07) == 0x03)
+            registros[0x12] |= 0x08; // modo TX: la transmisión termina de inmediato
+    }
+
+    uint8_t direccion_;
+    bool escritura_;
+    bool primero_;
+};
+
+extern SPIClass SPI;
+
+#endif
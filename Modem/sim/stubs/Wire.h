@@ -0,0 +1,124 @@
+/*
+    Bus I2C con un SSD1306 simulado en su dirección: interpreta el byte
+    de control (0x00 comandos, 0x40 datos), las ventanas de columna y
+    página (0x21, 0x22) en modo de direccionamiento horizontal y escribe
+    la GDDRAM. Cuenta los bytes que pasan por el bus (dirección incluida)
+    para medir cuánto cuesta refrescar la pantalla.
+*/
+#ifndef WIRE_STUB_H
+#define WIRE_STUB_H
+
+#include "Arduino.h"
+
+#define SSD1306_SIM_DIRECCION 0x3C
+#define SSD1306_SIM_ANCHO 128
+#define SSD1306_SIM_PAGINAS 8
+
+class TwoWire
+{
+private:
+    uint8_t _direccion;
+    int _posicion;          // bytes escritos en la transacción en curso
+    bool _datos;
+    uint8_t _comando[3];
+    int _largo_comando;
+    uint8_t _col_inicio, _col_fin, _pag_inicio, _pag_fin, _col, _pag;
+
+    void comando(uint8_t c)
+    {
+        _comando[_largo_comando++] = c;
+        uint8_t op = _comando[0];
+        int argumentos = (op == 0x21 || op == 0x22) ? 2 : (op == 0x20 || op == 0x81 || op == 0x8D || op == 0xA8 ||
+                          op == 0xD3 || op == 0xD5 || op == 0xD9 || op == 0xDA || op == 0xDB) ? 1 : 0;
+        if (_largo_comando <= argumentos)
+            return;
+        if (op == 0x21)
+        {
+            _col_inicio = _col = _comando[1] & 0x7F;
+            _col_fin = _comando[2] & 0x7F;
+        }
+        else if (op == 0x22)
+        {
+            _pag_inicio = _pag = _comando[1] & 0x07;
+            _pag_fin = _comando[2] & 0x07;
+        }
+        _largo_comando = 0;
+    }
+
+    void dato(uint8_t c)
+    {
+        gddram[_pag * SSD1306_SIM_ANCHO + _col] = c;
+        if (_col++ >= _col_fin)
+        {
+            _col = _col_inicio;
+            if (_pag++ >= _pag_fin)
+                _pag = _pag_inicio;
+        }
+    }
+
+public:
+    uint8_t gddram[SSD1306_SIM_ANCHO * SSD1306_SIM_PAGINAS];
+    uint32_t bytes;         // bytes en el bus
+    uint32_t bytes_datos;   // bytes escritos en la GDDRAM
+    uint32_t transacciones;
+
+    TwoWire() { simReiniciar(); }
+    bool begin(int = -1, int = -1, uint32_t = 0) { return true; }
+    void setClock(uint32_t) {}
+
+    void beginTransmission(uint8_t direccion)
+    {
+        _direccion = direccion;
+        _posicion = 0;
+        bytes++;
+        transacciones++;
+    }
+
+    size_t write(uint8_t c)
+    {
+        bytes++;
+        if (_direccion != SSD1306_SIM_DIRECCION)
+            return 1;
+        if (_posicion++ == 0)
+        {
+            _datos = c == 0x40;
+            _largo_comando = 0;
+        }
+        else if (_datos)
+        {
+            dato(c);
+            bytes_datos++;
+        }
+        else
+        {
+            comando(c);
+        }
+        return 1;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            write(buffer[i]);
+        return size;
+    }
+
+    uint8_t endTransmission(bool = true) { return 0; }
+
+    void simReiniciar()
+    {
+        memset(gddram, 0, sizeof(gddram));
+        bytes = bytes_datos = transacciones = 0;
+        _direccion = 0;
+        _posicion = 0;
+        _datos = false;
+        _largo_comando = 0;
+        _col_inicio = _col = _pag_inicio = _pag = 0;
+        _col_fin = SSD1306_SIM_ANCHO - 1;
+        _pag_fin = SSD1306_SIM_PAGINAS - 1;
+    }
+};
+
+extern TwoWire Wire;
+
+#endif
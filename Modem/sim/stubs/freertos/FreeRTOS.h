@@ -0,0 +1,41 @@
+/*
+    Reemplazo de FreeRTOS para compilar en Linux los módulos del modem que
+    usan colas y tareas. Las colas son seguras entre hilos (mutex +
+    variable de condición) y cada tarea es un std::thread; un tick es un
+    milisegundo. Sólo cubre la parte de la API que usa el firmware.
+*/
+#ifndef FREERTOS_STUB_H
+#define FREERTOS_STUB_H
+
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portYIELD_FROM_ISR(...) do {} while (0)
+
+// Espera hasta que pred() sea verdadero o se cumplan 'ticks' milisegundos
+template <typename Pred>
+inline bool esperarShim(std::unique_lock<std::mutex> &lock, std::condition_variable &cv, TickType_t ticks, Pred pred)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        cv.wait(lock, pred);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(ticks), pred);
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef FREERTOS_QUEUE_STUB_H
+#define FREERTOS_QUEUE_STUB_H
+
+#include "FreeRTOS.h"
+
+struct ColaShim
+{
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<uint8_t> datos;
+    UBaseType_t largo;
+    UBaseType_t tam_item;
+    UBaseType_t cabeza;
+    UBaseType_t cantidad;
+};
+
+typedef ColaShim *QueueHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t largo, UBaseType_t tam_item)
+{
+    ColaShim *q = new ColaShim();
+    q->datos.resize(largo * tam_item);
+    q->largo = largo;
+    q->tam_item = tam_item;
+    q->cabeza = 0;
+    q->cantidad = 0;
+    return q;
+}
+
+inline void vQueueDelete(QueueHandle_t q) { delete q; }
+
+inline BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t espera)
+{
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!esperarShim(lock, q->cv, espera, [q] { return q->cantidad < q->largo; }))
+        return pdFALSE;
+    UBaseType_t pos = (q->cabeza + q->cantidad) % q->largo;
+    memcpy(&q->datos[pos * q->tam_item], item, q->tam_item);
+    q->cantidad++;
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+inline BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item, BaseType_t *despertar)
+{
+    if (despertar)
+        *despertar = pdFALSE;
+    return xQueueSend(q, item, 0);
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t espera)
+{
+    std::unique_lock<std::mutex> lock(q->m);
+    if (!esperarShim(lock, q->cv, espera, [q] { return q->cantidad > 0; }))
+        return pdFALSE;
+    memcpy(item, &q->datos[q->cabeza * q->tam_item], q->tam_item);
+    q->cabeza = (q->cabeza + 1) % q->largo;
+    q->cantidad--;
+    q->cv.notify_all();
+    return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    std::lock_guard<std::mutex> lock(q->m);
+    return q->cantidad;
+}
+
+inline UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q)
+{
+    std::lock_guard<std::mutex> lock(q->m);
+    return q->largo - q->cantidad;
+}
+
+#endif
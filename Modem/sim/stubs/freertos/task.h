@@ -0,0 +1,79 @@
+#ifndef FREERTOS_TASK_STUB_H
+#define FREERTOS_TASK_STUB_H
+
+#include "FreeRTOS.h"
+#include <thread>
+
+struct TareaShim
+{
+    std::mutex m;
+    std::condition_variable cv;
+    uint32_t notificaciones;
+};
+
+typedef TareaShim *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+// Handle de la tarea que corre en el hilo actual (para ulTaskNotifyTake)
+inline TaskHandle_t &tareaShimActual()
+{
+    static thread_local TaskHandle_t actual = NULL;
+    return actual;
+}
+
+// Cada tarea corre en su propio hilo; prioridad y núcleo se ignoran
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t funcion, const char *, uint32_t, void *parametro,
+                                          UBaseType_t, TaskHandle_t *handle, BaseType_t)
+{
+    TareaShim *t = new TareaShim();
+    t->notificaciones = 0;
+    if (handle)
+        *handle = t;
+    std::thread([t, funcion, parametro] {
+        tareaShimActual() = t;
+        funcion(parametro);
+    }).detach();
+    return pdPASS;
+}
+
+inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+
+inline TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void vTaskDelete(TaskHandle_t) {}
+
+inline void xTaskNotifyGive(TaskHandle_t t)
+{
+    std::lock_guard<std::mutex> lock(t->m);
+    t->notificaciones++;
+    t->cv.notify_all();
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t t, BaseType_t *despertar)
+{
+    if (despertar)
+        *despertar = pdFALSE;
+    xTaskNotifyGive(t);
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t limpiar, TickType_t espera)
+{
+    TaskHandle_t t = tareaShimActual();
+    if (!t)
+    {
+        vTaskDelay(espera == portMAX_DELAY ? 1 : espera);
+        return 0;
+    }
+    std::unique_lock<std::mutex> lock(t->m);
+    esperarShim(lock, t->cv, espera, [t] { return t->notificaciones > 0; });
+    uint32_t valor = t->notificaciones;
+    if (valor > 0)
+        t->notificaciones = limpiar ? 0 : valor - 1;
+    return valor;
+}
+
+#endif
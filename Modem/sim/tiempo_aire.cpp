@@ -0,0 +1,113 @@
+/*
+    Verificación en Linux del tiempo en el aire (tiempo_aire.h) y del
+    presupuesto de ciclo de trabajo en red.cpp con la radio simulada.
+    Los valores de referencia son los de la calculadora de Semtech; la
+    cola se mantiene llena y se mide cuánto aire sale por ventana.
+
+    Uso: make bin/tiempo_aire && ./bin/tiempo_aire
+*/
+#include "red.h"
+#include "lora_stub.h"
+#include "verificar.h"
+
+// Referencias (calculadora de Semtech): preámbulo 8, CR 4/5, CRC, cabecera explícita
+static_assert(aire::tiempoAireUs(10, 7, 125000) == 41216, "SF7/125 10 bytes");
+static_assert(aire::tiempoAireUs(10, 12, 125000) == 991232, "SF12/125 10 bytes (baja tasa)");
+static_assert(aire::tiempoAireUs(51, 9, 125000) == 328704, "SF9/125 51 bytes");
+static_assert(aire::tiempoAireUs(255, 7, 250000) == 199808, "SF7/250 255 bytes");
+static_assert(aire::tiempoAireUs(0, 7, 125000) == 25856, "sin payload");
+static_assert(aire::tiempoAireUs(10, 7, 125000, 4, 12, true, true) == 49408, "CR 4/8, preámbulo 12, implícita");
+// Misma regla que setLdoFlag: SF11/125 y SF12/250 (16.384 ms) sin optimización, SF12/125 con ella
+static_assert(!aire::bajaTasa(11, 125000) && !aire::bajaTasa(12, 250000) && aire::bajaTasa(12, 125000), "LDRO");
+
+#define PASO_US 1000
+
+struct Banco {
+    Red &red;
+    unsigned long fin_aire;  // micros() en que termina la trama en el aire
+    unsigned long aire_us;   // total transmitido
+    int transmitidas;
+
+    Banco(Red &r) : red(r), fin_aire(0), aire_us(0), transmitidas(0) {}
+
+    // Avanza el reloj llamando a atender() y termina cada trama al cumplirse su tiempo en el aire
+    void correr(unsigned long duracion_us, const uint8_t *dato, int largo, bool llenar) {
+        unsigned long fin = micros() + duracion_us;
+        while ((long)(fin - micros()) > 0) {
+            while (llenar && red.tramasEnCola() < SLOTS_TX) red.transmite_data((BYTE *)dato, largo);
+            int previas = simTransmitidas();
+            red.atender();
+            if (simTransmitidas() != previas) {
+                uint32_t t = red.tiempoAireUs(largo);
+                fin_aire = micros() + t;
+                aire_us += t;
+                transmitidas++;
+            }
+            if (simTransmitiendo() && (long)(micros() - fin_aire) >= 0) {
+                simTerminarTransmision();
+                red.atender();
+            }
+            simAvanzarUs(PASO_US);
+        }
+    }
+};
+
+int main() {
+    Red red;
+    red.begin(7, 125E3, 1, 2);
+    uint8_t dato[255] = {0};
+
+    // La red usa la configuración real de la radio: preámbulo 12, CR 4/5
+    VERIFICAR(red.tiempoAireUs(10) == aire::tiempoAireUs(10, 7, 125000, 1, PREAMBLE_LENGTH));
+    VERIFICAR(red.tiempoAireUs(10, 12, 125000) == aire::tiempoAireUs(10, 12, 125000, 1, PREAMBLE_LENGTH));
+    printf("tiempo en el aire de 10 bytes: SF7/125 %.1f ms, SF12/125 %.1f ms\n",
+           red.tiempoAireUs(10) / 1000.0, red.tiempoAireUs(10, 12, 125000) / 1000.0);
+
+    // Ciclo de trabajo 10 % con 1 s de ráfaga y la cola siempre llena:
+    // nada se descarta y el aire se ajusta al ciclo
+    red.setCicloTrabajo(100, 1000);
+    Banco banco(red);
+    const int LARGO = 100;
+    const unsigned long DURACION_US = 600000000UL; // 10 minutos
+    banco.correr(DURACION_US, dato, LARGO, true);
+    const EstadisticasTx &tx = red.estadisticasTx();
+    const EstadisticasAire &est = red.estadisticasAire();
+    double ocupacion = (double)banco.aire_us / DURACION_US;
+    printf("ciclo 10%%: %d tramas, ocupación %.2f%%, utilización última ventana %u/1000, máxima %u/1000, "
+           "%u esperas\n", banco.transmitidas, 100 * ocupacion, (unsigned)est.utilizacion_pormil,
+           (unsigned)est.utilizacion_maxima_pormil, (unsigned)est.esperas);
+    VERIFICAR(tx.cola_llena == 0 && tx.descartadas_canal == 0);
+    VERIFICAR(banco.aire_us <= DURACION_US / 10 + 1000000 + red.tiempoAireUs(LARGO));
+    VERIFICAR(ocupacion > 0.095);
+    VERIFICAR(est.esperas > 0);
+    VERIFICAR(est.utilizacion_pormil >= 90 && est.utilizacion_pormil <= 110);
+    VERIFICAR(est.utilizacion_maxima_pormil <= 100 + 1000000 / VENTANA_UTILIZACION_MS + 10); // más la ráfaga
+    VERIFICAR(est.aire_total_ms == banco.aire_us / 1000);
+
+    // Una trama más larga que la ráfaga sale con el balde lleno y la
+    // siguiente espera a que se pague la deuda (aire / ciclo)
+    red.setCicloTrabajo(1000, 0);
+    while (red.tramasEnCola() > 0) banco.correr(100000, dato, LARGO, false);
+    red.setCicloTrabajo(10, 100);
+    Banco largo(red);
+    uint32_t aire_largo = red.tiempoAireUs(200);
+    red.transmite_data(dato, 200);
+    red.transmite_data(dato, 200);
+    unsigned long inicio = micros();
+    largo.correr(2000000, dato, 200, false);
+    VERIFICAR(largo.transmitidas == 1);
+    while (largo.transmitidas < 2 && micros() - inicio < 200000000UL) largo.correr(100000, dato, 200, false);
+    double espera_s = (micros() - inicio) / 1e6;
+    printf("trama de %.0f ms con 1%%: la siguiente sale a los %.1f s (esperado %.1f s)\n", aire_largo / 1000.0,
+           espera_s, aire_largo * 100 / 1e6);
+    VERIFICAR(largo.transmitidas == 2);
+    VERIFICAR(espera_s > 0.95 * aire_largo * 100 / 1e6 && espera_s < 1.05 * aire_largo * 100 / 1e6 + 1);
+
+    // Tiempo máximo por trama (permanencia de 400 ms): se rechaza lo que nunca podría salir
+    red.setCicloTrabajo(1000, 0, 400);
+    VERIFICAR(red.transmite_data(dato, 10));
+    VERIFICAR(!red.transmite_data(dato, 10, true, 12, 125000));
+    VERIFICAR(red.estadisticasAire().excede_maximo == 1);
+
+    return terminar();
+}
@@ -0,0 +1,101 @@
+/*
+    Verificación en Linux del pool de tramas y las colas de descriptores
+    (tramas.h) con el reemplazo de FreeRTOS de stubs/freertos: dos tareas
+    reales (hilos) se pasan tramas por colas como lo hacen la tarea serial
+    y la de radio, y al final todas deben haber vuelto al pool.
+
+    Uso: make bin/tramas_pool && ./bin/tramas_pool
+*/
+#include "tramas.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <atomic>
+#include "verificar.h"
+
+#define TRAMAS_PRUEBA 20000
+
+static PoolTramas pool;
+static QueueHandle_t ida, vuelta;
+static std::atomic<int> recibidas(0), corruptas(0);
+static std::atomic<bool> fin_eco(false);
+
+// Tarea "radio": recibe de 'ida', verifica y devuelve la misma trama por 'vuelta'
+static void tareaEco(void *) {
+    Trama *t;
+    while (recibidas < TRAMAS_PRUEBA) {
+        if (xQueueReceive(ida, &t, pdMS_TO_TICKS(100)) != pdTRUE) continue;
+        uint32_t n;
+        memcpy(&n, t->datos, sizeof(n));
+        if (t->largo != 5 + n % 200 || t->datos[t->largo - 1] != (uint8_t)n) corruptas++;
+        recibidas++;
+        t->tipo = 1;
+        pool.pasar(vuelta, t, portMAX_DELAY);
+    }
+    fin_eco = true;
+}
+
+int main() {
+    VERIFICAR(pool.begin());
+    VERIFICAR(pool.libres() == TRAMAS_POOL);
+
+    // Agotamiento y liberaciones inválidas
+    Trama *tomadas[TRAMAS_POOL];
+    for (int i = 0; i < TRAMAS_POOL; i++) tomadas[i] = pool.tomar();
+    VERIFICAR(pool.tomar() == NULL);
+    VERIFICAR(pool.estadisticas().agotado == 1);
+    pool.liberar(tomadas[0]);
+    pool.liberar(tomadas[0]); // doble liberación
+    Trama ajena;
+    pool.liberar(&ajena);
+    pool.liberar((Trama *)((uint8_t *)tomadas[1] + 1)); // puntero desalineado
+    VERIFICAR(pool.estadisticas().liberacion_invalida == 3);
+    VERIFICAR(pool.libres() == 1);
+    for (int i = 1; i < TRAMAS_POOL; i++) pool.liberar(tomadas[i]);
+    VERIFICAR(pool.libres() == TRAMAS_POOL);
+
+    // Cola llena: pasar() devuelve la trama al pool
+    QueueHandle_t chica = crearColaTramas(2);
+    for (int i = 0; i < 3; i++) pool.pasar(chica, pool.tomar());
+    VERIFICAR(pool.estadisticas().cola_llena == 1);
+    VERIFICAR(pool.libres() == TRAMAS_POOL - 2);
+    Trama *t;
+    while (xQueueReceive(chica, &t, 0) == pdTRUE) pool.liberar(t);
+    VERIFICAR(pool.libres() == TRAMAS_POOL);
+
+    // Dos tareas pasándose tramas por colas más cortas que el pool
+    ida = crearColaTramas(8);
+    vuelta = crearColaTramas(8);
+    TaskHandle_t eco;
+    xTaskCreatePinnedToCore(tareaEco, "eco", 4096, NULL, 1, &eco, 1);
+
+    int enviadas = 0, devueltas = 0;
+    while (devueltas < TRAMAS_PRUEBA) {
+        if (enviadas < TRAMAS_PRUEBA) {
+            Trama *nueva = pool.tomar(pdMS_TO_TICKS(1));
+            if (nueva != NULL) {
+                uint32_t n = enviadas;
+                nueva->largo = 5 + n % 200;
+                memcpy(nueva->datos, &n, sizeof(n));
+                nueva->datos[nueva->largo - 1] = (uint8_t)n;
+                pool.pasar(ida, nueva, portMAX_DELAY);
+                enviadas++;
+            }
+        }
+        while (xQueueReceive(vuelta, &t, 0) == pdTRUE) {
+            VERIFICAR(t->tipo == 1);
+            pool.liberar(t);
+            devueltas++;
+        }
+    }
+    while (!fin_eco) vTaskDelay(1);
+
+    VERIFICAR(recibidas == TRAMAS_PRUEBA);
+    VERIFICAR(corruptas == 0);
+    VERIFICAR(pool.libres() == TRAMAS_POOL);
+    VERIFICAR(pool.estadisticas().liberacion_invalida == 3);
+
+    const EstadisticasPool &est = pool.estadisticas();
+    printf("tomadas=%u agotado=%u cola_llena=%u liberacion_invalida=%u libres=%d\n", (unsigned)est.tomadas,
+           (unsigned)est.agotado, (unsigned)est.cola_llena, (unsigned)est.liberacion_invalida, pool.libres());
+    return terminar();
+}
@@ -0,0 +1,26 @@
+#ifndef VERIFICAR_H
+#define VERIFICAR_H
+#include <stdio.h>
+
+/*
+    Verificaciones de los programas de sim/: VERIFICAR cuenta la falla y
+    sigue, terminar() imprime OK (lo que busca `make run`) o la cantidad
+    de fallas y devuelve el código de salida de main.
+*/
+
+static int fallas = 0;
+
+#define VERIFICAR(cond)                                            \
+    do {                                                           \
+        if (!(cond)) {                                             \
+            printf("FALLA %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            fallas++;                                              \
+        }                                                          \
+    } while (0)
+
+static inline int terminar() {
+    printf(fallas == 0 ? "OK\n" : "FALLAS: %d\n", fallas);
+    return fallas == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,89 @@
+#include "slip.h"
+
+DecodificadorSLIP::DecodificadorSLIP()
+    : _salida(NULL), _max(0), _pos(0), _escape(false), _descartando(false)
+{
+    memset(&_est, 0, sizeof(_est));
+}
+
+void DecodificadorSLIP::setSalida(uint8_t *salida, int max) {
+    _salida = salida;
+    _max = max;
+}
+
+void DecodificadorSLIP::descartar(uint32_t *contador) {
+    (*contador)++;
+    _descartando = true;
+    _escape = false;
+    _pos = 0;
+}
+
+int DecodificadorSLIP::agregar(const uint8_t *datos, int largo, int *consumidos) {
+    for (int i = 0; i < largo; i++) {
+        uint8_t c = datos[i];
+
+        if (c == SLIP_END) {
+            bool error = _escape;
+            bool descartada = _descartando;
+            int n = _pos;
+            _escape = false;
+            _descartando = false;
+            _pos = 0;
+
+            if (error) {
+                _est.errores_trama++;
+            } else if (!descartada && n > 0) {
+                // END iniciales o repetidos no forman trama
+                _est.tramas++;
+                *consumidos = i + 1;
+                return n;
+            }
+            continue;
+        }
+        if (_descartando) continue;
+
+        if (_escape) {
+            _escape = false;
+            if (c == SLIP_ESC_END) {
+                c = SLIP_END;
+            } else if (c == SLIP_ESC_ESC) {
+                c = SLIP_ESC;
+            } else {
+                descartar(&_est.errores_trama);
+                continue;
+            }
+        } else if (c == SLIP_ESC) {
+            _escape = true;
+            continue;
+        }
+
+        if (_salida == NULL) {
+            descartar(&_est.sin_buffer);
+        } else if (_pos >= _max) {
+            descartar(&_est.desbordes);
+        } else {
+            _salida[_pos++] = c;
+        }
+    }
+    *consumidos = largo;
+    return 0;
+}
+
+size_t escribirSLIP(Print &salida, const uint8_t *datos, int largo) {
+    static const uint8_t fin = SLIP_END;
+    static const uint8_t esc_end[2] = {SLIP_ESC, SLIP_ESC_END};
+    static const uint8_t esc_esc[2] = {SLIP_ESC, SLIP_ESC_ESC};
+    size_t escritos = salida.write(&fin, 1);
+
+    int inicio = 0;
+    for (int i = 0; i < largo; i++) {
+        if (datos[i] != SLIP_END && datos[i] != SLIP_ESC) continue;
+        if (i > inicio) escritos += salida.write(&datos[inicio], i - inicio);
+        escritos += salida.write(datos[i] == SLIP_END ? esc_end : esc_esc, 2);
+        inicio = i + 1;
+    }
+    if (largo > inicio) escritos += salida.write(&datos[inicio], largo - inicio);
+
+    escritos += salida.write(&fin, 1);
+    return escritos;
+}
@@ -0,0 +1,73 @@
+#ifndef SLIP_H
+#define SLIP_H
+#include <Arduino.h>
+
+/*
+    Entramado SLIP por flujo para el puerto serie del modem.
+
+    DecodificadorSLIP recibe los bytes tal como los entrega el driver de la
+    UART, en bloques de cualquier tamaño, y decodifica directamente en el
+    buffer de la trama destino: no hay un buffer intermedio con la trama
+    codificada. Una trama que no cabe o con un escape inválido se descarta
+    hasta el siguiente END y se cuenta; no reinicia en silencio.
+
+    escribirSLIP codifica en una sola pasada directo hacia el buffer de TX
+    del puerto: los tramos sin bytes especiales se escriben tal cual desde
+    la trama y sólo los escapes se escriben aparte.
+*/
+
+#define SLIP_END     0xC0
+#define SLIP_ESC     0xDB
+#define SLIP_ESC_END 0xDC
+#define SLIP_ESC_ESC 0xDD
+
+struct EstadisticasSLIP {
+    uint32_t tramas;         // tramas completas entregadas
+    uint32_t errores_trama;  // escape inválido o escape seguido de END
+    uint32_t desbordes;      // tramas más largas que el buffer destino
+    uint32_t sin_buffer;     // tramas descartadas por no haber buffer destino
+};
+
+class DecodificadorSLIP
+{
+private:
+    uint8_t *_salida;
+    int _max;
+    int _pos;
+    bool _escape;
+    bool _descartando;       // ignorar hasta el próximo END
+    EstadisticasSLIP _est;
+
+    void descartar(uint32_t *contador);
+public:
+    DecodificadorSLIP();
+
+    /**
+     * @brief fijar el buffer donde se decodifica la próxima trama
+     *
+     * @param salida buffer destino, o NULL si no hay dónde decodificar
+     *               (la trama en curso se descarta y se cuenta)
+     * @param max tamaño del buffer
+     */
+    void setSalida(uint8_t *salida, int max);
+    /**
+     * @brief consumir bytes recibidos hasta completar una trama
+     *
+     * @param datos bytes tal como llegaron de la UART
+     * @param largo cantidad de bytes
+     * @param consumidos bytes usados; si se completó una trama, el resto
+     *                   se entrega en la siguiente llamada (tras setSalida)
+     * @return largo de la trama completada en el buffer de salida, o 0
+     */
+    int agregar(const uint8_t *datos, int largo, int *consumidos);
+    const EstadisticasSLIP &estadisticas() const { return _est; }
+};
+
+/**
+ * @brief codificar una trama en SLIP escribiéndola directo en el puerto
+ *
+ * @return bytes escritos en el puerto
+ */
+size_t escribirSLIP(Print &salida, const uint8_t *datos, int largo);
+
+#endif
@@ -0,0 +1,33 @@
+#include "telemetria.h"
+#include <string.h>
+
+static void escribir32(uint32_t valor, uint8_t *salida) {
+    salida[0] = valor >> 24;
+    salida[1] = valor >> 16;
+    salida[2] = valor >> 8;
+    salida[3] = valor;
+}
+
+Telemetria::Telemetria() {
+    memset(_contadores, 0, sizeof(_contadores));
+}
+
+int Telemetria::bloques() {
+    return (CONTADORES_TELEMETRIA + CONTADORES_POR_BLOQUE - 1) / CONTADORES_POR_BLOQUE;
+}
+
+int Telemetria::serializarBloque(uint8_t bloque, uint32_t ahora_ms, uint8_t *salida) const {
+    if (bloque >= bloques()) return 0;
+    int primero = bloque * CONTADORES_POR_BLOQUE;
+    int n = CONTADORES_TELEMETRIA - primero;
+    if (n > CONTADORES_POR_BLOQUE) n = CONTADORES_POR_BLOQUE;
+
+    salida[0] = VERSION_TELEMETRIA;
+    salida[1] = bloque;
+    salida[2] = bloques();
+    escribir32(ahora_ms, &salida[3]);
+    for (int i = 0; i < n; i++) {
+        escribir32(_contadores[primero + i], &salida[CABECERA_BLOQUE_TELEMETRIA + 4 * i]);
+    }
+    return CABECERA_BLOQUE_TELEMETRIA + 4 * n;
+}
@@ -0,0 +1,111 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+#include <stdint.h>
+
+/*
+    Contadores de telemetría del modem y su consulta desde el Nodo.
+
+    Es un arreglo fijo de contadores de 32 bits indexado por
+    ContadorTelemetria. Cada contador tiene una sola tarea que lo escribe
+    (un incremento, sin locks); los que ya llevan los módulos (red, SLIP,
+    pool, inundación, pantalla) se copian con fijar() al armar la
+    respuesta. Los contadores son acumulados desde el arranque salvo los
+    marcados como nivel, que son la ocupación en el instante de la
+    consulta.
+
+    La respuesta al comando CMD_TELEMETRIA del protocolo propio no cabe en
+    los 63 bytes de dato, así que se pide por bloques:
+    pedido  [bloque]
+    bloque  [versión][bloque][bloques][millis 4B][contador 4B]... big endian
+*/
+
+#define CMD_TELEMETRIA             8
+#define VERSION_TELEMETRIA         1
+#define CONTADORES_POR_BLOQUE      14  // 7 + 14 * 4 = 63 bytes de dato
+#define CABECERA_BLOQUE_TELEMETRIA 7
+
+// El orden es parte del formato: agregar sólo al final (el Nodo tiene la misma lista)
+enum ContadorTelemetria {
+    // UART con el Nodo (tarea serial)
+    TEL_UART_TRAMAS_RX,         // tramas SLIP completas desde el Nodo
+    TEL_UART_BYTES_RX,
+    TEL_UART_TRAMAS_TX,         // tramas escritas hacia el Nodo
+    TEL_UART_BYTES_TX,          // bytes SLIP escritos
+    TEL_UART_ERRORES_SLIP,      // escapes inválidos
+    TEL_UART_DESBORDES,         // tramas más largas que el buffer
+    TEL_UART_SIN_BUFFER,        // tramas perdidas por pool agotado
+    // Tarea de radio
+    TEL_IPV4_INVALIDAS,         // tramas más cortas que la cabecera (UART o radio)
+    TEL_COMANDOS,               // comandos del protocolo propio atendidos
+    TEL_RX_TRAMAS,              // tramas guardadas en el anillo de recepción
+    TEL_RX_ERRORES_CRC,
+    TEL_RX_DESBORDES,           // anillo de recepción lleno
+    TEL_RX_LARGO_INVALIDO,
+    TEL_RX_FEC_CORREGIDAS,
+    TEL_RX_FEC_IRRECUPERABLES,
+    TEL_TX_ENCOLADAS,
+    TEL_TX_TRANSMITIDAS,
+    TEL_TX_COLA_LLENA,
+    TEL_TX_TIMEOUTS,
+    TEL_TX_CANAL_OCUPADO,       // CAD con actividad
+    TEL_TX_DESCARTADAS_CANAL,
+    TEL_AIRE_TOTAL_MS,
+    TEL_AIRE_ESPERAS,           // tramas que esperaron presupuesto de aire
+    TEL_INUNDACION_REENVIADAS,
+    TEL_INUNDACION_DUPLICADAS,
+    TEL_POOL_AGOTADO,
+    TEL_OLED_REFRESCOS,
+    TEL_OLED_BYTES_I2C,
+    TEL_OLED_COALESCIDAS,
+    // Niveles
+    TEL_AIRE_UTILIZACION_PORMIL, // última ventana de VENTANA_UTILIZACION_MS
+    TEL_POOL_LIBRES,
+    TEL_COLA_UART_A_RADIO,
+    TEL_COLA_RADIO_A_UART,
+    TEL_COLA_TX,                // tramas en la cola de transmisión
+    TEL_ANILLO_RX,              // tramas sin leer en el anillo de recepción
+    // Reenvío directo (tarea de radio)
+    TEL_DIRECTAS_HACIA_RED,     // tramas del Nodo a la radio sin rearmar
+    TEL_DIRECTAS_HACIA_NODO,    // tramas de la radio al Nodo en el buffer en que se leyeron
+    TEL_COPIAS_IPV4,            // datos copiados al parsear o armar un IPv4Packet
+    TEL_BYTES_COPIADOS_IPV4,
+    // Entrega en el modem (entrega.h)
+    TEL_ENTREGA_CONFIRMADAS,    // tramas propias confirmadas por el destino
+    TEL_ENTREGA_FALLIDAS,       // sin ACK tras todos los intentos
+    TEL_ENTREGA_REINTENTOS,
+    TEL_ENTREGA_ACKS,           // ACK generados como destino
+    // Filtro de direcciones (grupos.h)
+    TEL_DESTINO_FILTRADAS,      // tramas de otro nodo o de un grupo ajeno, no suben a la UART
+    // Lotes de comandos (lote.h)
+    TEL_LOTES,                  // lotes ejecutados (cada comando cuenta además en TEL_COMANDOS)
+    TEL_LOTES_RECHAZADOS,       // mal formados o con FCS errado, no se ejecuta ninguno
+    // Descartes de la tarea de radio (no escribe en la UART)
+    TEL_TX_NO_ENCOLADAS,        // tramas del modem que la red no aceptó (largas para la tasa o cola llena)
+    TEL_COMANDOS_DESCONOCIDOS,
+    TEL_ENTREGA_SIN_LUGAR,      // tramas con entrega en el modem sin lugar para guardarlas
+    CONTADORES_TELEMETRIA
+};
+
+class Telemetria
+{
+private:
+    uint32_t _contadores[CONTADORES_TELEMETRIA];
+public:
+    Telemetria();
+
+    void contar(ContadorTelemetria contador, uint32_t n = 1) { _contadores[contador] += n; }
+    void fijar(ContadorTelemetria contador, uint32_t valor) { _contadores[contador] = valor; }
+    uint32_t valor(ContadorTelemetria contador) const { return _contadores[contador]; }
+    static int bloques();
+    /**
+     * @brief serializar un bloque de la respuesta a CMD_TELEMETRIA
+     *
+     * @param bloque índice pedido por el Nodo
+     * @param ahora_ms millis() del modem, para que el Nodo calcule tasas
+     * @param salida buffer de al menos CABECERA_BLOQUE_TELEMETRIA + 4 * CONTADORES_POR_BLOQUE bytes
+     * @return bytes escritos, 0 si el bloque no existe
+     */
+    int serializarBloque(uint8_t bloque, uint32_t ahora_ms, uint8_t *salida) const;
+};
+
+#endif
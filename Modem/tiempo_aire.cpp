@@ -0,0 +1,68 @@
+#include "tiempo_aire.h"
+#include <string.h>
+
+PresupuestoAire::PresupuestoAire()
+    : _pormil(1000), _capacidad(0), _fichas(0), _recarga_us(0), _maximo_trama_us(0),
+      _ventana_ms(0), _aire_total_us(0)
+{
+    memset(&_est, 0, sizeof(_est));
+}
+
+void PresupuestoAire::configurar(uint16_t pormil, uint32_t rafaga_ms, uint32_t maximo_trama_ms) {
+    _pormil = pormil > 1000 ? 1000 : pormil;
+    _capacidad = (int64_t)rafaga_ms * 1000 * 1000; // µs de aire escalados por 1000
+    _fichas = _capacidad;                          // arranca con la ráfaga disponible
+    _maximo_trama_us = maximo_trama_ms * 1000;
+}
+
+void PresupuestoAire::recargar(uint32_t ahora_us) {
+    uint32_t transcurrido = ahora_us - _recarga_us;
+    _recarga_us = ahora_us;
+    _fichas += (int64_t)transcurrido * _pormil;
+    if (_fichas > _capacidad) _fichas = _capacidad;
+}
+
+bool PresupuestoAire::admite(uint32_t aire_us) {
+    if (_maximo_trama_us == 0 || aire_us <= _maximo_trama_us) return true;
+    _est.excede_maximo++;
+    return false;
+}
+
+bool PresupuestoAire::disponible(uint32_t aire_us, uint32_t ahora_us) {
+    if (_pormil >= 1000) return true;
+    recargar(ahora_us);
+    return _fichas >= (int64_t)aire_us * 1000 || _fichas >= _capacidad;
+}
+
+void PresupuestoAire::contarEspera() {
+    _est.esperas++;
+}
+
+void PresupuestoAire::cerrarVentanas(uint32_t ahora_ms) {
+    uint32_t transcurrido = ahora_ms - _ventana_ms;
+    if (transcurrido < VENTANA_UTILIZACION_MS) return;
+    // si pasó más de una ventana, la última completa estuvo vacía
+    uint16_t utilizacion = transcurrido < 2 * VENTANA_UTILIZACION_MS ?
+        (uint16_t)(_est.aire_ventana_us / VENTANA_UTILIZACION_MS) : 0;
+    _est.utilizacion_pormil = utilizacion;
+    if (utilizacion > _est.utilizacion_maxima_pormil) _est.utilizacion_maxima_pormil = utilizacion;
+    _est.aire_ventana_us = 0;
+    _ventana_ms += transcurrido / VENTANA_UTILIZACION_MS * VENTANA_UTILIZACION_MS;
+}
+
+void PresupuestoAire::consumir(uint32_t aire_us, uint32_t ahora_us, uint32_t ahora_ms) {
+    if (_pormil < 1000) {
+        recargar(ahora_us);
+        _fichas -= (int64_t)aire_us * 1000;
+    }
+    cerrarVentanas(ahora_ms);
+    _est.aire_ventana_us += aire_us;
+    _aire_total_us += aire_us;
+    _est.aire_total_ms += _aire_total_us / 1000;
+    _aire_total_us %= 1000;
+}
+
+const EstadisticasAire &PresupuestoAire::estadisticas(uint32_t ahora_ms) {
+    cerrarVentanas(ahora_ms);
+    return _est;
+}
@@ -0,0 +1,127 @@
+#ifndef TIEMPO_AIRE_H
+#define TIEMPO_AIRE_H
+#include <stdint.h>
+
+/*
+    Tiempo en el aire de una trama LoRa (hoja de datos del SX1276,
+    sección 4.1.1.7) y presupuesto de ocupación del canal.
+
+    El cálculo es constexpr (C++11, una expresión por función) para poder
+    evaluarlo en tiempo de compilación con parámetros constantes. La
+    optimización de baja tasa sigue la misma regla entera que
+    LoRaClass::setLdoFlag (símbolo de más de 16 ms), que es lo que la
+    radio realmente transmite.
+
+    PresupuestoAire es un balde de fichas en microsegundos de aire: se
+    recarga a la fracción de ciclo de trabajo permitida y su capacidad es
+    la ráfaga tolerada. Una trama sale si el balde alcanza para ella (o si
+    está lleno, para que una trama más larga que la ráfaga no quede
+    bloqueada para siempre: el balde queda en deuda). A largo plazo la
+    ocupación no supera el ciclo de trabajo y en cualquier ventana lo
+    excede a lo más en la ráfaga más una trama.
+*/
+
+#define VENTANA_UTILIZACION_MS 60000UL // ventana del reporte de utilización
+
+namespace aire {
+
+// Regla de LoRaClass::setLdoFlag: 1000 / (BW / 2^SF) > 16 ms
+constexpr bool bajaTasa(int sf, long bw) {
+    return 1000 / (bw / (1L << sf)) > 16;
+}
+
+// 8·PL − 4·SF + 28 + 16·CRC − 20·IH
+constexpr long numeradorCarga(int largo, int sf, bool crc, bool implicito) {
+    return 8L * largo - 4 * sf + 28 + (crc ? 16 : 0) - (implicito ? 20 : 0);
+}
+
+constexpr long simbolosCargaRec(long numerador, long denominador, int cr) {
+    return numerador > 0 ? (numerador + denominador - 1) / denominador * (cr + 4) : 0;
+}
+
+/**
+ * @brief símbolos de la cabecera y el payload (sin preámbulo)
+ *
+ * @param cr tasa de código 1..4 (4/5 .. 4/8)
+ */
+constexpr long simbolosCarga(int largo, int sf, long bw, int cr, bool crc, bool implicito) {
+    return 8 + simbolosCargaRec(numeradorCarga(largo, sf, crc, implicito),
+                                4L * (sf - (bajaTasa(sf, bw) ? 2 : 0)), cr);
+}
+
+/**
+ * @brief tiempo en el aire en microsegundos
+ *
+ * @param largo bytes del payload (con la paridad FEC)
+ * @param cr tasa de código 1..4 (4/5 .. 4/8)
+ * @param preambulo símbolos de preámbulo programados (se suman 4.25)
+ * @param crc CRC del payload habilitado
+ * @param implicito cabecera implícita
+ */
+constexpr uint32_t tiempoAireUs(int largo, int sf, long bw, int cr = 1, long preambulo = 8,
+                                bool crc = true, bool implicito = false) {
+    // en cuartos de símbolo para el 4.25 del preámbulo
+    return (uint32_t)(((uint64_t)(4 * preambulo + 17 + 4 * simbolosCarga(largo, sf, bw, cr, crc, implicito)) << sf)
+                      * 1000000ULL / (4ULL * bw));
+}
+
+} // namespace aire
+
+/**
+ * @brief Ocupación del canal y efecto del presupuesto
+ */
+struct EstadisticasAire {
+    uint32_t aire_total_ms;           // tiempo en el aire acumulado
+    uint32_t aire_ventana_us;         // en la ventana en curso
+    uint16_t utilizacion_pormil;      // de la última ventana completa
+    uint16_t utilizacion_maxima_pormil;
+    uint32_t esperas;                 // tramas que esperaron presupuesto
+    uint32_t excede_maximo;           // tramas rechazadas por superar el tiempo máximo por trama
+};
+
+class PresupuestoAire
+{
+private:
+    uint16_t _pormil;          // ciclo de trabajo (1000 = sin límite)
+    int64_t _capacidad;        // ráfaga en µs·pormil
+    int64_t _fichas;           // puede quedar negativo (deuda)
+    uint32_t _recarga_us;      // micros() de la última recarga
+    uint32_t _maximo_trama_us; // 0 = sin límite (tiempo de permanencia)
+    uint32_t _ventana_ms;      // millis() del inicio de la ventana en curso
+    uint32_t _aire_total_us;   // resto en µs de aire_total_ms
+    EstadisticasAire _est;
+
+    void recargar(uint32_t ahora_us);
+    void cerrarVentanas(uint32_t ahora_ms);
+public:
+    PresupuestoAire();
+
+    /**
+     * @brief configurar el presupuesto
+     *
+     * @param pormil fracción del tiempo que se puede transmitir (10 = 1 %, 1000 = sin límite)
+     * @param rafaga_ms tiempo en el aire que se puede gastar seguido con el balde lleno
+     * @param maximo_trama_ms tiempo máximo por trama (dwell time), 0 = sin límite
+     */
+    void configurar(uint16_t pormil, uint32_t rafaga_ms, uint32_t maximo_trama_ms = 0);
+    /**
+     * @brief la trama puede transmitirse alguna vez (no supera el máximo por trama);
+     * si no, se cuenta como rechazada
+     */
+    bool admite(uint32_t aire_us);
+    /**
+     * @brief hay presupuesto para transmitir ahora una trama de aire_us
+     */
+    bool disponible(uint32_t aire_us, uint32_t ahora_us);
+    /**
+     * @brief contar una trama que no salió por falta de presupuesto
+     */
+    void contarEspera();
+    /**
+     * @brief descontar una trama que sale al aire
+     */
+    void consumir(uint32_t aire_us, uint32_t ahora_us, uint32_t ahora_ms);
+    const EstadisticasAire &estadisticas(uint32_t ahora_ms);
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include "tramas.h"
+#include <string.h>
+
+PoolTramas::PoolTramas() : _libres(NULL)
+{
+    memset(&_est, 0, sizeof(_est));
+    for (int i = 0; i < TRAMAS_POOL; i++) {
+        _tramas[i].indice = i;
+        _en_uso[i] = 0;
+    }
+}
+
+bool PoolTramas::begin() {
+    _libres = xQueueCreate(TRAMAS_POOL, sizeof(uint8_t));
+    if (_libres == NULL) return false;
+    for (uint8_t i = 0; i < TRAMAS_POOL; i++) {
+        xQueueSend(_libres, &i, 0);
+    }
+    return true;
+}
+
+Trama *PoolTramas::tomar(TickType_t espera) {
+    uint8_t i;
+    if (xQueueReceive(_libres, &i, espera) != pdTRUE) {
+        _est.agotado++;
+        return NULL;
+    }
+    _en_uso[i] = 1;
+    _est.tomadas++;
+    Trama *trama = &_tramas[i];
+    trama->largo = 0;
+    trama->tipo = 0;
+    return trama;
+}
+
+void PoolTramas::liberar(Trama *trama) {
+    if (trama == NULL) return;
+    uintptr_t p = (uintptr_t)trama, base = (uintptr_t)_tramas;
+    if (p < base || p >= base + sizeof(_tramas) || (p - base) % sizeof(Trama) != 0) {
+        _est.liberacion_invalida++;
+        return;
+    }
+    int i = (p - base) / sizeof(Trama);
+    if (!_en_uso[i]) {
+        _est.liberacion_invalida++;
+        return;
+    }
+    _en_uso[i] = 0;
+    uint8_t indice = i;
+    xQueueSend(_libres, &indice, 0); // siempre hay lugar: la cola tiene TRAMAS_POOL elementos
+}
+
+bool PoolTramas::pasar(QueueHandle_t cola, Trama *trama, TickType_t espera) {
+    if (xQueueSend(cola, &trama, espera) == pdTRUE) return true;
+    _est.cola_llena++;
+    liberar(trama);
+    return false;
+}
+
+int PoolTramas::libres() {
+    return uxQueueMessagesWaiting(_libres);
+}
+
+const EstadisticasPool &PoolTramas::estadisticas() {
+    return _est;
+}
+
+QueueHandle_t crearColaTramas(int largo) {
+    return xQueueCreate(largo, sizeof(Trama *));
+}
@@ -0,0 +1,67 @@
+#ifndef TRAMAS_H
+#define TRAMAS_H
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+/*
+    Pool de tramas compartido entre las tareas del modem.
+
+    Las tareas no copian tramas entre sí: se pasan punteros (descriptores)
+    por colas de FreeRTOS y quien recibe un puntero pasa a ser su dueño.
+    El dueño debe, o bien pasarlo a otra cola con pasar(), o devolverlo
+    con liberar(). pasar() libera la trama si la cola está llena, así una
+    trama nunca queda sin dueño. El pool detecta liberaciones dobles o de
+    punteros ajenos y las cuenta en vez de corromper la lista de libres.
+*/
+
+#define TAM_TRAMA    272   // IPv4 completo (11 + 255) más el trailer de enlace
+#define TRAMAS_POOL  16
+
+struct Trama {
+    uint8_t datos[TAM_TRAMA];
+    uint16_t largo;
+    uint8_t tipo;          // uso libre según la cola (ej: comando para el display)
+    uint8_t indice;        // posición en el pool, no modificar
+};
+
+struct EstadisticasPool {
+    uint32_t tomadas;
+    uint32_t agotado;              // pedidos sin trama libre
+    uint32_t cola_llena;           // tramas liberadas porque la cola destino estaba llena
+    uint32_t liberacion_invalida;  // doble liberación o puntero fuera del pool
+};
+
+class PoolTramas
+{
+private:
+    Trama _tramas[TRAMAS_POOL];
+    volatile uint8_t _en_uso[TRAMAS_POOL];
+    QueueHandle_t _libres;         // índices de las tramas libres
+    EstadisticasPool _est;
+public:
+    PoolTramas();
+
+    bool begin();
+    /**
+     * @brief tomar una trama libre; el llamador pasa a ser su dueño
+     *
+     * @param espera ticks a esperar si el pool está agotado
+     * @return trama o NULL si no hay
+     */
+    Trama *tomar(TickType_t espera = 0);
+    void liberar(Trama *trama);
+    /**
+     * @brief entregar la trama a otra tarea por una cola de descriptores
+     *
+     * @return false si la cola estaba llena (la trama se libera)
+     */
+    bool pasar(QueueHandle_t cola, Trama *trama, TickType_t espera = 0);
+    int libres();
+    const EstadisticasPool &estadisticas();
+};
+
+// Cola de descriptores (Trama*) de 'largo' elementos
+QueueHandle_t crearColaTramas(int largo);
+
+#endif
@@ -0,0 +1,68 @@
+/*
+    Throughput del código fuente de la difusión codificada (Fuente.h) en
+    el host: para varios K y tamaños de símbolo mide cuánto tarda
+    CodificadorFuente::generar y DecodificadorFuente::agregar por
+    símbolo, y cuántos símbolos por encima de K necesita el decodificador
+    con un 20 % de símbolos perdidos, en promedio sobre varios objetos.
+
+    Uso: make bench
+*/
+#include "Fuente.h"
+#include "Reloj.h"
+#include <cstdio>
+#include <cstdlib>
+
+#define OBJETOS 20
+#define PERDIDA_PORCENTAJE 20
+
+int main()
+{
+    const int ks[] = {8, 32, 64, 128, 255};
+    const int tamanos[] = {16, 64, 128};
+    srand(27);
+
+    printf("%5s %6s %14s %14s %12s %10s\n", "K", "bytes", "generar us", "agregar us", "decod. MB/s", "extra");
+    for (size_t t = 0; t < sizeof(tamanos) / sizeof(tamanos[0]); ++t)
+    {
+        for (size_t i = 0; i < sizeof(ks) / sizeof(ks[0]); ++i)
+        {
+            int k = ks[i];
+            int tam = tamanos[t];
+            uint64_t us_generar = 0, us_agregar = 0;
+            long generados = 0, agregados = 0, extra = 0;
+            for (int o = 0; o < OBJETOS; ++o)
+            {
+                ByteVector objeto(k * tam);
+                for (size_t b = 0; b < objeto.size(); ++b)
+                    objeto[b] = rand() & 0xFF;
+                CodificadorFuente codificador(o, objeto, tam);
+                DecodificadorFuente decodificador;
+
+                for (uint16_t esi = 0; !decodificador.completo() && esi < 4 * k + 100; ++esi)
+                {
+                    uint64_t inicio = relojUs();
+                    SimboloFuente simbolo = codificador.generar(esi);
+                    us_generar += relojUs() - inicio;
+                    generados++;
+                    if (rand() % 100 < PERDIDA_PORCENTAJE)
+                        continue;
+
+                    inicio = relojUs();
+                    decodificador.agregar(simbolo);
+                    us_agregar += relojUs() - inicio;
+                    agregados++;
+                }
+                if (!decodificador.completo() || decodificador.objeto() != objeto)
+                {
+                    printf("FALLA: K=%d tam=%d objeto %d sin decodificar\n", k, tam, o);
+                    return 1;
+                }
+                extra += decodificador.simbolosRecibidos() - k;
+            }
+            printf("%5d %6d %14.2f %14.2f %12.2f %10.2f\n", k, tam, (double)us_generar / generados,
+                   (double)us_agregar / agregados, (double)OBJETOS * k * tam / (us_agregar > 0 ? us_agregar : 1),
+                   (double)extra / OBJETOS);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+#ifndef CALIDAD_ENLACE_H
+#define CALIDAD_ENLACE_H
+
+#include "Tipos_de_Datos.h"
+#include "IPv4.h"
+
+// Bit de flag_fragmento con el que el modem indica que agregó el trailer
+// de calidad de enlace al final de los datos.
+#define FLAG_METADATA_ENLACE 0x1
+#define TAM_METADATOS_ENLACE 5 // [rssi 2B][snr/4 1B][error de frecuencia 2B]
+
+#define ALFA_EWMA_ENLACE 0.125 // peso de la muestra nueva en los promedios
+#define MAX_HUECO_ID 64        // saltos de identificador mayores se toman como reinicio del nodo
+
+struct MetadatosEnlace
+{
+    int16_t rssi;             // dBm
+    double snr;               // dB
+    int16_t error_frecuencia; // Hz
+};
+
+struct CalidadEnlace
+{
+    double rssi_ewma;
+    double snr_ewma;
+    double perdida_ewma; // fracción estimada de paquetes perdidos (0..1)
+    int16_t ultimo_rssi;
+    double ultimo_snr;
+    int16_t error_frecuencia;
+    uint16_t ultimo_id;
+    uint64_t ultimo_ms;
+    uint32_t paquetes;
+    uint32_t perdidos;
+    bool con_metadatos;
+};
+
+// Quita el trailer de enlace de los datos si el paquete lo trae
+bool extraerMetadatosEnlace(IPv4 &paquete, MetadatosEnlace &enlace);
+
+// Actualiza la calidad del enlace con un paquete recibido del vecino.
+// La pérdida se estima por huecos en el identificador del emisor; como
+// el identificador también avanza con tramas dirigidas a otros nodos,
+// es una cota superior de la pérdida real.
+void actualizarCalidadEnlace(CalidadEnlace &calidad, uint16_t identificador,
+                             const MetadatosEnlace *enlace, uint64_t ahora_ms);
+
+#endif // CALIDAD_ENLACE_H
@@ -0,0 +1,87 @@
+#ifndef FUENTE_H
+#define FUENTE_H
+
+#include "Tipos_de_Datos.h"
+
+/*
+    Código fuente (rateless) para difusión de objetos grandes por broadcast.
+
+    El objeto se divide en K símbolos de igual tamaño. Los símbolos con
+    ESI < K son los originales (código sistemático); los siguientes son
+    combinaciones XOR pseudoaleatorias de los originales, derivadas sólo
+    de (id_objeto, ESI), por lo que el receptor las reconstruye sin que
+    viajen en la trama. Cada receptor decodifica por eliminación gaussiana
+    sobre GF(2) apenas junta K símbolos linealmente independientes
+    (típicamente K + 2), sin importar cuáles perdió. No se envían ACKs.
+
+    Cabecera de cada símbolo (dentro de los datos IPv4, protocolo 8):
+    [id_objeto 2B][K 1B][tam_simbolo 1B][largo_objeto 2B][ESI 2B][símbolo]
+*/
+
+#define FUENTE_CABECERA 8
+#define FUENTE_MAX_SIMBOLOS 255
+#define FUENTE_TAM_SIMBOLO 64 // bytes por símbolo (cabe en una trama LoRa)
+
+struct SimboloFuente
+{
+    uint16_t id_objeto;
+    BYTE k;
+    BYTE tam_simbolo;
+    uint16_t largo_objeto;
+    uint16_t esi;
+    ByteVector datos;
+};
+
+ByteVector construirSimboloFuente(const SimboloFuente &simbolo);
+bool parsearSimboloFuente(const ByteVector &entrada, SimboloFuente &simbolo);
+
+class CodificadorFuente
+{
+public:
+    CodificadorFuente(uint16_t id_objeto, const ByteVector &objeto, int tam_simbolo = FUENTE_TAM_SIMBOLO);
+
+    bool valido() const;
+    int cantidadFuente() const; // K
+    SimboloFuente generar(uint16_t esi) const;
+
+private:
+    uint16_t id_objeto_;
+    uint16_t largo_objeto_;
+    int tam_simbolo_;
+    int k_;
+    std::vector<ByteVector> fuente_;
+};
+
+class DecodificadorFuente
+{
+public:
+    DecodificadorFuente();
+
+    // Agrega un símbolo; retorna true cuando el objeto quedó completo
+    bool agregar(const SimboloFuente &simbolo);
+    bool completo() const;
+    ByteVector objeto() const;
+    int simbolosRecibidos() const;
+    int rango() const;
+
+    Tiempo ultimo_simbolo;
+
+private:
+    typedef std::vector<uint64_t> Fila;
+
+    void resolver();
+
+    bool iniciado_;
+    bool completo_;
+    uint16_t id_objeto_;
+    uint16_t largo_objeto_;
+    int tam_simbolo_;
+    int k_;
+    int recibidos_;
+    int rango_;
+    std::vector<Fila> coeficientes_; // fila pivote indexada por su columna líder
+    std::vector<ByteVector> datos_;
+    std::vector<bool> hay_pivote_;
+};
+
+#endif // FUENTE_H
@@ -5,15 +5,52 @@
 #include "ComunicacionUART.h"
 #include "IPv4.h"
 #include "PropioProtocolo.h"
+#include "Fuente.h"
+#include "CalidadEnlace.h"
+#include "Trickle.h"
+#include "Telemetria.h"
+#include "RegistroProtocolos.h"
 #include <map>
+#include <set>
 #include <iostream>
 
+// Difusión codificada (protocolo 8)
+#define REDUNDANCIA_FUENTE_PORCENTAJE 50     // símbolos extra sobre K que se envían
+#define INTERVALO_SIMBOLO_FUENTE_US 200000   // pausa entre símbolos para no saturar el modem
+#define TIMEOUT_DIFUSION_FUENTE 60           // segundos sin símbolos para descartar una difusión
+
+// Hello automáticos (temporizador Trickle)
+#define HELLO_IMIN_MS 2000                   // intervalo mínimo tras un cambio de vecinos
+#define HELLO_DUPLICACIONES 6                // Imax = Imin * 2^6 (~2 minutos)
+#define HELLO_REDUNDANCIA 2                  // Hello consistentes que suprimen el propio
+#define HELLO_JITTER_RESPUESTA_MS 1500       // retardo máximo de la respuesta a un vecino nuevo
+#define VIDA_VECINO_HELLO 300                // segundos sin Hello para olvidar un nodo
+
+// Entrega en el modem: el modem de destino confirma apenas recibe la trama
+// y el de origen retransmite y avisa el resultado con el comando
+// CMD_ENTREGA (ver Modem/entrega.h), sin el ACK del Nodo de por medio
+#define ENTREGA_EN_MODEM 1
+#define FLAG_ENTREGA_MODEM 0x4
+#define CMD_ENTREGA 11
+#define ENTREGA_SIN_SEGUIMIENTO 2            // estado del aviso: por malla o sin lugar en el modem
+#define TIMEOUT_ENTREGA_MODEM 60             // segundos sin aviso del modem para descartar
+#define ID_MAXIMO_NODO 0x7FFF                // los identificadores con el bit alto son del modem
+
+// Dirección y grupos de multicast que el Nodo configura en el modem (ver
+// Modem/grupos.h): el modem sólo sube a la UART lo dirigido a esta IP, el
+// broadcast y los grupos 0xFF00-0xFFFE de los que el Nodo es miembro
+#define CMD_DIRECCION 12
+#define CMD_GRUPOS 13
+#define BASE_GRUPOS 0xFF00
+#define MAX_GRUPOS_NODO 63                   // los que caben en un comando
+
 struct ACKPendiente
 {
     uint16_t ip_destino;
     uint16_t id_mensaje;
     int intentos;
     time_t tiempo_envio;
+    bool en_modem; // el resultado llega con el aviso del modem
 };
 
 class Nodo
@@ -23,7 +60,16 @@ private:
     uint16_t ip_nodo;
     uint16_t contador_id;
     std::map<uint16_t, time_t> tablaNodosHello;
+    std::map<uint16_t, CalidadEnlace> tablaVecinos; // calidad de enlace medida por el modem
     std::map<uint16_t, ACKPendiente> acksEsperando;
+    std::map<uint32_t, DecodificadorFuente> difusionesFuente; // (origen << 16 | id_objeto)
+    Trickle trickleHello;
+    std::map<uint16_t, uint64_t> respuestasHello; // vecino nuevo -> instante de la respuesta (ms)
+    TelemetriaModem telemetriaModem;
+    uint64_t proximaTelemetria; // instante de la próxima consulta al modem (ms)
+    std::set<uint8_t> gruposMulticast;
+    RegistroProtocolos protocolos;
+    int resumenesPorAvisar; // lotes del usuario cuyo resumen se muestra
 
     // Métodos del menú
     void menu();
@@ -32,10 +78,16 @@ private:
 
     // Métodos de comunicación
     void actualizarMensajesEntrantes();
+    void registrarProtocolos();
     void enviarPaquete(const IPv4 &paquete);
     void enviarACK(uint16_t ip_destino, uint16_t id_mensaje);
+    void confirmar(const IPv4 &paquete);
     void enviarComandoAlModem(const PropioProtocolo &comando);
+    void enviarLoteAlModem(const LoteComandos &lote);
+    void configurarModem();
+    void enviarGruposAlModem();
     void verificarACKsPendientes();
+    void tareasPeriodicas();
 
     // Métodos de procesamiento de mensajes
     void procesarACK(const IPv4 &paquete);
@@ -45,18 +97,34 @@ private:
     void procesarComandoPrueba(const IPv4 &paquete);
     void procesarComandoLed(const IPv4 &paquete);
     void procesarComandoOLED(const IPv4 &paquete);
+    void procesarSimboloFuente(const IPv4 &paquete);
+    void procesarRespuestaModem(const IPv4 &paquete);
+    void procesarComandoModem(const ByteVector &datos);
+    void procesarLoteModem(const ByteVector &datos);
+    void procesarAvisoEntrega(const ByteVector &datos);
+    void procesarConfiguracionModem(const ByteVector &datos);
 
     // Métodos de envío
     void verNodos();
     void enviarHello();
+    void transmitirHello(uint16_t ip_destino);
+    void expirarVecinosHello();
     void enviarMensajeUnicast();
-    void enviarMensajeBroadcast();
+    void enviarMensajeBroadcast(uint16_t ip_destino = 0xFFFF);
+    void enviarMensajeGrupo();
+    void enviarDifusionCodificada();
     void enviarComandoPrueba();
     void enviarComandoLed();
     void enviarMensajeOLED();
+    void pedirTelemetria();
+    void verTelemetria();
+    void cambiarGrupos();
+    void enviarSecuenciaComandos();
 
     // Utilidades
     uint16_t obtenerNuevoID();
+    bool esGrupoPropio(uint16_t ip) const;
+    void avisarSiNoEsVecino(uint16_t ip_destino) const;
     void limpiarPantalla();
 
     // Manejo de entrada No Bloqueante
@@ -65,7 +133,7 @@ private:
     bool leerLineaNoBloqueante(std::string &buffer);
 
 public:
-    Nodo(uint16_t ip);
+    Nodo(uint16_t ip, const std::string &dispositivo = "/dev/ttyUSB0");
     ~Nodo();
     void run();
 };
@@ -13,9 +13,39 @@ struct PropioProtocolo
     BYTE fcs;
 };
 
+// Lote de comandos en una sola trama (ver Modem/lote.h): el modem los
+// ejecuta en orden y devuelve las respuestas juntas, cerradas por un
+// resumen [CMD_LOTE][1][comandos ejecutados].
+// [CMD_LOTE][tramos][cmd][largo 0-63][dato]...[fcs], fcs: XOR de lo anterior.
+// Un dato de más de 63 bytes va en tramos con CMD_CONTINUA en todos menos el último
+#define CMD_LOTE 14
+#define CMD_CONTINUA 0x80
+#define MAX_DATO_COMANDO 63
+#define MAX_DATO_ENCADENADO 189
+#define MAX_LOTE 240
+
+class LoteComandos
+{
+private:
+    ByteVector tramos;
+    int cantidadTramos;
+    int cantidadComandos;
+
+public:
+    LoteComandos();
+    // false si no cabe o el dato pasa de MAX_DATO_ENCADENADO: el lote no cambia
+    bool agregar(BYTE cmd, const ByteVector &dato);
+    bool agregar(const PropioProtocolo &comando);
+    int comandos() const { return cantidadComandos; }
+    ByteVector construir() const;
+};
+
 // Funciones para manejar el protocolo
 ByteVector construirProtocoloPropio(const PropioProtocolo &protocolo);
 bool parsearProtocoloPropio(const ByteVector &entrada, PropioProtocolo &protocolo);
 BYTE calcularFCS(const PropioProtocolo &protocolo);
+// Comandos de un lote como [cmd][largo][dato][fcs], con los tramos ya unidos
+// y el FCS del modem (XOR de cmd, largo y dato)
+bool parsearLoteComandos(const ByteVector &entrada, std::vector<ByteVector> &comandos);
 
 #endif // PROPIO_PROTOCOLO_H
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef REGISTRO_PROTOCOLOS_H
+#define REGISTRO_PROTOCOLOS_H
+
+#include "Tipos_de_Datos.h"
+#include "IPv4.h"
+#include <functional>
+#include <ostream>
+
+/*
+    Manejadores de lo que llega del modem, por número de protocolo IPv4.
+
+    Cada protocolo se registra en tiempo de ejecución con un nombre y su
+    manejador; el despacho es un acceso indexado a una tabla de 256
+    entradas que mide cada llamada, así que las tramas y el tiempo por
+    protocolo se acumulan sin que el manejador haga nada. Un protocolo
+    nuevo se agrega con registrar(), sin tocar el lazo de recepción.
+
+    También guarda el mismo costo medido en el despacho de la UART del
+    modem, que se consulta con CMD_PROTOCOLOS por páginas (ver
+    Modem/protocolos.h): [siguiente][protocolo][tramas 4B][us medio 2B][us máximo 2B]...
+*/
+
+#define CMD_PROTOCOLOS 15
+#define ENTRADA_PROTOCOLO 9
+#define PROTOCOLO_OTROS_MODEM 16 // el modem junta aquí los números desde 16
+
+class RegistroProtocolos
+{
+public:
+    typedef std::function<void(const IPv4 &)> Manejador;
+
+    RegistroProtocolos();
+
+    // Reemplaza al manejador que hubiera para ese número
+    void registrar(BYTE protocolo, const std::string &nombre, const Manejador &manejador);
+    // false si el protocolo no tiene manejador (la trama se cuenta igual)
+    bool despachar(const IPv4 &paquete);
+
+    // Página de la respuesta del modem: [cmd][largo][siguiente][entrada]...[fcs]
+    bool registrarModem(const ByteVector &datos);
+    // Página a pedir en la próxima consulta al modem
+    BYTE siguientePaginaModem() const { return paginaModem_; }
+    void mostrar(std::ostream &salida) const;
+
+private:
+    struct Entrada
+    {
+        std::string nombre;
+        Manejador manejador;
+        uint32_t tramas;
+        uint64_t us_total;
+        uint64_t us_maximo;
+    };
+    struct EntradaModem
+    {
+        uint32_t tramas;
+        uint16_t us_medio;
+        uint16_t us_maximo;
+    };
+
+    std::vector<Entrada> entradas_;
+    std::vector<EntradaModem> modem_; // protocolos 0 a PROTOCOLO_OTROS_MODEM
+    BYTE paginaModem_;
+
+    std::string nombre(int protocolo) const;
+};
+
+#endif // REGISTRO_PROTOCOLOS_H
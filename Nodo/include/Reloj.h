@@ -0,0 +1,11 @@
+#ifndef RELOJ_H
+#define RELOJ_H
+
+#include <cstdint>
+
+// Milisegundos de un reloj monotónico (no retrocede si cambia la hora del sistema)
+uint64_t relojMs();
+// Microsegundos del mismo reloj, para medir lo que dura un manejador
+uint64_t relojUs();
+
+#endif // RELOJ_H
@@ -0,0 +1,61 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include "Tipos_de_Datos.h"
+#include <ostream>
+
+/*
+    Telemetría del modem consultada con el comando 8 del protocolo propio.
+
+    El modem responde un bloque de contadores por pedido (no caben todos
+    en los 63 bytes de dato): [versión][bloque][bloques][millis 4B]
+    [contador 4B]... big endian. El Nodo pide un bloque por vez, rotando,
+    y calcula la tasa de cada contador con el reloj del modem entre dos
+    respuestas del mismo bloque. La lista de contadores tiene el mismo
+    orden que ContadorTelemetria en el firmware (Modem/telemetria.h).
+*/
+
+#define CMD_TELEMETRIA 8
+#define VERSION_TELEMETRIA 1
+#define CABECERA_BLOQUE_TELEMETRIA 7
+#define INTERVALO_TELEMETRIA_MS 2000 // un bloque por consulta
+
+struct BloqueTelemetria
+{
+    BYTE bloque;
+    BYTE bloques;
+    uint32_t tiempo_ms; // millis() del modem al responder
+    std::vector<uint32_t> valores;
+};
+
+// Datos de la respuesta del modem: [cmd][largo][bloque][fcs]
+bool parsearBloqueTelemetria(const ByteVector &datos, BloqueTelemetria &bloque);
+
+class TelemetriaModem
+{
+public:
+    TelemetriaModem();
+
+    // Bloque a pedir en la próxima consulta
+    BYTE siguienteBloque();
+    void registrar(const BloqueTelemetria &bloque);
+    bool vacia() const;
+    void mostrar(std::ostream &salida) const;
+
+private:
+    struct Muestra
+    {
+        uint32_t valor;
+        uint32_t tiempo_ms;
+        uint32_t anterior;
+        uint32_t tiempo_anterior_ms;
+        bool valida;
+        bool con_anterior;
+    };
+
+    std::vector<Muestra> muestras_;
+    BYTE bloques_;
+    BYTE proximo_;
+};
+
+#endif // TELEMETRIA_H
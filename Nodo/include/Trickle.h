@@ -0,0 +1,41 @@
+#ifndef TRICKLE_H
+#define TRICKLE_H
+
+#include <cstdint>
+
+/*
+    Temporizador Trickle (RFC 6206) para los Hello automáticos.
+
+    Cada intervalo I se elige un instante t al azar en [I/2, I). Al llegar
+    a t se transmite sólo si se escucharon menos de k mensajes consistentes
+    (Hello de vecinos ya conocidos) durante el intervalo. Al terminar el
+    intervalo, I se duplica hasta Imax. Una inconsistencia (vecino nuevo o
+    vencido) vuelve I a Imin para reaccionar rápido.
+*/
+class Trickle
+{
+public:
+    Trickle(uint64_t imin_ms, int duplicaciones, int k);
+
+    void iniciar(uint64_t ahora_ms);
+    void reiniciar(uint64_t ahora_ms); // inconsistencia detectada
+    void consistente();                // se escuchó un mensaje consistente
+
+    // true una vez por intervalo, en el instante t, si no hubo supresión
+    bool debeTransmitir(uint64_t ahora_ms);
+    uint64_t intervalo() const;
+
+private:
+    void nuevoIntervalo(uint64_t ahora_ms);
+
+    uint64_t imin_;
+    uint64_t imax_;
+    int k_;
+    uint64_t i_;
+    uint64_t inicio_;
+    uint64_t t_;
+    int c_;
+    bool evaluado_;
+};
+
+#endif // TRICKLE_H
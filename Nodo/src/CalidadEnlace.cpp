@@ -0,0 +1,62 @@
+#include "CalidadEnlace.h"
+
+bool extraerMetadatosEnlace(IPv4 &paquete, MetadatosEnlace &enlace)
+{
+    if (!(paquete.flag_fragmento & FLAG_METADATA_ENLACE) || paquete.datos.size() < TAM_METADATOS_ENLACE)
+        return false;
+
+    size_t inicio = paquete.datos.size() - TAM_METADATOS_ENLACE;
+    const BYTE *t = &paquete.datos[inicio];
+
+    enlace.rssi = (int16_t)((t[0] << 8) | t[1]);
+    enlace.snr = (int8_t)t[2] * 0.25;
+    enlace.error_frecuencia = (int16_t)((t[3] << 8) | t[4]);
+
+    paquete.datos.resize(inicio);
+    paquete.flag_fragmento &= ~FLAG_METADATA_ENLACE;
+    return true;
+}
+
+void actualizarCalidadEnlace(CalidadEnlace &calidad, uint16_t identificador,
+                             const MetadatosEnlace *enlace, uint64_t ahora_ms)
+{
+    if (calidad.paquetes == 0)
+    {
+        calidad.perdida_ewma = 0.0;
+        calidad.perdidos = 0;
+        calidad.con_metadatos = false;
+    }
+    else
+    {
+        uint16_t hueco = (uint16_t)(identificador - calidad.ultimo_id - 1);
+        if (hueco > 0 && hueco <= MAX_HUECO_ID)
+        {
+            calidad.perdidos += hueco;
+            for (uint16_t i = 0; i < hueco; ++i)
+                calidad.perdida_ewma += ALFA_EWMA_ENLACE * (1.0 - calidad.perdida_ewma);
+        }
+        calidad.perdida_ewma *= (1.0 - ALFA_EWMA_ENLACE);
+    }
+
+    if (enlace != NULL)
+    {
+        if (!calidad.con_metadatos)
+        {
+            calidad.rssi_ewma = enlace->rssi;
+            calidad.snr_ewma = enlace->snr;
+            calidad.con_metadatos = true;
+        }
+        else
+        {
+            calidad.rssi_ewma += ALFA_EWMA_ENLACE * (enlace->rssi - calidad.rssi_ewma);
+            calidad.snr_ewma += ALFA_EWMA_ENLACE * (enlace->snr - calidad.snr_ewma);
+        }
+        calidad.ultimo_rssi = enlace->rssi;
+        calidad.ultimo_snr = enlace->snr;
+        calidad.error_frecuencia = enlace->error_frecuencia;
+    }
+
+    calidad.ultimo_id = identificador;
+    calidad.ultimo_ms = ahora_ms;
+    calidad.paquetes++;
+}
@@ -0,0 +1,258 @@
+#include "Fuente.h"
+#include <ctime>
+
+// Mezclador de 32 bits (finalizador de MurmurHash3) aplicado a un contador
+// sembrado con (id_objeto, esi): emisor y receptores obtienen exactamente
+// la misma combinación de símbolos fuente.
+static uint32_t siguienteAleatorio(uint32_t &estado)
+{
+    uint32_t h = (estado += 0x9E3779B9u);
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static void coeficientesSimbolo(uint16_t id_objeto, uint16_t esi, int k, std::vector<uint64_t> &fila)
+{
+    fila.assign((k + 63) / 64, 0);
+
+    if (esi < k)
+    {
+        fila[esi / 64] = 1ULL << (esi % 64);
+        return;
+    }
+
+    uint32_t estado = ((uint32_t)id_objeto << 16) | esi;
+    estado = siguienteAleatorio(estado);
+
+    // Fuente lineal aleatoria: cada símbolo fuente entra con probabilidad 1/2
+    bool vacia = true;
+    for (int i = 0; i < k; i += 32)
+    {
+        uint32_t bits = siguienteAleatorio(estado);
+        for (int j = 0; j < 32 && i + j < k; ++j)
+        {
+            if (bits & (1u << j))
+            {
+                fila[(i + j) / 64] |= 1ULL << ((i + j) % 64);
+                vacia = false;
+            }
+        }
+    }
+    if (vacia)
+    {
+        int c = siguienteAleatorio(estado) % k;
+        fila[c / 64] |= 1ULL << (c % 64);
+    }
+}
+
+ByteVector construirSimboloFuente(const SimboloFuente &simbolo)
+{
+    ByteVector salida;
+    salida.push_back((simbolo.id_objeto >> 8) & 0xFF);
+    salida.push_back(simbolo.id_objeto & 0xFF);
+    salida.push_back(simbolo.k);
+    salida.push_back(simbolo.tam_simbolo);
+    salida.push_back((simbolo.largo_objeto >> 8) & 0xFF);
+    salida.push_back(simbolo.largo_objeto & 0xFF);
+    salida.push_back((simbolo.esi >> 8) & 0xFF);
+    salida.push_back(simbolo.esi & 0xFF);
+    salida.insert(salida.end(), simbolo.datos.begin(), simbolo.datos.end());
+    return salida;
+}
+
+bool parsearSimboloFuente(const ByteVector &entrada, SimboloFuente &simbolo)
+{
+    if (entrada.size() < FUENTE_CABECERA)
+        return false;
+
+    simbolo.id_objeto = (entrada[0] << 8) | entrada[1];
+    simbolo.k = entrada[2];
+    simbolo.tam_simbolo = entrada[3];
+    simbolo.largo_objeto = (entrada[4] << 8) | entrada[5];
+    simbolo.esi = (entrada[6] << 8) | entrada[7];
+
+    if (simbolo.k == 0 || simbolo.tam_simbolo == 0)
+        return false;
+    if (entrada.size() != (size_t)FUENTE_CABECERA + simbolo.tam_simbolo)
+        return false;
+    if (simbolo.largo_objeto > simbolo.k * simbolo.tam_simbolo)
+        return false;
+
+    simbolo.datos.assign(entrada.begin() + FUENTE_CABECERA, entrada.end());
+    return true;
+}
+
+CodificadorFuente::CodificadorFuente(uint16_t id_objeto, const ByteVector &objeto, int tam_simbolo)
+    : id_objeto_(id_objeto), largo_objeto_(objeto.size()), tam_simbolo_(tam_simbolo), k_(0)
+{
+    if (tam_simbolo_ <= 0 || objeto.empty() || objeto.size() > 0xFFFF)
+        return;
+
+    k_ = (objeto.size() + tam_simbolo_ - 1) / tam_simbolo_;
+    if (k_ > FUENTE_MAX_SIMBOLOS)
+    {
+        k_ = 0;
+        return;
+    }
+
+    // El último símbolo se rellena con ceros
+    fuente_.resize(k_, ByteVector(tam_simbolo_, 0));
+    for (size_t i = 0; i < objeto.size(); ++i)
+    {
+        fuente_[i / tam_simbolo_][i % tam_simbolo_] = objeto[i];
+    }
+}
+
+bool CodificadorFuente::valido() const
+{
+    return k_ > 0;
+}
+
+int CodificadorFuente::cantidadFuente() const
+{
+    return k_;
+}
+
+SimboloFuente CodificadorFuente::generar(uint16_t esi) const
+{
+    SimboloFuente simbolo;
+    simbolo.id_objeto = id_objeto_;
+    simbolo.k = k_;
+    simbolo.tam_simbolo = tam_simbolo_;
+    simbolo.largo_objeto = largo_objeto_;
+    simbolo.esi = esi;
+    simbolo.datos.assign(tam_simbolo_, 0);
+
+    std::vector<uint64_t> fila;
+    coeficientesSimbolo(id_objeto_, esi, k_, fila);
+
+    for (int i = 0; i < k_; ++i)
+    {
+        if (fila[i / 64] & (1ULL << (i % 64)))
+        {
+            for (int j = 0; j < tam_simbolo_; ++j)
+                simbolo.datos[j] ^= fuente_[i][j];
+        }
+    }
+
+    return simbolo;
+}
+
+DecodificadorFuente::DecodificadorFuente()
+    : ultimo_simbolo(0), iniciado_(false), completo_(false), id_objeto_(0), largo_objeto_(0),
+      tam_simbolo_(0), k_(0), recibidos_(0), rango_(0) {}
+
+bool DecodificadorFuente::agregar(const SimboloFuente &simbolo)
+{
+    if (completo_)
+        return false;
+
+    if (!iniciado_)
+    {
+        id_objeto_ = simbolo.id_objeto;
+        largo_objeto_ = simbolo.largo_objeto;
+        tam_simbolo_ = simbolo.tam_simbolo;
+        k_ = simbolo.k;
+        coeficientes_.assign(k_, Fila());
+        datos_.assign(k_, ByteVector());
+        hay_pivote_.assign(k_, false);
+        iniciado_ = true;
+    }
+    else if (simbolo.id_objeto != id_objeto_ || simbolo.k != k_ || simbolo.tam_simbolo != tam_simbolo_)
+    {
+        return false;
+    }
+
+    recibidos_++;
+    ultimo_simbolo = time(NULL);
+
+    Fila fila;
+    coeficientesSimbolo(id_objeto_, simbolo.esi, k_, fila);
+    ByteVector datos = simbolo.datos;
+
+    // Eliminación incremental: se reduce contra los pivotes existentes y,
+    // si queda una columna libre, la fila pasa a ser su pivote.
+    for (int c = 0; c < k_; ++c)
+    {
+        if (!(fila[c / 64] & (1ULL << (c % 64))))
+            continue;
+
+        if (hay_pivote_[c])
+        {
+            const Fila &pivote = coeficientes_[c];
+            for (size_t w = c / 64; w < fila.size(); ++w)
+                fila[w] ^= pivote[w];
+            const ByteVector &datos_pivote = datos_[c];
+            for (int j = 0; j < tam_simbolo_; ++j)
+                datos[j] ^= datos_pivote[j];
+        }
+        else
+        {
+            coeficientes_[c].swap(fila);
+            datos_[c].swap(datos);
+            hay_pivote_[c] = true;
+            rango_++;
+            break;
+        }
+    }
+
+    if (rango_ == k_)
+    {
+        resolver();
+        completo_ = true;
+        return true;
+    }
+    return false;
+}
+
+void DecodificadorFuente::resolver()
+{
+    // Sustitución hacia atrás: la matriz ya es triangular superior
+    for (int c = k_ - 1; c >= 0; --c)
+    {
+        Fila &fila = coeficientes_[c];
+        for (int j = c + 1; j < k_; ++j)
+        {
+            if (fila[j / 64] & (1ULL << (j % 64)))
+            {
+                fila[j / 64] ^= 1ULL << (j % 64);
+                for (int b = 0; b < tam_simbolo_; ++b)
+                    datos_[c][b] ^= datos_[j][b];
+            }
+        }
+    }
+}
+
+bool DecodificadorFuente::completo() const
+{
+    return completo_;
+}
+
+ByteVector DecodificadorFuente::objeto() const
+{
+    ByteVector salida;
+    if (!completo_)
+        return salida;
+
+    for (int i = 0; i < k_ && (int)salida.size() < largo_objeto_; ++i)
+    {
+        size_t restante = largo_objeto_ - salida.size();
+        size_t n = restante < (size_t)tam_simbolo_ ? restante : tam_simbolo_;
+        salida.insert(salida.end(), datos_[i].begin(), datos_[i].begin() + n);
+    }
+    return salida;
+}
+
+int DecodificadorFuente::simbolosRecibidos() const
+{
+    return recibidos_;
+}
+
+int DecodificadorFuente::rango() const
+{
+    return rango_;
+}
@@ -3,11 +3,13 @@
 #include "Slip.h"
 #include "IPv4.h"
 #include "PropioProtocolo.h"
+#include "Reloj.h"
 #include <iostream>
 #include <map>
 #include <cstdlib>
 #include <ctime>
 #include <sstream>
+#include <fstream>
 #include <unistd.h>
 
 #include <termios.h>
@@ -15,8 +17,12 @@
 #include <sys/select.h>
 #include <sys/time.h>
 
-Nodo::Nodo(uint16_t ip) : uart("/dev/ttyUSB0", 115200), ip_nodo(ip), contador_id(1)
+Nodo::Nodo(uint16_t ip, const std::string &dispositivo)
+    : uart(dispositivo, 115200), ip_nodo(ip), contador_id(1),
+      trickleHello(HELLO_IMIN_MS, HELLO_DUPLICACIONES, HELLO_REDUNDANCIA), proximaTelemetria(0),
+      resumenesPorAvisar(0)
 {
+    registrarProtocolos();
     if (!uart.abrir())
     {
         std::cerr << "Error: No se pudo abrir el puerto UART" << std::endl;
@@ -30,7 +36,24 @@ Nodo::~Nodo()
 
 uint16_t Nodo::obtenerNuevoID()
 {
-    return contador_id++;
+    // 1..ID_MAXIMO_NODO: el modem origina tramas con la misma IP y los
+    // identificadores de arriba
+    uint16_t id = contador_id;
+    contador_id = contador_id < ID_MAXIMO_NODO ? contador_id + 1 : 1;
+    return id;
+}
+
+bool Nodo::esGrupoPropio(uint16_t ip) const
+{
+    return ip >= BASE_GRUPOS && ip != 0xFFFF && gruposMulticast.count(ip & 0xFF) > 0;
+}
+
+void Nodo::avisarSiNoEsVecino(uint16_t ip_destino) const
+{
+    // Puede estar a varios saltos: el modem lo enruta por la malla si conoce una ruta
+    if (tablaNodosHello.find(ip_destino) == tablaNodosHello.end() && ip_destino != ip_nodo)
+        std::cout << "[!] Nodo 0x" << std::hex << ip_destino << std::dec
+                  << " no es vecino directo (sin Hello). Se enviará por la malla." << std::endl;
 }
 
 void Nodo::limpiarPantalla()
@@ -40,6 +63,8 @@ void Nodo::limpiarPantalla()
 
 void Nodo::actualizarMensajesEntrantes()
 {
+    tareasPeriodicas();
+
     ByteVector datos_recibidos = uart.recibir();
 
     if (datos_recibidos.empty())
@@ -59,44 +84,45 @@ void Nodo::actualizarMensajesEntrantes()
         return;
     }
 
-    // Verificar que el paquete esté dirigido a este nodo o sea broadcast
-    if (paquete.ip_destino != ip_nodo && paquete.ip_destino != 0xFFFF)
+    // Trailer de RSSI/SNR que agrega el modem a lo recibido por LoRa
+    MetadatosEnlace enlace;
+    bool con_enlace = extraerMetadatosEnlace(paquete, enlace);
+
+    // Verificar que el paquete esté dirigido a este nodo, sea broadcast o de un grupo propio
+    // (el modem ya descarta el resto; esto cubre un modem sin configurar)
+    if (paquete.ip_destino != ip_nodo && paquete.ip_destino != 0xFFFF && !esGrupoPropio(paquete.ip_destino))
     {
         return; // No es para este nodo
     }
 
-    // Procesar diferentes tipos de mensajes según protocolo
-    switch (paquete.protocolo)
-    {
-    case 1: // ACK
-        procesarACK(paquete);
-        break;
-    case 2: // Mensaje Unicast
-        procesarMensajeUnicast(paquete);
-        break;
-    case 3: // Mensaje Broadcast
-        procesarMensajeBroadcast(paquete);
-        break;
-    case 4: // Hello
-        procesarHello(paquete);
-        break;
-    case 5: // Prueba
-        procesarComandoPrueba(paquete);
-        break;
-    case 6: // Estado Led
-        procesarComandoLed(paquete);
-        break;
-    case 7: // Mensaje en OLED
-        procesarComandoOLED(paquete);
-        break;
-    default:
+    if (paquete.ip_origen != ip_nodo)
+    {
+        actualizarCalidadEnlace(tablaVecinos[paquete.ip_origen], paquete.identificador,
+                                con_enlace ? &enlace : NULL, relojMs());
+    }
+
+    // Despacho por número de protocolo (ver registrarProtocolos)
+    if (!protocolos.despachar(paquete))
+    {
         std::cout << "[!] Protocolo desconocido: " << (int)paquete.protocolo << std::endl;
-        break;
     }
 
     verificarACKsPendientes();
 }
 
+void Nodo::registrarProtocolos()
+{
+    protocolos.registrar(0, "Propio", [this](const IPv4 &p) { procesarRespuestaModem(p); });
+    protocolos.registrar(1, "ACK", [this](const IPv4 &p) { procesarACK(p); });
+    protocolos.registrar(2, "Unicast", [this](const IPv4 &p) { procesarMensajeUnicast(p); });
+    protocolos.registrar(3, "Broadcast", [this](const IPv4 &p) { procesarMensajeBroadcast(p); });
+    protocolos.registrar(4, "Hello", [this](const IPv4 &p) { procesarHello(p); });
+    protocolos.registrar(5, "Prueba", [this](const IPv4 &p) { procesarComandoPrueba(p); });
+    protocolos.registrar(6, "LED", [this](const IPv4 &p) { procesarComandoLed(p); });
+    protocolos.registrar(7, "OLED", [this](const IPv4 &p) { procesarComandoOLED(p); });
+    protocolos.registrar(8, "Codificada", [this](const IPv4 &p) { procesarSimboloFuente(p); });
+}
+
 void Nodo::procesarACK(const IPv4 &paquete)
 {
     if (paquete.datos.size() >= 2)
@@ -119,21 +145,44 @@ void Nodo::procesarMensajeUnicast(const IPv4 &paquete)
     std::cout << "[+] Mensaje unicast de nodo 0x" << std::hex << paquete.ip_origen << std::dec << ": ";
     std::cout << std::string(paquete.datos.begin(), paquete.datos.end()) << std::endl;
 
-    // Enviar ACK
-    enviarACK(paquete.ip_origen, paquete.identificador);
+    confirmar(paquete);
 }
 
 void Nodo::procesarMensajeBroadcast(const IPv4 &paquete)
 {
-    std::cout << "[+] Mensaje broadcast de nodo 0x" << std::hex << paquete.ip_origen << std::dec << ": ";
+    if (paquete.ip_destino != 0xFFFF)
+        std::cout << "[+] Mensaje al grupo " << std::hex << (paquete.ip_destino & 0xFF) << " de nodo 0x"
+                  << paquete.ip_origen << std::dec << ": ";
+    else
+        std::cout << "[+] Mensaje broadcast de nodo 0x" << std::hex << paquete.ip_origen << std::dec << ": ";
     std::cout << std::string(paquete.datos.begin(), paquete.datos.end()) << std::endl;
 }
 
 void Nodo::procesarHello(const IPv4 &paquete)
 {
+    if (paquete.ip_origen == ip_nodo)
+        return;
+
     time_t ahora = time(NULL);
+    bool nuevo = tablaNodosHello.find(paquete.ip_origen) == tablaNodosHello.end();
     tablaNodosHello[paquete.ip_origen] = ahora;
     // No mostrar mensaje Hello según requisitos
+
+    if (!nuevo)
+    {
+        trickleHello.consistente();
+        return;
+    }
+
+    // Vecino nuevo: la topología cambió, se vuelve al intervalo mínimo.
+    // Si llegó por broadcast se le responde en unicast con un retardo
+    // aleatorio para que los vecinos que lo oyeron no respondan a la vez.
+    uint64_t ahora_ms = relojMs();
+    trickleHello.reiniciar(ahora_ms);
+    if (paquete.ip_destino == 0xFFFF)
+    {
+        respuestasHello[paquete.ip_origen] = ahora_ms + rand() % (HELLO_JITTER_RESPUESTA_MS + 1);
+    }
 }
 
 void Nodo::procesarComandoPrueba(const IPv4 &paquete)
@@ -147,7 +196,7 @@ void Nodo::procesarComandoPrueba(const IPv4 &paquete)
     comando.fcs = calcularFCS(comando);
     enviarComandoAlModem(comando);
 
-    enviarACK(paquete.ip_origen, paquete.identificador);
+    confirmar(paquete);
 }
 
 void Nodo::procesarComandoLed(const IPv4 &paquete)
@@ -161,7 +210,7 @@ void Nodo::procesarComandoLed(const IPv4 &paquete)
     comando.fcs = calcularFCS(comando);
     enviarComandoAlModem(comando);
 
-    enviarACK(paquete.ip_origen, paquete.identificador);
+    confirmar(paquete);
 }
 
 void Nodo::procesarComandoOLED(const IPv4 &paquete)
@@ -169,20 +218,174 @@ void Nodo::procesarComandoOLED(const IPv4 &paquete)
     std::cout << "[+] Comando OLED recibido de nodo 0x" << std::hex << paquete.ip_origen << std::dec << ": ";
     std::cout << std::string(paquete.datos.begin(), paquete.datos.end()) << std::endl;
 
-    // Enviar comando al modem para mostrar mensaje en OLED
-    PropioProtocolo comando;
-    comando.cmd = 7; // Comando OLED
-    comando.longitud_de_dato = paquete.datos.size();
+    // Enviar comando al modem para mostrar mensaje en OLED; un texto de más
+    // de 63 bytes va encadenado en un lote (hasta MAX_DATO_ENCADENADO)
+    size_t bytes_a_copiar = (paquete.datos.size() > MAX_DATO_ENCADENADO) ? MAX_DATO_ENCADENADO : paquete.datos.size();
+    if (bytes_a_copiar > MAX_DATO_COMANDO)
+    {
+        LoteComandos lote;
+        lote.agregar(7, ByteVector(paquete.datos.begin(), paquete.datos.begin() + bytes_a_copiar));
+        enviarLoteAlModem(lote);
+    }
+    else
+    {
+        PropioProtocolo comando;
+        comando.cmd = 7; // Comando OLED
+        comando.longitud_de_dato = bytes_a_copiar;
+        for (size_t i = 0; i < bytes_a_copiar; i++)
+        {
+            comando.dato[i] = paquete.datos[i];
+        }
+        comando.fcs = calcularFCS(comando);
+        enviarComandoAlModem(comando);
+    }
+    confirmar(paquete);
+}
+
+void Nodo::procesarSimboloFuente(const IPv4 &paquete)
+{
+    SimboloFuente simbolo;
+    if (!parsearSimboloFuente(paquete.datos, simbolo))
+        return;
 
-    // Copiar datos (máximo 63 bytes)
-    size_t bytes_a_copiar = (paquete.datos.size() > 63) ? 63 : paquete.datos.size();
-    for (size_t i = 0; i < bytes_a_copiar; i++)
+    time_t ahora = time(NULL);
+
+    // Descartar difusiones abandonadas por el emisor
+    for (std::map<uint32_t, DecodificadorFuente>::iterator it = difusionesFuente.begin(); it != difusionesFuente.end();)
     {
-        comando.dato[i] = paquete.datos[i];
+        if (difftime(ahora, it->second.ultimo_simbolo) > TIMEOUT_DIFUSION_FUENTE)
+            difusionesFuente.erase(it++);
+        else
+            ++it;
     }
-    comando.fcs = calcularFCS(comando);
 
-    enviarComandoAlModem(comando);
+    uint32_t clave = ((uint32_t)paquete.ip_origen << 16) | simbolo.id_objeto;
+    DecodificadorFuente &decodificador = difusionesFuente[clave];
+
+    if (decodificador.completo())
+    {
+        decodificador.ultimo_simbolo = ahora; // símbolos sobrantes del mismo objeto
+        return;
+    }
+
+    if (decodificador.agregar(simbolo))
+    {
+        ByteVector objeto = decodificador.objeto();
+        std::cout << "[+] Difusión codificada de nodo 0x" << std::hex << paquete.ip_origen << std::dec
+                  << " completa: " << objeto.size() << " bytes con "
+                  << decodificador.simbolosRecibidos() << " símbolos (K=" << (int)simbolo.k << ")" << std::endl;
+
+        std::stringstream nombre;
+        nombre << "difusion_" << std::hex << paquete.ip_origen << "_" << simbolo.id_objeto << ".bin";
+        std::ofstream archivo(nombre.str().c_str(), std::ios::binary);
+        if (archivo)
+        {
+            archivo.write((const char *)&objeto[0], objeto.size());
+            std::cout << "[✓] Guardado en " << nombre.str() << std::endl;
+        }
+    }
+}
+
+void Nodo::procesarRespuestaModem(const IPv4 &paquete)
+{
+    if (paquete.ip_origen != ip_nodo || paquete.datos.empty())
+        return;
+
+    if (paquete.datos[0] == CMD_LOTE)
+        procesarLoteModem(paquete.datos);
+    else
+        procesarComandoModem(paquete.datos);
+}
+
+void Nodo::procesarComandoModem(const ByteVector &datos)
+{
+    BloqueTelemetria bloque;
+    if (datos[0] == CMD_TELEMETRIA && parsearBloqueTelemetria(datos, bloque))
+        telemetriaModem.registrar(bloque);
+    else if (datos[0] == CMD_ENTREGA)
+        procesarAvisoEntrega(datos);
+    else if (datos[0] == CMD_DIRECCION || datos[0] == CMD_GRUPOS)
+        procesarConfiguracionModem(datos);
+    else if (datos[0] == CMD_PROTOCOLOS)
+        protocolos.registrarModem(datos);
+}
+
+void Nodo::procesarLoteModem(const ByteVector &datos)
+{
+    // Respuestas a un lote, en el orden de los comandos, y el resumen al final
+    std::vector<ByteVector> respuestas;
+    if (!parsearLoteComandos(datos, respuestas))
+    {
+        std::cout << "[!] Respuesta del modem a un lote mal formada." << std::endl;
+        return;
+    }
+    for (size_t i = 0; i < respuestas.size(); ++i)
+    {
+        if (respuestas[i][0] == CMD_LOTE && respuestas[i][1] == 1)
+        {
+            // Los lotes propios del Nodo (configuración, consultas) cierran en silencio
+            if (resumenesPorAvisar > 0)
+            {
+                resumenesPorAvisar--;
+                std::cout << "[+] El modem ejecutó " << (int)respuestas[i][2] << " comandos del lote." << std::endl;
+            }
+        }
+        else
+            procesarComandoModem(respuestas[i]);
+    }
+}
+
+void Nodo::procesarAvisoEntrega(const ByteVector &datos)
+{
+    // [cmd][6][destino 2B][identificador 2B][estado][intentos][fcs]
+    if (datos.size() < 9 || datos[1] != 6)
+        return;
+    uint16_t destino = (datos[2] << 8) | datos[3];
+    uint16_t id = (datos[4] << 8) | datos[5];
+    if (datos[6] == ENTREGA_SIN_SEGUIMIENTO)
+    {
+        // El modem no la reintenta: se espera el ACK del destino como sin la entrega en el modem
+        std::map<uint16_t, ACKPendiente>::iterator it = acksEsperando.find(id);
+        if (it != acksEsperando.end())
+        {
+            it->second.en_modem = false;
+            it->second.tiempo_envio = time(NULL);
+        }
+        return;
+    }
+    if (datos[6] == 0)
+        std::cout << "[+] Entrega confirmada por el modem: ID " << std::dec << id << " a nodo 0x" << std::hex
+                  << destino << std::dec << " (" << (int)datos[7] << " intentos)" << std::endl;
+    else
+        std::cout << "[!] El modem no obtuvo ACK de nodo 0x" << std::hex << destino << std::dec << " para ID "
+                  << id << " después de " << (int)datos[7] << " intentos." << std::endl;
+    acksEsperando.erase(id);
+}
+
+void Nodo::procesarConfiguracionModem(const ByteVector &datos)
+{
+    // El modem responde con lo que quedó aplicado: [cmd][largo][dato...][fcs]
+    if (datos.size() < 2 || datos.size() < 2u + datos[1])
+        return;
+    if (datos[0] == CMD_DIRECCION && datos[1] == 2)
+    {
+        uint16_t ip = (datos[2] << 8) | datos[3];
+        if (ip != ip_nodo)
+            std::cout << "[!] El modem quedó con IP 0x" << std::hex << ip << " en lugar de 0x" << ip_nodo
+                      << std::dec << std::endl;
+    }
+    else if (datos[0] == CMD_GRUPOS && datos[1] != gruposMulticast.size())
+    {
+        std::cout << "[!] El modem aceptó " << (int)datos[1] << " de " << gruposMulticast.size() << " grupos."
+                  << std::endl;
+    }
+}
+
+void Nodo::confirmar(const IPv4 &paquete)
+{
+    // Con la entrega en el modem el ACK ya salió del modem de este nodo
+    if (paquete.flag_fragmento & FLAG_ENTREGA_MODEM)
+        return;
     enviarACK(paquete.ip_origen, paquete.identificador);
 }
 
@@ -232,6 +435,51 @@ void Nodo::enviarComandoAlModem(const PropioProtocolo &comando)
     enviarPaquete(paquete);
 }
 
+void Nodo::enviarLoteAlModem(const LoteComandos &lote)
+{
+    IPv4 paquete;
+    paquete.flag_fragmento = 0;
+    paquete.offset_fragmento = 0;
+    paquete.identificador = obtenerNuevoID();
+    paquete.protocolo = 0; // Protocolo propio
+    paquete.ip_origen = ip_nodo;
+    paquete.ip_destino = ip_nodo;
+    paquete.datos = lote.construir();
+    paquete.longitud_total = paquete.datos.size();
+
+    // Calcular checksum
+    paquete.checksum = calcularChecksum(paquete);
+
+    enviarPaquete(paquete);
+}
+
+void Nodo::configurarModem()
+{
+    // IP de este nodo (el modem la usa para filtrar y elegir su canal) y
+    // grupos, en un solo lote
+    LoteComandos lote;
+    ByteVector ip;
+    ip.push_back(ip_nodo >> 8);
+    ip.push_back(ip_nodo & 0xFF);
+    lote.agregar(CMD_DIRECCION, ip);
+    lote.agregar(CMD_GRUPOS, ByteVector(gruposMulticast.begin(), gruposMulticast.end()));
+    enviarLoteAlModem(lote);
+}
+
+void Nodo::enviarGruposAlModem()
+{
+    // La lista completa reemplaza a la que tenía el modem
+    PropioProtocolo comando;
+    comando.cmd = CMD_GRUPOS;
+    comando.longitud_de_dato = 0;
+    for (std::set<uint8_t>::iterator it = gruposMulticast.begin(); it != gruposMulticast.end(); ++it)
+    {
+        comando.dato[comando.longitud_de_dato++] = *it;
+    }
+    comando.fcs = calcularFCS(comando);
+    enviarComandoAlModem(comando);
+}
+
 void Nodo::enviarPaquete(const IPv4 &paquete)
 {
     ByteVector ipv4_bytes = construirIPv4(paquete);
@@ -259,6 +507,17 @@ void Nodo::verificarACKsPendientes()
     {
         ACKPendiente &ack = it->second;
 
+        if (ack.en_modem)
+        {
+            // El modem reintenta y siempre avisa; esto cubre sólo un aviso perdido
+            if (difftime(ahora, ack.tiempo_envio) >= TIMEOUT_ENTREGA_MODEM)
+            {
+                std::cout << "[!] Sin aviso del modem para ID " << ack.id_mensaje << ". Descartando." << std::endl;
+                ids_a_eliminar.push_back(it->first);
+            }
+            continue;
+        }
+
         if (difftime(ahora, ack.tiempo_envio) >= 3.0)
         {
             if (ack.intentos < 1)
@@ -294,24 +553,47 @@ void Nodo::verNodos()
     if (tablaNodosHello.empty())
     {
         std::cout << "No se han recibido mensajes Hello de ningún nodo." << std::endl;
-        return;
     }
+    else
+    {
+        time_t ahora = time(NULL);
 
-    time_t ahora = time(NULL);
+        std::cout << "IP Nodo\t\tTiempo transcurrido" << std::endl;
+        std::cout << "-------\t\t-------------------" << std::endl;
+
+        for (std::map<uint16_t, time_t>::iterator it = tablaNodosHello.begin();
+             it != tablaNodosHello.end(); ++it)
+        {
+            uint16_t ip = it->first;
+            time_t recibido = it->second;
+
+            double segundos = difftime(ahora, recibido);
 
-    std::cout << "IP Nodo\t\tTiempo transcurrido" << std::endl;
-    std::cout << "-------\t\t-------------------" << std::endl;
+            std::cout << "0x" << std::hex << ip << std::dec << "\t\t"
+                      << (int)segundos << " segundos" << std::endl;
+        }
+    }
 
-    for (std::map<uint16_t, time_t>::iterator it = tablaNodosHello.begin();
-         it != tablaNodosHello.end(); ++it)
+    if (!tablaVecinos.empty())
     {
-        uint16_t ip = it->first;
-        time_t recibido = it->second;
+        uint64_t ahora_ms = relojMs();
 
-        double segundos = difftime(ahora, recibido);
+        std::cout << "\nCalidad de enlace (promedios EWMA)" << std::endl;
+        std::cout << "IP Nodo\tRSSI\tSNR\tPérdida\tPaquetes\tÚltimo (ms)" << std::endl;
+        std::cout << "-------\t----\t---\t-------\t--------\t-----------" << std::endl;
 
-        std::cout << "0x" << std::hex << ip << std::dec << "\t\t"
-                  << (int)segundos << " segundos" << std::endl;
+        for (std::map<uint16_t, CalidadEnlace>::iterator it = tablaVecinos.begin();
+             it != tablaVecinos.end(); ++it)
+        {
+            const CalidadEnlace &c = it->second;
+            std::cout << "0x" << std::hex << it->first << std::dec << "\t";
+            if (c.con_metadatos)
+                std::cout << (int)c.rssi_ewma << "\t" << (int)(c.snr_ewma * 10) / 10.0 << "\t";
+            else
+                std::cout << "-\t-\t";
+            std::cout << (int)(c.perdida_ewma * 100) << "%\t" << c.paquetes << "\t\t"
+                      << (ahora_ms - c.ultimo_ms) << std::endl;
+        }
     }
     std::cout << "=================================================" << std::endl;
 }
@@ -319,7 +601,12 @@ void Nodo::verNodos()
 void Nodo::enviarHello()
 {
     std::cout << "[+] Enviando mensaje Hello..." << std::endl;
+    transmitirHello(0xFFFF);
+    std::cout << "[✓] Hello enviado correctamente." << std::endl;
+}
 
+void Nodo::transmitirHello(uint16_t ip_destino)
+{
     IPv4 paquete;
     paquete.flag_fragmento = 0;
     paquete.offset_fragmento = 0;
@@ -327,7 +614,7 @@ void Nodo::enviarHello()
     paquete.identificador = obtenerNuevoID();
     paquete.protocolo = 4; // Hello
     paquete.ip_origen = ip_nodo;
-    paquete.ip_destino = 0xFFFF; // Broadcast
+    paquete.ip_destino = ip_destino; // Broadcast o respuesta a un vecino nuevo
 
     // Mensaje "hola"
     std::string mensaje = "hola";
@@ -340,7 +627,59 @@ void Nodo::enviarHello()
     paquete.checksum = calcularChecksum(paquete);
 
     enviarPaquete(paquete);
-    std::cout << "[✓] Hello enviado correctamente." << std::endl;
+}
+
+void Nodo::expirarVecinosHello()
+{
+    time_t ahora = time(NULL);
+    bool cambio = false;
+
+    std::map<uint16_t, time_t>::iterator it = tablaNodosHello.begin();
+    while (it != tablaNodosHello.end())
+    {
+        if (difftime(ahora, it->second) > VIDA_VECINO_HELLO)
+        {
+            tablaNodosHello.erase(it++);
+            cambio = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (cambio)
+        trickleHello.reiniciar(relojMs());
+}
+
+void Nodo::tareasPeriodicas()
+{
+    uint64_t ahora_ms = relojMs();
+
+    expirarVecinosHello();
+
+    if (trickleHello.debeTransmitir(ahora_ms))
+        transmitirHello(0xFFFF);
+
+    if (ahora_ms >= proximaTelemetria)
+    {
+        proximaTelemetria = ahora_ms + INTERVALO_TELEMETRIA_MS;
+        pedirTelemetria();
+    }
+
+    std::map<uint16_t, uint64_t>::iterator it = respuestasHello.begin();
+    while (it != respuestasHello.end())
+    {
+        if (ahora_ms >= it->second)
+        {
+            transmitirHello(it->first);
+            respuestasHello.erase(it++);
+        }
+        else
+        {
+            ++it;
+        }
+    }
 }
 
 void Nodo::enviarMensajeUnicast()
@@ -361,12 +700,7 @@ void Nodo::enviarMensajeUnicast()
     std::stringstream ss(buffer);
     ss >> std::hex >> ip_destino;
 
-    if (tablaNodosHello.find(ip_destino) == tablaNodosHello.end())
-    {
-        std::cout << "[!] Nodo 0x" << std::hex << ip_destino << std::dec
-                  << " no está disponible. Envíe un Hello primero." << std::endl;
-        return;
-    }
+    avisarSiNoEsVecino(ip_destino);
 
     std::cout << "Ingrese el mensaje: ";
     std::cout.flush();
@@ -387,7 +721,7 @@ void Nodo::enviarMensajeUnicast()
     }
 
     IPv4 paquete;
-    paquete.flag_fragmento = 0;
+    paquete.flag_fragmento = ENTREGA_EN_MODEM ? FLAG_ENTREGA_MODEM : 0;
     paquete.offset_fragmento = 0;
     paquete.longitud_total = mensaje.length();
     paquete.identificador = obtenerNuevoID();
@@ -408,6 +742,7 @@ void Nodo::enviarMensajeUnicast()
     ack.id_mensaje = paquete.identificador;
     ack.intentos = 0;
     ack.tiempo_envio = time(NULL);
+    ack.en_modem = ENTREGA_EN_MODEM;
     acksEsperando[paquete.identificador] = ack;
 
     enviarPaquete(paquete);
@@ -416,10 +751,10 @@ void Nodo::enviarMensajeUnicast()
     std::cout << "[...] Esperando ACK en segundo plano...\n";
 }
 
-void Nodo::enviarMensajeBroadcast()
+void Nodo::enviarMensajeBroadcast(uint16_t ip_destino)
 {
     std::string buffer;
-    std::cout << "Ingrese el mensaje broadcast: ";
+    std::cout << (ip_destino == 0xFFFF ? "Ingrese el mensaje broadcast: " : "Ingrese el mensaje para el grupo: ");
     std::cout.flush();
     buffer.clear();
 
@@ -442,9 +777,9 @@ void Nodo::enviarMensajeBroadcast()
     paquete.offset_fragmento = 0;
     paquete.longitud_total = mensaje.length();
     paquete.identificador = obtenerNuevoID();
-    paquete.protocolo = 3; // Broadcast
+    paquete.protocolo = 3; // Broadcast (o multicast a un grupo)
     paquete.ip_origen = ip_nodo;
-    paquete.ip_destino = 0xFFFF;
+    paquete.ip_destino = ip_destino;
 
     for (size_t i = 0; i < mensaje.length(); i++)
     {
@@ -457,6 +792,91 @@ void Nodo::enviarMensajeBroadcast()
     std::cout << "[✓] Mensaje broadcast enviado." << std::endl;
 }
 
+void Nodo::enviarMensajeGrupo()
+{
+    std::string buffer;
+    unsigned int grupo = 0;
+
+    std::cout << "Ingrese el grupo (en hexadecimal, 0 a fe): ";
+    std::cout.flush();
+    buffer.clear();
+
+    while (!leerLineaNoBloqueante(buffer))
+    {
+        actualizarMensajesEntrantes();
+        usleep(50000);
+    }
+
+    std::stringstream ss(buffer);
+    if (!(ss >> std::hex >> grupo) || grupo > 0xFE)
+    {
+        std::cout << "[!] Grupo no válido." << std::endl;
+        return;
+    }
+
+    // Se inunda como un broadcast; sólo lo suben a la UART los modems de los miembros
+    enviarMensajeBroadcast(BASE_GRUPOS | grupo);
+}
+
+void Nodo::enviarDifusionCodificada()
+{
+    std::string buffer;
+    std::cout << "Ingrese la ruta del archivo a difundir: ";
+    std::cout.flush();
+    buffer.clear();
+
+    while (!leerLineaNoBloqueante(buffer))
+    {
+        actualizarMensajesEntrantes();
+        usleep(50000);
+    }
+
+    std::ifstream archivo(buffer.c_str(), std::ios::binary);
+    if (!archivo)
+    {
+        std::cout << "[!] No se pudo abrir el archivo " << buffer << std::endl;
+        return;
+    }
+    ByteVector objeto((std::istreambuf_iterator<char>(archivo)), std::istreambuf_iterator<char>());
+
+    CodificadorFuente codificador(obtenerNuevoID(), objeto);
+    if (!codificador.valido())
+    {
+        std::cout << "[!] El archivo debe tener entre 1 y "
+                  << FUENTE_MAX_SIMBOLOS * FUENTE_TAM_SIMBOLO << " bytes." << std::endl;
+        return;
+    }
+
+    // Sin ACKs: se envía K más un margen de redundancia para cubrir pérdidas
+    int k = codificador.cantidadFuente();
+    int total = k + (k * REDUNDANCIA_FUENTE_PORCENTAJE) / 100 + 2;
+
+    std::cout << "[...] Difundiendo " << objeto.size() << " bytes en " << total
+              << " símbolos (K=" << k << ")" << std::endl;
+
+    for (int esi = 0; esi < total; ++esi)
+    {
+        IPv4 paquete;
+        paquete.flag_fragmento = 0;
+        paquete.offset_fragmento = 0;
+        paquete.identificador = obtenerNuevoID();
+        paquete.protocolo = 8; // Difusión codificada
+        paquete.ip_origen = ip_nodo;
+        paquete.ip_destino = 0xFFFF;
+        paquete.datos = construirSimboloFuente(codificador.generar(esi));
+        paquete.longitud_total = paquete.datos.size();
+        paquete.checksum = calcularChecksum(paquete);
+
+        enviarPaquete(paquete);
+
+        // Dar tiempo al modem para transmitir antes del siguiente símbolo
+        actualizarMensajesEntrantes();
+        usleep(INTERVALO_SIMBOLO_FUENTE_US);
+    }
+
+    std::cout << "[✓] Difusión codificada enviada." << std::endl;
+}
+
 void Nodo::enviarComandoPrueba()
 {
     std::string buffer;
@@ -475,14 +895,10 @@ void Nodo::enviarComandoPrueba()
     std::stringstream ss(buffer);
     ss >> std::hex >> ip_destino;
 
-    if (tablaNodosHello.find(ip_destino) == tablaNodosHello.end() && ip_destino != ip_nodo)
-    {
-        std::cout << "[!] Nodo 0x" << std::hex << ip_destino << std::dec << " no está disponible." << std::endl;
-        return;
-    }
+    avisarSiNoEsVecino(ip_destino);
 
     IPv4 paquete;
-    paquete.flag_fragmento = 0;
+    paquete.flag_fragmento = ENTREGA_EN_MODEM ? FLAG_ENTREGA_MODEM : 0;
     paquete.offset_fragmento = 0;
     paquete.longitud_total = 0;
     paquete.identificador = obtenerNuevoID();
@@ -497,6 +913,7 @@ void Nodo::enviarComandoPrueba()
     ack.id_mensaje = paquete.identificador;
     ack.intentos = 0;
     ack.tiempo_envio = time(NULL);
+    ack.en_modem = ENTREGA_EN_MODEM;
     acksEsperando[paquete.identificador] = ack;
 
     enviarPaquete(paquete);
@@ -521,14 +938,10 @@ void Nodo::enviarComandoLed()
     std::stringstream ss(buffer);
     ss >> std::hex >> ip_destino;
 
-    if (tablaNodosHello.find(ip_destino) == tablaNodosHello.end() && ip_destino != ip_nodo)
-    {
-        std::cout << "[!] Nodo 0x" << std::hex << ip_destino << std::dec << " no está disponible." << std::endl;
-        return;
-    }
+    avisarSiNoEsVecino(ip_destino);
 
     IPv4 paquete;
-    paquete.flag_fragmento = 0;
+    paquete.flag_fragmento = ENTREGA_EN_MODEM ? FLAG_ENTREGA_MODEM : 0;
     paquete.offset_fragmento = 0;
     paquete.longitud_total = 0;
     paquete.identificador = obtenerNuevoID();
@@ -543,6 +956,7 @@ void Nodo::enviarComandoLed()
     ack.id_mensaje = paquete.identificador;
     ack.intentos = 0;
     ack.tiempo_envio = time(NULL);
+    ack.en_modem = ENTREGA_EN_MODEM;
     acksEsperando[paquete.identificador] = ack;
 
     enviarPaquete(paquete);
@@ -567,11 +981,7 @@ void Nodo::enviarMensajeOLED()
     std::stringstream ss(buffer);
     ss >> std::hex >> ip_destino;
 
-    if (tablaNodosHello.find(ip_destino) == tablaNodosHello.end() && ip_destino != ip_nodo)
-    {
-        std::cout << "[!] Nodo 0x" << std::hex << ip_destino << std::dec << " no está disponible." << std::endl;
-        return;
-    }
+    avisarSiNoEsVecino(ip_destino);
 
     std::cout << "Ingrese mensaje para OLED: ";
     std::cout.flush();
@@ -592,7 +1002,7 @@ void Nodo::enviarMensajeOLED()
     }
 
     IPv4 paquete;
-    paquete.flag_fragmento = 0;
+    paquete.flag_fragmento = ENTREGA_EN_MODEM ? FLAG_ENTREGA_MODEM : 0;
     paquete.offset_fragmento = 0;
     paquete.longitud_total = mensaje.length();
     paquete.identificador = obtenerNuevoID();
@@ -612,12 +1022,136 @@ void Nodo::enviarMensajeOLED()
     ack.id_mensaje = paquete.identificador;
     ack.intentos = 0;
     ack.tiempo_envio = time(NULL);
+    ack.en_modem = ENTREGA_EN_MODEM;
     acksEsperando[paquete.identificador] = ack;
 
     enviarPaquete(paquete);
     std::cout << "[✓] Mensaje OLED enviado. Esperando ACK en segundo plano...\n";
 }
 
+void Nodo::pedirTelemetria()
+{
+    // Un bloque de contadores y una página del costo por protocolo, en un lote
+    LoteComandos lote;
+    lote.agregar(CMD_TELEMETRIA, ByteVector(1, telemetriaModem.siguienteBloque()));
+    lote.agregar(CMD_PROTOCOLOS, ByteVector(1, protocolos.siguientePaginaModem()));
+    enviarLoteAlModem(lote);
+}
+
+void Nodo::verTelemetria()
+{
+    std::cout << "\n============ ESTADÍSTICAS DEL MODEM ============" << std::endl;
+    if (telemetriaModem.vacia())
+        std::cout << "El modem aún no respondió la consulta de contadores." << std::endl;
+    else
+        telemetriaModem.mostrar(std::cout);
+    std::cout << "\n-------------- COSTO POR PROTOCOLO --------------" << std::endl;
+    protocolos.mostrar(std::cout);
+    std::cout << "=================================================" << std::endl;
+}
+
+void Nodo::cambiarGrupos()
+{
+    std::string buffer;
+    unsigned int grupo = 0;
+
+    std::cout << "Grupos de multicast:";
+    if (gruposMulticast.empty())
+        std::cout << " ninguno";
+    for (std::set<uint8_t>::iterator it = gruposMulticast.begin(); it != gruposMulticast.end(); ++it)
+        std::cout << " " << std::hex << (int)*it << std::dec;
+    std::cout << "\nIngrese el grupo para unirse o salir (en hexadecimal, 0 a fe): ";
+    std::cout.flush();
+    buffer.clear();
+
+    while (!leerLineaNoBloqueante(buffer))
+    {
+        actualizarMensajesEntrantes();
+        usleep(50000);
+    }
+
+    std::stringstream ss(buffer);
+    if (!(ss >> std::hex >> grupo) || grupo > 0xFE)
+    {
+        std::cout << "[!] Grupo no válido." << std::endl;
+        return;
+    }
+
+    if (gruposMulticast.erase(grupo) > 0)
+    {
+        std::cout << "[✓] Se salió del grupo " << std::hex << grupo << std::dec << "." << std::endl;
+    }
+    else if (gruposMulticast.size() >= MAX_GRUPOS_NODO)
+    {
+        std::cout << "[!] No se puede estar en más de " << MAX_GRUPOS_NODO << " grupos." << std::endl;
+        return;
+    }
+    else
+    {
+        gruposMulticast.insert(grupo);
+        std::cout << "[✓] Unido al grupo " << std::hex << grupo << std::dec << "." << std::endl;
+    }
+    enviarGruposAlModem();
+}
+
+void Nodo::enviarSecuenciaComandos()
+{
+    std::string buffer;
+
+    std::cout << "Comandos separados por ';' (prueba, led, oled <texto>, telemetria): ";
+    std::cout.flush();
+    buffer.clear();
+
+    while (!leerLineaNoBloqueante(buffer))
+    {
+        actualizarMensajesEntrantes();
+        usleep(50000);
+    }
+
+    // Todo el guión va al modem en una trama; si algo no se entiende no se envía nada
+    LoteComandos lote;
+    std::stringstream ss(buffer);
+    std::string paso;
+    while (std::getline(ss, paso, ';'))
+    {
+        size_t inicio = paso.find_first_not_of(" ");
+        if (inicio == std::string::npos)
+            continue;
+        paso = paso.substr(inicio);
+        std::string nombre = paso.substr(0, paso.find(' '));
+        std::string texto = nombre.size() < paso.size() ? paso.substr(nombre.size() + 1) : "";
+
+        bool agregado = false;
+        if (nombre == "prueba")
+            agregado = lote.agregar(5, ByteVector());
+        else if (nombre == "led")
+            agregado = lote.agregar(6, ByteVector());
+        else if (nombre == "oled" && !texto.empty())
+            agregado = lote.agregar(7, ByteVector(texto.begin(), texto.end()));
+        else if (nombre == "telemetria")
+            agregado = lote.agregar(CMD_TELEMETRIA, ByteVector(1, telemetriaModem.siguienteBloque()));
+        else
+        {
+            std::cout << "[!] Comando no válido: " << paso << std::endl;
+            return;
+        }
+        if (!agregado)
+        {
+            std::cout << "[!] La secuencia no cabe en una trama (" << MAX_LOTE << " bytes)." << std::endl;
+            return;
+        }
+    }
+    if (lote.comandos() == 0)
+    {
+        std::cout << "[!] Secuencia vacía." << std::endl;
+        return;
+    }
+
+    enviarLoteAlModem(lote);
+    resumenesPorAvisar++;
+    std::cout << "[✓] " << lote.comandos() << " comandos enviados al modem en una trama." << std::endl;
+}
+
 void Nodo::menuComandosInternos()
 {
     std::string buffer;
@@ -631,7 +1165,10 @@ void Nodo::menuComandosInternos()
         std::cout << "1. Comando de prueba" << std::endl;
         std::cout << "2. Cambiar estado LED" << std::endl;
         std::cout << "3. Enviar mensaje a OLED" << std::endl;
-        std::cout << "4. Volver al menú principal" << std::endl;
+        std::cout << "4. Estadísticas del modem" << std::endl;
+        std::cout << "5. Grupos de multicast" << std::endl;
+        std::cout << "6. Secuencia de comandos al modem" << std::endl;
+        std::cout << "7. Volver al menú principal" << std::endl;
         std::cout << "Seleccione una opción: ";
         std::cout.flush();
 
@@ -656,6 +1193,15 @@ void Nodo::menuComandosInternos()
             enviarMensajeOLED();
             break;
         case 4:
+            verTelemetria();
+            break;
+        case 5:
+            cambiarGrupos();
+            break;
+        case 6:
+            enviarSecuenciaComandos();
+            break;
+        case 7:
             std::cout << "Volviendo al menú principal..." << std::endl;
             break;
         default:
@@ -663,7 +1209,7 @@ void Nodo::menuComandosInternos()
             break;
         }
 
-    } while (opcion != 4);
+    } while (opcion != 7);
 }
 
 void Nodo::menuEnvioMensajes()
@@ -678,7 +1224,9 @@ void Nodo::menuEnvioMensajes()
         std::cout << "\n========== ENVÍO DE MENSAJES ==========" << std::endl;
         std::cout << "1. Enviar mensaje unicast" << std::endl;
         std::cout << "2. Enviar mensaje broadcast" << std::endl;
-        std::cout << "3. Volver al menú principal" << std::endl;
+        std::cout << "3. Difundir archivo (broadcast codificado)" << std::endl;
+        std::cout << "4. Enviar mensaje a un grupo" << std::endl;
+        std::cout << "5. Volver al menú principal" << std::endl;
         std::cout << "Seleccione una opción: ";
         std::cout.flush();
 
@@ -700,6 +1248,12 @@ void Nodo::menuEnvioMensajes()
             enviarMensajeBroadcast();
             break;
         case 3:
+            enviarDifusionCodificada();
+            break;
+        case 4:
+            enviarMensajeGrupo();
+            break;
+        case 5:
             std::cout << "Volviendo al menú principal..." << std::endl;
             break;
         default:
@@ -707,7 +1261,7 @@ void Nodo::menuEnvioMensajes()
             break;
         }
 
-    } while (opcion != 3);
+    } while (opcion != 5);
 }
 
 void Nodo::menu()
@@ -716,7 +1270,8 @@ void Nodo::menu()
     std::string buffer;
     int opcion = -1;
 
-    srand(time(NULL));
+    srand(time(NULL) ^ ip_nodo);
+    trickleHello.iniciar(relojMs());
 
     do
     {
@@ -817,6 +1372,8 @@ void Nodo::run()
 
     std::cout << "Comunicación UART establecida correctamente" << std::endl;
 
+    configurarModem();
+
     menu();
 
     std::cout << "=== NODO FINALIZADO ===" << std::endl;
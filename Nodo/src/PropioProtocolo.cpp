@@ -1,8 +1,5 @@
 #include "PropioProtocolo.h"
 
-#include "PropioProtocolo.h"
-#include <cstring>
-
 ByteVector construirProtocoloPropio(const PropioProtocolo &protocolo)
 {
     ByteVector salida;
@@ -42,10 +39,7 @@ bool parsearProtocoloPropio(const ByteVector &entrada, PropioProtocolo &protocol
     if (entrada.size() < (2 + protocolo.longitud_de_dato + 1))
         return false;
 
-    // Limpiar datos
-    memset(protocolo.dato, 0, sizeof(protocolo.dato));
-
-    // Copiar datos
+    // Copiar sólo los bytes del dato
     for (int i = 0; i < protocolo.longitud_de_dato && i < 63; ++i)
     {
         protocolo.dato[i] = entrada[2 + i];
@@ -75,4 +69,101 @@ BYTE calcularFCS(const PropioProtocolo &protocolo)
     }
 
     return fcs;
-}
\ No newline at end of file
+}
+
+LoteComandos::LoteComandos() : cantidadTramos(0), cantidadComandos(0)
+{
+}
+
+bool LoteComandos::agregar(BYTE cmd, const ByteVector &dato)
+{
+    // Tramos de 63 bytes; un dato vacío ocupa igual un tramo
+    size_t tramos_dato = dato.empty() ? 1 : (dato.size() + MAX_DATO_COMANDO - 1) / MAX_DATO_COMANDO;
+    if (dato.size() > MAX_DATO_ENCADENADO || 2 + tramos.size() + 2 * tramos_dato + dato.size() + 1 > MAX_LOTE)
+        return false;
+
+    size_t pos = 0;
+    do
+    {
+        size_t largo = dato.size() - pos > MAX_DATO_COMANDO ? MAX_DATO_COMANDO : dato.size() - pos;
+        bool continua = pos + largo < dato.size();
+        tramos.push_back(continua ? (cmd | CMD_CONTINUA) : (cmd & ~CMD_CONTINUA));
+        tramos.push_back(largo);
+        tramos.insert(tramos.end(), dato.begin() + pos, dato.begin() + pos + largo);
+        cantidadTramos++;
+        pos += largo;
+    } while (pos < dato.size());
+    cantidadComandos++;
+    return true;
+}
+
+bool LoteComandos::agregar(const PropioProtocolo &comando)
+{
+    return agregar(comando.cmd, ByteVector(comando.dato, comando.dato + comando.longitud_de_dato));
+}
+
+ByteVector LoteComandos::construir() const
+{
+    ByteVector salida;
+    salida.push_back(CMD_LOTE);
+    salida.push_back(cantidadTramos);
+    salida.insert(salida.end(), tramos.begin(), tramos.end());
+
+    BYTE fcs = 0;
+    for (size_t i = 0; i < salida.size(); ++i)
+        fcs ^= salida[i];
+    salida.push_back(fcs);
+    return salida;
+}
+
+bool parsearLoteComandos(const ByteVector &entrada, std::vector<ByteVector> &comandos)
+{
+    if (entrada.size() < 3 || entrada[0] != CMD_LOTE)
+        return false;
+    BYTE fcs = 0;
+    for (size_t i = 0; i + 1 < entrada.size(); ++i)
+        fcs ^= entrada[i];
+    if (fcs != entrada.back())
+        return false;
+
+    // Se valida todo antes de devolver nada
+    std::vector<ByteVector> salida;
+    ByteVector dato;
+    size_t fin = entrada.size() - 1;
+    size_t pos = 2;
+    bool encadenado = false;
+    BYTE anterior = 0;
+    for (int i = 0; i < entrada[1]; ++i)
+    {
+        if (pos + 2 > fin)
+            return false;
+        BYTE cmd = entrada[pos] & ~CMD_CONTINUA;
+        size_t largo = entrada[pos + 1];
+        if (largo > MAX_DATO_COMANDO || pos + 2 + largo > fin || (encadenado && cmd != anterior))
+            return false;
+        dato.insert(dato.end(), entrada.begin() + pos + 2, entrada.begin() + pos + 2 + largo);
+        if (dato.size() > MAX_DATO_ENCADENADO)
+            return false;
+        encadenado = entrada[pos] & CMD_CONTINUA;
+        anterior = cmd;
+        pos += 2 + largo;
+
+        if (!encadenado)
+        {
+            ByteVector comando;
+            comando.push_back(cmd);
+            comando.push_back(dato.size());
+            comando.insert(comando.end(), dato.begin(), dato.end());
+            BYTE fcs_comando = 0;
+            for (size_t j = 0; j < comando.size(); ++j)
+                fcs_comando ^= comando[j];
+            comando.push_back(fcs_comando);
+            salida.push_back(comando);
+            dato.clear();
+        }
+    }
+    if (pos != fin || encadenado)
+        return false;
+    comandos.swap(salida);
+    return true;
+}
@@ -0,0 +1,108 @@
+#include "RegistroProtocolos.h"
+#include "Reloj.h"
+#include <iomanip>
+#include <sstream>
+
+RegistroProtocolos::RegistroProtocolos()
+    : entradas_(256), modem_(PROTOCOLO_OTROS_MODEM + 1), paginaModem_(0)
+{
+    for (size_t i = 0; i < entradas_.size(); ++i)
+    {
+        entradas_[i].tramas = 0;
+        entradas_[i].us_total = 0;
+        entradas_[i].us_maximo = 0;
+    }
+    for (size_t i = 0; i < modem_.size(); ++i)
+    {
+        modem_[i].tramas = 0;
+        modem_[i].us_medio = 0;
+        modem_[i].us_maximo = 0;
+    }
+}
+
+void RegistroProtocolos::registrar(BYTE protocolo, const std::string &nombre, const Manejador &manejador)
+{
+    entradas_[protocolo].nombre = nombre;
+    entradas_[protocolo].manejador = manejador;
+}
+
+bool RegistroProtocolos::despachar(const IPv4 &paquete)
+{
+    Entrada &entrada = entradas_[paquete.protocolo];
+    if (!entrada.manejador)
+    {
+        entrada.tramas++;
+        return false;
+    }
+
+    uint64_t inicio = relojUs();
+    entrada.manejador(paquete);
+    uint64_t duracion = relojUs() - inicio;
+    entrada.tramas++;
+    entrada.us_total += duracion;
+    if (duracion > entrada.us_maximo)
+        entrada.us_maximo = duracion;
+    return true;
+}
+
+bool RegistroProtocolos::registrarModem(const ByteVector &datos)
+{
+    if (datos.size() < 4 || datos[0] != CMD_PROTOCOLOS)
+        return false;
+    size_t largo = datos[1];
+    if (largo < 1 || datos.size() < 3 + largo || (largo - 1) % ENTRADA_PROTOCOLO != 0)
+        return false;
+
+    for (size_t pos = 3; pos < 2 + largo; pos += ENTRADA_PROTOCOLO)
+    {
+        const BYTE *e = &datos[pos];
+        if (e[0] >= modem_.size())
+            continue;
+        EntradaModem &entrada = modem_[e[0]];
+        entrada.tramas = ((uint32_t)e[1] << 24) | (e[2] << 16) | (e[3] << 8) | e[4];
+        entrada.us_medio = (e[5] << 8) | e[6];
+        entrada.us_maximo = (e[7] << 8) | e[8];
+    }
+    paginaModem_ = datos[2];
+    return true;
+}
+
+std::string RegistroProtocolos::nombre(int protocolo) const
+{
+    if (protocolo < (int)entradas_.size() && !entradas_[protocolo].nombre.empty())
+        return entradas_[protocolo].nombre;
+    std::stringstream s;
+    s << "Protocolo " << protocolo;
+    return s.str();
+}
+
+void RegistroProtocolos::mostrar(std::ostream &salida) const
+{
+    salida << std::left << std::setw(4) << "N" << std::setw(14) << "Protocolo" << std::right << std::setw(10)
+           << "Tramas" << std::setw(10) << "us medio" << std::setw(10) << "us max" << std::endl;
+
+    salida << "Nodo:" << std::endl;
+    for (size_t i = 0; i < entradas_.size(); ++i)
+    {
+        const Entrada &e = entradas_[i];
+        if (e.tramas == 0)
+            continue;
+        salida << std::left << std::setw(4) << i << std::setw(14) << (e.manejador ? nombre(i) : "(sin manejador)")
+               << std::right << std::setw(10) << e.tramas;
+        if (e.manejador)
+            salida << std::setw(10) << e.us_total / e.tramas << std::setw(10) << e.us_maximo;
+        salida << std::endl;
+    }
+
+    salida << "Modem (desde el Nodo):" << std::endl;
+    for (size_t i = 0; i < modem_.size(); ++i)
+    {
+        const EntradaModem &e = modem_[i];
+        if (e.tramas == 0)
+            continue;
+        salida << std::left << std::setw(4) << (i == PROTOCOLO_OTROS_MODEM ? "16+" : std::to_string(i))
+               << std::setw(14) << (i == PROTOCOLO_OTROS_MODEM ? "Otros" : nombre(i)) << std::right
+               << std::setw(10) << e.tramas << std::setw(10) << e.us_medio << std::setw(10) << e.us_maximo
+               << std::endl;
+    }
+}
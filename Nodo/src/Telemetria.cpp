@@ -0,0 +1,174 @@
+#include "Telemetria.h"
+#include <iomanip>
+
+#define CONTADORES_POR_BLOQUE 14
+
+struct DescripcionContador
+{
+    const char *nombre;
+    bool nivel; // ocupación instantánea, sin tasa
+};
+
+// Mismo orden que ContadorTelemetria en el firmware
+static const DescripcionContador contadores[] = {
+    {"UART tramas RX", false},
+    {"UART bytes RX", false},
+    {"UART tramas TX", false},
+    {"UART bytes TX", false},
+    {"UART errores SLIP", false},
+    {"UART desbordes", false},
+    {"UART sin buffer", false},
+    {"IPv4 inválidas", false},
+    {"Comandos propios", false},
+    {"RX tramas", false},
+    {"RX errores CRC", false},
+    {"RX anillo lleno", false},
+    {"RX largo inválido", false},
+    {"RX FEC corregidas", false},
+    {"RX FEC irrecuperables", false},
+    {"TX encoladas", false},
+    {"TX transmitidas", false},
+    {"TX cola llena", false},
+    {"TX timeouts", false},
+    {"TX canal ocupado", false},
+    {"TX descartadas (canal)", false},
+    {"Aire total (ms)", false},
+    {"Aire esperas", false},
+    {"Inundación reenviadas", false},
+    {"Inundación duplicadas", false},
+    {"Pool agotado", false},
+    {"OLED refrescos", false},
+    {"OLED bytes I2C", false},
+    {"OLED coalescidas", false},
+    {"Utilización aire (pormil)", true},
+    {"Pool libres", true},
+    {"Cola UART->radio", true},
+    {"Cola radio->UART", true},
+    {"Cola TX", true},
+    {"Anillo RX", true},
+    {"Directas hacia red", false},
+    {"Directas hacia Nodo", false},
+    {"Copias IPv4", false},
+    {"Bytes copiados IPv4", false},
+    {"Entregas confirmadas", false},
+    {"Entregas fallidas", false},
+    {"Entregas reintentos", false},
+    {"Entregas ACK generados", false},
+    {"Filtradas por destino", false},
+    {"Lotes de comandos", false},
+    {"Lotes rechazados", false},
+    {"TX no encoladas", false},
+    {"Comandos desconocidos", false},
+    {"Entregas sin lugar", false},
+};
+
+static const size_t CONTADORES_CONOCIDOS = sizeof(contadores) / sizeof(contadores[0]);
+
+static uint32_t leer32(const BYTE *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Nombre rellenado a 'ancho' caracteres contando en UTF-8 (setw cuenta bytes)
+static std::string columna(const std::string &texto, size_t ancho)
+{
+    size_t caracteres = 0;
+    for (size_t i = 0; i < texto.size(); ++i)
+        if ((texto[i] & 0xC0) != 0x80)
+            caracteres++;
+    return caracteres < ancho ? texto + std::string(ancho - caracteres, ' ') : texto;
+}
+
+bool parsearBloqueTelemetria(const ByteVector &datos, BloqueTelemetria &bloque)
+{
+    if (datos.size() < 3 || datos[0] != CMD_TELEMETRIA)
+        return false;
+    size_t largo = datos[1];
+    if (largo < CABECERA_BLOQUE_TELEMETRIA || datos.size() < 3 + largo || (largo - CABECERA_BLOQUE_TELEMETRIA) % 4 != 0)
+        return false;
+
+    // FCS del modem: XOR de cmd, largo y dato
+    BYTE fcs = 0;
+    for (size_t i = 0; i < 2 + largo; ++i)
+        fcs ^= datos[i];
+    if (fcs != datos[2 + largo])
+        return false;
+
+    const BYTE *d = &datos[2];
+    if (d[0] != VERSION_TELEMETRIA || d[2] == 0 || d[1] >= d[2])
+        return false;
+    bloque.bloque = d[1];
+    bloque.bloques = d[2];
+    bloque.tiempo_ms = leer32(&d[3]);
+    bloque.valores.clear();
+    for (size_t i = CABECERA_BLOQUE_TELEMETRIA; i < largo; i += 4)
+        bloque.valores.push_back(leer32(&d[i]));
+    return true;
+}
+
+TelemetriaModem::TelemetriaModem() : bloques_(1), proximo_(0) {}
+
+BYTE TelemetriaModem::siguienteBloque()
+{
+    BYTE bloque = proximo_;
+    proximo_ = (proximo_ + 1) % bloques_;
+    return bloque;
+}
+
+void TelemetriaModem::registrar(const BloqueTelemetria &bloque)
+{
+    bloques_ = bloque.bloques;
+    if (proximo_ >= bloques_)
+        proximo_ = 0;
+
+    size_t primero = (size_t)bloque.bloque * CONTADORES_POR_BLOQUE;
+    if (muestras_.size() < primero + bloque.valores.size())
+        muestras_.resize(primero + bloque.valores.size(), Muestra());
+
+    for (size_t i = 0; i < bloque.valores.size(); ++i)
+    {
+        Muestra &m = muestras_[primero + i];
+        // Un reloj que retrocede es un modem reiniciado: la tasa no vale
+        m.con_anterior = m.valida && bloque.tiempo_ms > m.tiempo_ms && bloque.valores[i] >= m.valor;
+        m.anterior = m.valor;
+        m.tiempo_anterior_ms = m.tiempo_ms;
+        m.valor = bloque.valores[i];
+        m.tiempo_ms = bloque.tiempo_ms;
+        m.valida = true;
+    }
+}
+
+bool TelemetriaModem::vacia() const
+{
+    return muestras_.empty();
+}
+
+void TelemetriaModem::mostrar(std::ostream &salida) const
+{
+    salida << std::left << std::setw(26) << "Contador" << std::right << std::setw(12) << "Valor"
+           << std::setw(12) << "Por seg." << std::endl;
+    salida << std::left << std::setw(26) << "--------" << std::right << std::setw(12) << "-----"
+           << std::setw(12) << "--------" << std::endl;
+    for (size_t i = 0; i < muestras_.size(); ++i)
+    {
+        const Muestra &m = muestras_[i];
+        if (!m.valida)
+            continue;
+        bool nivel = i < CONTADORES_CONOCIDOS && contadores[i].nivel;
+        if (i < CONTADORES_CONOCIDOS)
+            salida << columna(contadores[i].nombre, 26);
+        else
+            salida << "Contador " << std::left << std::setw(17) << i;
+        salida << std::right << std::setw(12) << m.valor << std::setw(12);
+        if (!nivel && m.con_anterior)
+        {
+            double tasa = (m.valor - m.anterior) * 1000.0 / (m.tiempo_ms - m.tiempo_anterior_ms);
+            salida << std::fixed << std::setprecision(2) << tasa;
+        }
+        else
+        {
+            salida << "-";
+        }
+        salida << std::endl;
+    }
+}
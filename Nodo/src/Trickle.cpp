@@ -0,0 +1,56 @@
+#include "Trickle.h"
+#include <cstdlib>
+
+Trickle::Trickle(uint64_t imin_ms, int duplicaciones, int k)
+    : imin_(imin_ms), imax_(imin_ms << duplicaciones), k_(k), i_(imin_ms), inicio_(0), t_(0), c_(0), evaluado_(true) {}
+
+void Trickle::iniciar(uint64_t ahora_ms)
+{
+    // Primer intervalo al azar en [Imin, Imax] para no sincronizar nodos encendidos juntos
+    i_ = imin_ + rand() % (imax_ - imin_ + 1);
+    nuevoIntervalo(ahora_ms);
+}
+
+void Trickle::reiniciar(uint64_t ahora_ms)
+{
+    if (i_ == imin_)
+        return; // ya en el intervalo mínimo
+    i_ = imin_;
+    nuevoIntervalo(ahora_ms);
+}
+
+void Trickle::consistente()
+{
+    c_++;
+}
+
+bool Trickle::debeTransmitir(uint64_t ahora_ms)
+{
+    if (ahora_ms >= inicio_ + i_)
+    {
+        i_ = (i_ * 2 > imax_) ? imax_ : i_ * 2;
+        nuevoIntervalo(ahora_ms);
+    }
+
+    if (!evaluado_ && ahora_ms >= inicio_ + t_)
+    {
+        evaluado_ = true;
+        return c_ < k_;
+    }
+    return false;
+}
+
+uint64_t Trickle::intervalo() const
+{
+    return i_;
+}
+
+void Trickle::nuevoIntervalo(uint64_t ahora_ms)
+{
+    inicio_ = ahora_ms;
+    t_ = i_ / 2 + rand() % (i_ / 2 + 1);
+    if (t_ >= i_)
+        t_ = i_ - 1;
+    c_ = 0;
+    evaluado_ = false;
+}
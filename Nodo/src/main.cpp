@@ -5,6 +5,7 @@
 int main(int argc, char *argv[])
 {
     uint16_t ip_nodo = 0x0003; // IP
+    std::string dispositivo = "/dev/ttyUSB0";
 
     // Permitir especificar IP como argumento
     if (argc > 1)
@@ -12,9 +13,15 @@ int main(int argc, char *argv[])
         ip_nodo = (uint16_t)strtol(argv[1], NULL, 16);
     }
 
+    // Puerto serie del modem (p. ej. la pty de un modem simulado en sim/fil)
+    if (argc > 2)
+    {
+        dispositivo = argv[2];
+    }
+
     std::cout << "Iniciando nodo con IP: 0x" << std::hex << ip_nodo << std::dec << std::endl;
 
-    Nodo nodo(ip_nodo);
+    Nodo nodo(ip_nodo, dispositivo);
     nodo.run();
 
     return 0;